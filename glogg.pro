@@ -21,12 +21,28 @@ win32:Release:QMAKE_LFLAGS += "-Wl,-subsystem,windows"
 SOURCES += \
     src/main.cpp \
     src/session.cpp \
+    src/headlesssearch.cpp \
     src/data/abstractlogdata.cpp \
+    src/data/abstractlogsource.cpp \
     src/data/logdata.cpp \
     src/data/logfiltereddata.cpp \
     src/data/logfiltereddataworkerthread.cpp \
     src/data/logdataworkerthread.cpp \
     src/data/compressedlinestorage.cpp \
+    src/data/filefingerprint.cpp \
+    src/data/compositelogdata.cpp \
+    src/data/concatenatedlogdata.cpp \
+    src/data/mergedlogdata.cpp \
+    src/data/mergedlogdataworkerthread.cpp \
+    src/data/timestampparser.cpp \
+    src/data/globalsearch.cpp \
+    src/data/groupby.cpp \
+    src/data/taskscheduler.cpp \
+    src/data/inputspooler.cpp \
+    src/data/utf16scanner.cpp \
+    src/data/fieldquery.cpp \
+    src/data/fieldindex.cpp \
+    src/data/templateminer.cpp \
     src/mainwindow.cpp \
     src/crawlerwidget.cpp \
     src/abstractlogview.cpp \
@@ -43,9 +59,15 @@ SOURCES += \
     src/selection.cpp \
     src/quickfind.cpp \
     src/quickfindpattern.cpp \
+    src/quickfindindex.cpp \
     src/quickfindwidget.cpp \
+    src/globalsearchwidget.cpp \
+    src/groupbywidget.cpp \
+    src/templateswidget.cpp \
+    src/statisticswidget.cpp \
     src/sessioninfo.cpp \
     src/recentfiles.cpp \
+    src/fileset.cpp \
     src/overview.cpp \
     src/overviewwidget.cpp \
     src/marks.cpp \
@@ -55,20 +77,39 @@ SOURCES += \
     src/viewtools.cpp \
     src/encodingspeculator.cpp \
     src/gloggapp.cpp \
+    src/updatescheduler.cpp \
+    src/tracing.cpp \
 
 INCLUDEPATH += src/
 
 HEADERS += \
     src/data/abstractlogdata.h \
+    src/data/abstractlogsource.h \
     src/data/logdata.h \
     src/data/logfiltereddata.h \
     src/data/logfiltereddataworkerthread.h \
     src/data/logdataworkerthread.h \
     src/data/threadprivatestore.h \
     src/data/compressedlinestorage.h \
+    src/data/filefingerprint.h \
     src/data/linepositionarray.h \
+    src/data/compositelogdata.h \
+    src/data/concatenatedlogdata.h \
+    src/data/mergedlogdata.h \
+    src/data/mergedlogdataworkerthread.h \
+    src/data/timestampparser.h \
+    src/data/globalsearch.h \
+    src/data/groupby.h \
+    src/data/taskscheduler.h \
+    src/data/inputspooler.h \
+    src/data/utf16scanner.h \
+    src/data/fieldquery.h \
+    src/data/fieldindex.h \
+    src/data/packedarray.h \
+    src/data/templateminer.h \
     src/mainwindow.h \
     src/session.h \
+    src/headlesssearch.h \
     src/viewinterface.h \
     src/crawlerwidget.h \
     src/logmainview.h \
@@ -86,10 +127,17 @@ HEADERS += \
     src/selection.h \
     src/quickfind.h \
     src/quickfindpattern.h \
+    src/quickfindindex.h \
+    src/timeslice.h \
     src/quickfindwidget.h \
+    src/globalsearchwidget.h \
+    src/groupbywidget.h \
+    src/templateswidget.h \
+    src/statisticswidget.h \
     src/sessioninfo.h \
     src/persistable.h \
     src/recentfiles.h \
+    src/fileset.h \
     src/menuactiontooltipbehavior.h \
     src/overview.h \
     src/overviewwidget.h \
@@ -101,8 +149,11 @@ HEADERS += \
     src/loadingstatus.h \
     src/externalcom.h \
     src/viewtools.h \
+    src/perfcounter.h \
     src/encodingspeculator.h \
     src/gloggapp.h \
+    src/updatescheduler.h \
+    src/tracing.h \
 
 isEmpty(BOOST_PATH) {
     message(Building using system dynamic Boost libraries)
@@ -41,6 +41,7 @@
 #include <QGestureEvent>
 
 #include "log.h"
+#include "tracing.h"
 
 #include "persistentinfo.h"
 #include "filterset.h"
@@ -288,6 +289,10 @@ AbstractLogView::AbstractLogView(const AbstractLogData* newLogData,
             this, SIGNAL( notifyQuickFind( const QFNotification& ) ) );
     connect( &quickFind_, SIGNAL( clearNotification() ),
             this, SIGNAL( clearQuickFindNotification() ) );
+    connect( &quickFind_, SIGNAL( searchDone( qint64 ) ),
+            this, SLOT( quickFindDone( qint64 ) ) );
+    connect( &quickFind_, SIGNAL( indexUpdated() ),
+            this, SLOT( quickFindIndexUpdated() ) );
     connect( &followElasticHook_, SIGNAL( lengthChanged() ),
             this, SLOT( repaint() ) );
     connect( &followElasticHook_, SIGNAL( hooked( bool ) ),
@@ -753,6 +758,8 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
     if ( (invalidRect.isEmpty()) || (logData == NULL) )
         return;
 
+    TRACE_SPAN( "view", "AbstractLogView::paintEvent" );
+
     LOG(logDEBUG4) << "paintEvent received, firstLine=" << firstLine
         << " lastLineAligned=" << lastLineAligned
         << " rect: " << invalidRect.topLeft().x() <<
@@ -770,6 +777,11 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
     }
 #endif
 
+    if ( ! paintCounter_.addEvent() ) {
+        paintCounter_.readAndReset();
+        paintCounter_.addEvent();
+    }
+
     auto start = std::chrono::system_clock::now();
 
     // Can we use our cache?
@@ -783,6 +795,7 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
     if ( delta_y != 0 ) {
         // Full or partial redraw
         drawTextArea( &textAreaCache_.pixmap_, delta_y );
+        ++textCacheMisses_;
 
         textAreaCache_.invalid_      = false;
         textAreaCache_.first_line_   = firstLine;
@@ -794,6 +807,7 @@ void AbstractLogView::paintEvent( QPaintEvent* paintEvent )
     }
     else {
         // Use the cache as is: nothing to do!
+        ++textCacheHits_;
     }
 
     // Height including the potentially invisible last line
@@ -861,12 +875,21 @@ qint64 AbstractLogView::maxDisplayLineNumber() const
     return logData->getNbLine();
 }
 
+bool AbstractLogView::searchMatchesForLine( int,
+        QList<QuickFindMatch>& ) const
+{
+    return false;
+}
+
 void AbstractLogView::setOverview( Overview* overview,
        OverviewWidget* overview_widget )
 {
     overview_ = overview;
     overviewWidget_ = overview_widget;
 
+    if ( overview_ )
+        overview_->setQuickFindIndex( quickFind_.index() );
+
     if ( overviewWidget_ ) {
         connect( overviewWidget_, SIGNAL( lineClicked ( int ) ),
                 this, SLOT( jumpToLine( int ) ) );
@@ -890,12 +913,26 @@ LineNumber AbstractLogView::getViewPosition() const
     return line;
 }
 
+// The result is received asynchronously by quickFindDone()
 void AbstractLogView::searchUsingFunction(
-        qint64 (QuickFind::*search_function)() )
+        void (QuickFind::*search_function)() )
 {
     disableFollow();
 
-    int line = (quickFind_.*search_function)();
+    (quickFind_.*search_function)();
+}
+
+void AbstractLogView::quickFindIndexUpdated()
+{
+    if ( overview_ ) {
+        overview_->updateQuickFind();
+        if ( overviewWidget_ )
+            overviewWidget_->update();
+    }
+}
+
+void AbstractLogView::quickFindDone( qint64 line )
+{
     if ( line >= 0 ) {
         LOG(logDEBUG) << "Found line " << line;
         displayLine( line );
@@ -960,12 +997,26 @@ void AbstractLogView::refreshOverview()
     }
 }
 
+void AbstractLogView::invalidateQuickFindIndex()
+{
+    quickFind_.resetLimits();
+    quickFind_.clearIndex();
+}
+
 // Reset the QuickFind when the pattern is changed.
 void AbstractLogView::handlePatternUpdated()
 {
     LOG(logDEBUG) << "AbstractLogView::handlePatternUpdated()";
 
     quickFind_.resetLimits();
+
+    // Only index the occurrences straight away if we are displayed,
+    // the index will be built on the first search otherwise.
+    if ( isVisible() )
+        quickFind_.rebuildIndex();
+    else
+        quickFind_.clearIndex();
+
     update();
 }
 
@@ -1040,6 +1091,10 @@ void AbstractLogView::updateData()
 
     // Reset the QuickFind in case we have new stuff to search into
     quickFind_.resetLimits();
+    if ( isDataAppendOnly() )
+        quickFind_.extendIndex();
+    else
+        quickFind_.clearIndex();
 
     if ( followMode_ )
         jumpToBottom();
@@ -1093,6 +1148,18 @@ int AbstractLogView::getTopLine() const
     return firstLine;
 }
 
+AbstractLogView::DrawingStatistics AbstractLogView::getDrawingStatistics() const
+{
+    const auto pixmapSize = []( const QPixmap& pixmap ) {
+        return static_cast<qint64>( pixmap.width() ) * pixmap.height()
+            * pixmap.depth() / 8;
+    };
+
+    return { paintCounter_.rate(), textCacheHits_, textCacheMisses_,
+        pixmapSize( textAreaCache_.pixmap_ )
+            + pixmapSize( pullToFollowCache_.pixmap_ ) };
+}
+
 QString AbstractLogView::getSelection() const
 {
     return selection_.getSelectedText( logData );
@@ -1419,6 +1486,8 @@ void AbstractLogView::updateScrollBars()
 
 void AbstractLogView::drawTextArea( QPaintDevice* paint_device, int32_t )
 {
+    TRACE_SPAN( "view", "AbstractLogView::drawTextArea" );
+
     // LOG( logDEBUG ) << "devicePixelRatio: " << viewport()->devicePixelRatio();
     // LOG( logDEBUG ) << "viewport size: " << viewport()->size().width();
     // LOG( logDEBUG ) << "pixmap size: " << textPixmap.width();
@@ -1442,6 +1511,13 @@ void AbstractLogView::drawTextArea( QPaintDevice* paint_device, int32_t )
     static const QBrush normalBulletBrush = QBrush( Qt::white );
     static const QBrush matchBulletBrush = QBrush( Qt::red );
     static const QBrush markBrush = QBrush( "dodgerblue" );
+    // Colours identifying the file of each line for data made of
+    // several files (reused if there are more files)
+    static const QColor sourceColors[] = {
+        QColor( "orange" ), QColor( "mediumseagreen" ), QColor( "orchid" ),
+        QColor( "gold" ), QColor( "lightskyblue" ), QColor( "tomato" ) };
+    static const int nbSourceColors = sizeof( sourceColors ) / sizeof( sourceColors[0] );
+    static const int SOURCE_STRIPE_WIDTH = 2;
 
     static const int SEPARATOR_WIDTH = 1;
     static const qreal BULLET_AREA_WIDTH = 11;
@@ -1466,6 +1542,9 @@ void AbstractLogView::drawTextArea( QPaintDevice* paint_device, int32_t )
 
     // Lines to write
     const QStringList lines = logData->getExpandedLines( firstLine, nbLines );
+#ifdef GLOGG_PERF_MEASURE_FPS
+    nbLinesFetched_ += nbLines;
+#endif
 
     // First draw the bullet left margin
     painter.setPen(palette.color(QPalette::Text));
@@ -1530,6 +1609,12 @@ void AbstractLogView::drawTextArea( QPaintDevice* paint_device, int32_t )
         const QString line = lines[i];
         const QString cutLine = line.mid( firstCol, nbCols );
 
+#ifdef GLOGG_PERF_MEASURE_FPS
+        // The filters are matched against the line read again
+        if ( ! selection_.isLineSelected( line_index ) )
+            ++nbLinesFetched_;
+#endif
+
         if ( selection_.isLineSelected( line_index ) ) {
             // Reverse the selected line
             foreColor = palette.color( QPalette::HighlightedText );
@@ -1551,9 +1636,14 @@ void AbstractLogView::drawTextArea( QPaintDevice* paint_device, int32_t )
         bool isSelection =
             selection_.getPortionForLine( line_index, &sel_start, &sel_end );
         // Has the line got elements to be highlighted
+        // (the QuickFind occurrences come from the index when it covers
+        // the line, the search matches from what the search recorded)
         QList<QuickFindMatch> qfMatchList;
-        bool isMatch =
+        if ( quickFindPattern_->isActive()
+                && ( ! quickFind_.index()->getLineOccurrences( line_index, &qfMatchList ) ) )
             quickFindPattern_->matchLine( line, qfMatchList );
+        bool isMatch = ( ! qfMatchList.isEmpty() )
+            || searchMatchesForLine( line_index, qfMatchList );
 
         if ( isSelection || isMatch ) {
             // We use the LineDrawer and its chunks because the
@@ -1629,6 +1719,12 @@ void AbstractLogView::drawTextArea( QPaintDevice* paint_device, int32_t )
             painter.drawText( xPos, yPos + fontAscent, cutLine );
         }
 
+        // Then the colour of the file the line comes from
+        const int source = lineSource( line_index );
+        if ( source >= 0 )
+            painter.fillRect( 0, yPos, SOURCE_STRIPE_WIDTH, fontHeight,
+                    sourceColors[ source % nbSourceColors ] );
+
         // Then draw the bullet
         painter.setPen( palette.color( QPalette::Text ) );
         const qreal circleSize = 3;
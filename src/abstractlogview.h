@@ -24,9 +24,7 @@
 #include <QAbstractScrollArea>
 #include <QBasicTimer>
 
-#ifdef GLOGG_PERF_MEASURE_FPS
-#  include "perfcounter.h"
-#endif
+#include "perfcounter.h"
 
 #include "selection.h"
 #include "quickfind.h"
@@ -37,6 +35,7 @@
 class QMenu;
 class QAction;
 class AbstractLogData;
+class QuickFindMatch;
 
 class LineChunk
 {
@@ -163,6 +162,10 @@ class AbstractLogView :
 
     // Refresh the widget when the data set has changed.
     void updateData();
+    // Throw away the QuickFind occurrences found so far, they are searched
+    // again on the next update (when the lines already displayed have
+    // changed: the file has been truncated or rewritten).
+    void invalidateQuickFindIndex();
     // Instructs the widget to update it's content geometry,
     // used when the font is changed.
     void updateDisplaySize();
@@ -175,6 +178,24 @@ class AbstractLogView :
 
     bool isFollowEnabled() const { return followMode_; }
 
+    // Statistics about the drawing of the view
+    struct DrawingStatistics {
+        // Number of paints in the last second
+        uint32_t paintRate;
+        // Paints that reused the text drawn before and the ones that
+        // redrew it
+        uint64_t textCacheHits;
+        uint64_t textCacheMisses;
+        // Memory used by the cached pixmaps (in bytes)
+        qint64 cacheMemory;
+    };
+    DrawingStatistics getDrawingStatistics() const;
+
+#ifdef GLOGG_PERF_MEASURE_FPS
+    // Number of lines read from the data to draw the view so far
+    qint64 getNbLinesFetched() const { return nbLinesFetched_; }
+#endif
+
   protected:
     virtual void mousePressEvent( QMouseEvent* mouseEvent );
     virtual void mouseMoveEvent( QMouseEvent* mouseEvent );
@@ -194,10 +215,25 @@ class AbstractLogView :
     enum LineType { Normal, Marked, Match };
     virtual LineType lineType( int lineNumber ) const = 0;
 
+    // Index of the file the line at the given index comes from, for
+    // data made of several files (used for the coloured stripe in the
+    // bullet area), -1 by default.
+    virtual int lineSource( int ) const { return -1; }
+
     // Line number to display for line at the given index
     virtual qint64 displayLineNumber( int lineNumber ) const;
     virtual qint64 maxDisplayLineNumber() const;
 
+    // Position of the search matches in the passed line, highlighted
+    // when there is no QuickFind match in the line.
+    // Returns false if there is none (the default).
+    virtual bool searchMatchesForLine( int lineNumber,
+            QList<QuickFindMatch>& matches ) const;
+
+    // Whether lines are only ever added at the end of the data
+    // (used to keep the QuickFind index across updates)
+    virtual bool isDataAppendOnly() const { return true; }
+
     // Get the overview associated with this view, or NULL if there is none
     Overview* getOverview() const { return overview_; }
     // Set the Overview and OverviewWidget
@@ -278,6 +314,10 @@ class AbstractLogView :
 
   private slots:
     void handlePatternUpdated();
+    // Called when the QuickFind has finished searching
+    void quickFindDone( qint64 line );
+    // Called when the QuickFind index has changed
+    void quickFindIndexUpdated();
     void addToSearch();
     void findNextSelected();
     void findPreviousSelected();
@@ -362,6 +402,7 @@ class AbstractLogView :
 #ifdef GLOGG_PERF_MEASURE_FPS
     // Performance measurement
     PerfCounter perfCounter_;
+    qint64 nbLinesFetched_ = 0;
 #endif
 
     // Vertical offset (in pixels) at which the first line of text is written
@@ -382,6 +423,11 @@ class AbstractLogView :
     TextAreaCache textAreaCache_ = { {}, true, 0, 0, 0 };
     PullToFollowCache pullToFollowCache_ = { {}, 0 };
 
+    // For the statistics
+    PerfCounter paintCounter_;
+    uint64_t textCacheHits_ = 0;
+    uint64_t textCacheMisses_ = 0;
+
     LineNumber getNbVisibleLines() const;
     int getNbVisibleCols() const;
     QPoint convertCoordToFilePos( const QPoint& pos ) const;
@@ -401,7 +447,7 @@ class AbstractLogView :
     void considerMouseHovering( int x_pos, int y_pos );
 
     // Search functions (for n/N)
-    void searchUsingFunction( qint64 (QuickFind::*search_function)() );
+    void searchUsingFunction( void (QuickFind::*search_function)() );
 
     void updateScrollBars();
 
@@ -41,6 +41,8 @@ Configuration::Configuration()
     pollIntervalMs_               = 2000;
 
     loadLastSession_              = true;
+    searchParallelFiles_          = 2;
+    maxRotatedFiles_              = 10;
 
     overviewVisible_              = true;
     lineNumbersVisibleInMain_     = false;
@@ -94,6 +96,10 @@ void Configuration::retrieveFromStorage( QSettings& settings )
 
     if ( settings.contains( "session.loadLast" ) )
         loadLastSession_ = settings.value( "session.loadLast" ).toBool();
+    if ( settings.contains( "search.parallelFiles" ) )
+        searchParallelFiles_ = settings.value( "search.parallelFiles" ).toInt();
+    if ( settings.contains( "rotation.maxFiles" ) )
+        maxRotatedFiles_ = settings.value( "rotation.maxFiles" ).toInt();
 
     // View settings
     if ( settings.contains( "view.overviewVisible" ) )
@@ -130,6 +136,8 @@ void Configuration::saveToStorage( QSettings& settings ) const
     settings.setValue( "polling.enabled", pollingEnabled_ );
     settings.setValue( "polling.intervalMs", pollIntervalMs_ );
     settings.setValue( "session.loadLast", loadLastSession_);
+    settings.setValue( "search.parallelFiles", searchParallelFiles_ );
+    settings.setValue( "rotation.maxFiles", maxRotatedFiles_ );
 
     settings.setValue( "view.overviewVisible", overviewVisible_ );
     settings.setValue( "view.lineNumbersVisibleInMain", lineNumbersVisibleInMain_ );
@@ -68,6 +68,18 @@ class Configuration : public Persistable {
     { return loadLastSession_; }
     void setLoadLastSession( bool enabled )
     { loadLastSession_ = enabled; }
+    // Number of files searched at the same time when searching
+    // all the open files (kept low not to thrash spinning disks)
+    int searchParallelFiles() const
+    { return searchParallelFiles_; }
+    void setSearchParallelFiles( int nb_files )
+    { searchParallelFiles_ = nb_files; }
+    // Number of files rotated away still displayed before the
+    // followed one (the oldest are dropped after that)
+    int maxRotatedFiles() const
+    { return maxRotatedFiles_; }
+    void setMaxRotatedFiles( int nb_files )
+    { maxRotatedFiles_ = nb_files; }
 
     // View settings
     bool isOverviewVisible() const
@@ -106,6 +118,8 @@ class Configuration : public Persistable {
     bool pollingEnabled_;
     uint32_t pollIntervalMs_;
     bool loadLastSession_;
+    int searchParallelFiles_;
+    int maxRotatedFiles_;
 
     // View settings
     bool overviewVisible_;
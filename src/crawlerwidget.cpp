@@ -44,6 +44,7 @@
 #include "quickfindwidget.h"
 #include "persistentinfo.h"
 #include "configuration.h"
+#include "updatescheduler.h"
 
 // Palette for error signaling (yellow background)
 const QPalette CrawlerWidget::errorPalette( QColor( "yellow" ) );
@@ -104,6 +105,11 @@ CrawlerWidget::CrawlerWidget( QWidget *parent )
     currentLineNumber_ = 0;
 }
 
+CrawlerWidget::~CrawlerWidget()
+{
+    GetUpdateScheduler().cancel( this );
+}
+
 // The top line is first one on the main display
 int CrawlerWidget::getTopLine() const
 {
@@ -138,6 +144,57 @@ QString CrawlerWidget::encodingText() const
     return encoding_text_;
 }
 
+qint64 CrawlerWidget::lastDisplayLatency() const
+{
+    return lastDisplayLatency_;
+}
+
+CrawlerWidget::Statistics CrawlerWidget::getStatistics() const
+{
+    return { logData_->getFileSize(), logData_->getNbLine(),
+        logData_->getIndexingStatistics(),
+        logFilteredData_->getSearchStatistics(),
+        logMainView->getDrawingStatistics(),
+        filteredView->getDrawingStatistics() };
+}
+
+void CrawlerWidget::displayLine( qint64 line )
+{
+    logMainView->selectAndDisplayLine( line );
+    logMainView->setFocus();
+}
+
+std::vector<qint64> CrawlerWidget::getFilteredLines() const
+{
+    std::vector<qint64> lines;
+    const qint64 nb_lines = logFilteredData_->getNbLine();
+    lines.reserve( nb_lines );
+    for ( qint64 i = 0; i < nb_lines; ++i )
+        lines.push_back( logFilteredData_->getMatchingLineNumber( i ) );
+
+    return lines;
+}
+
+void CrawlerWidget::searchFor( const QString& text )
+{
+    // The text is a regular expression
+    fieldsCheck->setCheckState( Qt::Unchecked );
+    searchLineEdit->setEditText( text );
+    startNewSearch();
+}
+
+void CrawlerWidget::showTemplates( const std::shared_ptr<const TemplateIndex>& templateIndex,
+        const std::vector<bool>& selected )
+{
+    // The search line is not used, the previous search is cleared
+    searchLineEdit->setEditText( "" );
+    replaceCurrentSearch( "" );
+
+    stopButton->setEnabled( true );
+    logFilteredData_->runTemplateSearch( templateIndex, selected );
+    searchState_.startSearch();
+}
+
 // Return a pointer to the view in which we should do the QuickFind
 SearchableWidgetInterface* CrawlerWidget::doGetActiveSearchable() const
 {
@@ -161,6 +218,61 @@ void CrawlerWidget::doSendAllStateSignals()
         emit loadingFinished( LoadingStatus::Successful );
 }
 
+bool CrawlerWidget::doIsShownForUpdate() const
+{
+    return isVisible();
+}
+
+// Refresh everything depending on the size of the file,
+// called (at most once per frame) after some loading has finished.
+void CrawlerWidget::doApplyScheduledUpdate()
+{
+    LOG(logDEBUG) << "CrawlerWidget::doApplyScheduledUpdate";
+
+    // We need to refresh the main window because the view lines on the
+    // overview have probably changed.
+    overview_.updateData( logData_->getNbLine() );
+
+    // FIXME, handle topLine
+    // logMainView->updateData( logData_, topLine );
+    logMainView->updateData();
+
+    // Shall we Forbid starting a search when loading in progress?
+    // searchButton->setEnabled( false );
+
+    // searchButton->setEnabled( true );
+
+    // See if we need to auto-refresh the search
+    if ( searchState_.isAutorefreshAllowed() ) {
+        if ( searchState_.isFileTruncated() )
+            // We need to restart the search
+            replaceCurrentSearch( searchLineEdit->currentText() );
+        else
+            logFilteredData_->updateSearch();
+    }
+
+    // Set the encoding for the views
+    updateEncoding();
+
+    // Field searches are offered for structured logs only
+    const bool structured = ( logData_->getStructuredFormat() != StructuredFormat::None );
+    if ( ! structured )
+        fieldsCheck->setCheckState( Qt::Unchecked );
+    fieldsCheck->setVisible( structured );
+
+    dataTruncated_ = false;
+    if ( dataAppended_ ) {
+        dataAppended_ = false;
+        const QDateTime modified = logData_->getLastModifiedDate();
+        if ( modified.isValid() ) {
+            lastDisplayLatency_ = modified.msecsTo( QDateTime::currentDateTime() );
+            LOG(logDEBUG) << "Appended data displayed " << lastDisplayLatency_
+                << " ms after the file was modified (indexed after "
+                << logData_->getLastIndexingLatency() << " ms)";
+        }
+    }
+}
+
 void CrawlerWidget::keyPressEvent( QKeyEvent* keyEvent )
 {
     bool noModifier = keyEvent->modifiers() == Qt::NoModifier;
@@ -180,6 +292,23 @@ void CrawlerWidget::keyPressEvent( QKeyEvent* keyEvent )
     }
 }
 
+void CrawlerWidget::showEvent( QShowEvent* event )
+{
+    QSplitter::showEvent( event );
+
+    // Catch up with the changes received while we were hidden
+    GetUpdateScheduler().flush( this );
+
+    setDataForeground( true );
+}
+
+void CrawlerWidget::hideEvent( QHideEvent* event )
+{
+    QSplitter::hideEvent( event );
+
+    setDataForeground( false );
+}
+
 //
 // Public slots
 //
@@ -217,7 +346,7 @@ void CrawlerWidget::setEncoding( Encoding encoding )
 // Protected functions
 //
 void CrawlerWidget::doSetData(
-        std::shared_ptr<LogData> log_data,
+        std::shared_ptr<AbstractLogSource> log_data,
         std::shared_ptr<LogFilteredData> filtered_data )
 {
     logData_         = log_data.get();
@@ -464,30 +593,14 @@ void CrawlerWidget::loadingFinishedHandler( LoadingStatus status )
 {
     loadingInProgress_ = false;
 
-    // We need to refresh the main window because the view lines on the
-    // overview have probably changed.
-    overview_.updateData( logData_->getNbLine() );
-
-    // FIXME, handle topLine
-    // logMainView->updateData( logData_, topLine );
-    logMainView->updateData();
-
-        // Shall we Forbid starting a search when loading in progress?
-        // searchButton->setEnabled( false );
-
-    // searchButton->setEnabled( true );
-
-    // See if we need to auto-refresh the search
-    if ( searchState_.isAutorefreshAllowed() ) {
-        if ( searchState_.isFileTruncated() )
-            // We need to restart the search
-            replaceCurrentSearch( searchLineEdit->currentText() );
-        else
-            logFilteredData_->updateSearch();
-    }
-
-    // Set the encoding for the views
-    updateEncoding();
+    // Refreshing the views is left to the scheduler so a file growing
+    // quickly only triggers one refresh per frame, and nothing is done
+    // for a tab in the background until it is shown.
+    // The first load is displayed straight away.
+    if ( firstLoadDone_ )
+        GetUpdateScheduler().requestUpdate( this );
+    else
+        doApplyScheduledUpdate();
 
     emit loadingFinished( status );
 
@@ -498,12 +611,29 @@ void CrawlerWidget::loadingFinishedHandler( LoadingStatus status )
         firstLoadDone_ = true;
 }
 
-void CrawlerWidget::fileChangedHandler( LogData::MonitoredFileStatus status )
+void CrawlerWidget::fileChangedHandler( AbstractLogSource::MonitoredFileStatus status )
 {
+    // The changes are accumulated until the next update is applied
+    if ( status == AbstractLogSource::DataAdded ) {
+        if ( ! dataTruncated_ )
+            dataAppended_ = true;
+    }
+    else if ( status != AbstractLogSource::Unchanged ) {
+        dataTruncated_ = true;
+        dataAppended_  = false;
+    }
+
     // Handle the case where the file has been truncated
-    if ( status == LogData::Truncated ) {
+    // (or rewritten, the lines after the change are different)
+    if ( status == AbstractLogSource::Truncated || status == AbstractLogSource::Rewritten ) {
         // Clear all marks (TODO offer the option to keep them)
         logFilteredData_->clearMarks();
+        // The lines indexed by the field searches are not valid anymore
+        logFilteredData_->interruptSearch();
+        logFilteredData_->clearFieldIndex();
+        // as are the QuickFind occurrences, even if there are more
+        // lines by the time the view is updated
+        logMainView->invalidateQuickFindIndex();
         if ( ! searchInfoLine->text().isEmpty() ) {
             // Invalidate the search
             logFilteredData_->clearSearch();
@@ -693,6 +823,11 @@ void CrawlerWidget::setup()
     searchInfoLine->setLineWidth( 1 );
     searchInfoLineDefaultPalette = searchInfoLine->palette();
 
+    fieldsCheck = new QCheckBox( "Fie&lds" );
+    fieldsCheck->setToolTip( tr( "Search the fields of the structured log:\n"
+                "key=value, key^=prefix, key=min..max, key>=min, key<max\n"
+                "separated by spaces, all of them must match" ) );
+    fieldsCheck->hide();
     ignoreCaseCheck = new QCheckBox( "Ignore &case" );
     searchRefreshCheck = new QCheckBox( "Auto-&refresh" );
 
@@ -728,6 +863,7 @@ void CrawlerWidget::setup()
     QHBoxLayout* searchInfoLineLayout = new QHBoxLayout;
     searchInfoLineLayout->addWidget( visibilityBox );
     searchInfoLineLayout->addWidget( searchInfoLine );
+    searchInfoLineLayout->addWidget( fieldsCheck );
     searchInfoLineLayout->addWidget( ignoreCaseCheck );
     searchInfoLineLayout->addWidget( searchRefreshCheck );
 
@@ -817,8 +953,8 @@ void CrawlerWidget::setup()
             this, SIGNAL( loadingProgressed( int ) ) );
     connect( logData_, SIGNAL( loadingFinished( LoadingStatus ) ),
             this, SLOT( loadingFinishedHandler( LoadingStatus ) ) );
-    connect( logData_, SIGNAL( fileChanged( LogData::MonitoredFileStatus ) ),
-            this, SLOT( fileChangedHandler( LogData::MonitoredFileStatus ) ) );
+    connect( logData_, SIGNAL( fileChanged( AbstractLogSource::MonitoredFileStatus ) ),
+            this, SLOT( fileChangedHandler( AbstractLogSource::MonitoredFileStatus ) ) );
 
     // Search auto-refresh
     connect( searchRefreshCheck, SIGNAL( stateChanged( int ) ),
@@ -863,7 +999,25 @@ void CrawlerWidget::replaceCurrentSearch( const QString& searchText )
     // Update the match overview
     overview_.updateData( logData_->getNbLine() );
 
-    if ( !searchText.isEmpty() ) {
+    if ( !searchText.isEmpty() && fieldsCheck->checkState() == Qt::Checked ) {
+        QString error;
+        const FieldQuery query = FieldQuery::parse( searchText, &error );
+
+        if ( ! query.isEmpty() ) {
+            stopButton->setEnabled( true );
+            logFilteredData_->runFieldSearch( query );
+            searchState_.startSearch();
+        }
+        else {
+            logFilteredData_->clearSearch();
+            filteredView->updateData();
+            searchState_.resetState();
+
+            searchInfoLine->setPalette( errorPalette );
+            searchInfoLine->setText( tr("Error in field query: ") + error );
+        }
+    }
+    else if ( !searchText.isEmpty() ) {
 
         QString pattern;
 
@@ -1061,6 +1215,16 @@ void CrawlerWidget::changeTopViewSize( int32_t delta )
     LOG(logDEBUG) << "CrawlerWidget::changeTopViewSize " << sizes()[0];
 }
 
+// The indexing and searches of the file displayed are run before
+// the other files' by the TaskScheduler.
+void CrawlerWidget::setDataForeground( bool foreground )
+{
+    if ( logData_ )
+        logData_->setForeground( foreground );
+    if ( logFilteredData_ )
+        logFilteredData_->setForeground( foreground );
+}
+
 //
 // SearchState implementation
 //
@@ -32,12 +32,13 @@
 
 #include "logmainview.h"
 #include "filteredview.h"
-#include "data/logdata.h"
+#include "data/abstractlogsource.h"
 #include "data/logfiltereddata.h"
 #include "viewinterface.h"
 #include "signalmux.h"
 #include "overview.h"
 #include "loadingstatus.h"
+#include "updatescheduler.h"
 
 class InfoLine;
 class QuickFindPattern;
@@ -50,12 +51,13 @@ class OverviewWidget;
 // lines and various buttons.
 class CrawlerWidget : public QSplitter,
     public QuickFindMuxSelectorInterface, public ViewInterface,
-    public MuxableDocumentInterface
+    public MuxableDocumentInterface, public ScheduledUpdateClientInterface
 {
   Q_OBJECT
 
   public:
     CrawlerWidget( QWidget *parent=0 );
+    ~CrawlerWidget();
 
     // Get the line number of the first line displayed.
     int getTopLine() const;
@@ -78,6 +80,38 @@ class CrawlerWidget : public QSplitter,
     // suitable to display to the user.
     QString encodingText() const;
 
+    // Returns the time (in ms) between the last modification of the
+    // file on disk and the appended data being displayed,
+    // -1 if no appended data have been displayed yet.
+    qint64 lastDisplayLatency() const;
+
+    // Statistics about the resources used for the file
+    struct Statistics {
+        qint64 fileSize;
+        qint64 nbLines;
+        AbstractLogSource::IndexingStatistics indexing;
+        LogFilteredData::SearchStatistics search;
+        AbstractLogView::DrawingStatistics mainView;
+        AbstractLogView::DrawingStatistics filteredView;
+    };
+    Statistics getStatistics() const;
+    // Returns whether the file has not been loaded yet (its loading
+    // is in progress or has not started)
+    bool isLoading() const { return loadingInProgress_; }
+
+    // Select and display the passed line in the main view
+    void displayLine( qint64 line );
+
+    // Returns the line numbers (in the file) of the lines displayed
+    // in the filtered view
+    std::vector<qint64> getFilteredLines() const;
+    // Replace the current search with the passed text
+    void searchFor( const QString& text );
+    // Replace the current search with the lines whose template (in
+    // the passed index, built from this file) is selected
+    void showTemplates( const std::shared_ptr<const TemplateIndex>& templateIndex,
+            const std::vector<bool>& selected );
+
   public slots:
     // Stop the asynchoronous loading of the file if one is in progress
     // The file is identified by the view attached to it.
@@ -90,7 +124,7 @@ class CrawlerWidget : public QSplitter,
   protected:
     // Implementation of the ViewInterface functions
     virtual void doSetData(
-            std::shared_ptr<LogData> log_data,
+            std::shared_ptr<AbstractLogSource> log_data,
             std::shared_ptr<LogFilteredData> filtered_data );
     virtual void doSetQuickFindPattern(
             std::shared_ptr<QuickFindPattern> qfp );
@@ -108,7 +142,13 @@ class CrawlerWidget : public QSplitter,
     // Implementation of the MuxableDocumentInterface
     virtual void doSendAllStateSignals();
 
+    // Implementation of the ScheduledUpdateClientInterface
+    virtual bool doIsShownForUpdate() const;
+    virtual void doApplyScheduledUpdate();
+
     virtual void keyPressEvent( QKeyEvent* keyEvent );
+    virtual void showEvent( QShowEvent* event );
+    virtual void hideEvent( QHideEvent* event );
 
   signals:
     // Sent to signal the client load has progressed,
@@ -158,7 +198,7 @@ class CrawlerWidget : public QSplitter,
 
     void loadingFinishedHandler( LoadingStatus status );
     // Manages the info lines to inform the user the file has changed.
-    void fileChangedHandler( LogData::MonitoredFileStatus );
+    void fileChangedHandler( AbstractLogSource::MonitoredFileStatus );
 
     void searchForward();
     void searchBackward();
@@ -231,6 +271,7 @@ class CrawlerWidget : public QSplitter,
     void changeDataStatus( DataStatus status );
     void updateEncoding();
     void changeTopViewSize( int32_t delta );
+    void setDataForeground( bool foreground );
 
     // Palette for error notification (yellow background)
     static const QPalette errorPalette;
@@ -244,6 +285,7 @@ class CrawlerWidget : public QSplitter,
     FilteredView*   filteredView;
     QComboBox*      visibilityBox;
     InfoLine*       searchInfoLine;
+    QCheckBox*      fieldsCheck;
     QCheckBox*      ignoreCaseCheck;
     QCheckBox*      searchRefreshCheck;
     OverviewWidget* overviewWidget_;
@@ -260,7 +302,7 @@ class CrawlerWidget : public QSplitter,
     // Reference to the QuickFind Pattern (not owned)
     std::shared_ptr<QuickFindPattern> quickFindPattern_;
 
-    LogData*        logData_;
+    AbstractLogSource* logData_;
     LogFilteredData* logFilteredData_;
 
     qint64          logFileSize_;
@@ -295,6 +337,13 @@ class CrawlerWidget : public QSplitter,
     // Current encoding setting;
     Encoding        encodingSetting_ = Encoding::ENCODING_AUTO;
     QString         encoding_text_;
+
+    // Data have only been appended to the file since the last update
+    // (not if it has also been truncated or rewritten in the meantime)
+    bool            dataAppended_ = false;
+    // The file has been truncated or rewritten since the last update
+    bool            dataTruncated_ = false;
+    qint64          lastDisplayLatency_ = -1;
 };
 
 #endif
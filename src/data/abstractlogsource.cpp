@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements AbstractLogSource.
+// Like AbstractLogData, it is primarily an interface class.
+
+#include "abstractlogsource.h"
+
+AbstractLogSource::AbstractLogSource() : AbstractLogData()
+{
+}
+
+// Simple wrapper in order to use a clean Template Method
+void AbstractLogSource::interruptLoading()
+{
+    doInterruptLoading();
+}
+
+// Simple wrapper in order to use a clean Template Method
+LogFilteredData* AbstractLogSource::getNewFilteredData() const
+{
+    return doGetNewFilteredData();
+}
+
+// Simple wrapper in order to use a clean Template Method
+qint64 AbstractLogSource::getFileSize() const
+{
+    return doGetFileSize();
+}
+
+// Simple wrapper in order to use a clean Template Method
+QDateTime AbstractLogSource::getLastModifiedDate() const
+{
+    return doGetLastModifiedDate();
+}
+
+// Simple wrapper in order to use a clean Template Method
+void AbstractLogSource::reload()
+{
+    doReload();
+}
+
+// Simple wrapper in order to use a clean Template Method
+void AbstractLogSource::setPollingInterval( uint32_t interval_ms )
+{
+    doSetPollingInterval( interval_ms );
+}
+
+// Simple wrapper in order to use a clean Template Method
+void AbstractLogSource::setForeground( bool foreground )
+{
+    doSetForeground( foreground );
+}
+
+// Simple wrapper in order to use a clean Template Method
+EncodingSpeculator::Encoding AbstractLogSource::getDetectedEncoding() const
+{
+    return doGetDetectedEncoding();
+}
+
+// Simple wrapper in order to use a clean Template Method
+StructuredFormat AbstractLogSource::getStructuredFormat() const
+{
+    return doGetStructuredFormat();
+}
+
+// Simple wrapper in order to use a clean Template Method
+qint64 AbstractLogSource::getLastIndexingLatency() const
+{
+    return doGetLastIndexingLatency();
+}
+
+// Simple wrapper in order to use a clean Template Method
+AbstractLogSource::IndexingStatistics AbstractLogSource::getIndexingStatistics() const
+{
+    return doGetIndexingStatistics();
+}
+
+// Simple wrapper in order to use a clean Template Method
+std::vector<qint64> AbstractLogSource::getSearchPartitions() const
+{
+    return doGetSearchPartitions();
+}
+
+// Simple wrapper in order to use a clean Template Method
+int AbstractLogSource::getLineSource( qint64 line ) const
+{
+    return doGetLineSource( line );
+}
+
+std::vector<qint64> AbstractLogSource::doGetSearchPartitions() const
+{
+    return { 0 };
+}
+
+int AbstractLogSource::doGetLineSource( qint64 ) const
+{
+    return -1;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ABSTRACTLOGSOURCE_H
+#define ABSTRACTLOGSOURCE_H
+
+#include <vector>
+
+#include <QDateTime>
+
+#include "abstractlogdata.h"
+#include "encodingspeculator.h"
+#include "fieldquery.h"
+#include "loadingstatus.h"
+
+class LogFilteredData;
+
+// Base class for the data read from disk and displayed in the main view
+// of a CrawlerWidget, it is either a single file (LogData) or a set of
+// files displayed together.
+// It is the source a LogFilteredData searches.
+class AbstractLogSource : public AbstractLogData {
+  Q_OBJECT
+
+  public:
+    AbstractLogSource();
+    // Permit each child to have its destructor
+    virtual ~AbstractLogSource() {};
+
+    // Rewritten means the beginning of the file is unchanged but
+    // the rest has been rewritten (the lines after are reindexed)
+    enum MonitoredFileStatus { Unchanged, DataAdded, Truncated, Rewritten };
+
+    // Interrupt the loading and report a null file.
+    // Does nothing if no loading in progress.
+    void interruptLoading();
+    // Creates a new filtered data.
+    // ownership is passed to the caller
+    LogFilteredData* getNewFilteredData() const;
+    // Returns the size if the file in bytes
+    qint64 getFileSize() const;
+    // Returns the last modification date for the file.
+    // Null if the file is not on disk.
+    QDateTime getLastModifiedDate() const;
+    // Throw away all the file data and reload/reindex.
+    void reload();
+
+    // Update the polling interval (in ms, 0 means disabled)
+    void setPollingInterval( uint32_t interval_ms );
+    // Tells whether the data is displayed, its background work
+    // is then run before the other files'.
+    void setForeground( bool foreground );
+
+    // Get the auto-detected encoding for the indexed text.
+    EncodingSpeculator::Encoding getDetectedEncoding() const;
+    // Get the format of the lines if the data is a structured log
+    // (detected from its first lines).
+    StructuredFormat getStructuredFormat() const;
+
+    // Returns the time (in ms) between the last modification of the
+    // file on disk and the end of the indexing of the appended data,
+    // -1 if no data has been appended since the file was attached.
+    qint64 getLastIndexingLatency() const;
+
+    // Statistics about the indexing of the data
+    struct IndexingStatistics {
+        // Memory used by the index of the lines (in bytes)
+        qint64 indexMemory = 0;
+        // Bytes read by the last indexing operation and its duration (in ms)
+        qint64 lastIndexingBytes = 0;
+        qint64 lastIndexingDuration = 0;
+        // Bytes appended since the data were first indexed and the
+        // time elapsed since then (in ms)
+        qint64 bytesAppended = 0;
+        qint64 followedDuration = 0;
+    };
+    IndexingStatistics getIndexingStatistics() const;
+
+    // Returns the first line of each of the parts of the data that
+    // can be searched independently (and in parallel), the first
+    // element is always 0.
+    std::vector<qint64> getSearchPartitions() const;
+
+    // Returns the index of the file the passed line comes from, for
+    // data made of several files, -1 otherwise.
+    int getLineSource( qint64 line ) const;
+
+  signals:
+    // Sent during the 'attach' process to signal progress
+    // percent being the percentage of completion.
+    void loadingProgressed( int percent );
+    // Signal the client the file is fully loaded and available.
+    void loadingFinished( LoadingStatus status );
+    // Sent when the file on disk has changed, will be followed
+    // by loadingProgressed if needed and then a loadingFinished.
+    void fileChanged( AbstractLogSource::MonitoredFileStatus status );
+
+  protected:
+    // Internal function called to interrupt the loading
+    virtual void doInterruptLoading() = 0;
+    // Internal function called to create a filtered data
+    virtual LogFilteredData* doGetNewFilteredData() const = 0;
+    // Internal function called to get the size of the file(s)
+    virtual qint64 doGetFileSize() const = 0;
+    // Internal function called to get the modification date
+    virtual QDateTime doGetLastModifiedDate() const = 0;
+    // Internal function called to reload the file(s)
+    virtual void doReload() = 0;
+    // Internal function called to set the polling interval
+    virtual void doSetPollingInterval( uint32_t interval_ms ) = 0;
+    // Internal function called to set the foreground status
+    virtual void doSetForeground( bool foreground ) = 0;
+    // Internal function called to get the detected encoding
+    virtual EncodingSpeculator::Encoding doGetDetectedEncoding() const = 0;
+    // Internal function called to get the structured format
+    virtual StructuredFormat doGetStructuredFormat() const = 0;
+    // Internal function called to get the indexing latency
+    virtual qint64 doGetLastIndexingLatency() const = 0;
+    // Internal function called to get the indexing statistics
+    virtual IndexingStatistics doGetIndexingStatistics() const = 0;
+    // Internal function called to get the search partitions,
+    // by default, the data is searched as a whole.
+    virtual std::vector<qint64> doGetSearchPartitions() const;
+    // Internal function called to get the source of a line,
+    // by default, there is a single source.
+    virtual int doGetLineSource( qint64 line ) const;
+};
+
+Q_DECLARE_METATYPE( AbstractLogSource::MonitoredFileStatus );
+
+#endif
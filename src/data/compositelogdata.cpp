@@ -0,0 +1,288 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements CompositeLogData, the base of the data
+// made of several files.
+
+#include "compositelogdata.h"
+
+#include <algorithm>
+
+#include "log.h"
+
+#include "logdata.h"
+#include "logfiltereddata.h"
+
+CompositeLogData::CompositeLogData() : AbstractLogSource(),
+    loadingStatus_( LoadingStatus::Successful )
+{
+}
+
+CompositeLogData::~CompositeLogData()
+{
+}
+
+//
+// Public functions
+//
+
+void CompositeLogData::attachFiles( const QStringList& fileNames )
+{
+    LOG(logDEBUG) << "CompositeLogData::attachFiles " << fileNames.size() << " files";
+
+    if ( ! members_.empty() ) {
+        // We cannot reattach
+        throw CantReattachErr();
+    }
+
+    for ( int i = 0; i < fileNames.size(); ++i ) {
+        members_.emplace_back( new LogData() );
+        LogData* member = members_.back().get();
+        // The rotated files are members of the set themselves: a member
+        // following its file would show the same lines as the next
+        // one, it is reindexed with the file now having its name.
+        member->setMaxRotatedFiles( 0 );
+
+        connect( member, SIGNAL( loadingProgressed( int ) ),
+                this, SLOT( memberLoadingProgressed( int ) ) );
+        connect( member, SIGNAL( loadingFinished( LoadingStatus ) ),
+                this, SLOT( memberLoadingFinished( LoadingStatus ) ) );
+        connect( member, SIGNAL( fileChanged( AbstractLogSource::MonitoredFileStatus ) ),
+                this, SLOT( memberFileChanged( AbstractLogSource::MonitoredFileStatus ) ) );
+    }
+
+    loadingProgress_.assign( members_.size(), -1 );
+
+    for ( int i = 0; i < fileNames.size(); ++i ) {
+        startLoading( i );
+        members_[i]->attachFile( fileNames[i] );
+    }
+}
+
+//
+// Slots
+//
+
+void CompositeLogData::memberLoadingProgressed( int percent )
+{
+    const int index = senderIndex();
+    if ( index < 0 || loadingProgress_[index] < 0 )
+        return;
+
+    loadingProgress_[index] = percent;
+
+    // The files are loaded in parallel, we report the average
+    int total = 0;
+    int loading = 0;
+    for ( int progress: loadingProgress_ ) {
+        if ( progress >= 0 ) {
+            total += progress;
+            ++loading;
+        }
+    }
+
+    emit loadingProgressed( total / loading );
+}
+
+void CompositeLogData::memberLoadingFinished( LoadingStatus status )
+{
+    const int index = senderIndex();
+    if ( index < 0 )
+        return;
+
+    LOG(logDEBUG) << "CompositeLogData: file " << index << " loaded";
+
+    loadingProgress_[index] = -1;
+    if ( status == LoadingStatus::NoMemory
+            || ( status == LoadingStatus::Interrupted
+                && loadingStatus_ == LoadingStatus::Successful ) )
+        loadingStatus_ = status;
+
+    // Only the end of the last loading is reported
+    if ( std::none_of( loadingProgress_.begin(), loadingProgress_.end(),
+                []( int progress ) { return progress >= 0; } ) ) {
+        LOG(logDEBUG) << "CompositeLogData: all files loaded";
+        membersLoaded( loadingStatus_ );
+    }
+}
+
+void CompositeLogData::memberFileChanged(
+        AbstractLogSource::MonitoredFileStatus status )
+{
+    const int index = senderIndex();
+    if ( index < 0 )
+        return;
+
+    startLoading( index );
+
+    emit fileChanged( memberChanged( index, status ) );
+}
+
+//
+// Implementation of virtual functions
+//
+
+int CompositeLogData::doGetMaxLength() const
+{
+    int max_length = 0;
+    for ( const auto& member: members_ )
+        max_length = qMax( max_length, member->getMaxLength() );
+
+    return max_length;
+}
+
+void CompositeLogData::doSetDisplayEncoding( Encoding encoding )
+{
+    for ( const auto& member: members_ )
+        member->setDisplayEncoding( encoding );
+}
+
+void CompositeLogData::doSetMultibyteEncodingOffsets( int, int )
+{
+    // Done by each file when its display encoding is set
+}
+
+void CompositeLogData::doInterruptLoading()
+{
+    for ( const auto& member: members_ )
+        member->interruptLoading();
+}
+
+// Return an initialised LogFilteredData. The search is not started.
+LogFilteredData* CompositeLogData::doGetNewFilteredData() const
+{
+    return new LogFilteredData( this );
+}
+
+qint64 CompositeLogData::doGetFileSize() const
+{
+    qint64 size = 0;
+    for ( const auto& member: members_ )
+        size += member->getFileSize();
+
+    return size;
+}
+
+QDateTime CompositeLogData::doGetLastModifiedDate() const
+{
+    QDateTime last_modified;
+    for ( const auto& member: members_ ) {
+        const QDateTime modified = member->getLastModifiedDate();
+        if ( modified.isValid()
+                && ( ! last_modified.isValid() || modified > last_modified ) )
+            last_modified = modified;
+    }
+
+    return last_modified;
+}
+
+void CompositeLogData::doReload()
+{
+    for ( size_t i = 0; i < members_.size(); ++i ) {
+        startLoading( i );
+        members_[i]->reload();
+    }
+}
+
+void CompositeLogData::doSetPollingInterval( uint32_t interval_ms )
+{
+    for ( const auto& member: members_ )
+        member->setPollingInterval( interval_ms );
+}
+
+void CompositeLogData::doSetForeground( bool foreground )
+{
+    for ( const auto& member: members_ )
+        member->setForeground( foreground );
+}
+
+// The last file is the most recent one for rotated files
+EncodingSpeculator::Encoding CompositeLogData::doGetDetectedEncoding() const
+{
+    if ( members_.empty() )
+        return EncodingSpeculator::Encoding::ASCII7;
+
+    return members_.back()->getDetectedEncoding();
+}
+
+// The files are expected to be in the same format
+StructuredFormat CompositeLogData::doGetStructuredFormat() const
+{
+    if ( members_.empty() )
+        return StructuredFormat::None;
+
+    return members_.front()->getStructuredFormat();
+}
+
+// The worst of the files
+qint64 CompositeLogData::doGetLastIndexingLatency() const
+{
+    qint64 latency = -1;
+    for ( const auto& member: members_ )
+        latency = qMax( latency, member->getLastIndexingLatency() );
+
+    return latency;
+}
+
+// The files are indexed in parallel
+AbstractLogSource::IndexingStatistics CompositeLogData::doGetIndexingStatistics() const
+{
+    IndexingStatistics statistics;
+    for ( const auto& member: members_ ) {
+        const IndexingStatistics member_statistics = member->getIndexingStatistics();
+        statistics.indexMemory       += member_statistics.indexMemory;
+        statistics.lastIndexingBytes += member_statistics.lastIndexingBytes;
+        statistics.lastIndexingDuration = qMax( statistics.lastIndexingDuration,
+                member_statistics.lastIndexingDuration );
+        statistics.bytesAppended     += member_statistics.bytesAppended;
+        statistics.followedDuration  = qMax( statistics.followedDuration,
+                member_statistics.followedDuration );
+    }
+
+    return statistics;
+}
+
+//
+// Private functions
+//
+
+int CompositeLogData::senderIndex() const
+{
+    const QObject* member = sender();
+
+    auto found = std::find_if( members_.begin(), members_.end(),
+            [member]( const std::unique_ptr<LogData>& m ) { return m.get() == member; } );
+
+    if ( found == members_.end() )
+        return -1;
+    else
+        return found - members_.begin();
+}
+
+void CompositeLogData::startLoading( int index )
+{
+    // First file to start loading, we start a new loading
+    if ( std::none_of( loadingProgress_.begin(), loadingProgress_.end(),
+                []( int progress ) { return progress >= 0; } ) )
+        loadingStatus_ = LoadingStatus::Successful;
+
+    if ( loadingProgress_[index] < 0 )
+        loadingProgress_[index] = 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef COMPOSITELOGDATA_H
+#define COMPOSITELOGDATA_H
+
+#include <memory>
+#include <vector>
+
+#include <QStringList>
+
+#include "abstractlogsource.h"
+
+class LogData;
+
+// Base class for the data made of several files displayed in one view,
+// each file being a LogData keeping its own index.
+// It manages the files (loading, watching...), the subclasses define
+// how their lines are presented.
+class CompositeLogData : public AbstractLogSource {
+  Q_OBJECT
+
+  public:
+    // Creates an empty CompositeLogData
+    CompositeLogData();
+    ~CompositeLogData();
+
+    // Attaches the data to the files passed.
+    // The files are indexed in parallel and membersLoaded() is called
+    // once all of them are indexed.
+    // Reattaching is forbidden and will throw.
+    void attachFiles( const QStringList& fileNames );
+
+  private slots:
+    // Called when one of the files signals progress/end of loading
+    // or a change on disk.
+    void memberLoadingProgressed( int percent );
+    void memberLoadingFinished( LoadingStatus status );
+    void memberFileChanged( AbstractLogSource::MonitoredFileStatus status );
+
+  protected:
+    // Called when all the files have been indexed (after the initial
+    // loading or after some of them changed), status being the worst
+    // one returned by the files.
+    // It must eventually send loadingFinished.
+    virtual void membersLoaded( LoadingStatus status ) = 0;
+    // Returns the change to report when the file at index has changed
+    // on disk (in the way passed).
+    virtual MonitoredFileStatus memberChanged( int index, MonitoredFileStatus status ) = 0;
+
+    // Implementation of virtual functions common to all composites
+    int doGetMaxLength() const override;
+    void doSetDisplayEncoding( Encoding encoding ) override;
+    void doSetMultibyteEncodingOffsets( int before_cr, int after_cr ) override;
+    void doInterruptLoading() override;
+    LogFilteredData* doGetNewFilteredData() const override;
+    qint64 doGetFileSize() const override;
+    QDateTime doGetLastModifiedDate() const override;
+    void doReload() override;
+    void doSetPollingInterval( uint32_t interval_ms ) override;
+    void doSetForeground( bool foreground ) override;
+    EncodingSpeculator::Encoding doGetDetectedEncoding() const override;
+    StructuredFormat doGetStructuredFormat() const override;
+    qint64 doGetLastIndexingLatency() const override;
+    IndexingStatistics doGetIndexingStatistics() const override;
+
+    // The files, in the order they were passed
+    std::vector<std::unique_ptr<LogData>> members_;
+
+  private:
+    // Returns the index of the file the passed signal comes from
+    int senderIndex() const;
+    // Mark the file as being loaded
+    void startLoading( int index );
+
+    // For each file, progress of the loading, or -1 if not loading
+    std::vector<int> loadingProgress_;
+    // Worst status returned by the files since the loading started
+    LoadingStatus loadingStatus_;
+};
+
+#endif
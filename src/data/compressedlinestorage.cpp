@@ -26,6 +26,10 @@
 #include "data/compressedlinestorage.h"
 
 namespace {
+    // Size allocated for a new block (where every line is >16384)
+    const size_t BLOCK32_MAX_SIZE = 4 + BLOCK_SIZE * 6;
+    const size_t BLOCK64_MAX_SIZE = 8 + BLOCK_SIZE * 10;
+
     // Functions to manipulate blocks
 
     // Create a new 32 bits block of the passed size,
@@ -193,12 +197,14 @@ void CompressedLinePositionStorage::move_from(
         CompressedLinePositionStorage&& orig )
 {
     nb_lines_        = orig.nb_lines_;
+    blocks_size_     = orig.blocks_size_;
     first_long_line_ = orig.first_long_line_;
     current_pos_     = orig.current_pos_;
     block_pointer_   = orig.block_pointer_;
     previous_block_pointer_ = orig.previous_block_pointer_;
 
     orig.nb_lines_   = 0;
+    orig.blocks_size_ = 0;
 }
 
 // Move constructor
@@ -262,12 +268,16 @@ void CompressedLinePositionStorage::append( uint64_t pos )
 
     if ( ! block_pointer_ ) {
         // We need to start a new block
-        if ( ! store_in_big )
+        if ( ! store_in_big ) {
             block32_index_.push_back(
                 block32_new( BLOCK_SIZE, pos, &block_pointer_ ) );
-        else
+            blocks_size_ += BLOCK32_MAX_SIZE;
+        }
+        else {
             block64_index_.push_back(
                 block64_new( BLOCK_SIZE, pos, &block_pointer_ ) );
+            blocks_size_ += BLOCK64_MAX_SIZE;
+        }
     }
     else {
         uint64_t delta = pos - current_pos_;
@@ -303,8 +313,10 @@ void CompressedLinePositionStorage::append( uint64_t pos )
             size_t new_size = ( previous_block_pointer_
                     + sizeof( uint16_t ) + sizeof( uint32_t ) ) - block;
             void* new_location = realloc( block, new_size );
-            if ( new_location )
+            if ( new_location ) {
                 block32_index_[block_index] = static_cast<char*>( new_location );
+                blocks_size_ -= BLOCK32_MAX_SIZE - new_size;
+            }
 
             block_pointer_ = nullptr;
             previous_block_pointer_ = static_cast<char*>( new_location ) + ( previous_block_pointer_ - block );
@@ -322,8 +334,10 @@ void CompressedLinePositionStorage::append( uint64_t pos )
             size_t new_size = ( previous_block_pointer_
                     + sizeof( uint16_t ) + sizeof( uint64_t ) ) - block;
             void* new_location = realloc( block, new_size );
-            if ( new_location )
+            if ( new_location ) {
                 block64_index_[block_index] = static_cast<char*>( new_location );
+                blocks_size_ -= BLOCK64_MAX_SIZE - new_size;
+            }
 
             block_pointer_ = nullptr;
             previous_block_pointer_ = static_cast<char*>( new_location ) + ( previous_block_pointer_ - block );
@@ -413,6 +427,7 @@ void CompressedLinePositionStorage::pop_back()
             char* block = block32_index_.back();
             block32_index_.pop_back();
             free( block );
+            blocks_size_ -= BLOCK32_MAX_SIZE;
         }
         else {
             // If we try to pop_back() twice, we're dead!
@@ -421,6 +436,7 @@ void CompressedLinePositionStorage::pop_back()
             char* block = block64_index_.back();
             block64_index_.pop_back();
             free( block );
+            blocks_size_ -= BLOCK64_MAX_SIZE;
         }
 
         block_pointer_ = nullptr;
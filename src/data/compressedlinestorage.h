@@ -88,7 +88,7 @@ class CompressedLinePositionStorage
     CompressedLinePositionStorage()
     { nb_lines_ = 0; first_long_line_ = UINT32_MAX;
       current_pos_ = 0; block_pointer_ = nullptr;
-      previous_block_pointer_ = nullptr; }
+      previous_block_pointer_ = nullptr; blocks_size_ = 0; }
     // Copy constructor would be slow, delete!
     CompressedLinePositionStorage( const CompressedLinePositionStorage& orig ) = delete;
 
@@ -109,6 +109,10 @@ class CompressedLinePositionStorage
     { return nb_lines_; }
     // Element at index
     uint64_t at( uint32_t i ) const;
+    // Memory used by the storage (in bytes)
+    size_t allocatedSize() const
+    { return blocks_size_ + ( block32_index_.capacity()
+            + block64_index_.capacity() ) * sizeof( char* ); }
 
     // Add one list to the other
     void append_list( const std::vector<uint64_t>& positions );
@@ -128,6 +132,9 @@ class CompressedLinePositionStorage
     // Total number of lines in storage
     uint32_t nb_lines_;
 
+    // Total size of the blocks allocated
+    size_t blocks_size_;
+
     // Current position (position of the end of the last line added)
     uint64_t current_pos_;
     // Address of the next position (not yet written) within the current
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements ConcatenatedLogData, a set of files displayed
+// as a single log.
+
+#include "concatenatedlogdata.h"
+
+#include <algorithm>
+
+#include "log.h"
+
+#include "logdata.h"
+
+ConcatenatedLogData::ConcatenatedLogData() : CompositeLogData(),
+    firstLines_( 1, 0 )
+{
+}
+
+ConcatenatedLogData::~ConcatenatedLogData()
+{
+}
+
+//
+// Protected functions
+//
+
+void ConcatenatedLogData::membersLoaded( LoadingStatus status )
+{
+    updateFirstLines();
+
+    LOG(logDEBUG) << "ConcatenatedLogData: " << doGetNbLine() << " lines";
+    emit loadingFinished( status );
+}
+
+AbstractLogSource::MonitoredFileStatus ConcatenatedLogData::memberChanged(
+        int index, MonitoredFileStatus status )
+{
+    // Lines added to a file which is not the last one are inserted
+    // in the middle of the set: the lines after are changed.
+    if ( status == DataAdded && index != static_cast<int>( members_.size() ) - 1 )
+        return Rewritten;
+    else
+        return status;
+}
+
+//
+// Implementation of virtual functions
+//
+
+QString ConcatenatedLogData::doGetLineString( qint64 line ) const
+{
+    qint64 line_in_file;
+    const int index = fileForLine( line, &line_in_file );
+
+    if ( index < 0 || line_in_file >= members_[index]->getNbLine() )
+        return QString();
+
+    return members_[index]->getLineString( line_in_file );
+}
+
+QString ConcatenatedLogData::doGetExpandedLineString( qint64 line ) const
+{
+    qint64 line_in_file;
+    const int index = fileForLine( line, &line_in_file );
+
+    if ( index < 0 || line_in_file >= members_[index]->getNbLine() )
+        return QString();
+
+    return members_[index]->getExpandedLineString( line_in_file );
+}
+
+QStringList ConcatenatedLogData::doGetLines( qint64 first_line, int number ) const
+{
+    return getLinesFromFiles( first_line, number, false );
+}
+
+QStringList ConcatenatedLogData::doGetExpandedLines( qint64 first_line, int number ) const
+{
+    return getLinesFromFiles( first_line, number, true );
+}
+
+qint64 ConcatenatedLogData::doGetNbLine() const
+{
+    QMutexLocker locker( &linesMutex_ );
+
+    return firstLines_.back();
+}
+
+int ConcatenatedLogData::doGetLineLength( qint64 line ) const
+{
+    qint64 line_in_file;
+    const int index = fileForLine( line, &line_in_file );
+
+    if ( index < 0 )
+        return 0;
+
+    return members_[index]->getLineLength( line_in_file );
+}
+
+// Each file is searched independently
+std::vector<qint64> ConcatenatedLogData::doGetSearchPartitions() const
+{
+    QMutexLocker locker( &linesMutex_ );
+
+    return std::vector<qint64>( firstLines_.begin(), firstLines_.end() - 1 );
+}
+
+int ConcatenatedLogData::doGetLineSource( qint64 line ) const
+{
+    qint64 line_in_file;
+    return fileForLine( line, &line_in_file );
+}
+
+//
+// Private functions
+//
+
+void ConcatenatedLogData::updateFirstLines()
+{
+    QMutexLocker locker( &linesMutex_ );
+
+    firstLines_.resize( members_.size() + 1 );
+    for ( size_t i = 0; i < members_.size(); ++i )
+        firstLines_[i + 1] = firstLines_[i] + members_[i]->getNbLine();
+}
+
+int ConcatenatedLogData::fileForLine( qint64 line, qint64* line_in_file ) const
+{
+    QMutexLocker locker( &linesMutex_ );
+
+    if ( line < 0 || line >= firstLines_.back() )
+        return -1;
+
+    // The last file starting at or before the line
+    // (files with no lines start at the same line as the next one)
+    const auto next = std::upper_bound( firstLines_.begin(), firstLines_.end(), line );
+    const int index = ( next - firstLines_.begin() ) - 1;
+
+    *line_in_file = line - firstLines_[index];
+    return index;
+}
+
+QStringList ConcatenatedLogData::getLinesFromFiles( qint64 first_line, int number,
+        bool expanded ) const
+{
+    std::vector<qint64> first_lines;
+    {
+        QMutexLocker locker( &linesMutex_ );
+        first_lines = firstLines_;
+    }
+
+    const qint64 end_line = first_line + number;
+    if ( first_line < 0 || end_line > first_lines.back() ) {
+        LOG(logWARNING) << "ConcatenatedLogData::getLines Lines out of bound asked for";
+        return QStringList(); /* exception? */
+    }
+
+    QStringList lines;
+    lines.reserve( number );
+
+    qint64 line = first_line;
+    while ( line < end_line ) {
+        const auto next = std::upper_bound( first_lines.begin(), first_lines.end(), line );
+        const int index = ( next - first_lines.begin() ) - 1;
+        const LogData* member = members_[index].get();
+
+        const qint64 line_in_file = line - first_lines[index];
+        const int count = qMin( end_line, *next ) - line;
+
+        QStringList file_lines;
+        const int available = qBound<qint64>( 0,
+                member->getNbLine() - line_in_file, count );
+        if ( available > 0 )
+            file_lines = expanded ?
+                member->getExpandedLines( line_in_file, available ) :
+                member->getLines( line_in_file, available );
+
+        // If the file has been truncated since, the missing lines are empty
+        while ( file_lines.size() < count )
+            file_lines.append( QString() );
+        lines.append( file_lines );
+
+        line += count;
+    }
+
+    return lines;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CONCATENATEDLOGDATA_H
+#define CONCATENATEDLOGDATA_H
+
+#include <vector>
+
+#include <QMutex>
+
+#include "compositelogdata.h"
+
+// Represents an ordered set of files displayed as one log, each file
+// being displayed after the previous one (e.g. a log and its rotated
+// versions, oldest first).
+// The line numbers are global to the set.
+// This class is thread-safe.
+class ConcatenatedLogData : public CompositeLogData {
+  Q_OBJECT
+
+  public:
+    // Creates an empty ConcatenatedLogData
+    ConcatenatedLogData();
+    ~ConcatenatedLogData();
+
+  protected:
+    void membersLoaded( LoadingStatus status ) override;
+    MonitoredFileStatus memberChanged( int index, MonitoredFileStatus status ) override;
+
+  private:
+    // Implementation of virtual functions
+    QString doGetLineString( qint64 line ) const override;
+    QString doGetExpandedLineString( qint64 line ) const override;
+    QStringList doGetLines( qint64 first, int number ) const override;
+    QStringList doGetExpandedLines( qint64 first, int number ) const override;
+    qint64 doGetNbLine() const override;
+    int doGetLineLength( qint64 line ) const override;
+    std::vector<qint64> doGetSearchPartitions() const override;
+    int doGetLineSource( qint64 line ) const override;
+
+    // Recompute the position of each file from their number of lines
+    void updateFirstLines();
+    // Returns the index of the file containing the passed (global) line
+    // and the line number in that file, -1 if the line is out of bound.
+    int fileForLine( qint64 line, qint64* line_in_file ) const;
+    // Get the lines from each file, expanded or not
+    QStringList getLinesFromFiles( qint64 first_line, int number,
+            bool expanded ) const;
+
+    // First (global) line of each file, followed by the total number
+    // of lines. They are updated when the files finish indexing (and
+    // read by the search threads).
+    std::vector<qint64> firstLines_;
+    mutable QMutex linesMutex_;
+};
+
+#endif
@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements FieldIndex, the columnar index of the fields
+// of a structured log.
+
+#include "fieldindex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "log.h"
+#include "abstractlogsource.h"
+
+const int FieldIndex::BLOCK_LINES = 4096;
+
+namespace {
+    // Returns the length of the line once the tabs are expanded
+    int expandedLength( const QString& line )
+    {
+        int length = 0;
+        for ( const QChar c: line ) {
+            if ( c == '\t' )
+                length += AbstractLogData::tabStop - ( length % AbstractLogData::tabStop );
+            else
+                ++length;
+        }
+
+        return length;
+    }
+}
+
+FieldIndex::FieldIndex() : columns_(), blockMaxLengths_(), nbLines_( 0 )
+{
+}
+
+bool FieldIndex::update( const AbstractLogSource* source, const QStringList& keys,
+        const bool* interrupt_request, std::function<void( int )> progress )
+{
+    if ( keys.isEmpty() )
+        return true;
+
+    const LineNumber source_lines = source->getNbLine();
+
+    // The data has been truncated
+    if ( source_lines < nbLines_ )
+        clear();
+
+    QStringList new_keys;
+    for ( const auto& key: keys ) {
+        if ( ! columns_.contains( key ) )
+            new_keys.append( key );
+    }
+
+    // The last block is indexed again as it might have been incomplete
+    // (as might its last line)
+    const LineNumber from = ( nbLines_ > 0 ) ?
+        ( ( nbLines_ - 1 ) / BLOCK_LINES ) * BLOCK_LINES : 0;
+
+    const LineNumber nb_lines_to_index =
+        ( new_keys.isEmpty() ? 0 : from ) + ( source_lines - from );
+    if ( nb_lines_to_index == 0 )
+        return true;
+
+    LOG(logDEBUG) << "FieldIndex: indexing " << nb_lines_to_index << " lines";
+
+    LineNumber nb_lines_done = 0;
+    auto lines_done = [&]( LineNumber nb_lines ) {
+        progress( static_cast<int>(
+                    ( nb_lines_done + nb_lines ) * 100LL / nb_lines_to_index ) );
+    };
+
+    // The new keys are indexed for the lines already covered
+    if ( ! new_keys.isEmpty() ) {
+        for ( const auto& key: new_keys )
+            columns_.insert( key, Column() );
+
+        if ( ! indexLines( source, new_keys, 0, from,
+                    interrupt_request, lines_done ) ) {
+            for ( const auto& key: new_keys )
+                columns_.remove( key );
+            return false;
+        }
+        nb_lines_done = from;
+    }
+
+    // Then all the keys for the new lines
+    const size_t first_block = from / BLOCK_LINES;
+    for ( auto& column: columns_ )
+        column.resize( first_block );
+    blockMaxLengths_.resize( first_block );
+    nbLines_ = from;
+
+    const bool done = indexLines( source, columns_.keys(), from, source_lines,
+            interrupt_request, lines_done );
+
+    // Only the blocks fully indexed are kept
+    const size_t nb_blocks = columns_.begin()->size();
+    for ( auto& column: columns_ )
+        column.resize( nb_blocks );
+    blockMaxLengths_.resize( nb_blocks );
+    nbLines_ = std::min<LineNumber>( nb_blocks * BLOCK_LINES, source_lines );
+
+    return done;
+}
+
+int FieldIndex::match( const FieldQuery& query, LineNumber first_line,
+        LineNumber end_line, SearchResultArray* matches ) const
+{
+    const std::vector<FieldFilter>& filters = query.filters();
+
+    std::vector<const Column*> columns;
+    for ( const auto& filter: filters ) {
+        const auto column = columns_.find( filter.key() );
+        if ( column == columns_.end() )
+            return 0;
+        columns.push_back( &column.value() );
+    }
+
+    end_line = std::min( end_line, nbLines_ );
+
+    int max_length = 0;
+    // The codes accepted by each filter in the current block
+    std::vector<std::vector<bool>> accepted( filters.size() );
+    for ( LineNumber block_first = ( first_line / BLOCK_LINES ) * BLOCK_LINES;
+            block_first < end_line; block_first += BLOCK_LINES ) {
+        const size_t b = block_first / BLOCK_LINES;
+
+        // A block is skipped if one of the filters accepts none of its values
+        bool possible = true;
+        for ( size_t f = 0; f < filters.size() && possible; ++f ) {
+            const Block& block = (*columns[f])[b];
+            if ( ! filters[f].acceptsSomeOf( block.min, block.max ) ) {
+                possible = false;
+                break;
+            }
+
+            accepted[f].assign( block.dictionary.size() + 1, false );
+            if ( filters[f].op() == FieldFilter::Operator::Equal ) {
+                const int index = block.dictionary.indexOf( filters[f].value() );
+                if ( index != -1 )
+                    accepted[f][index + 1] = true;
+                possible = ( index != -1 );
+            }
+            else {
+                possible = false;
+                for ( int i = 0; i < block.dictionary.size(); ++i ) {
+                    if ( filters[f].accepts( block.dictionary[i], block.numbers[i] ) ) {
+                        accepted[f][i + 1] = true;
+                        possible = true;
+                    }
+                }
+            }
+        }
+        if ( ! possible )
+            continue;
+
+        const LineNumber from = std::max( first_line, block_first );
+        const LineNumber to = std::min<LineNumber>( end_line, block_first + BLOCK_LINES );
+        bool found = false;
+        for ( LineNumber line = from; line < to; ++line ) {
+            bool matching = true;
+            for ( size_t f = 0; f < filters.size() && matching; ++f )
+                matching = accepted[f][ (*columns[f])[b].codes[ line - block_first ] ];
+
+            if ( matching ) {
+                matches->push_back( MatchingLine( line ) );
+                found = true;
+            }
+        }
+
+        if ( found )
+            max_length = std::max( max_length, blockMaxLengths_[b] );
+    }
+
+    return max_length;
+}
+
+qint64 FieldIndex::getAllocatedSize() const
+{
+    qint64 size = blockMaxLengths_.capacity() * sizeof( int );
+    for ( const auto& column: columns_ ) {
+        for ( const auto& block: column ) {
+            size += sizeof( Block ) + block.codes.allocatedSize()
+                + block.numbers.capacity() * sizeof( double );
+            for ( const auto& value: block.dictionary )
+                size += sizeof( QString ) + value.capacity() * sizeof( QChar );
+        }
+    }
+
+    return size;
+}
+
+void FieldIndex::clear()
+{
+    columns_.clear();
+    blockMaxLengths_.clear();
+    nbLines_ = 0;
+}
+
+bool FieldIndex::indexLines( const AbstractLogSource* source, const QStringList& keys,
+        LineNumber first_line, LineNumber end_line,
+        const bool* interrupt_request, std::function<void( LineNumber )> progress )
+{
+    const int nb_keys = keys.size();
+
+    std::vector<Column*> columns;
+    for ( const auto& key: keys )
+        columns.push_back( &columns_[key] );
+
+    std::vector<QString> values;
+    std::vector<QHash<QString, uint32_t>> dictionaries( nb_keys );
+    std::vector<std::vector<uint32_t>> codes( nb_keys );
+
+    for ( LineNumber block_first = first_line; block_first < end_line;
+            block_first += BLOCK_LINES ) {
+        if ( *interrupt_request )
+            return false;
+
+        const int nb_lines = std::min<LineNumber>( BLOCK_LINES, end_line - block_first );
+        const QStringList lines = source->getLines( block_first, nb_lines );
+        if ( lines.size() != nb_lines )
+            return false;
+
+        std::vector<Block> blocks( nb_keys );
+        for ( int k = 0; k < nb_keys; ++k ) {
+            dictionaries[k].clear();
+            codes[k].clear();
+        }
+
+        int max_length = 0;
+        for ( const auto& line: lines ) {
+            FieldParser::parse( line, keys, &values );
+
+            for ( int k = 0; k < nb_keys; ++k ) {
+                uint32_t code = 0;
+                if ( ! values[k].isNull() ) {
+                    auto entry = dictionaries[k].find( values[k] );
+                    if ( entry == dictionaries[k].end() ) {
+                        blocks[k].dictionary.append( values[k] );
+                        entry = dictionaries[k].insert(
+                                values[k], blocks[k].dictionary.size() );
+                    }
+                    code = entry.value();
+                }
+                codes[k].push_back( code );
+            }
+
+            max_length = std::max( max_length, expandedLength( line ) );
+        }
+
+        for ( int k = 0; k < nb_keys; ++k ) {
+            Block& block = blocks[k];
+
+            block.min = std::numeric_limits<double>::quiet_NaN();
+            block.max = std::numeric_limits<double>::quiet_NaN();
+            for ( const auto& value: block.dictionary ) {
+                const double number = FieldQuery::toNumber( value );
+                block.numbers.push_back( number );
+                if ( ! std::isnan( number ) ) {
+                    if ( std::isnan( block.min ) || number < block.min )
+                        block.min = number;
+                    if ( std::isnan( block.max ) || number > block.max )
+                        block.max = number;
+                }
+            }
+
+            block.codes = PackedArray( codes[k] );
+
+            columns[k]->push_back( std::move( block ) );
+        }
+
+        if ( blockMaxLengths_.size() <= block_first / BLOCK_LINES )
+            blockMaxLengths_.push_back( max_length );
+
+        progress( block_first + nb_lines - first_line );
+    }
+
+    return true;
+}
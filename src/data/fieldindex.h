@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FIELDINDEX_H
+#define FIELDINDEX_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include "fieldquery.h"
+#include "packedarray.h"
+#include "logfiltereddataworkerthread.h"
+
+class AbstractLogSource;
+
+// Columnar index of the values of some fields of a structured log,
+// built lazily: a key is only indexed when a query needs it, and the
+// lines appended to the source are only indexed by the next query.
+// The lines are split in blocks, each column holding, for each block,
+// a dictionary of the values found and the (packed) codes of the value
+// of each line, so a filter is checked against each distinct value of
+// the block rather than against each line, and blocks holding no
+// accepted value are skipped.
+// This class is not thread-safe, it is used by the search operations
+// which run one at a time.
+class FieldIndex {
+  public:
+    FieldIndex();
+
+    // Index the keys passed (for the lines of the source not indexed
+    // yet), progress is called with the percentage done.
+    // Returns false if the indexing has been interrupted.
+    bool update( const AbstractLogSource* source, const QStringList& keys,
+            const bool* interrupt_request, std::function<void( int )> progress );
+
+    // Add the lines in [first_line, end_line) matching the query
+    // (whose keys must have been indexed) to matches, returns the
+    // length of the longest block the matches were found in.
+    int match( const FieldQuery& query, LineNumber first_line, LineNumber end_line,
+            SearchResultArray* matches ) const;
+
+    // Returns the number of lines indexed
+    LineNumber getNbLines() const { return nbLines_; }
+    // Returns the memory used by the index (in bytes)
+    qint64 getAllocatedSize() const;
+
+    // Drop the whole index
+    void clear();
+
+    // Number of lines in a block
+    static const int BLOCK_LINES;
+
+  private:
+    // The values of a key for the lines of a block
+    struct Block {
+        // Distinct values (the code of a value is its index plus one,
+        // 0 is for the lines without the field)
+        QStringList dictionary;
+        // The values read as numbers (NaN if not a number)
+        std::vector<double> numbers;
+        // The numeric values found are between min and max
+        double min;
+        double max;
+        // The code of the value of each line
+        PackedArray codes;
+    };
+    typedef std::vector<Block> Column;
+
+    // Read the lines of the source in [first_line, end_line), adding
+    // the values of the keys to the columns.
+    bool indexLines( const AbstractLogSource* source, const QStringList& keys,
+            LineNumber first_line, LineNumber end_line,
+            const bool* interrupt_request, std::function<void( LineNumber )> progress );
+
+    QHash<QString, Column> columns_;
+    // Length of the longest line of each block
+    std::vector<int> blockMaxLengths_;
+    LineNumber nbLines_;
+};
+
+#endif
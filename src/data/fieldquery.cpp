@@ -0,0 +1,450 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements the parsing of structured log lines and
+// of the queries on their fields.
+
+#include "fieldquery.h"
+
+#include <cmath>
+#include <limits>
+
+#include <QRegularExpression>
+
+namespace {
+    // Number of pairs for a line to be logfmt
+    const int MIN_LOGFMT_PAIRS = 2;
+
+    void skipSpaces( const QString& line, int* pos )
+    {
+        while ( *pos < line.size() && line[*pos].isSpace() )
+            ++(*pos);
+    }
+
+    // Reads the quoted string starting at pos (on the opening quote),
+    // pos is moved past the closing quote. Returns false if the string
+    // is not terminated.
+    bool readQuoted( const QString& line, int* pos, QString* value )
+    {
+        const int start = *pos + 1;
+        int i = start;
+        while ( i < line.size() && line[i] != '"' && line[i] != '\\' )
+            ++i;
+        if ( i >= line.size() )
+            return false;
+
+        if ( line[i] == '"' ) {
+            // Nothing to unescape
+            *value = ( i > start ) ? line.mid( start, i - start ) : QString( "" );
+            *pos = i + 1;
+            return true;
+        }
+
+        QString unescaped = line.mid( start, i - start );
+        while ( i < line.size() ) {
+            const QChar c = line[i];
+            if ( c == '"' ) {
+                *value = unescaped;
+                *pos = i + 1;
+                return true;
+            }
+            else if ( c == '\\' && i + 1 < line.size() ) {
+                const QChar escaped = line[++i];
+                switch ( escaped.unicode() ) {
+                    case 'n': unescaped += '\n'; break;
+                    case 't': unescaped += '\t'; break;
+                    case 'r': unescaped += '\r'; break;
+                    case 'b': unescaped += '\b'; break;
+                    case 'f': unescaped += '\f'; break;
+                    case 'u': {
+                        bool ok = false;
+                        const ushort code = line.mid( i + 1, 4 ).toUShort( &ok, 16 );
+                        if ( ok ) {
+                            unescaped += QChar( code );
+                            i += 4;
+                        }
+                        else {
+                            unescaped += escaped;
+                        }
+                        break;
+                    }
+                    default: unescaped += escaped; break;
+                }
+            }
+            else {
+                unescaped += c;
+            }
+            ++i;
+        }
+
+        return false;
+    }
+
+    // Skips the JSON object or array starting at pos
+    bool skipNested( const QString& line, int* pos )
+    {
+        int depth = 0;
+        int i = *pos;
+        while ( i < line.size() ) {
+            const QChar c = line[i];
+            if ( c == '"' ) {
+                QString ignored;
+                if ( ! readQuoted( line, &i, &ignored ) )
+                    return false;
+                continue;
+            }
+            else if ( c == '{' || c == '[' ) {
+                ++depth;
+            }
+            else if ( c == '}' || c == ']' ) {
+                if ( --depth == 0 ) {
+                    *pos = i + 1;
+                    return true;
+                }
+            }
+            ++i;
+        }
+
+        return false;
+    }
+
+    // Returns the number in text, an empty text being the infinity
+    // of the sign passed.
+    bool readBound( const QString& text, double infinity, double* bound )
+    {
+        if ( text.isEmpty() ) {
+            *bound = infinity;
+            return true;
+        }
+
+        *bound = FieldQuery::toNumber( text );
+        return ! std::isnan( *bound );
+    }
+
+    // Splits the text on the spaces that are not quoted
+    QStringList splitFilters( const QString& text )
+    {
+        QStringList filters;
+        QString current;
+        bool quoted = false;
+        for ( int i = 0; i < text.size(); ++i ) {
+            const QChar c = text[i];
+            if ( c == '\\' && quoted && i + 1 < text.size() ) {
+                current += c;
+                current += text[++i];
+            }
+            else if ( c == '"' ) {
+                quoted = ! quoted;
+                current += c;
+            }
+            else if ( c.isSpace() && ! quoted ) {
+                if ( ! current.isEmpty() )
+                    filters.append( current );
+                current.clear();
+            }
+            else {
+                current += c;
+            }
+        }
+        if ( ! current.isEmpty() )
+            filters.append( current );
+
+        return filters;
+    }
+}
+
+//
+// FieldParser
+//
+
+StructuredFormat FieldParser::detect( const QStringList& lines )
+{
+    static const QRegularExpression logfmt_pair( "(?:^|\\s)[\\w.\\-]+=" );
+
+    int nb_lines = 0;
+    int nb_json = 0;
+    int nb_logfmt = 0;
+    for ( const auto& line: lines ) {
+        const QString trimmed = line.trimmed();
+        if ( trimmed.isEmpty() )
+            continue;
+
+        ++nb_lines;
+        if ( trimmed.startsWith( '{' ) && trimmed.endsWith( '}' ) ) {
+            ++nb_json;
+        }
+        else {
+            int nb_pairs = 0;
+            auto pairs = logfmt_pair.globalMatch( trimmed );
+            while ( pairs.hasNext() && nb_pairs < MIN_LOGFMT_PAIRS ) {
+                pairs.next();
+                ++nb_pairs;
+            }
+            if ( nb_pairs >= MIN_LOGFMT_PAIRS )
+                ++nb_logfmt;
+        }
+    }
+
+    // Most of the lines, some (e.g. a banner) might not be structured
+    if ( nb_lines == 0 )
+        return StructuredFormat::None;
+    else if ( nb_json * 5 >= nb_lines * 4 )
+        return StructuredFormat::Json;
+    else if ( nb_logfmt * 5 >= nb_lines * 4 )
+        return StructuredFormat::Logfmt;
+    else
+        return StructuredFormat::None;
+}
+
+void FieldParser::parse( const QString& line, const QStringList& keys,
+        std::vector<QString>* values )
+{
+    values->assign( keys.size(), QString() );
+
+    int pos = 0;
+    skipSpaces( line, &pos );
+    if ( pos < line.size() && line[pos] == '{' )
+        parseJson( line, pos, keys, values );
+    else
+        parseLogfmt( line, keys, values );
+}
+
+void FieldParser::parseJson( const QString& line, int pos,
+        const QStringList& keys, std::vector<QString>* values )
+{
+    // Skip the '{'
+    ++pos;
+
+    while ( true ) {
+        skipSpaces( line, &pos );
+        if ( pos >= line.size() || line[pos] != '"' )
+            return;
+
+        QString key;
+        if ( ! readQuoted( line, &pos, &key ) )
+            return;
+
+        skipSpaces( line, &pos );
+        if ( pos >= line.size() || line[pos] != ':' )
+            return;
+        ++pos;
+        skipSpaces( line, &pos );
+        if ( pos >= line.size() )
+            return;
+
+        QString value;
+        const int start = pos;
+        if ( line[pos] == '"' ) {
+            if ( ! readQuoted( line, &pos, &value ) )
+                return;
+        }
+        else if ( line[pos] == '{' || line[pos] == '[' ) {
+            // Nested values are kept as they are written
+            if ( ! skipNested( line, &pos ) )
+                return;
+            value = line.mid( start, pos - start );
+        }
+        else {
+            // Number, true, false or null
+            while ( pos < line.size() && line[pos] != ',' && line[pos] != '}' )
+                ++pos;
+            value = line.mid( start, pos - start ).trimmed();
+        }
+
+        const int index = keys.indexOf( key );
+        if ( index != -1 )
+            (*values)[index] = value;
+
+        skipSpaces( line, &pos );
+        if ( pos >= line.size() || line[pos] != ',' )
+            return;
+        ++pos;
+    }
+}
+
+void FieldParser::parseLogfmt( const QString& line,
+        const QStringList& keys, std::vector<QString>* values )
+{
+    int pos = 0;
+    while ( pos < line.size() ) {
+        skipSpaces( line, &pos );
+
+        const int key_start = pos;
+        while ( pos < line.size() && ! line[pos].isSpace() && line[pos] != '=' )
+            ++pos;
+
+        // Words which are not pairs are skipped
+        if ( pos >= line.size() || line[pos] != '=' || pos == key_start ) {
+            while ( pos < line.size() && ! line[pos].isSpace() )
+                ++pos;
+            continue;
+        }
+
+        const QString key = line.mid( key_start, pos - key_start );
+        ++pos;
+
+        QString value;
+        if ( pos < line.size() && line[pos] == '"' ) {
+            if ( ! readQuoted( line, &pos, &value ) )
+                return;
+        }
+        else {
+            const int start = pos;
+            while ( pos < line.size() && ! line[pos].isSpace() )
+                ++pos;
+            value = ( pos > start ) ? line.mid( start, pos - start ) : QString( "" );
+        }
+
+        const int index = keys.indexOf( key );
+        if ( index != -1 )
+            (*values)[index] = value;
+    }
+}
+
+//
+// FieldFilter
+//
+
+FieldFilter::FieldFilter( const QString& key, Operator op, const QString& value )
+    : key_( key ), op_( op ), value_( value ),
+    min_( 0 ), minInclusive_( true ), max_( 0 ), maxInclusive_( true )
+{
+}
+
+FieldFilter::FieldFilter( const QString& key, double min, bool min_inclusive,
+        double max, bool max_inclusive )
+    : key_( key ), op_( Operator::Range ), value_(),
+    min_( min ), minInclusive_( min_inclusive ),
+    max_( max ), maxInclusive_( max_inclusive )
+{
+}
+
+bool FieldFilter::accepts( const QString& value, double number ) const
+{
+    switch ( op_ ) {
+        case Operator::Equal:
+            return value == value_;
+        case Operator::Prefix:
+            return value.startsWith( value_ );
+        case Operator::Range:
+            return ! std::isnan( number )
+                && ( minInclusive_ ? number >= min_ : number > min_ )
+                && ( maxInclusive_ ? number <= max_ : number < max_ );
+    }
+
+    return false;
+}
+
+bool FieldFilter::acceptsSomeOf( double min, double max ) const
+{
+    if ( op_ != Operator::Range )
+        return true;
+
+    return ( minInclusive_ ? max >= min_ : max > min_ )
+        && ( maxInclusive_ ? min <= max_ : min < max_ );
+}
+
+//
+// FieldQuery
+//
+
+FieldQuery FieldQuery::parse( const QString& text, QString* error )
+{
+    static const QRegularExpression filter_syntax(
+            "^([^=<>^\\s\"]+)(\\^=|>=|<=|=|>|<)(.*)$" );
+    static const QRegularExpression range_syntax( "^(.*?)\\.\\.(.*)$" );
+
+    FieldQuery query;
+    for ( const auto& filter: splitFilters( text ) ) {
+        const QRegularExpressionMatch match = filter_syntax.match( filter );
+        if ( ! match.hasMatch() ) {
+            *error = QString( "'%1' is not a filter (key=value, key^=prefix, "
+                    "key=min..max, key>number...)" ).arg( filter );
+            return FieldQuery();
+        }
+
+        const QString key = match.captured( 1 );
+        const QString op = match.captured( 2 );
+        QString value = match.captured( 3 );
+        if ( value.size() >= 2 && value.startsWith( '"' ) && value.endsWith( '"' ) ) {
+            QString unquoted;
+            int pos = 0;
+            if ( readQuoted( value, &pos, &unquoted ) )
+                value = unquoted;
+        }
+
+        if ( value.isEmpty() ) {
+            *error = QString( "No value in '%1'" ).arg( filter );
+            return FieldQuery();
+        }
+
+        // A value which is not a range of numbers (e.g. a path
+        // containing '..') is compared as it is
+        const double infinity = std::numeric_limits<double>::infinity();
+        const QRegularExpressionMatch range = range_syntax.match( value );
+        double min, max;
+        const double number = toNumber( value );
+        if ( op == "=" && range.hasMatch()
+                && readBound( range.captured( 1 ), -infinity, &min )
+                && readBound( range.captured( 2 ), infinity, &max ) ) {
+            query.filters_.emplace_back( key, min, true, max, true );
+        }
+        else if ( op == "=" ) {
+            query.filters_.emplace_back( key, FieldFilter::Operator::Equal, value );
+        }
+        else if ( op == "^=" ) {
+            query.filters_.emplace_back( key, FieldFilter::Operator::Prefix, value );
+        }
+        else if ( std::isnan( number ) ) {
+            *error = QString( "'%1' is not a number in '%2'" ).arg( value, filter );
+            return FieldQuery();
+        }
+        else if ( op.startsWith( '>' ) ) {
+            query.filters_.emplace_back( key, number, op == ">=", infinity, true );
+        }
+        else {
+            query.filters_.emplace_back( key, -infinity, true, number, op == "<=" );
+        }
+    }
+
+    if ( query.isEmpty() )
+        *error = "Empty query";
+
+    return query;
+}
+
+QStringList FieldQuery::keys() const
+{
+    QStringList keys;
+    for ( const auto& filter: filters_ ) {
+        if ( ! keys.contains( filter.key() ) )
+            keys.append( filter.key() );
+    }
+
+    return keys;
+}
+
+double FieldQuery::toNumber( const QString& value )
+{
+    bool ok = false;
+    const double number = value.toDouble( &ok );
+
+    return ok ? number : std::numeric_limits<double>::quiet_NaN();
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FIELDQUERY_H
+#define FIELDQUERY_H
+
+#include <vector>
+
+#include <QString>
+#include <QStringList>
+
+// Format of the lines of a structured log
+enum class StructuredFormat {
+    None,
+    Json,       // {"key": "value", "other": 42}
+    Logfmt,     // key=value other="quoted value"
+};
+
+// Extracts the fields of structured log lines, a line starting with '{'
+// is read as a JSON object (only its top level keys are fields), any
+// other line as logfmt key=value pairs.
+class FieldParser {
+  public:
+    // Returns the format most of the lines passed are in, None
+    // if they are not structured.
+    static StructuredFormat detect( const QStringList& lines );
+
+    // Sets values[i] to the value of keys[i] in the line,
+    // or to a null string if the line has no such field.
+    static void parse( const QString& line, const QStringList& keys,
+            std::vector<QString>* values );
+
+  private:
+    static void parseJson( const QString& line, int pos,
+            const QStringList& keys, std::vector<QString>* values );
+    static void parseLogfmt( const QString& line,
+            const QStringList& keys, std::vector<QString>* values );
+};
+
+// A condition on the value of a field
+class FieldFilter {
+  public:
+    enum class Operator {
+        Equal,      // key=value
+        Prefix,     // key^=prefix
+        Range,      // key=min..max, key>min, key>=min, key<max, key<=max
+    };
+
+    FieldFilter( const QString& key, Operator op, const QString& value );
+    FieldFilter( const QString& key, double min, bool min_inclusive,
+            double max, bool max_inclusive );
+
+    const QString& key() const { return key_; }
+    Operator op() const { return op_; }
+
+    // Returns whether the value of the field passes the filter,
+    // number is the value read as a number (NaN if it is not one).
+    bool accepts( const QString& value, double number ) const;
+    // Returns whether a value between min and max (numbers) can pass
+    // the filter.
+    bool acceptsSomeOf( double min, double max ) const;
+
+    // For Equal, the only value accepted
+    const QString& value() const { return value_; }
+
+  private:
+    QString key_;
+    Operator op_;
+    QString value_;
+    double min_;
+    bool minInclusive_;
+    double max_;
+    bool maxInclusive_;
+};
+
+// A set of conditions on the fields of the lines, all of them
+// must be met for a line to match.
+class FieldQuery {
+  public:
+    // Creates an empty query
+    FieldQuery() = default;
+
+    // Parses a query made of filters separated by spaces
+    // (e.g. 'status=500..599 latency_ms>=250 trace_id^=4bf9'), values
+    // containing spaces can be quoted. Returns an empty query and sets
+    // error if the text is not a valid query.
+    static FieldQuery parse( const QString& text, QString* error );
+
+    bool isEmpty() const { return filters_.empty(); }
+    const std::vector<FieldFilter>& filters() const { return filters_; }
+    // Returns the keys the filters are about (without duplicates)
+    QStringList keys() const;
+
+    // Returns the numeric value of a field (NaN if it is not a number)
+    static double toNumber( const QString& value );
+
+  private:
+    std::vector<FieldFilter> filters_;
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "filefingerprint.h"
+
+#include <QIODevice>
+#include <QByteArray>
+
+#include "log.h"
+
+const int FileFingerprint::BLOCK_SIZE = 4096;
+
+namespace {
+    // The blocks sampled from the beginning of the file are at fixed
+    // positions so they stay valid when the file grows, they get sparser
+    // further in the file (0, 64 KiB, 1 MiB, 16 MiB...)
+    const qint64 FIRST_SAMPLE_DISTANCE = 64 * 1024;
+    const int SAMPLE_DISTANCE_FACTOR = 16;
+
+    const quint32 ADLER_MODULO = 65521;
+};
+
+FileFingerprint FileFingerprint::compute( QIODevice* file, qint64 size )
+{
+    FileFingerprint fingerprint;
+    fingerprint.size_ = size;
+
+    std::vector<qint64> offsets;
+    if ( size >= BLOCK_SIZE )
+        offsets.push_back( 0 );
+    for ( qint64 offset = FIRST_SAMPLE_DISTANCE; offset + BLOCK_SIZE <= size;
+            offset *= SAMPLE_DISTANCE_FACTOR )
+        offsets.push_back( offset );
+
+    for ( qint64 offset: offsets ) {
+        Block block { offset, BLOCK_SIZE, 0 };
+        if ( blockChecksum( file, block.offset, block.length, &block.checksum ) )
+            fingerprint.blocks_.push_back( block );
+    }
+
+    // The tail block
+    if ( size > 0 ) {
+        const qint64 tail_offset = qMax<qint64>( 0, size - BLOCK_SIZE );
+        Block block { tail_offset, static_cast<int>( size - tail_offset ), 0 };
+        if ( blockChecksum( file, block.offset, block.length, &block.checksum ) )
+            fingerprint.blocks_.push_back( block );
+    }
+
+    return fingerprint;
+}
+
+FileFingerprint::Change FileFingerprint::compare(
+        QIODevice* file, qint64 size, qint64* changed_from ) const
+{
+    *changed_from = 0;
+
+    if ( size_ == 0 )
+        return ( size > 0 ) ? Change::Appended : Change::None;
+
+    qint64 identical_end = 0;
+    for ( const auto& block: blocks_ ) {
+        quint32 checksum;
+        if ( block.offset + block.length > size
+                || ! blockChecksum( file, block.offset, block.length, &checksum )
+                || checksum != block.checksum ) {
+            LOG(logDEBUG) << "FileFingerprint: block at " << block.offset << " changed";
+
+            if ( identical_end == 0 )
+                return Change::Replaced;
+
+            *changed_from = identical_end;
+            return Change::Rewritten;
+        }
+
+        identical_end = block.offset + block.length;
+    }
+
+    // The tail block is identical, so the file can only have grown
+    return ( size > size_ ) ? Change::Appended : Change::None;
+}
+
+bool FileFingerprint::blockChecksum( QIODevice* file, qint64 offset, int length,
+        quint32* checksum )
+{
+    if ( ! file->seek( offset ) )
+        return false;
+
+    const QByteArray data = file->read( length );
+    if ( data.size() != length )
+        return false;
+
+    quint32 a = 1;
+    quint32 b = 0;
+    for ( const char c: data ) {
+        a = ( a + static_cast<unsigned char>( c ) ) % ADLER_MODULO;
+        b = ( b + a ) % ADLER_MODULO;
+    }
+
+    *checksum = ( b << 16 ) | a;
+    return true;
+}
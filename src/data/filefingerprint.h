@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FILEFINGERPRINT_H
+#define FILEFINGERPRINT_H
+
+#include <vector>
+
+#include <QtGlobal>
+
+class QIODevice;
+
+// Checksums of a few blocks of a file: some at fixed positions from its
+// beginning and the last block of the part that has been indexed.
+// Comparing it to the file on disk tells whether the file has been
+// appended to, rewritten from a given position or replaced, without
+// reading it all again.
+// The blocks being sampled, a change between them is not seen.
+class FileFingerprint {
+  public:
+    enum class Change {
+        // The sampled blocks are identical and the size is the same
+        None,
+        // The sampled blocks are identical and the file is bigger
+        Appended,
+        // The beginning of the file is identical, the rest might not be
+        Rewritten,
+        // The first block has changed (or the file is empty)
+        Replaced,
+    };
+
+    // Size of the blocks checksummed
+    static const int BLOCK_SIZE;
+
+    // Creates an empty fingerprint (of an empty file)
+    FileFingerprint() = default;
+
+    // Compute the fingerprint of the first size bytes of the file
+    static FileFingerprint compute( QIODevice* file, qint64 size );
+
+    // Compare with the first size bytes of the file (its current content),
+    // for Rewritten, changed_from is set to the position from which
+    // the content might be different (the end of the last identical block).
+    Change compare( QIODevice* file, qint64 size, qint64* changed_from ) const;
+
+    // Size covered by the fingerprint
+    qint64 size() const { return size_; }
+
+  private:
+    struct Block {
+        qint64 offset;
+        int length;
+        quint32 checksum;
+    };
+
+    // Returns the Adler-32 checksum of the block read from file,
+    // returns false if it can't be fully read.
+    static bool blockChecksum( QIODevice* file, qint64 offset, int length,
+            quint32* checksum );
+
+    // Ordered by offset
+    std::vector<Block> blocks_;
+    qint64 size_ = 0;
+};
+
+#endif
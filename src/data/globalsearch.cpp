@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements GlobalSearch, searching several files
+// on the shared TaskScheduler.
+
+#include "globalsearch.h"
+
+#include <iterator>
+
+#include "log.h"
+
+#include "abstractlogsource.h"
+
+namespace {
+    // Number of lines in each chunk to read
+    const int nbLinesInChunk = 5000;
+    // Longest text kept for a matching line
+    const int maxMatchTextLength = 300;
+};
+
+GlobalSearch::GlobalSearch( int max_parallel_files, int max_matches )
+    : QObject(), maxParallelFiles_( qMax( 1, max_parallel_files ) ),
+    maxMatches_( max_matches ), nbFiles_( 0 ), interruptRequested_( false ),
+    nbFilesSearched_( 0 ), nbMatches_( 0 ), nextFile_( 0 ),
+    tasks_( TaskScheduler::instance(), TaskPriority::Search )
+{
+}
+
+GlobalSearch::~GlobalSearch()
+{
+    interrupt();
+}
+
+void GlobalSearch::start(
+        const std::vector<std::shared_ptr<const AbstractLogSource>>& files,
+        const QRegularExpression& regexp )
+{
+    LOG(logDEBUG) << "GlobalSearch::start on " << files.size() << " files";
+
+    interrupt();
+
+    {
+        QMutexLocker locker( &matchesMutex_ );
+        newMatches_.clear();
+    }
+    files_           = files;
+    regexp_          = regexp;
+    nbFiles_         = files.size();
+    nbFilesSearched_ = 0;
+    nbMatches_       = 0;
+    nextFile_        = 0;
+
+    if ( files.empty() ) {
+        emit searchFinished();
+        return;
+    }
+
+    // The files are searched in order, by at most maxParallelFiles_ tasks
+    tasks_.submit( qMin( maxParallelFiles_, nbFiles_ ), [this] { searchFiles(); } );
+}
+
+void GlobalSearch::interrupt()
+{
+    interruptRequested_ = true;
+    tasks_.cancelAndWait();
+    interruptRequested_ = false;
+}
+
+std::vector<GlobalSearchMatch> GlobalSearch::takeNewMatches()
+{
+    QMutexLocker locker( &matchesMutex_ );
+
+    std::vector<GlobalSearchMatch> matches;
+    matches.swap( newMatches_ );
+
+    return matches;
+}
+
+void GlobalSearch::addMatches( std::vector<GlobalSearchMatch>&& matches )
+{
+    const int nb_matches = nbMatches_.fetch_add( matches.size() );
+
+    // Only the first max_matches ones are kept
+    if ( nb_matches + static_cast<int>( matches.size() ) > maxMatches_ )
+        matches.resize( qMax( 0, maxMatches_ - nb_matches ) );
+
+    bool notify;
+    {
+        QMutexLocker locker( &matchesMutex_ );
+
+        // The client takes all the pending matches when notified
+        notify = newMatches_.empty();
+        newMatches_.insert( newMatches_.end(),
+                std::make_move_iterator( matches.begin() ),
+                std::make_move_iterator( matches.end() ) );
+    }
+
+    if ( notify && ! matches.empty() )
+        emit matchesAvailable();
+}
+
+void GlobalSearch::fileSearched()
+{
+    // The last file searched signals the end
+    if ( nbFilesSearched_.fetch_add( 1 ) + 1 == nbFiles_ && ! interruptRequested_ ) {
+        LOG(logDEBUG) << "GlobalSearch: all files searched";
+        emit searchFinished();
+    }
+}
+
+//
+// Private functions
+//
+
+void GlobalSearch::searchFiles()
+{
+    int file_index;
+    while ( ( file_index = nextFile_++ ) < nbFiles_ && ! interruptRequested_ )
+        searchFile( file_index );
+}
+
+void GlobalSearch::searchFile( int file_index )
+{
+    const AbstractLogSource* source = files_[file_index].get();
+    const qint64 nb_lines = source->getNbLine();
+
+    for ( qint64 i = 0; i < nb_lines; i += nbLinesInChunk ) {
+        if ( interruptRequested_ )
+            return;
+        // Enough matches, the rest of the file is skipped
+        if ( nbMatches_ >= maxMatches_ )
+            break;
+
+        const int nb_lines_to_read = qMin<qint64>( nbLinesInChunk, nb_lines - i );
+        const QStringList lines = source->getLines( i, nb_lines_to_read );
+
+        std::vector<GlobalSearchMatch> matches;
+        for ( int j = 0; j < lines.size(); ++j ) {
+            if ( regexp_.match( lines[j] ).hasMatch() )
+                matches.push_back( { file_index, i + j,
+                        lines[j].left( maxMatchTextLength ) } );
+        }
+
+        if ( ! matches.empty() )
+            addMatches( std::move( matches ) );
+    }
+
+    fileSearched();
+}
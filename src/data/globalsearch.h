@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef GLOBALSEARCH_H
+#define GLOBALSEARCH_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QMutex>
+#include <QRegularExpression>
+
+#include "taskscheduler.h"
+
+class AbstractLogSource;
+
+// A line matching a global search
+struct GlobalSearchMatch {
+    // Index of the file in the list searched
+    int file;
+    qint64 line;
+    QString text;
+};
+
+// Search the same regexp in several files (typically all the open ones)
+// at once. A bounded number of files are searched in parallel by tasks
+// on the TaskScheduler, so the disks are not thrashed, and the matches
+// are reported as they are found.
+// The matches are pulled by the client (takeNewMatches) when
+// matchesAvailable is received.
+class GlobalSearch : public QObject
+{
+  Q_OBJECT
+
+  public:
+    // At most max_parallel_files files are searched at the same time
+    // and the search stops after max_matches matches.
+    GlobalSearch( int max_parallel_files, int max_matches = 10000 );
+    ~GlobalSearch();
+
+    // Start searching the passed files, the search in progress (if any)
+    // is interrupted. The files are kept alive until the next search
+    // (so they are not destroyed by the search threads).
+    void start( const std::vector<std::shared_ptr<const AbstractLogSource>>& files,
+            const QRegularExpression& regexp );
+    // Interrupts the search if one is in progress and wait for
+    // the interruption to be done.
+    void interrupt();
+
+    // Returns the matches found since the previous call, for each file
+    // in line order.
+    std::vector<GlobalSearchMatch> takeNewMatches();
+    // Returns the number of files completely searched
+    int getNbFilesSearched() const { return nbFilesSearched_; }
+    // Returns whether all the files have been searched
+    bool isFinished() const { return nbFilesSearched_ == nbFiles_; }
+    // Returns whether the search stopped at max_matches matches
+    bool isTruncated() const { return nbMatches_ >= maxMatches_; }
+
+  signals:
+    // Sent (from the search threads) when new matches can be taken
+    void matchesAvailable();
+    // Sent when all the files have been searched (not sent if the
+    // search is interrupted)
+    void searchFinished();
+
+  private:
+    // Run by the tasks, search the files not taken by another task
+    void searchFiles();
+    void searchFile( int file_index );
+
+    void addMatches( std::vector<GlobalSearchMatch>&& matches );
+    void fileSearched();
+
+    std::vector<std::shared_ptr<const AbstractLogSource>> files_;
+    QRegularExpression regexp_;
+
+    const int maxParallelFiles_;
+    const int maxMatches_;
+    int nbFiles_;
+    std::atomic<bool> interruptRequested_;
+    std::atomic<int> nbFilesSearched_;
+    std::atomic<int> nbMatches_;
+    // Next file to be taken by a task
+    std::atomic<int> nextFile_;
+
+    // Tasks of the current search
+    TaskGroup tasks_;
+
+    // Matches not taken by the client yet
+    QMutex matchesMutex_;
+    std::vector<GlobalSearchMatch> newMatches_;
+};
+
+#endif
@@ -0,0 +1,392 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements HeavyHitters and GroupBy, counting the values
+// of capture groups on the shared TaskScheduler.
+
+#include "groupby.h"
+
+#include <algorithm>
+
+#include "log.h"
+
+#include "abstractlogsource.h"
+
+namespace {
+    // Number of lines in each chunk to read
+    const int nbLinesInChunk = 5000;
+    // Number of lines in the parts taken by the tasks
+    const qint64 nbLinesInPart = 50000;
+    // Between the capture groups in a value
+    const QChar valueSeparator( 0x1F );
+
+    // Returns whether the group opened at open captures
+    bool isCapturing( const QString& pattern, int open )
+    {
+        if ( open + 1 >= pattern.size() || pattern[open + 1] != '?' )
+            return true;
+
+        // Named groups: (?<name>...), (?P<name>...) and (?'name'...)
+        const QString rest = pattern.mid( open + 2, 2 );
+        return rest.startsWith( '\'' ) || rest.startsWith( "P<" )
+            || ( rest.startsWith( '<' ) && rest != "<=" && rest != "<!" );
+    }
+
+    // Returns the position after the character class starting at pos
+    int skipClass( const QString& pattern, int pos )
+    {
+        int i = pos + 1;
+        if ( i < pattern.size() && pattern[i] == '^' )
+            ++i;
+        // A ']' first is part of the class
+        if ( i < pattern.size() && pattern[i] == ']' )
+            ++i;
+        while ( i < pattern.size() && pattern[i] != ']' )
+            i += ( pattern[i] == '\\' ) ? 2 : 1;
+
+        return i + 1;
+    }
+}
+
+//
+// HeavyHitters
+//
+
+HeavyHitters::HeavyHitters( int capacity )
+    : capacity_( qMax( 1, capacity ) ), total_( 0 ), exact_( true )
+{
+}
+
+void HeavyHitters::add( const QString& value )
+{
+    ++total_;
+
+    auto counter = counters_.find( value );
+    if ( counter != counters_.end() ) {
+        byCount_.erase( std::make_pair( counter->count, value ) );
+        ++counter->count;
+        byCount_.insert( std::make_pair( counter->count, value ) );
+    }
+    else if ( counters_.size() < capacity_ ) {
+        insert( value, { 1, 0 } );
+    }
+    else {
+        // The least frequent value is replaced
+        exact_ = false;
+        const auto least_frequent = byCount_.begin();
+        const qint64 min_count = least_frequent->first;
+        counters_.remove( least_frequent->second );
+        byCount_.erase( least_frequent );
+
+        insert( value, { min_count + 1, min_count } );
+    }
+}
+
+void HeavyHitters::merge( const HeavyHitters& other )
+{
+    // A value missing from a full summary might have been counted
+    // up to its minimum count
+    const qint64 min_count = minCount();
+    const qint64 other_min_count = other.minCount();
+
+    std::vector<std::pair<QString, Counter>> merged;
+    merged.reserve( counters_.size() + other.counters_.size() );
+    for ( auto i = counters_.constBegin(); i != counters_.constEnd(); ++i ) {
+        const auto other_counter = other.counters_.find( i.key() );
+        if ( other_counter != other.counters_.end() )
+            merged.push_back( { i.key(), { i->count + other_counter->count,
+                        i->error + other_counter->error } } );
+        else
+            merged.push_back( { i.key(), { i->count + other_min_count,
+                        i->error + other_min_count } } );
+    }
+    for ( auto i = other.counters_.constBegin(); i != other.counters_.constEnd(); ++i ) {
+        if ( ! counters_.contains( i.key() ) )
+            merged.push_back( { i.key(), { i->count + min_count,
+                        i->error + min_count } } );
+    }
+
+    // Only the most frequent values are kept
+    exact_ = exact_ && other.exact_ && merged.size() <= static_cast<size_t>( capacity_ );
+    if ( merged.size() > static_cast<size_t>( capacity_ ) ) {
+        std::nth_element( merged.begin(), merged.begin() + capacity_, merged.end(),
+                []( const std::pair<QString, Counter>& a,
+                    const std::pair<QString, Counter>& b ) {
+                    return a.second.count > b.second.count;
+                } );
+        merged.resize( capacity_ );
+    }
+
+    total_ += other.total_;
+    counters_.clear();
+    byCount_.clear();
+    for ( const auto& value: merged )
+        insert( value.first, value.second );
+}
+
+std::vector<HeavyHitters::Entry> HeavyHitters::entries() const
+{
+    std::vector<Entry> entries;
+    entries.reserve( byCount_.size() );
+    for ( auto i = byCount_.rbegin(); i != byCount_.rend(); ++i )
+        entries.push_back( { i->second, i->first, counters_[i->second].error } );
+
+    return entries;
+}
+
+qint64 HeavyHitters::minCount() const
+{
+    if ( counters_.size() < capacity_ )
+        return 0;
+
+    return byCount_.begin()->first;
+}
+
+void HeavyHitters::insert( const QString& value, const Counter& counter )
+{
+    counters_.insert( value, counter );
+    byCount_.insert( std::make_pair( counter.count, value ) );
+}
+
+//
+// GroupBy
+//
+
+GroupBy::GroupBy( int capacity )
+    : QObject(), capacity_( capacity ), allLines_( true ),
+    nbItems_( 0 ), nbParts_( 0 ), interruptRequested_( false ),
+    nextPart_( 0 ), nbItemsCounted_( 0 ), finished_( false ),
+    tasks_( TaskScheduler::instance(), TaskPriority::Search ), results_( capacity )
+{
+}
+
+GroupBy::~GroupBy()
+{
+    interrupt();
+}
+
+void GroupBy::start( const std::shared_ptr<const AbstractLogSource>& source,
+        const QRegularExpression& regexp )
+{
+    interrupt();
+
+    lines_.clear();
+    allLines_ = true;
+    nbItems_  = source->getNbLine();
+    doStart( source, regexp );
+}
+
+void GroupBy::start( const std::shared_ptr<const AbstractLogSource>& source,
+        const QRegularExpression& regexp, std::vector<qint64> lines )
+{
+    interrupt();
+
+    lines_    = std::move( lines );
+    allLines_ = false;
+    nbItems_  = lines_.size();
+    doStart( source, regexp );
+}
+
+void GroupBy::interrupt()
+{
+    interruptRequested_ = true;
+    tasks_.cancelAndWait();
+    interruptRequested_ = false;
+}
+
+std::vector<HeavyHitters::Entry> GroupBy::getResults() const
+{
+    QMutexLocker locker( &resultsMutex_ );
+
+    return results_.entries();
+}
+
+qint64 GroupBy::getNbMatchingLines() const
+{
+    QMutexLocker locker( &resultsMutex_ );
+
+    return results_.getTotal();
+}
+
+bool GroupBy::isExact() const
+{
+    QMutexLocker locker( &resultsMutex_ );
+
+    return results_.isExact();
+}
+
+QString GroupBy::displayText( const QString& value )
+{
+    return value.split( valueSeparator ).join( " | " );
+}
+
+// Each capture group (outermost ones, the nested ones being part of
+// their value) is replaced by its value.
+QString GroupBy::filterPattern( const QString& pattern, const QString& value )
+{
+    const QStringList values = value.split( valueSeparator );
+    const QRegularExpression regexp( pattern );
+    if ( regexp.captureCount() == 0 )
+        return QRegularExpression::escape( value );
+
+    QString filter;
+    int group = 0;
+    int i = 0;
+    while ( i < pattern.size() ) {
+        const QChar c = pattern[i];
+        if ( c == '\\' ) {
+            filter += pattern.mid( i, 2 );
+            i += 2;
+        }
+        else if ( c == '[' ) {
+            const int end = skipClass( pattern, i );
+            filter += pattern.mid( i, end - i );
+            i = end;
+        }
+        else if ( c == '(' && isCapturing( pattern, i ) ) {
+            // Find the end of the group, counting the groups it contains
+            int depth = 0;
+            int nb_groups = 0;
+            int j = i;
+            while ( j < pattern.size() ) {
+                if ( pattern[j] == '\\' ) {
+                    j += 2;
+                    continue;
+                }
+                else if ( pattern[j] == '[' ) {
+                    j = skipClass( pattern, j );
+                    continue;
+                }
+                else if ( pattern[j] == '(' ) {
+                    ++depth;
+                    if ( isCapturing( pattern, j ) )
+                        ++nb_groups;
+                }
+                else if ( pattern[j] == ')' && --depth == 0 ) {
+                    break;
+                }
+                ++j;
+            }
+
+            filter += '(' + QRegularExpression::escape( values.value( group ) ) + ')';
+            group += nb_groups;
+            i = j + 1;
+        }
+        else {
+            filter += c;
+            ++i;
+        }
+    }
+
+    return filter;
+}
+
+//
+// Private functions
+//
+
+void GroupBy::doStart( const std::shared_ptr<const AbstractLogSource>& source,
+        const QRegularExpression& regexp )
+{
+    LOG(logDEBUG) << "GroupBy::start on " << nbItems_ << " lines";
+
+    source_         = source;
+    regexp_         = regexp;
+    nbParts_        = ( nbItems_ + nbLinesInPart - 1 ) / nbLinesInPart;
+    nextPart_       = 0;
+    nbItemsCounted_ = 0;
+    finished_       = false;
+    {
+        QMutexLocker locker( &resultsMutex_ );
+        results_ = HeavyHitters( capacity_ );
+    }
+
+    if ( nbParts_ == 0 ) {
+        finished_ = true;
+        emit finished();
+        return;
+    }
+
+    // The last task to finish signals the end
+    tasks_.submit( qMin( TaskScheduler::instance().nbThreads(), nbParts_ ),
+            [this] { countParts(); },
+            [this] {
+                if ( interruptRequested_ )
+                    return;
+                LOG(logDEBUG) << "GroupBy: all lines counted";
+                finished_ = true;
+                emit finished();
+            } );
+}
+
+void GroupBy::countParts()
+{
+    HeavyHitters values( capacity_ );
+
+    int part;
+    while ( ( part = nextPart_++ ) < nbParts_ && ! interruptRequested_ ) {
+        const qint64 begin = part * nbLinesInPart;
+        const qint64 end = qMin( begin + nbLinesInPart, nbItems_ );
+
+        qint64 i = begin;
+        while ( i < end && ! interruptRequested_ ) {
+            if ( allLines_ ) {
+                const int nb_lines = qMin<qint64>( nbLinesInChunk, end - i );
+                countLines( source_->getLines( i, nb_lines ), &values );
+                i += nb_lines;
+            }
+            else {
+                // The consecutive lines are read together
+                qint64 j = i + 1;
+                while ( j < end && j - i < nbLinesInChunk && lines_[j] == lines_[j - 1] + 1 )
+                    ++j;
+                countLines( source_->getLines( lines_[i], j - i ), &values );
+                i = j;
+            }
+        }
+
+        const qint64 nb_counted = nbItemsCounted_ += end - begin;
+        emit progressed( static_cast<int>( nb_counted * 100 / nbItems_ ) );
+    }
+
+    QMutexLocker locker( &resultsMutex_ );
+    results_.merge( values );
+}
+
+void GroupBy::countLines( const QStringList& lines, HeavyHitters* values ) const
+{
+    const int nb_groups = regexp_.captureCount();
+
+    for ( const auto& line: lines ) {
+        const QRegularExpressionMatch match = regexp_.match( line );
+        if ( ! match.hasMatch() )
+            continue;
+
+        if ( nb_groups <= 1 ) {
+            values->add( match.captured( nb_groups ) );
+        }
+        else {
+            QString value = match.captured( 1 );
+            for ( int group = 2; group <= nb_groups; ++group )
+                value += valueSeparator + match.captured( group );
+            values->add( value );
+        }
+    }
+}
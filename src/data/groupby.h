@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef GROUPBY_H
+#define GROUPBY_H
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QRegularExpression>
+
+#include "taskscheduler.h"
+
+class AbstractLogSource;
+
+// Space-saving summary of the most frequent values of a stream
+// (Metwally et al.): at most capacity values are counted, a new value
+// replacing the least frequent one and taking its count (which becomes
+// the possible error on its own count). Any value seen more than
+// total / capacity times is always in the summary.
+class HeavyHitters {
+  public:
+    struct Entry {
+        QString value;
+        qint64 count;
+        // The count might be overestimated by up to error
+        qint64 error;
+    };
+
+    explicit HeavyHitters( int capacity );
+
+    void add( const QString& value );
+    // Merge a summary of another part of the stream (the result being
+    // as accurate as a summary of both parts).
+    void merge( const HeavyHitters& other );
+
+    // Returns the values counted, the most frequent first
+    std::vector<Entry> entries() const;
+    // Returns the number of values added
+    qint64 getTotal() const { return total_; }
+    // Returns whether the counts are exact (no value has been replaced)
+    bool isExact() const { return exact_; }
+
+  private:
+    struct Counter {
+        qint64 count;
+        qint64 error;
+    };
+
+    // Count a value not seen yet would have (0 until the summary is full)
+    qint64 minCount() const;
+    void insert( const QString& value, const Counter& counter );
+
+    int capacity_;
+    qint64 total_;
+    bool exact_;
+    QHash<QString, Counter> counters_;
+    // The values ordered by count, to find the least frequent one
+    std::set<std::pair<qint64, QString>> byCount_;
+};
+
+// Counts the values of the capture groups of a regexp in the lines
+// of a source (all of them or a set of lines, e.g. the matches of the
+// current search). The lines are split in parts counted in parallel
+// by tasks on the TaskScheduler, each one keeping its own HeavyHitters,
+// merged when the task ends.
+// When a regexp has several capture groups, the value counted is
+// made of all of them.
+class GroupBy : public QObject
+{
+  Q_OBJECT
+
+  public:
+    // At most capacity values are counted
+    explicit GroupBy( int capacity = 1000 );
+    ~GroupBy();
+
+    // Count the values in all the lines of source, the count in
+    // progress (if any) is interrupted.
+    void start( const std::shared_ptr<const AbstractLogSource>& source,
+            const QRegularExpression& regexp );
+    // Same for the passed lines only (in increasing order)
+    void start( const std::shared_ptr<const AbstractLogSource>& source,
+            const QRegularExpression& regexp, std::vector<qint64> lines );
+    // Interrupts the count if one is in progress and wait for
+    // the interruption to be done.
+    void interrupt();
+
+    // Returns the values counted, the most frequent first (to be called
+    // once finished has been received).
+    std::vector<HeavyHitters::Entry> getResults() const;
+    // Returns the number of lines matching the regexp
+    qint64 getNbMatchingLines() const;
+    // Returns whether the counts are exact
+    bool isExact() const;
+    // Returns whether all the lines have been counted
+    bool isFinished() const { return finished_; }
+
+    // Returns the text to display for a value counted
+    static QString displayText( const QString& value );
+    // Returns the pattern matching the lines where the capture groups
+    // of pattern have the passed value.
+    static QString filterPattern( const QString& pattern, const QString& value );
+
+  signals:
+    // Sent (from the tasks) when some lines have been counted
+    void progressed( int percent );
+    // Sent when all the lines have been counted (not sent if the
+    // count is interrupted)
+    void finished();
+
+  private:
+    void doStart( const std::shared_ptr<const AbstractLogSource>& source,
+            const QRegularExpression& regexp );
+
+    // Run by the tasks, count the parts not taken by another task
+    void countParts();
+    void countLines( const QStringList& lines, HeavyHitters* values ) const;
+
+    const int capacity_;
+
+    std::shared_ptr<const AbstractLogSource> source_;
+    QRegularExpression regexp_;
+    // The lines counted if not all of them
+    std::vector<qint64> lines_;
+    bool allLines_;
+
+    // Number of lines (or elements of lines_) to count
+    qint64 nbItems_;
+    int nbParts_;
+    std::atomic<bool> interruptRequested_;
+    std::atomic<int> nextPart_;
+    std::atomic<qint64> nbItemsCounted_;
+    std::atomic<bool> finished_;
+
+    // Tasks of the current count
+    TaskGroup tasks_;
+
+    // Merged summaries of the tasks
+    mutable QMutex resultsMutex_;
+    HeavyHitters results_;
+};
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements InputSpooler, copying a stream to a file
+// that can be indexed.
+
+#include "inputspooler.h"
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#include <QDir>
+#include <QFileInfo>
+
+#include "log.h"
+
+namespace {
+    // Size of the reads from the input
+    const size_t READ_SIZE = 64 * 1024;
+    // How often the thread checks it has to terminate when
+    // the input is idle
+    const int POLL_TIMEOUT_MS = 100;
+}
+
+InputSpooler::InputSpooler( const QString& input, qint64 max_size )
+    : input_( input ), maxSize_( max_size ),
+    spool_( QDir::tempPath() + "/glogg_"
+            + ( input == "-" ? QString( "stdin" ) : QFileInfo( input ).fileName() )
+            + "_XXXXXX.log" ),
+    spoolFile_( nullptr ), terminate_( false ),
+    bytesSpooled_( 0 ), bytesDropped_( 0 ), ended_( false )
+{
+    // The file is reserved by QTemporaryFile (and removed by it),
+    // but written with stdio from the reading thread.
+    if ( spool_.open() ) {
+        spool_.close();
+        spoolFile_ = std::fopen( QFile::encodeName( spool_.fileName() ).constData(), "ab" );
+    }
+
+    if ( ! spoolFile_ )
+        LOG(logERROR) << "InputSpooler: cannot create the spool for "
+            << input_.toStdString();
+    else
+        LOG(logDEBUG) << "InputSpooler: spooling " << input_.toStdString()
+            << " to " << spool_.fileName().toStdString();
+}
+
+InputSpooler::~InputSpooler()
+{
+    terminate_ = true;
+
+    if ( thread_.joinable() ) {
+#ifdef _WIN32
+        // The thread might be blocked in a read that cannot be
+        // interrupted, it is left behind (we are exiting anyway).
+        if ( ! ended_ ) {
+            thread_.detach();
+            return;
+        }
+#endif
+        thread_.join();
+    }
+
+    if ( spoolFile_ )
+        std::fclose( spoolFile_ );
+}
+
+bool InputSpooler::isStream( const QString& name )
+{
+    if ( name == "-" )
+        return true;
+
+#ifdef _WIN32
+    return false;
+#else
+    struct stat file_stat;
+    return ::stat( QFile::encodeName( name ).constData(), &file_stat ) == 0
+        && S_ISFIFO( file_stat.st_mode );
+#endif
+}
+
+void InputSpooler::start()
+{
+    if ( spoolFile_ )
+        thread_ = std::thread( &InputSpooler::run, this );
+    else
+        ended_ = true;
+}
+
+void InputSpooler::waitForEnd()
+{
+    std::unique_lock<std::mutex> lock( endMutex_ );
+    endCond_.wait( lock, [this] { return ended_.load(); } );
+}
+
+QString InputSpooler::spoolFileName() const
+{
+    return spool_.fileName();
+}
+
+void InputSpooler::run()
+{
+    int fd;
+    if ( input_ == "-" ) {
+        fd = 0;
+#ifdef _WIN32
+        _setmode( fd, _O_BINARY );
+#endif
+    }
+    else {
+#ifdef _WIN32
+        fd = ::open( QFile::encodeName( input_ ).constData(), O_RDONLY );
+#else
+        // A blocking open would wait for a writer, and could not be
+        // terminated. The pipe stays non-blocking, the poll below
+        // waits for the data (and only reports the end once a writer
+        // has come and gone).
+        fd = ::open( QFile::encodeName( input_ ).constData(), O_RDONLY | O_NONBLOCK );
+#endif
+    }
+
+    if ( fd < 0 )
+        LOG(logERROR) << "InputSpooler: cannot open " << input_.toStdString()
+            << ": " << std::strerror( errno );
+
+    std::vector<char> buffer( READ_SIZE );
+    while ( fd >= 0 && ! terminate_ ) {
+#ifndef _WIN32
+        pollfd poll_fd = { fd, POLLIN, 0 };
+        const int ready = ::poll( &poll_fd, 1, POLL_TIMEOUT_MS );
+        if ( ready == 0 || ( ready < 0 && errno == EINTR ) )
+            continue;
+#endif
+
+        const auto nb_read = ::read( fd, buffer.data(), buffer.size() );
+        if ( nb_read == 0 )
+            break;
+        else if ( nb_read < 0 ) {
+            if ( errno == EINTR || errno == EAGAIN )
+                continue;
+            LOG(logERROR) << "InputSpooler: error reading " << input_.toStdString()
+                << ": " << std::strerror( errno );
+            break;
+        }
+
+        // Once something has been dropped, everything after is, a smaller
+        // read fitting in the spool would be spliced after the gap.
+        if ( bytesDropped_ > 0
+                || ( maxSize_ > 0 && bytesSpooled_ + nb_read > maxSize_ ) ) {
+            if ( bytesDropped_ == 0 )
+                LOG(logWARNING) << "InputSpooler: the spool of " << input_.toStdString()
+                    << " is full, the rest of the input is dropped";
+            bytesDropped_ += nb_read;
+            continue;
+        }
+
+        // Flushed straight away for the watcher to see the new data
+        if ( std::fwrite( buffer.data(), 1, nb_read, spoolFile_ )
+                != static_cast<size_t>( nb_read )
+                || std::fflush( spoolFile_ ) != 0 ) {
+            LOG(logERROR) << "InputSpooler: error writing the spool: "
+                << std::strerror( errno );
+            break;
+        }
+        bytesSpooled_ += nb_read;
+    }
+
+    if ( fd > 0 )
+        ::close( fd );
+
+    LOG(logDEBUG) << "InputSpooler: end of " << input_.toStdString() << ", "
+        << bytesSpooled_ << " bytes spooled";
+
+    {
+        std::lock_guard<std::mutex> lock( endMutex_ );
+        ended_ = true;
+    }
+    endCond_.notify_all();
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INPUTSPOOLER_H
+#define INPUTSPOOLER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#include <QString>
+#include <QTemporaryFile>
+
+// Copies a stream that cannot be seeked (the standard input or a named
+// pipe) to a temporary file, on a thread of its own, as the data arrives.
+// The temporary file (the spool) is then opened as any other log: it is
+// indexed as it grows and can be followed and searched.
+// The spool is append-only and stops growing when it reaches its maximum
+// size, the rest of the input is then read and dropped so the producer
+// is not blocked.
+// The spool is removed when the InputSpooler is destroyed.
+class InputSpooler {
+  public:
+    // Spools input ("-" for the standard input or the path of a named
+    // pipe), up to max_size bytes (0 for no limit).
+    InputSpooler( const QString& input, qint64 max_size );
+    // Stop reading the input and remove the spool.
+    ~InputSpooler();
+
+    // No copy/assignment please
+    InputSpooler( const InputSpooler& ) = delete;
+    InputSpooler& operator =( const InputSpooler& ) = delete;
+
+    // Returns whether name must be spooled to be opened
+    // (it is "-" or a named pipe).
+    static bool isStream( const QString& name );
+
+    // Start reading the input.
+    void start();
+    // Wait until the whole input has been read.
+    void waitForEnd();
+
+    // Returns the name of the file the input is copied to.
+    QString spoolFileName() const;
+    // Returns the number of bytes written to the spool so far.
+    qint64 bytesSpooled() const { return bytesSpooled_; }
+    // Returns the number of bytes read and dropped because the spool
+    // had reached its maximum size.
+    qint64 bytesDropped() const { return bytesDropped_; }
+    // Returns whether the end of the input has been reached.
+    bool hasEnded() const { return ended_; }
+
+  private:
+    void run();
+
+    const QString input_;
+    const qint64 maxSize_;
+
+    QTemporaryFile spool_;
+    std::FILE* spoolFile_;
+
+    std::thread thread_;
+    std::atomic<bool> terminate_;
+
+    std::atomic<qint64> bytesSpooled_;
+    std::atomic<qint64> bytesDropped_;
+
+    std::mutex endMutex_;
+    std::condition_variable endCond_;
+    std::atomic<bool> ended_;
+};
+
+#endif
@@ -26,6 +26,12 @@
 
 typedef std::vector<uint64_t> SimpleLinePositionStorage;
 
+// Memory used by each storage (in bytes)
+inline size_t storageSize( const SimpleLinePositionStorage& storage )
+{ return storage.capacity() * sizeof( uint64_t ); }
+inline size_t storageSize( const CompressedLinePositionStorage& storage )
+{ return storage.allocatedSize(); }
+
 // This class is a list of end of lines position,
 // in addition to a list of uint64_t (positions within the files)
 // it can keep track of whether the final LF was added (for non-LF terminated
@@ -61,6 +67,9 @@ class LinePosition
     // Size of the array
     inline int size() const
     { return array.size(); }
+    // Memory used by the positions (in bytes)
+    inline size_t allocatedSize() const
+    { return storageSize( array ); }
     // Extract an element
     inline uint64_t at( int i ) const
     { return array.at( i ); }
@@ -70,6 +79,9 @@ class LinePosition
     // Must be used after 'append'-ing a fake LF at the end.
     void setFakeFinalLF( bool finalLF=true )
     { fakeFinalLF_ = finalLF; }
+    // Whether the final LF is fake
+    bool hasFakeFinalLF() const
+    { return fakeFinalLF_; }
 
     // Add another list to this one, removing any fake LF on this list.
     // Invariant: all pos in other must be greater than any pos in this
@@ -25,7 +25,13 @@
 
 #include <QFileInfo>
 
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
 #include "log.h"
+#include "tracing.h"
 
 #include "logdata.h"
 #include "logfiltereddata.h"
@@ -35,6 +41,32 @@
 #include "qtfilewatcher.h"
 #endif
 
+namespace {
+#ifndef _WIN32
+    // Files are identified by inode, so rotations can be detected
+    const bool FILE_IDENTITY_AVAILABLE = true;
+#else
+    const bool FILE_IDENTITY_AVAILABLE = false;
+#endif
+
+    // Returns whether the name now designates another file than the
+    // open one (e.g. it has been rotated), false if it is the same or
+    // if we cannot tell.
+    bool hasBeenReplaced( const QFile& file, const QString& name );
+
+    // Returns whether the open file has no name left (e.g. another file
+    // has been renamed over it), false if we cannot tell.
+    bool isUnlinked( const QFile& file );
+
+    // Append to bytes the part of [pos, end_byte) found in the segment of
+    // the concatenation [segment_start, segment_end) read from file, the
+    // gap before the segment (if any) is filled with LFs.
+    // Returns the new position.
+    qint64 readFromSegment( QByteArray* bytes, QFile* file,
+            qint64 segment_start, qint64 segment_end,
+            qint64 pos, qint64 end_byte );
+};
+
 // Implementation of the 'start' functions for each operation
 
 void LogData::AttachOperation::doStart(
@@ -56,7 +88,28 @@ void LogData::PartialIndexOperation::doStart(
         LogDataWorkerThread& workerThread ) const
 {
     LOG(logDEBUG) << "Reindexing (partial)";
-    workerThread.indexAdditionalLines();
+    workerThread.indexAdditionalLines( reopenFile_ );
+}
+
+void LogData::UpdateIndexOperation::doStart(
+        LogDataWorkerThread& workerThread ) const
+{
+    LOG(logDEBUG) << "Checking the file for changes";
+    workerThread.indexChanges( reopenFile_ );
+}
+
+void LogData::RewriteIndexOperation::doStart(
+        LogDataWorkerThread& workerThread ) const
+{
+    LOG(logDEBUG) << "Reindexing (rewritten from " << rewrittenFrom_ << ")";
+    workerThread.indexRewrittenLines( rewrittenFrom_ );
+}
+
+void LogData::RotationIndexOperation::doStart(
+        LogDataWorkerThread& workerThread ) const
+{
+    LOG(logDEBUG) << "Reindexing (rotation)";
+    workerThread.indexRotatedFile( rotatedFileEnd_, newFileOffset_, droppedEnd_ );
 }
 
 
@@ -86,9 +139,6 @@ LogData::LogData() : AbstractLogData(), indexing_data_(),
             this, SIGNAL( loadingProgressed( int ) ) );
     connect( &workerThread_, SIGNAL( indexingFinished( LoadingStatus ) ),
             this, SLOT( indexingFinished( LoadingStatus ) ) );
-
-    // Starts the worker thread
-    workerThread_.start();
 }
 
 LogData::~LogData()
@@ -121,44 +171,60 @@ void LogData::attachFile( const QString& fileName )
     enqueueOperation( std::move( operation ) );
 }
 
-void LogData::interruptLoading()
+void LogData::setMaxRotatedFiles( int max_files )
+{
+    maxRotatedFiles_ = qMax( 0, max_files );
+}
+
+LogData::NotificationStatistics LogData::getNotificationStatistics() const
+{
+    return notificationStatistics_;
+}
+
+void LogData::doInterruptLoading()
 {
     workerThread_.interrupt();
 }
 
-qint64 LogData::getFileSize() const
+qint64 LogData::doGetFileSize() const
 {
-    return indexing_data_.getSize();
+    return indexing_data_.getSize() - indexing_data_.getFirstPosition();
 }
 
-QDateTime LogData::getLastModifiedDate() const
+QDateTime LogData::doGetLastModifiedDate() const
 {
     return lastModifiedDate_;
 }
 
 // Return an initialised LogFilteredData. The search is not started.
-LogFilteredData* LogData::getNewFilteredData() const
+LogFilteredData* LogData::doGetNewFilteredData() const
 {
     LogFilteredData* newFilteredData = new LogFilteredData( this );
 
     return newFilteredData;
 }
 
-void LogData::reload()
+void LogData::doReload()
 {
     workerThread_.interrupt();
 
     // Re-open the file, useful in case the file has been moved
     reOpenFile();
+    forgetRotatedFiles();
 
     enqueueOperation( std::make_shared<FullIndexOperation>() );
 }
 
-void LogData::setPollingInterval( uint32_t interval_ms )
+void LogData::doSetPollingInterval( uint32_t interval_ms )
 {
     fileWatcher_->setPollingInterval( interval_ms );
 }
 
+void LogData::doSetForeground( bool foreground )
+{
+    workerThread_.setForeground( foreground );
+}
+
 //
 // Private functions
 //
@@ -199,16 +265,53 @@ void LogData::startOperation()
 //
 
 void LogData::fileChangedOnDisk()
+{
+    ++notificationStatistics_.received;
+
+    if ( ! checkFileChanges() )
+        ++notificationStatistics_.coalesced;
+}
+
+bool LogData::checkFileChanges()
 {
     const QString name = attached_file_->fileName();
 
     LOG(logDEBUG) << "signalFileChanged: " << name.toStdString();
 
     QFileInfo info( name );
-    qint64 file_size = indexing_data_.getSize();
-    LOG(logDEBUG) << "current indexed fileSize=" << file_size;
     LOG(logDEBUG) << "info file_->size()=" << info.size();
     LOG(logDEBUG) << "attached_file_->size()=" << attached_file_->size();
+
+    // The file has been moved away (or deleted), we keep displaying
+    // what we have until a new file is created with the same name.
+    if ( FILE_IDENTITY_AVAILABLE && attached_file_->isOpen() && ! info.exists() ) {
+        LOG(logINFO) << "File moved or deleted, waiting for it to reappear";
+        return false;
+    }
+
+    // If the name is now a different inode, the file has been rotated
+    // (moved away and a new one created): the new file is displayed
+    // after the old one and only its content is indexed.
+    if ( attached_file_->isOpen() && info.exists()
+            && hasBeenReplaced( *attached_file_, name ) ) {
+        // Unless the old file is gone, as when a file is atomically
+        // replaced (written aside and renamed over the name): the new
+        // one is not a continuation and is indexed on its own.
+        if ( isUnlinked( *attached_file_ ) || maxRotatedFiles_ == 0 ) {
+            LOG(logINFO) << "File replaced, reindexing the new file";
+            reOpenFile();
+            return indexChange( FileFingerprint::Change::Replaced, 0, true );
+        }
+
+        LOG(logINFO) << "File rotated, following the new file";
+        // The line numbers change if the oldest lines are dropped
+        fileChangedOnDisk_ = followRotatedFile() ? Truncated : DataAdded;
+        lastModifiedDate_ = info.lastModified();
+
+        emit fileChanged( fileChangedOnDisk_ );
+        return true;
+    }
+
     // In absence of any clearer information, we use the following size comparison
     // to determine whether we are following the same file or not (i.e. the file
     // has been moved and the inode we are following is now under a new name, if for
@@ -216,10 +319,12 @@ void LogData::fileChangedOnDisk()
     // the file to ensure we are reading the right one.
     // This is a crude heuristic but necessary for notification services that do not
     // give details (e.g. kqueues)
+    bool reopened = false;
     if ( ( info.size() != attached_file_->size() )
             || ( attached_file_->openMode() == QIODevice::NotOpen ) ) {
         LOG(logINFO) << "Inconsistent size, the file might have changed, re-opening";
         reOpenFile();
+        reopened = true;
 
         // We don't force a (slow) full reindex as this routinely happens if
         // the file is appended quickly.
@@ -228,29 +333,60 @@ void LogData::fileChangedOnDisk()
         // and with a size greater than the old one (should be rare in practice).
     }
 
+    if ( ! currentOperation_ ) {
+        // Comparing the file with its fingerprint means reading it, this
+        // is left to the worker, which indexes the appended data straight
+        // away if that is what it finds.
+        lastModifiedDate_ = info.lastModified();
+        enqueueOperation( std::make_shared<UpdateIndexOperation>( reopened ) );
+        return true;
+    }
+
+    return indexChange( detectSizeChange(), 0, reopened );
+}
+
+// Start the operation handling the change found in the attached file,
+// returns false if there is nothing to do.
+bool LogData::indexChange( FileFingerprint::Change change,
+        qint64 changed_from, bool reopened )
+{
     std::shared_ptr<LogDataOperation> newOperation;
 
-    qint64 real_file_size = attached_file_->size();
-    if ( real_file_size < file_size ) {
-        fileChangedOnDisk_ = Truncated;
-        LOG(logINFO) << "File truncated";
-        newOperation = std::make_shared<FullIndexOperation>();
-    }
-    else if ( real_file_size == file_size ) {
-        LOG(logINFO) << "No change in file";
-    }
-    else if ( fileChangedOnDisk_ != DataAdded ) {
-        fileChangedOnDisk_ = DataAdded;
-        LOG(logINFO) << "New data on disk";
-        newOperation = std::make_shared<PartialIndexOperation>();
+    switch ( change ) {
+        case FileFingerprint::Change::Replaced:
+            fileChangedOnDisk_ = Truncated;
+            LOG(logINFO) << "File truncated";
+            forgetRotatedFiles();
+            newOperation = std::make_shared<FullIndexOperation>();
+            break;
+        case FileFingerprint::Change::Rewritten:
+            fileChangedOnDisk_ = Rewritten;
+            LOG(logINFO) << "File rewritten from " << changed_from;
+            newOperation = std::make_shared<RewriteIndexOperation>( changed_from );
+            break;
+        case FileFingerprint::Change::None:
+            LOG(logINFO) << "No change in file";
+            break;
+        case FileFingerprint::Change::Appended:
+            // A check in progress indexes what was appended, and what
+            // comes after is picked up when it finishes.
+            if ( fileChangedOnDisk_ != DataAdded && ! std::dynamic_pointer_cast<
+                        const UpdateIndexOperation>( currentOperation_ ) ) {
+                fileChangedOnDisk_ = DataAdded;
+                LOG(logINFO) << "New data on disk";
+                newOperation = std::make_shared<PartialIndexOperation>( reopened );
+            }
+            break;
     }
 
     if ( newOperation ) {
         enqueueOperation( newOperation );
-        lastModifiedDate_ = info.lastModified();
+        lastModifiedDate_ = QFileInfo( attached_file_->fileName() ).lastModified();
 
         emit fileChanged( fileChangedOnDisk_ );
     }
+
+    return newOperation != nullptr;
 }
 
 void LogData::indexingFinished( LoadingStatus status )
@@ -259,11 +395,53 @@ void LogData::indexingFinished( LoadingStatus status )
         ( status == LoadingStatus::Successful ) <<
         ", found " << indexing_data_.getNbLines() << " lines.";
 
+    // The worker has compared the file with its fingerprint, only
+    // appended data have been indexed, the other changes need
+    // another operation.
+    bool data_indexed = true;
+    if ( status == LoadingStatus::Successful
+            && std::dynamic_pointer_cast<const UpdateIndexOperation>( currentOperation_ ) ) {
+        qint64 changed_from = 0;
+        const auto change = indexing_data_.getLastChange( &changed_from );
+
+        if ( change == FileFingerprint::Change::Appended ) {
+            fileChangedOnDisk_ = DataAdded;
+            emit fileChanged( fileChangedOnDisk_ );
+        }
+        else {
+            data_indexed = false;
+            // An operation queued meanwhile (other than an append, which
+            // the one for this change covers) takes precedence.
+            if ( ! nextOperation_ || std::dynamic_pointer_cast<
+                        const PartialIndexOperation>( nextOperation_ ) )
+                indexChange( change, changed_from, false );
+        }
+    }
+
+    if ( status == LoadingStatus::Successful && fileChangedOnDisk_ == DataAdded
+            && lastModifiedDate_.isValid() ) {
+        lastIndexingLatency_ =
+            lastModifiedDate_.msecsTo( QDateTime::currentDateTime() );
+        LOG(logDEBUG) << "Appended data indexed " << lastIndexingLatency_
+            << " ms after the file was modified";
+    }
+
+    // A rotation (even interrupted) might have dropped the oldest lines
+    closeDroppedFiles();
+
     if ( status == LoadingStatus::Successful ) {
+        utf16_index_ = EncodingSpeculator::isUtf16( indexing_data_.getEncodingGuess() );
+
         // Start watching we watch the file for updates
         fileChangedOnDisk_ = Unchanged;
         fileWatcher_->addFile( attached_file_->fileName() );
 
+        if ( ! followedTimer_.isValid()
+                || indexing_data_.getSize() < followedFromSize_ ) {
+            followedTimer_.start();
+            followedFromSize_ = indexing_data_.getSize();
+        }
+
         // Update the modified date/time if the file exists
         lastModifiedDate_ = QDateTime();
         QFileInfo fileInfo( *attached_file_ );
@@ -271,12 +449,12 @@ void LogData::indexingFinished( LoadingStatus status )
             lastModifiedDate_ = fileInfo.lastModified();
     }
 
-    // FIXME be cleverer here as a notification might have arrived whilst we
-    // were indexing.
     fileChangedOnDisk_ = Unchanged;
 
-    LOG(logDEBUG) << "Sending indexingFinished.";
-    emit loadingFinished( status );
+    if ( data_indexed ) {
+        LOG(logDEBUG) << "Sending indexingFinished.";
+        emit loadingFinished( status );
+    }
 
     // So now the operation is done, let's see if there is something
     // else to do, in which case, do it!
@@ -289,6 +467,15 @@ void LogData::indexingFinished( LoadingStatus status )
         LOG(logDEBUG) << "indexingFinished is performing the next operation";
         startOperation();
     }
+    else if ( status == LoadingStatus::Successful
+            && attached_file_offset_ + attached_file_->size()
+                > indexing_data_.getSize() ) {
+        // Notifications received whilst we were indexing have been
+        // ignored, the data written since the operation started
+        // have to be indexed now.
+        LOG(logDEBUG) << "indexingFinished: more data have been appended";
+        checkFileChanges();
+    }
 }
 
 //
@@ -392,13 +579,10 @@ QString LogData::doGetLineString( qint64 line ) const
     fileMutex_.lock();
 
     // end_byte is non-inclusive.(is not read)
-    const qint64 first_byte = (line == 0) ?
-        0 : ( indexing_data_.getPosForLine( line-1 ) + after_cr_offset_ );
+    const qint64 first_byte = beginningOfLine( line );
     const qint64 end_byte  = endOfLinePosition( line );
 
-    attached_file_->seek( first_byte );
-
-    QString string = codec_->toUnicode( attached_file_->read( end_byte - first_byte ) );
+    QString string = codec_->toUnicode( readBytes( first_byte, end_byte ) );
 
     fileMutex_.unlock();
 
@@ -412,14 +596,11 @@ QString LogData::doGetExpandedLineString( qint64 line ) const
     fileMutex_.lock();
 
     // end_byte is non-inclusive.(is not read) We also exclude the final \r.
-    const qint64 first_byte = (line == 0) ?
-        0 : ( indexing_data_.getPosForLine( line-1 ) + after_cr_offset_ );
+    const qint64 first_byte = beginningOfLine( line );
     const qint64 end_byte  = endOfLinePosition( line );
 
-    attached_file_->seek( first_byte );
-
     // LOG(logDEBUG) << "LogData::doGetExpandedLineString first_byte:" << first_byte << " end_byte:" << end_byte;
-    QByteArray rawString = attached_file_->read( end_byte - first_byte );
+    QByteArray rawString = readBytes( first_byte, end_byte );
 
     fileMutex_.unlock();
 
@@ -435,6 +616,8 @@ QString LogData::doGetExpandedLineString( qint64 line ) const
 // indexingFinished).
 QStringList LogData::doGetLines( qint64 first_line, int number ) const
 {
+    TRACE_SPAN( "data", "LogData::getLines", number );
+
     QStringList list;
     const qint64 last_line = first_line + number - 1;
 
@@ -449,14 +632,15 @@ QStringList LogData::doGetLines( qint64 first_line, int number ) const
         return QStringList(); /* exception? */
     }
 
-    fileMutex_.lock();
+    {
+        TRACE_SPAN( "lock", "LogData::fileMutex_" );
+        fileMutex_.lock();
+    }
 
-    const qint64 first_byte = (first_line == 0) ?
-        0 : ( indexing_data_.getPosForLine( first_line-1 ) + after_cr_offset_ );
+    const qint64 first_byte = beginningOfLine( first_line );
     const qint64 end_byte  = endOfLinePosition( last_line );
     // LOG(logDEBUG) << "LogData::doGetLines first_byte:" << first_byte << " end_byte:" << end_byte;
-    attached_file_->seek( first_byte );
-    QByteArray blob = attached_file_->read( end_byte - first_byte );
+    QByteArray blob = readBytes( first_byte, end_byte );
 
     fileMutex_.unlock();
 
@@ -476,6 +660,8 @@ QStringList LogData::doGetLines( qint64 first_line, int number ) const
 
 QStringList LogData::doGetExpandedLines( qint64 first_line, int number ) const
 {
+    TRACE_SPAN( "data", "LogData::getLines", number );
+
     QStringList list;
     const qint64 last_line = first_line + number - 1;
 
@@ -488,16 +674,17 @@ QStringList LogData::doGetExpandedLines( qint64 first_line, int number ) const
         return QStringList(); /* exception? */
     }
 
-    fileMutex_.lock();
+    {
+        TRACE_SPAN( "lock", "LogData::fileMutex_" );
+        fileMutex_.lock();
+    }
 
     // end_byte is non-inclusive.(is not read)
-    const qint64 first_byte = (first_line == 0) ?
-        0 : ( indexing_data_.getPosForLine( first_line-1 ) + after_cr_offset_ );
+    const qint64 first_byte = beginningOfLine( first_line );
     const qint64 end_byte  = endOfLinePosition( last_line );
     LOG(logDEBUG) << "LogData::doGetExpandedLines first_byte:" << first_byte << " end_byte:" << end_byte;
 
-    attached_file_->seek( first_byte );
-    QByteArray blob = attached_file_->read( end_byte - first_byte );
+    QByteArray blob = readBytes( first_byte, end_byte );
 
     fileMutex_.unlock();
 
@@ -518,11 +705,38 @@ QStringList LogData::doGetExpandedLines( qint64 first_line, int number ) const
     return list;
 }
 
-EncodingSpeculator::Encoding LogData::getDetectedEncoding() const
+EncodingSpeculator::Encoding LogData::doGetDetectedEncoding() const
 {
     return indexing_data_.getEncodingGuess();
 }
 
+StructuredFormat LogData::doGetStructuredFormat() const
+{
+    return indexing_data_.getStructuredFormat();
+}
+
+qint64 LogData::doGetLastIndexingLatency() const
+{
+    return lastIndexingLatency_;
+}
+
+LogData::IndexingStatistics LogData::doGetIndexingStatistics() const
+{
+    IndexingStatistics statistics;
+
+    statistics.indexMemory = indexing_data_.getAllocatedSize();
+    indexing_data_.getLastIndexing( &statistics.lastIndexingBytes,
+            &statistics.lastIndexingDuration );
+
+    if ( followedTimer_.isValid() ) {
+        statistics.bytesAppended = qMax( 0LL,
+                indexing_data_.getSize() - followedFromSize_ );
+        statistics.followedDuration = followedTimer_.elapsed();
+    }
+
+    return statistics;
+}
+
 // Given a line number, returns the position (offset in file) of
 // the byte immediately past its end.
 // e.g. in utf-16: T e s t \n2 n d l i n e \n
@@ -531,14 +745,36 @@ EncodingSpeculator::Encoding LogData::getDetectedEncoding() const
 //                   endOfLinePosition( 0 )
 qint64 LogData::endOfLinePosition( qint64 line ) const
 {
+    // A UTF-16 index already stores the position past the line feed
+    if ( utf16_index_ )
+        return indexing_data_.getPosForLine( line ) - 2;
+
     return indexing_data_.getPosForLine( line ) - 1 - before_cr_offset_;
 }
 
+// Given a line number, returns the position (offset in file) of its
+// first byte.
+qint64 LogData::beginningOfLine( qint64 line ) const
+{
+    if ( line == 0 ) {
+        // Past the rotated files dropped (if any)
+        const qint64 first = indexing_data_.getFirstPosition();
+        return ( first == 0 || utf16_index_ ) ? first : first + after_cr_offset_;
+    }
+    else if ( utf16_index_ )
+        return indexing_data_.getPosForLine( line - 1 );
+    else
+        return indexing_data_.getPosForLine( line - 1 ) + after_cr_offset_;
+}
+
 // Given the position (offset in file) of the end of a line, returns
 // the position of the beginning of the following, taking into account
 // encoding and newline signalling.
 qint64 LogData::beginningOfNextLine( qint64 end_pos ) const
 {
+    if ( utf16_index_ )
+        return end_pos + 2;
+
     return end_pos + 1 + before_cr_offset_ + after_cr_offset_;
 }
 
@@ -552,3 +788,178 @@ void LogData::reOpenFile()
     QMutexLocker locker( &fileMutex_ );
     attached_file_ = std::move( reopened );      // This will close the old one and open the new
 }
+
+// Keep the current file as a rotated file and attach the new file
+// having the same name, the index continues with the new file.
+bool LogData::followRotatedFile()
+{
+    const qint64 rotated_offset = attached_file_offset_;
+    const qint64 rotated_size   = attached_file_->size();
+
+    auto new_file = std::make_unique<QFile>( attached_file_->fileName() );
+    new_file->open( QIODevice::ReadOnly );
+
+    QMutexLocker locker( &fileMutex_ );
+
+    // A non LF terminated file gets a fake LF at the end (one code
+    // unit, as when indexing), the new file starts after it.
+    QByteArray line_feed( "\n" );
+    switch ( indexing_data_.getEncodingGuess() ) {
+        case EncodingSpeculator::Encoding::UTF16LE:
+            line_feed = QByteArray( "\n\0", 2 );
+            break;
+        case EncodingSpeculator::Encoding::UTF16BE:
+            line_feed = QByteArray( "\0\n", 2 );
+            break;
+        default:
+            break;
+    }
+
+    bool final_lf = true;
+    if ( rotated_size >= line_feed.size() ) {
+        attached_file_->seek( rotated_size - line_feed.size() );
+        final_lf = ( attached_file_->read( line_feed.size() ) == line_feed );
+    }
+
+    RotatedFile rotated { rotated_offset, rotated_size, std::move( attached_file_ ) };
+    rotated_files_.push_back( std::move( rotated ) );
+
+    attached_file_ = std::move( new_file );
+    attached_file_offset_ = rotated_offset + rotated_size
+        + ( final_lf ? 0 : line_feed.size() );
+
+    // Beyond the maximum, the lines of the oldest files are dropped,
+    // the files being closed once the worker has done so.
+    qint64 dropped_end = 0;
+    if ( static_cast<int>( rotated_files_.size() ) > maxRotatedFiles_ ) {
+        const auto first_kept = rotated_files_.end() - maxRotatedFiles_;
+        dropped_end = ( first_kept != rotated_files_.end() ) ?
+            first_kept->offset : attached_file_offset_;
+        LOG(logINFO) << "Dropping the lines of the oldest rotated files, up to "
+            << dropped_end;
+    }
+
+    enqueueOperation( std::make_shared<RotationIndexOperation>(
+                rotated_offset + rotated_size, attached_file_offset_, dropped_end ) );
+
+    return dropped_end > 0;
+}
+
+// Used whilst an operation is running: the fingerprint might not be the
+// one of the file being indexed, we can only rely on the sizes.
+FileFingerprint::Change LogData::detectSizeChange() const
+{
+    const qint64 indexed_size = indexing_data_.getSize();
+    const qint64 real_file_size = attached_file_offset_ + attached_file_->size();
+
+    LOG(logDEBUG) << "current indexed fileSize=" << indexed_size;
+
+    if ( real_file_size < indexed_size )
+        return FileFingerprint::Change::Replaced;
+    else if ( real_file_size == indexed_size )
+        return FileFingerprint::Change::None;
+    else
+        return FileFingerprint::Change::Appended;
+}
+
+void LogData::closeDroppedFiles()
+{
+    const qint64 first_position = indexing_data_.getFirstPosition();
+
+    QMutexLocker locker( &fileMutex_ );
+
+    auto dropped = rotated_files_.begin();
+    while ( dropped != rotated_files_.end()
+            && dropped->offset + dropped->size <= first_position )
+        ++dropped;
+    rotated_files_.erase( rotated_files_.begin(), dropped );
+}
+
+// Called before a full reindex, only the attached file will be indexed.
+void LogData::forgetRotatedFiles()
+{
+    QMutexLocker locker( &fileMutex_ );
+
+    rotated_files_.clear();
+    attached_file_offset_ = 0;
+}
+
+QByteArray LogData::readBytes( qint64 first_byte, qint64 end_byte ) const
+{
+    if ( rotated_files_.empty() ) {
+        attached_file_->seek( first_byte );
+        return attached_file_->read( end_byte - first_byte );
+    }
+
+    QByteArray bytes;
+    bytes.reserve( end_byte - first_byte );
+
+    qint64 pos = first_byte;
+    for ( const auto& rotated: rotated_files_ ) {
+        pos = readFromSegment( &bytes, rotated.file.get(),
+                rotated.offset, rotated.offset + rotated.size, pos, end_byte );
+    }
+    readFromSegment( &bytes, attached_file_.get(),
+            attached_file_offset_, end_byte, pos, end_byte );
+
+    return bytes;
+}
+
+namespace {
+    bool hasBeenReplaced( const QFile& file, const QString& name )
+    {
+#ifndef _WIN32
+        struct stat file_stat;
+        struct stat name_stat;
+
+        if ( ( fstat( file.handle(), &file_stat ) == 0 )
+                && ( stat( QFile::encodeName( name ).constData(), &name_stat ) == 0 ) ) {
+            return ( file_stat.st_ino != name_stat.st_ino )
+                || ( file_stat.st_dev != name_stat.st_dev );
+        }
+#else
+        Q_UNUSED( file );
+        Q_UNUSED( name );
+#endif
+
+        return false;
+    }
+
+    bool isUnlinked( const QFile& file )
+    {
+#ifndef _WIN32
+        struct stat file_stat;
+
+        if ( fstat( file.handle(), &file_stat ) == 0 )
+            return ( file_stat.st_nlink == 0 );
+#else
+        Q_UNUSED( file );
+#endif
+
+        return false;
+    }
+
+    qint64 readFromSegment( QByteArray* bytes, QFile* file,
+            qint64 segment_start, qint64 segment_end,
+            qint64 pos, qint64 end_byte )
+    {
+        if ( pos < segment_start && pos < end_byte ) {
+            const qint64 gap_end = qMin( segment_start, end_byte );
+            bytes->append( QByteArray( gap_end - pos, '\n' ) );
+            pos = gap_end;
+        }
+
+        if ( pos < segment_end && pos < end_byte ) {
+            const qint64 read_end = qMin( segment_end, end_byte );
+            file->seek( pos - segment_start );
+            QByteArray data = file->read( read_end - pos );
+            bytes->append( data );
+            // Keep the positions right even if the file has shrunk
+            if ( data.size() < read_end - pos )
+                bytes->append( QByteArray( read_end - pos - data.size(), '\0' ) );
+            pos = read_end;
+        }
+
+        return pos;
+    }
+};
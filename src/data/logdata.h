@@ -21,6 +21,7 @@
 #define LOGDATA_H
 
 #include <memory>
+#include <vector>
 
 #include <QObject>
 #include <QString>
@@ -28,11 +29,12 @@
 #include <QVector>
 #include <QMutex>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QTextCodec>
 
 #include "utils.h"
 
-#include "abstractlogdata.h"
+#include "abstractlogsource.h"
 #include "logdataworkerthread.h"
 #include "filewatcher.h"
 #include "loadingstatus.h"
@@ -44,7 +46,7 @@ class CantReattachErr {};
 
 // Represents a complete set of data to be displayed (ie. a log file content)
 // This class is thread-safe.
-class LogData : public AbstractLogData {
+class LogData : public AbstractLogSource {
   Q_OBJECT
 
   public:
@@ -53,43 +55,28 @@ class LogData : public AbstractLogData {
     // Destroy an object
     ~LogData();
 
-    enum MonitoredFileStatus { Unchanged, DataAdded, Truncated };
-
     // Attaches the LogData to a file on disk
     // It starts the asynchronous indexing and returns (almost) immediately
     // Attaching to a non existant file works and the file is reported
     // to be empty.
     // Reattaching is forbidden and will throw.
     void attachFile( const QString& fileName );
-    // Interrupt the loading and report a null file.
-    // Does nothing if no loading in progress.
-    void interruptLoading();
-    // Creates a new filtered data.
-    // ownership is passed to the caller
-    LogFilteredData* getNewFilteredData() const;
-    // Returns the size if the file in bytes
-    qint64 getFileSize() const;
-    // Returns the last modification date for the file.
-    // Null if the file is not on disk.
-    QDateTime getLastModifiedDate() const;
-    // Throw away all the file data and reload/reindex.
-    void reload();
-
-    // Update the polling interval (in ms, 0 means disabled)
-    void setPollingInterval( uint32_t interval_ms );
-
-    // Get the auto-detected encoding for the indexed text.
-    EncodingSpeculator::Encoding getDetectedEncoding() const;
-
-  signals:
-    // Sent during the 'attach' process to signal progress
-    // percent being the percentage of completion.
-    void loadingProgressed( int percent );
-    // Signal the client the file is fully loaded and available.
-    void loadingFinished( LoadingStatus status );
-    // Sent when the file on disk has changed, will be followed
-    // by loadingProgressed if needed and then a loadingFinished.
-    void fileChanged( LogData::MonitoredFileStatus status );
+
+    // Set how many files rotated away are displayed before the
+    // attached one (each keeping a file descriptor open), the lines of
+    // the oldest ones are dropped after that.
+    // With 0, rotations are not followed: the new file is reindexed.
+    void setMaxRotatedFiles( int max_files );
+
+    // Counts of the change notifications received for the file
+    struct NotificationStatistics {
+        // Received from the file watcher
+        uint64_t received = 0;
+        // Received whilst the change was already known (e.g. while the
+        // appended data were being indexed) so no new indexing was needed
+        uint64_t coalesced = 0;
+    };
+    NotificationStatistics getNotificationStatistics() const;
 
   private slots:
     // Consider reloading the file when it changes on disk updated
@@ -140,11 +127,77 @@ class LogData : public AbstractLogData {
     // Indexing part of the current file (from fileSize)
     class PartialIndexOperation : public LogDataOperation {
       public:
-        PartialIndexOperation() : LogDataOperation( QString() ) {}
+        PartialIndexOperation( bool reopenFile = false )
+            : LogDataOperation( QString() ), reopenFile_( reopenFile ) {}
         ~PartialIndexOperation() {};
 
       protected:
         void doStart( LogDataWorkerThread& workerThread ) const;
+
+      private:
+        // The file has been reopened by name, the worker has to do the same
+        bool reopenFile_;
+    };
+
+    // Finding out how the current file has changed, indexing the data
+    // appended if it has just grown
+    class UpdateIndexOperation : public LogDataOperation {
+      public:
+        UpdateIndexOperation( bool reopenFile = false )
+            : LogDataOperation( QString() ), reopenFile_( reopenFile ) {}
+        ~UpdateIndexOperation() {};
+
+      protected:
+        void doStart( LogDataWorkerThread& workerThread ) const;
+
+      private:
+        // The file has been reopened by name, the worker has to do the same
+        bool reopenFile_;
+    };
+
+    // Reindexing the current file from the given position (in the file),
+    // the data before being unchanged
+    class RewriteIndexOperation : public LogDataOperation {
+      public:
+        RewriteIndexOperation( qint64 rewritten_from )
+            : LogDataOperation( QString() ), rewrittenFrom_( rewritten_from ) {}
+        ~RewriteIndexOperation() {};
+
+      protected:
+        void doStart( LogDataWorkerThread& workerThread ) const;
+
+      private:
+        qint64 rewrittenFrom_;
+    };
+
+    // Following the new file after a rotation (the index continues
+    // with the content of the new file)
+    class RotationIndexOperation : public LogDataOperation {
+      public:
+        RotationIndexOperation( qint64 rotated_file_end, qint64 new_file_offset,
+                qint64 dropped_end )
+            : LogDataOperation( QString() ),
+            rotatedFileEnd_( rotated_file_end ),
+            newFileOffset_( new_file_offset ),
+            droppedEnd_( dropped_end ) {}
+        ~RotationIndexOperation() {};
+
+      protected:
+        void doStart( LogDataWorkerThread& workerThread ) const;
+
+      private:
+        qint64 rotatedFileEnd_;
+        qint64 newFileOffset_;
+        qint64 droppedEnd_;
+    };
+
+    // A file that has been rotated away but whose content is still
+    // displayed before the attached file's.
+    struct RotatedFile {
+        // Position of the file in the (virtual) concatenation
+        qint64 offset;
+        qint64 size;
+        std::unique_ptr<QFile> file;
     };
 
     std::shared_ptr<FileWatcher> fileWatcher_;
@@ -160,31 +213,80 @@ class LogData : public AbstractLogData {
     int doGetLineLength( qint64 line ) const override;
     void doSetDisplayEncoding( Encoding encoding ) override;
     void doSetMultibyteEncodingOffsets( int before_cr, int after_cr ) override;
+    void doInterruptLoading() override;
+    LogFilteredData* doGetNewFilteredData() const override;
+    qint64 doGetFileSize() const override;
+    QDateTime doGetLastModifiedDate() const override;
+    void doReload() override;
+    void doSetPollingInterval( uint32_t interval_ms ) override;
+    void doSetForeground( bool foreground ) override;
+    EncodingSpeculator::Encoding doGetDetectedEncoding() const override;
+    StructuredFormat doGetStructuredFormat() const override;
+    qint64 doGetLastIndexingLatency() const override;
+    IndexingStatistics doGetIndexingStatistics() const override;
 
     void enqueueOperation( std::shared_ptr<const LogDataOperation> newOperation );
+    // Check how the file has changed and index it accordingly,
+    // returns false if nothing had to be done.
+    bool checkFileChanges();
     void startOperation();
     void reOpenFile();
+    // Returns whether the lines of the oldest rotated files are dropped
+    bool followRotatedFile();
+    void forgetRotatedFiles();
+    // Close the rotated files whose lines are not indexed anymore
+    void closeDroppedFiles();
+    // Find out how the attached file has changed since it was indexed,
+    // for a rewrite, changed_from is where the new data start in the file.
+    FileFingerprint::Change detectSizeChange() const;
+    bool indexChange( FileFingerprint::Change change,
+            qint64 changed_from, bool reopened );
+
+    // Read the bytes between first_byte and end_byte (non-inclusive),
+    // from the rotated files and the attached one.
+    // Must be called with fileMutex_ held.
+    QByteArray readBytes( qint64 first_byte, qint64 end_byte ) const;
 
     qint64 endOfLinePosition( qint64 line ) const;
+    qint64 beginningOfLine( qint64 line ) const;
     qint64 beginningOfNextLine( qint64 end_pos ) const;
 
     QString indexingFileName_;
     std::unique_ptr<QFile> attached_file_;
+    // Position of the attached file in the index, non zero if
+    // rotated files are displayed before it.
+    qint64 attached_file_offset_ = 0;
+    std::vector<RotatedFile> rotated_files_;
+    int maxRotatedFiles_ = 10;
 
     // Indexing data, read by us, written by the worker thread
     IndexingData indexing_data_;
 
     QDateTime lastModifiedDate_;
+    qint64 lastIndexingLatency_ = -1;
+
+    // Size of the data when first indexed (or when shrunk), to work
+    // out how fast the file grows
+    QElapsedTimer followedTimer_;
+    qint64 followedFromSize_ = 0;
+
+    NotificationStatistics notificationStatistics_;
+
     std::shared_ptr<const LogDataOperation> currentOperation_;
     std::shared_ptr<const LogDataOperation> nextOperation_;
 
     // Codec to decode text
     QTextCodec* codec_;
 
-    // Offset to apply to the newline character
+    // Offset to apply to the newline character (when the index
+    // has been built byte by byte)
     int before_cr_offset_ = 0;
     int after_cr_offset_  = 0;
 
+    // A UTF-16 file (with a BOM) is indexed by code units,
+    // the positions stored are then the beginnings of the lines.
+    bool utf16_index_ = false;
+
     // To protect the file:
     mutable QMutex fileMutex_;
     // (are mutable to allow 'const' function to touch it,
@@ -194,6 +296,4 @@ class LogData : public AbstractLogData {
     LogDataWorkerThread workerThread_;
 };
 
-Q_DECLARE_METATYPE( LogData::MonitoredFileStatus );
-
 #endif
@@ -18,14 +18,23 @@
  */
 
 #include <QFile>
+#include <QElapsedTimer>
 
 #include "log.h"
+#include "tracing.h"
 
 #include "logdata.h"
 #include "logdataworkerthread.h"
+#include "utf16scanner.h"
 
 // Size of the chunk to read (5 MiB)
 const int IndexOperation::sizeChunk = 5*1024*1024;
+const int IndexOperation::nbStructuredDetectionLines = 20;
+
+namespace {
+    // Number of lines in the blocks the longest line is recorded for
+    const int nbLinesInLengthBlock = 4096;
+}
 
 qint64 IndexingData::getSize() const
 {
@@ -34,6 +43,13 @@ qint64 IndexingData::getSize() const
     return indexedSize_;
 }
 
+qint64 IndexingData::getFirstPosition() const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return firstPosition_;
+}
+
 int IndexingData::getMaxLength() const
 {
     QMutexLocker locker( &dataMutex_ );
@@ -62,45 +78,249 @@ EncodingSpeculator::Encoding IndexingData::getEncodingGuess() const
     return encoding_;
 }
 
-void IndexingData::addAll( qint64 size, int length,
+StructuredFormat IndexingData::getStructuredFormat() const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return structuredFormat_;
+}
+
+void IndexingData::setStructuredFormat( StructuredFormat format )
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    structuredFormat_ = format;
+}
+
+FileFingerprint IndexingData::getFingerprint() const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return fingerprint_;
+}
+
+void IndexingData::setFingerprint( const FileFingerprint& fingerprint )
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    fingerprint_ = fingerprint;
+}
+
+FileFingerprint::Change IndexingData::getLastChange( qint64* changedFrom ) const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    *changedFrom = lastChangedFrom_;
+    return lastChange_;
+}
+
+void IndexingData::setLastChange( FileFingerprint::Change change, qint64 changedFrom )
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    lastChange_      = change;
+    lastChangedFrom_ = changedFrom;
+}
+
+qint64 IndexingData::getAllocatedSize() const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return linePosition_.allocatedSize();
+}
+
+void IndexingData::getLastIndexing( qint64* bytes, qint64* duration_ms ) const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    *bytes       = lastIndexingBytes_;
+    *duration_ms = lastIndexingDuration_;
+}
+
+void IndexingData::setLastIndexing( qint64 bytes, qint64 duration_ms )
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    lastIndexingBytes_    = bytes;
+    lastIndexingDuration_ = duration_ms;
+}
+
+void IndexingData::addAll( qint64 size, const std::vector<int>& lineLengths,
         const FastLinePositionArray& linePosition,
         EncodingSpeculator::Encoding encoding )
 
 {
     QMutexLocker locker( &dataMutex_ );
 
+    LineNumber line = linePosition_.size();
+    for ( const int length: lineLengths ) {
+        const size_t block = ( line++ + blockSkew_ ) / nbLinesInLengthBlock;
+        if ( block >= blockMaxLengths_.size() )
+            blockMaxLengths_.resize( block + 1, 0 );
+        blockMaxLengths_[block] = qMax( blockMaxLengths_[block], length );
+        maxLength_ = qMax( maxLength_, length );
+    }
+
     indexedSize_  += size;
-    maxLength_     = qMax( maxLength_, length );
     linePosition_.append_list( linePosition );
 
     encoding_      = encoding;
 }
 
+void IndexingData::startNewFile( qint64 offset )
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    // A fake final LF (non LF terminated file) now really ends
+    // the line, the new file doesn't continue it.
+    linePosition_.setFakeFinalLF( false );
+    indexedSize_ = offset;
+}
+
+void IndexingData::truncate( qint64 position, qint64 minPosition )
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    // Number of lines ending before position
+    int nb_lines = linePosition_.size();
+    if ( linePosition_.hasFakeFinalLF() )
+        --nb_lines;
+
+    int low = 0;
+    int high = nb_lines;
+    while ( low < high ) {
+        const int middle = low + ( high - low ) / 2;
+        if ( linePosition_.at( middle ) <= static_cast<uint64_t>( position ) )
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    int kept_lines = low;
+
+    // The lengths of the lines of a block are not known once some of
+    // them are dropped, the whole block is indexed again if possible.
+    const int block_first = kept_lines - ( kept_lines + blockSkew_ ) % nbLinesInLengthBlock;
+    if ( block_first < kept_lines && ( block_first <= 0
+                || linePosition_.at( block_first - 1 ) >= static_cast<uint64_t>( minPosition ) ) )
+        kept_lines = qMax( block_first, 0 );
+
+    const qint64 new_size = ( kept_lines > 0 ) ?
+        linePosition_.at( kept_lines - 1 ) : firstPosition_;
+
+    // The compressed storage cannot be shortened,
+    // it is rebuilt (in chunks to limit memory usage).
+    static const int REBUILD_CHUNK = 65536;
+    LinePositionArray kept;
+    for ( int i = 0; i < kept_lines; i += REBUILD_CHUNK ) {
+        FastLinePositionArray chunk;
+        const int end = qMin( kept_lines, i + REBUILD_CHUNK );
+        for ( int j = i; j < end; ++j )
+            chunk.append( linePosition_.at( j ) );
+        kept.append_list( chunk );
+    }
+
+    linePosition_ = std::move( kept );
+    indexedSize_  = new_size;
+
+    // The longest line is now the longest of the blocks kept
+    if ( kept_lines == 0 )
+        blockSkew_ = 0;
+    blockMaxLengths_.resize( ( kept_lines + blockSkew_ + nbLinesInLengthBlock - 1 )
+            / nbLinesInLengthBlock );
+    maxLength_ = 0;
+    for ( const int length: blockMaxLengths_ )
+        maxLength_ = qMax( maxLength_, length );
+}
+
+void IndexingData::dropLinesBefore( qint64 position )
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    // Number of lines ending at or before position
+    int low = 0;
+    int high = linePosition_.size();
+    while ( low < high ) {
+        const int middle = low + ( high - low ) / 2;
+        if ( linePosition_.at( middle ) <= static_cast<uint64_t>( position ) )
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    const int dropped_lines = low;
+
+    if ( dropped_lines == 0 )
+        return;
+
+    firstPosition_ = linePosition_.at( dropped_lines - 1 );
+
+    // Rebuilt as in truncate()
+    static const int REBUILD_CHUNK = 65536;
+    LinePositionArray kept;
+    for ( int i = dropped_lines; i < linePosition_.size(); i += REBUILD_CHUNK ) {
+        FastLinePositionArray chunk;
+        const int end = qMin( linePosition_.size(), i + REBUILD_CHUNK );
+        for ( int j = i; j < end; ++j )
+            chunk.append( linePosition_.at( j ) );
+        kept.append_list( chunk );
+    }
+    kept.setFakeFinalLF( linePosition_.hasFakeFinalLF() );
+
+    linePosition_ = std::move( kept );
+
+    // The blocks only containing dropped lines are forgotten, the one
+    // straddling the first line kept still counts its dropped lines.
+    const int skewed_lines = dropped_lines + blockSkew_;
+    const size_t dropped_blocks = qMin<size_t>(
+            skewed_lines / nbLinesInLengthBlock, blockMaxLengths_.size() );
+    blockMaxLengths_.erase( blockMaxLengths_.begin(),
+            blockMaxLengths_.begin() + dropped_blocks );
+    blockSkew_ = skewed_lines % nbLinesInLengthBlock;
+    if ( linePosition_.size() == 0 ) {
+        blockMaxLengths_.clear();
+        blockSkew_ = 0;
+    }
+
+    maxLength_ = 0;
+    for ( const int length: blockMaxLengths_ )
+        maxLength_ = qMax( maxLength_, length );
+}
+
 void IndexingData::clear()
 {
     maxLength_   = 0;
+    blockMaxLengths_.clear();
+    blockSkew_   = 0;
     indexedSize_ = 0;
+    firstPosition_ = 0;
     linePosition_ = LinePositionArray();
     encoding_    = EncodingSpeculator::Encoding::ASCII7;
+    structuredFormat_ = StructuredFormat::None;
+    fingerprint_ = FileFingerprint();
 }
 
 LogDataWorkerThread::LogDataWorkerThread( IndexingData* indexing_data )
-    : QThread(), mutex_(), operationRequestedCond_(),
-    nothingToDoCond_(), fileName_(), indexing_data_( indexing_data )
+    : QObject(), mutex_(), nothingToDoCond_(), fileName_(),
+    taskId_( 0 ), foreground_( false ), indexing_data_( indexing_data )
 {
-    terminate_          = false;
     interruptRequested_ = false;
     operationRequested_ = NULL;
 }
 
 LogDataWorkerThread::~LogDataWorkerThread()
 {
-    {
-        QMutexLocker locker( &mutex_ );
-        terminate_ = true;
-        operationRequestedCond_.wakeAll();
+    QMutexLocker locker( &mutex_ );
+
+    // An operation not started yet is dropped, a running one
+    // is interrupted and waited for.
+    if ( operationRequested_ &&
+            TaskScheduler::instance().cancel( taskId_ ) ) {
+        delete operationRequested_;
+        operationRequested_ = NULL;
     }
-    wait();
+
+    interruptRequested_ = true;
+    while ( operationRequested_ != NULL )
+        nothingToDoCond_.wait( &mutex_ );
 }
 
 void LogDataWorkerThread::attachFile( const QString& fileName )
@@ -121,12 +341,12 @@ void LogDataWorkerThread::indexAll()
         nothingToDoCond_.wait( &mutex_ );
 
     interruptRequested_ = false;
-    operationRequested_ = new FullIndexOperation( fileName_,
+    operationRequested_ = new FullIndexOperation( fileName_, &tailFile_,
             indexing_data_, &interruptRequested_, &encodingSpeculator_ );
-    operationRequestedCond_.wakeAll();
+    submitOperation();
 }
 
-void LogDataWorkerThread::indexAdditionalLines()
+void LogDataWorkerThread::indexAdditionalLines( bool reopenFile )
 {
     QMutexLocker locker( &mutex_ );  // to protect operationRequested_
 
@@ -137,9 +357,62 @@ void LogDataWorkerThread::indexAdditionalLines()
         nothingToDoCond_.wait( &mutex_ );
 
     interruptRequested_ = false;
-    operationRequested_ = new PartialIndexOperation( fileName_,
-            indexing_data_, &interruptRequested_, &encodingSpeculator_ );
-    operationRequestedCond_.wakeAll();
+    operationRequested_ = new PartialIndexOperation( fileName_, &tailFile_,
+            indexing_data_, &interruptRequested_, &encodingSpeculator_,
+            reopenFile );
+    submitOperation();
+}
+
+void LogDataWorkerThread::indexChanges( bool reopenFile )
+{
+    QMutexLocker locker( &mutex_ );  // to protect operationRequested_
+
+    LOG(logDEBUG) << "Change check requested";
+
+    // If an operation is ongoing, we will block
+    while ( (operationRequested_ != NULL) )
+        nothingToDoCond_.wait( &mutex_ );
+
+    interruptRequested_ = false;
+    operationRequested_ = new UpdateIndexOperation( fileName_, &tailFile_,
+            indexing_data_, &interruptRequested_, &encodingSpeculator_,
+            reopenFile );
+    submitOperation();
+}
+
+void LogDataWorkerThread::indexRewrittenLines( qint64 position )
+{
+    QMutexLocker locker( &mutex_ );  // to protect operationRequested_
+
+    LOG(logDEBUG) << "Rewrite requested from " << position;
+
+    // If an operation is ongoing, we will block
+    while ( (operationRequested_ != NULL) )
+        nothingToDoCond_.wait( &mutex_ );
+
+    interruptRequested_ = false;
+    operationRequested_ = new RewriteIndexOperation( fileName_, &tailFile_,
+            indexing_data_, &interruptRequested_, &encodingSpeculator_,
+            position );
+    submitOperation();
+}
+
+void LogDataWorkerThread::indexRotatedFile(
+        qint64 rotatedFileEnd, qint64 newFileOffset, qint64 droppedEnd )
+{
+    QMutexLocker locker( &mutex_ );  // to protect operationRequested_
+
+    LOG(logDEBUG) << "Rotation requested";
+
+    // If an operation is ongoing, we will block
+    while ( (operationRequested_ != NULL) )
+        nothingToDoCond_.wait( &mutex_ );
+
+    interruptRequested_ = false;
+    operationRequested_ = new RotationIndexOperation( fileName_, &tailFile_,
+            indexing_data_, &interruptRequested_, &encodingSpeculator_,
+            rotatedFileEnd, newFileOffset, droppedEnd );
+    submitOperation();
 }
 
 void LogDataWorkerThread::interrupt()
@@ -150,138 +423,238 @@ void LogDataWorkerThread::interrupt()
     interruptRequested_ = true;
 }
 
-// This is the thread's main loop
-void LogDataWorkerThread::run()
+void LogDataWorkerThread::setForeground( bool foreground )
 {
-    QMutexLocker locker( &mutex_ );
+    foreground_ = foreground;
 
-    forever {
-        while ( (terminate_ == false) && (operationRequested_ == NULL) )
-            operationRequestedCond_.wait( &mutex_ );
-        LOG(logDEBUG) << "Worker thread signaled";
+    if ( foreground )
+        TaskScheduler::instance().foregroundChanged();
+}
 
-        // Look at what needs to be done
-        if ( terminate_ )
-            return;      // We must die
+//
+// Private functions
+//
 
-        if ( operationRequested_ ) {
-            connect( operationRequested_, SIGNAL( indexingProgressed( int ) ),
-                    this, SIGNAL( indexingProgressed( int ) ) );
+// Called with mutex_ held
+void LogDataWorkerThread::submitOperation()
+{
+    connect( operationRequested_, SIGNAL( indexingProgressed( int ) ),
+            this, SIGNAL( indexingProgressed( int ) ) );
 
-            // Run the operation
-            try {
-                if ( operationRequested_->start() ) {
-                    LOG(logDEBUG) << "... finished copy in workerThread.";
-                    emit indexingFinished( LoadingStatus::Successful );
-                }
-                else {
-                    emit indexingFinished( LoadingStatus::Interrupted );
-                }
-            }
-            catch ( std::bad_alloc& ba ) {
-                LOG(logERROR) << "Out of memory whilst indexing!";
-                emit indexingFinished( LoadingStatus::NoMemory );
-            }
+    taskId_ = TaskScheduler::instance().submit( TaskPriority::Indexing,
+            &foreground_, [this] { runOperation(); } );
+}
+
+// Run in a thread of the scheduler, the operation can only be
+// replaced once it is finished so mutex_ is not held while it runs.
+void LogDataWorkerThread::runOperation()
+{
+    IndexOperation* operation;
+    {
+        QMutexLocker locker( &mutex_ );
+        operation = operationRequested_;
+    }
+
+    LOG(logDEBUG) << "Worker task started";
 
-            delete operationRequested_;
-            operationRequested_ = NULL;
-            nothingToDoCond_.wakeAll();
+    // Run the operation
+    try {
+        QElapsedTimer timer;
+        timer.start();
+
+        if ( operation->start() ) {
+            LOG(logDEBUG) << "... finished copy in workerThread.";
+            indexing_data_->setLastIndexing(
+                    operation->getBytesIndexed(), timer.elapsed() );
+            emit indexingFinished( LoadingStatus::Successful );
+        }
+        else {
+            emit indexingFinished( LoadingStatus::Interrupted );
         }
     }
+    catch ( std::bad_alloc& ba ) {
+        LOG(logERROR) << "Out of memory whilst indexing!";
+        emit indexingFinished( LoadingStatus::NoMemory );
+    }
+
+    QMutexLocker locker( &mutex_ );
+    delete operationRequested_;
+    operationRequested_ = NULL;
+    nothingToDoCond_.wakeAll();
 }
 
 //
 // Operations implementation
 //
 
-IndexOperation::IndexOperation( const QString& fileName,
+IndexOperation::IndexOperation( const QString& fileName, TailFile* tailFile,
         IndexingData* indexingData, bool* interruptRequest,
         EncodingSpeculator* encodingSpeculator )
-    : fileName_( fileName )
+    : fileName_( fileName ), tailFile_( tailFile )
 {
     interruptRequest_ = interruptRequest;
     indexing_data_ = indexingData;
     encoding_speculator_ = encodingSpeculator;
 }
 
+StructuredFormat IndexOperation::detectStructuredFormat( QFile& file ) const
+{
+    const qint64 position = file.pos();
+    file.seek( 0 );
+    QByteArray beginning = file.read( qMin<qint64>( 64 * 1024, position ) );
+    file.seek( position );
+
+    // Only the complete lines are used
+    beginning.truncate( beginning.lastIndexOf( '\n' ) + 1 );
+    QStringList lines = QString::fromUtf8( beginning ).split( '\n' );
+    if ( lines.size() > nbStructuredDetectionLines )
+        lines.erase( lines.begin() + nbStructuredDetectionLines, lines.end() );
+
+    return FieldParser::detect( lines );
+}
+
 void IndexOperation::doIndex( IndexingData* indexing_data,
-        EncodingSpeculator* encoding_speculator, qint64 initialPosition )
+        EncodingSpeculator* encoding_speculator,
+        qint64 initialPosition, qint64 endPosition )
 {
     qint64 pos = initialPosition; // Absolute position of the start of current line
     qint64 end = 0;               // Absolute position of the end of current line
     int additional_spaces = 0;    // Additional spaces due to tabs
+    int column = 0;               // Length of the current line so far (UTF-16)
 
-    QFile file( fileName_ );
-    if ( file.open( QIODevice::ReadOnly ) ) {
+    QFile& file = tailFile_->file;
+    const qint64 offset = tailFile_->offset;
+    if ( file.isOpen() ) {
         // Count the number of lines and max length
         // (read big chunks to speed up reading from disk)
         file.seek( pos );
-        while ( !file.atEnd() ) {
+        while ( file.pos() < endPosition ) {
             FastLinePositionArray line_positions;
-            int max_length = 0;
+            std::vector<int> line_lengths;
 
             if ( *interruptRequest_ )   // a bool is always read/written atomically isn't it?
                 break;
 
-            // Read a chunk of 5MB
+            // Read a chunk of 5MB (without going past the end position,
+            // data written after the operation started are left to the
+            // next one)
+            TraceSpan span( "indexing", "LogData index block" );
             const qint64 block_beginning = file.pos();
-            const QByteArray block = file.read( sizeChunk );
-
-            // Count the number of lines in each chunk
-            qint64 pos_within_block = 0;
-            while ( pos_within_block != -1 ) {
-                pos_within_block = qMax( pos - block_beginning, 0LL);
-                // Looking for the next \n, expanding tabs in the process
-                do {
-                    if ( pos_within_block < block.length() ) {
-                        const char c = block.at(pos_within_block);
-                        encoding_speculator->inject_byte( c );
-                        if ( c == '\n' )
-                            break;
-                        else if ( c == '\t' )
-                            additional_spaces += AbstractLogData::tabStop -
-                                ( ( ( block_beginning - pos ) + pos_within_block
-                                    + additional_spaces ) % AbstractLogData::tabStop ) - 1;
-
-                        pos_within_block++;
-                    }
-                    else {
-                        pos_within_block = -1;
+            QByteArray block = file.read(
+                    qMin<qint64>( sizeChunk, endPosition - block_beginning ) );
+            if ( block.isEmpty() ) {
+                LOG(logWARNING) << "Cannot read from " << fileName_.toStdString();
+                break;
+            }
+
+            // The encoding is guessed first, as UTF-16 (recognised by
+            // its BOM) is scanned by code units rather than bytes.
+            const char* const bytes = block.constData();
+            for ( int i = 0; i < block.length(); ++i )
+                encoding_speculator->inject_byte( bytes[i] );
+            const EncodingSpeculator::Encoding encoding = encoding_speculator->guess();
+            const bool utf16 = EncodingSpeculator::isUtf16( encoding );
+
+            // An incomplete final code unit is left for the next operation
+            if ( utf16 && block.length() % 2 != 0 ) {
+                block.chop( 1 );
+                file.seek( block_beginning + block.length() );
+                if ( block.isEmpty() )
+                    break;
+            }
+
+            span.setArg( block.length() );
+            bytesIndexed_ += block.length();
+
+            if ( utf16 ) {
+                // The positions stored are the beginnings of the next
+                // lines, after the two bytes of the line feed.
+                const Utf16Scanner scanner(
+                        encoding == EncodingSpeculator::Encoding::UTF16BE,
+                        AbstractLogData::tabStop );
+                int pos_within_block = qMax( pos - block_beginning, 0LL );
+                while ( true ) {
+                    const int line_feed = scanner.findLineFeed(
+                            block.constData(), pos_within_block, block.length() );
+                    column = scanner.expandedLength( block.constData(), pos_within_block,
+                            ( line_feed != -1 ) ? line_feed : block.length(), column );
+                    if ( line_feed == -1 )
+                        break;
+
+                    line_lengths.push_back( column );
+                    column = 0;
+                    pos = block_beginning + line_feed + 2;
+                    line_positions.append( offset + pos );
+                    pos_within_block = line_feed + 2;
+                }
+            }
+            else {
+                // Count the number of lines in each chunk
+                qint64 pos_within_block = 0;
+                while ( pos_within_block != -1 ) {
+                    pos_within_block = qMax( pos - block_beginning, 0LL);
+                    // Looking for the next \n, expanding tabs in the process
+                    do {
+                        if ( pos_within_block < block.length() ) {
+                            const char c = block.at(pos_within_block);
+                            if ( c == '\n' )
+                                break;
+                            else if ( c == '\t' )
+                                additional_spaces += AbstractLogData::tabStop -
+                                    ( ( ( block_beginning - pos ) + pos_within_block
+                                        + additional_spaces ) % AbstractLogData::tabStop ) - 1;
+
+                            pos_within_block++;
+                        }
+                        else {
+                            pos_within_block = -1;
+                        }
+                    } while ( pos_within_block != -1 );
+
+                    // When a end of line has been found...
+                    if ( pos_within_block != -1 ) {
+                        end = pos_within_block + block_beginning;
+                        line_lengths.push_back( end - pos + additional_spaces );
+                        pos = end + 1;
+                        additional_spaces = 0;
+                        line_positions.append( offset + pos );
                     }
-                } while ( pos_within_block != -1 );
-
-                // When a end of line has been found...
-                if ( pos_within_block != -1 ) {
-                    end = pos_within_block + block_beginning;
-                    const int length = end-pos + additional_spaces;
-                    if ( length > max_length )
-                        max_length = length;
-                    pos = end + 1;
-                    additional_spaces = 0;
-                    line_positions.append( pos );
                 }
             }
 
+            // The format is detected again until the first lines of the
+            // file have all been indexed (e.g. when following a new file)
+            const bool detect_format = ( offset == 0 ) && ! utf16
+                && indexing_data->getNbLines() < nbStructuredDetectionLines;
+
             // Update the shared data
-            indexing_data->addAll( block.length(), max_length, line_positions,
+            indexing_data->addAll( block.length(), line_lengths, line_positions,
                    encoding_speculator->guess() );
 
+            if ( detect_format )
+                indexing_data->setStructuredFormat( detectStructuredFormat( file ) );
+
             // Update the caller for progress indication
-            int progress = ( file.size() > 0 ) ? pos*100 / file.size() : 100;
+            int progress = ( endPosition > 0 ) ? pos*100 / endPosition : 100;
             emit indexingProgressed( progress );
         }
 
         // Check if there is a non LF terminated line at the end of the file
-        qint64 file_size = file.size();
+        qint64 file_size = endPosition;
         if ( !*interruptRequest_ && file_size > pos ) {
             LOG( logWARNING ) <<
                 "Non LF terminated file, adding a fake end of line";
 
+            // Past the line feed that would end the line
+            const int line_feed_size =
+                EncodingSpeculator::isUtf16( encoding_speculator->guess() ) ? 2 : 1;
+
             FastLinePositionArray line_position;
-            line_position.append( file_size + 1 );
+            line_position.append( offset + file_size + line_feed_size );
             line_position.setFakeFinalLF();
 
-            indexing_data->addAll( 0, 0, line_position, encoding_speculator->guess() );
+            indexing_data->addAll( 0, std::vector<int>( 1, 0 ), line_position,
+                    encoding_speculator->guess() );
         }
     }
     else {
@@ -293,6 +666,20 @@ void IndexOperation::doIndex( IndexingData* indexing_data,
     }
 }
 
+void IndexOperation::reopenTailFile()
+{
+    tailFile_->file.close();
+    tailFile_->file.setFileName( fileName_ );
+    tailFile_->file.open( QIODevice::ReadOnly );
+}
+
+void IndexOperation::updateFingerprint()
+{
+    if ( tailFile_->file.isOpen() && ! *interruptRequest_ )
+        indexing_data_->setFingerprint( FileFingerprint::compute(
+                    &tailFile_->file, indexing_data_->getSize() - tailFile_->offset ) );
+}
+
 // Called in the worker thread's context
 bool FullIndexOperation::start()
 {
@@ -306,7 +693,13 @@ bool FullIndexOperation::start()
     // First empty the index
     indexing_data_->clear();
 
-    doIndex( indexing_data_, encoding_speculator_, 0 );
+    // A full index is always done on the file currently having the name
+    // (forgetting the rotated files)
+    reopenTailFile();
+    tailFile_->offset = 0;
+
+    doIndex( indexing_data_, encoding_speculator_, 0, tailFile_->file.size() );
+    updateFingerprint();
 
     LOG(logDEBUG) << "FullIndexOperation: ... finished counting."
         "interrupt = " << *interruptRequest_;
@@ -319,16 +712,110 @@ bool PartialIndexOperation::start()
     LOG(logDEBUG) << "PartialIndexOperation::start(), file "
         << fileName_.toStdString();
 
-    qint64 initial_position = indexing_data_->getSize();
+    if ( reopenFile_ || ! tailFile_->file.isOpen() )
+        reopenTailFile();
+
+    qint64 initial_position = indexing_data_->getSize() - tailFile_->offset;
+    // The file is open so this is a fstat, we don't need to go
+    // through the name.
+    qint64 end_position = tailFile_->file.size();
 
     LOG(logDEBUG) << "PartialIndexOperation: Starting the count at "
-        << initial_position << " ...";
+        << initial_position << " up to " << end_position << " ...";
 
     emit indexingProgressed( 0 );
 
-    doIndex( indexing_data_, encoding_speculator_, initial_position );
+    doIndex( indexing_data_, encoding_speculator_,
+            initial_position, end_position );
+    updateFingerprint();
 
     LOG(logDEBUG) << "PartialIndexOperation: ... finished counting.";
 
     return ( *interruptRequest_ ? false : true );
 }
+
+bool UpdateIndexOperation::start()
+{
+    LOG(logDEBUG) << "UpdateIndexOperation::start(), file "
+        << fileName_.toStdString();
+
+    if ( reopenFile_ || ! tailFile_->file.isOpen() )
+        reopenTailFile();
+
+    // The file is open so this is a fstat
+    const qint64 end_position = tailFile_->file.size();
+
+    qint64 changed_from = 0;
+    const FileFingerprint::Change change = indexing_data_->getFingerprint().compare(
+            &tailFile_->file, end_position, &changed_from );
+    indexing_data_->setLastChange( change, changed_from );
+
+    if ( change == FileFingerprint::Change::Appended ) {
+        const qint64 initial_position = indexing_data_->getSize() - tailFile_->offset;
+
+        LOG(logDEBUG) << "UpdateIndexOperation: Starting the count at "
+            << initial_position << " up to " << end_position << " ...";
+
+        emit indexingProgressed( 0 );
+
+        doIndex( indexing_data_, encoding_speculator_,
+                initial_position, end_position );
+        updateFingerprint();
+    }
+
+    LOG(logDEBUG) << "UpdateIndexOperation: ... finished.";
+
+    return ( *interruptRequest_ ? false : true );
+}
+
+bool RotationIndexOperation::start()
+{
+    LOG(logDEBUG) << "RotationIndexOperation::start(), file "
+        << fileName_.toStdString() << " following at " << newFileOffset_;
+
+    emit indexingProgressed( 0 );
+
+    // The tail file is still the rotated one, index what has been
+    // written to it since the last time.
+    if ( tailFile_->file.isOpen() )
+        doIndex( indexing_data_, encoding_speculator_,
+                indexing_data_->getSize() - tailFile_->offset,
+                rotatedFileEnd_ - tailFile_->offset );
+
+    // Then continue with the file now having the name, even if
+    // interrupted, so we stay in sync with LogData.
+    indexing_data_->startNewFile( newFileOffset_ );
+    if ( droppedEnd_ > 0 )
+        indexing_data_->dropLinesBefore( droppedEnd_ );
+    reopenTailFile();
+    tailFile_->offset = newFileOffset_;
+
+    if ( ! *interruptRequest_ )
+        doIndex( indexing_data_, encoding_speculator_,
+                0, tailFile_->file.size() );
+    updateFingerprint();
+
+    LOG(logDEBUG) << "RotationIndexOperation: ... finished counting.";
+
+    return ( *interruptRequest_ ? false : true );
+}
+
+bool RewriteIndexOperation::start()
+{
+    LOG(logDEBUG) << "RewriteIndexOperation::start(), file "
+        << fileName_.toStdString() << " from " << rewrittenFrom_;
+
+    emit indexingProgressed( 0 );
+
+    // The lines before the rewritten part are kept
+    indexing_data_->truncate( tailFile_->offset + rewrittenFrom_, tailFile_->offset );
+
+    const qint64 initial_position = indexing_data_->getSize() - tailFile_->offset;
+    doIndex( indexing_data_, encoding_speculator_,
+            qMax<qint64>( 0, initial_position ), tailFile_->file.size() );
+    updateFingerprint();
+
+    LOG(logDEBUG) << "RewriteIndexOperation: ... finished counting.";
+
+    return ( *interruptRequest_ ? false : true );
+}
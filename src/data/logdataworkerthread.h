@@ -20,8 +20,11 @@
 #ifndef LOGDATAWORKERTHREAD_H
 #define LOGDATAWORKERTHREAD_H
 
+#include <atomic>
+#include <vector>
+
 #include <QObject>
-#include <QThread>
+#include <QFile>
 #include <QMutex>
 #include <QWaitCondition>
 #include <QVector>
@@ -29,7 +32,10 @@
 #include "loadingstatus.h"
 #include "linepositionarray.h"
 #include "encodingspeculator.h"
+#include "fieldquery.h"
+#include "filefingerprint.h"
 #include "utils.h"
+#include "taskscheduler.h"
 
 // This class is a thread-safe set of indexing data.
 class IndexingData
@@ -41,6 +47,11 @@ class IndexingData
     // Get the total indexed size
     qint64 getSize() const;
 
+    // Get the position of the beginning of the first line, non zero
+    // once the lines of the oldest rotated files have been dropped
+    // (the positions are not moved).
+    qint64 getFirstPosition() const;
+
     // Get the length of the longest line
     int getMaxLength() const;
 
@@ -54,12 +65,52 @@ class IndexingData
     // Get the guessed encoding for the content.
     EncodingSpeculator::Encoding getEncodingGuess() const;
 
+    // Get/set the format of the lines if the content is a structured log
+    StructuredFormat getStructuredFormat() const;
+    void setStructuredFormat( StructuredFormat format );
+
+    // Get the fingerprint of the indexed part of the last file
+    // (used to see how it has changed)
+    FileFingerprint getFingerprint() const;
+    void setFingerprint( const FileFingerprint& fingerprint );
+
+    // Get/set the change found by the last comparison of the file
+    // with its fingerprint (and where a rewrite starts)
+    FileFingerprint::Change getLastChange( qint64* changedFrom ) const;
+    void setLastChange( FileFingerprint::Change change, qint64 changedFrom );
+
+    // Get the memory used by the position of the lines (in bytes)
+    qint64 getAllocatedSize() const;
+
+    // Get/set the number of bytes read by the last indexing operation
+    // and its duration (in ms)
+    void getLastIndexing( qint64* bytes, qint64* duration_ms ) const;
+    void setLastIndexing( qint64 bytes, qint64 duration_ms );
+
     // Atomically add to all the existing
-    // indexing data.
-    void addAll( qint64 size, int length,
+    // indexing data (lineLengths being the length of each new line).
+    void addAll( qint64 size, const std::vector<int>& lineLengths,
             const FastLinePositionArray& linePosition,
             EncodingSpeculator::Encoding encoding );
 
+    // The data following are from a new file which will appear
+    // at offset in the index (after a rotation): terminates the final
+    // line if needed and moves the indexed size to offset.
+    void startNewFile( qint64 offset );
+
+    // Only keep the lines ending before position, the indexed size
+    // becomes the end of the last line kept.
+    // (used when the file has been rewritten from position)
+    // The length of the longest line is recomputed by block of lines,
+    // so the lines of the last block kept are dropped as well if they
+    // begin after minPosition (they can be indexed again).
+    void truncate( qint64 position, qint64 minPosition );
+
+    // Drop the lines ending at or before position, which becomes
+    // the beginning of the first line.
+    // (used to forget the oldest rotated files)
+    void dropLinesBefore( qint64 position );
+
     // Completely clear the indexing data.
     void clear();
 
@@ -68,16 +119,40 @@ class IndexingData
 
     LinePositionArray linePosition_;
     int maxLength_;
+    // Length of the longest line of each block of lines, the first
+    // block starting blockSkew_ lines before the first line (the
+    // others having been dropped)
+    std::vector<int> blockMaxLengths_;
+    int blockSkew_ = 0;
     qint64 indexedSize_;
+    qint64 firstPosition_ = 0;
 
     EncodingSpeculator::Encoding encoding_;
+
+    StructuredFormat structuredFormat_ = StructuredFormat::None;
+
+    FileFingerprint fingerprint_;
+    FileFingerprint::Change lastChange_ = FileFingerprint::Change::None;
+    qint64 lastChangedFrom_ = 0;
+
+    qint64 lastIndexingBytes_ = 0;
+    qint64 lastIndexingDuration_ = 0;
+};
+
+// The file being indexed, kept open between the indexing operations so
+// only the appended data have to be read when it grows.
+// The index can cover files that have been rotated away before this one,
+// offset is the position of the first byte of the file in the index.
+struct TailFile {
+    QFile file;
+    qint64 offset = 0;
 };
 
 class IndexOperation : public QObject
 {
   Q_OBJECT
   public:
-    IndexOperation( const QString& fileName,
+    IndexOperation( const QString& fileName, TailFile* tailFile,
             IndexingData* indexingData, bool* interruptRequest,
             EncodingSpeculator* encodingSpeculator );
 
@@ -87,50 +162,135 @@ class IndexOperation : public QObject
     // and false if it has been cancelled (results not copied)
     virtual bool start() = 0;
 
+    // Returns the number of bytes read from the file(s) so far
+    qint64 getBytesIndexed() const { return bytesIndexed_; }
+
   signals:
     void indexingProgressed( int );
 
   protected:
     static const int sizeChunk;
+    // Number of lines the format of a structured log is detected from
+    static const int nbStructuredDetectionLines;
 
-    // Returns the total size indexed
+    // Index the data between initialPosition and endPosition
+    // (read from the tail file, positions relative to it)
     // Modify the passed linePosition and maxLength
     void doIndex( IndexingData* linePosition, EncodingSpeculator* encodingSpeculator,
-            qint64 initialPosition );
+            qint64 initialPosition, qint64 endPosition );
+
+    // Detect the format of the lines from the beginning of the file
+    StructuredFormat detectStructuredFormat( QFile& file ) const;
+
+    // (Re)open the tail file by name, to follow the file now
+    // having this name.
+    void reopenTailFile();
+
+    // Record the fingerprint of the indexed part of the tail file
+    void updateFingerprint();
 
     QString fileName_;
+    TailFile* tailFile_;
     bool* interruptRequest_;
     IndexingData* indexing_data_;
 
     EncodingSpeculator* encoding_speculator_;
+
+    qint64 bytesIndexed_ = 0;
 };
 
 class FullIndexOperation : public IndexOperation
 {
   public:
-    FullIndexOperation( const QString& fileName,
+    FullIndexOperation( const QString& fileName, TailFile* tailFile,
             IndexingData* indexingData, bool* interruptRequest,
             EncodingSpeculator* speculator )
-        : IndexOperation( fileName, indexingData, interruptRequest, speculator ) { }
+        : IndexOperation( fileName, tailFile, indexingData,
+                interruptRequest, speculator ) { }
     virtual bool start();
 };
 
+// Only reads the data appended since the last indexing, up to the size
+// of the file (as seen by fstat on the tail file) when the operation starts.
 class PartialIndexOperation : public IndexOperation
 {
   public:
-    PartialIndexOperation( const QString& fileName,
+    PartialIndexOperation( const QString& fileName, TailFile* tailFile,
             IndexingData* indexingData, bool* interruptRequest,
-            EncodingSpeculator* speculator )
-        : IndexOperation( fileName, indexingData, interruptRequest, speculator ) { }
+            EncodingSpeculator* speculator, bool reopenFile )
+        : IndexOperation( fileName, tailFile, indexingData,
+                interruptRequest, speculator ),
+        reopenFile_( reopenFile ) { }
+    virtual bool start();
+
+  private:
+    bool reopenFile_;
+};
+
+// Compare the file with the fingerprint of its indexed part, recording
+// the change found in the IndexingData, and index the data appended
+// if that is the change (the others are left to the client).
+class UpdateIndexOperation : public IndexOperation
+{
+  public:
+    UpdateIndexOperation( const QString& fileName, TailFile* tailFile,
+            IndexingData* indexingData, bool* interruptRequest,
+            EncodingSpeculator* speculator, bool reopenFile )
+        : IndexOperation( fileName, tailFile, indexingData,
+                interruptRequest, speculator ),
+        reopenFile_( reopenFile ) { }
     virtual bool start();
+
+  private:
+    bool reopenFile_;
 };
 
-// Create and manage the thread doing loading/indexing for
-// the creating LogData. One LogDataWorkerThread is used
-// per LogData instance.
-// Note everything except the run() function is in the LogData's
+// Reindex the current file from the line including position
+// rewrittenFrom (in the tail file), keeping the lines before.
+class RewriteIndexOperation : public IndexOperation
+{
+  public:
+    RewriteIndexOperation( const QString& fileName, TailFile* tailFile,
+            IndexingData* indexingData, bool* interruptRequest,
+            EncodingSpeculator* speculator, qint64 rewrittenFrom )
+        : IndexOperation( fileName, tailFile, indexingData,
+                interruptRequest, speculator ),
+        rewrittenFrom_( rewrittenFrom ) { }
+    virtual bool start();
+
+  private:
+    qint64 rewrittenFrom_;
+};
+
+// Index the end of a file that has been rotated away (up to
+// rotatedFileEnd) then the new file having its name, as if it
+// was following the old one at newFileOffset.
+class RotationIndexOperation : public IndexOperation
+{
+  public:
+    RotationIndexOperation( const QString& fileName, TailFile* tailFile,
+            IndexingData* indexingData, bool* interruptRequest,
+            EncodingSpeculator* speculator,
+            qint64 rotatedFileEnd, qint64 newFileOffset, qint64 droppedEnd )
+        : IndexOperation( fileName, tailFile, indexingData,
+                interruptRequest, speculator ),
+        rotatedFileEnd_( rotatedFileEnd ), newFileOffset_( newFileOffset ),
+        droppedEnd_( droppedEnd ) { }
+    virtual bool start();
+
+  private:
+    qint64 rotatedFileEnd_;
+    qint64 newFileOffset_;
+    // The lines before are dropped (oldest rotated files)
+    qint64 droppedEnd_;
+};
+
+// Manage the loading/indexing for the creating LogData.
+// One LogDataWorkerThread is used per LogData instance, the operations
+// are run by the shared TaskScheduler (one at a time for a given file).
+// Note everything except the runOperation() function is in the LogData's
 // thread.
-class LogDataWorkerThread : public QThread
+class LogDataWorkerThread : public QObject
 {
   Q_OBJECT
 
@@ -148,9 +308,27 @@ class LogDataWorkerThread : public QThread
     void indexAll();
     // Instructs the thread to start a partial indexing (starting at
     // the end of the file as indexed).
-    void indexAdditionalLines();
+    // If reopenFile is true, the file is reopened by name first (e.g. if
+    // it has been moved).
+    void indexAdditionalLines( bool reopenFile );
+    // Instructs the thread to find out how the file has changed since
+    // it was indexed, indexing the data appended if it has just grown.
+    // The change found is then available from the IndexingData.
+    void indexChanges( bool reopenFile );
+    // Instructs the thread to reindex the file from the line including
+    // position (in the file), the lines before are kept.
+    void indexRewrittenLines( qint64 position );
+    // Instructs the thread to finish indexing the file that has been
+    // rotated (up to rotatedFileEnd, in the index) and to continue
+    // with the new file, its first byte being at newFileOffset.
+    // The lines ending before droppedEnd (if not 0) are then forgotten.
+    void indexRotatedFile( qint64 rotatedFileEnd, qint64 newFileOffset,
+            qint64 droppedEnd );
     // Interrupts the indexing if one is in progress
     void interrupt();
+    // Tells whether the file is the one displayed, its operations
+    // are then run before the other files'.
+    void setForeground( bool foreground );
 
     // Returns a copy of the current indexing data
     void getIndexingData( qint64* indexedSize,
@@ -164,28 +342,33 @@ class LogDataWorkerThread : public QThread
     // to copy the new data back.
     void indexingFinished( LoadingStatus status );
 
-  protected:
-    void run();
-
   private:
-    void doIndexAll();
+    // Submit the operation requested to the scheduler
+    void submitOperation();
+    // Run the operation requested (in a thread of the scheduler)
+    void runOperation();
 
     // Mutex to protect operationRequested_ and friends
     QMutex mutex_;
-    QWaitCondition operationRequestedCond_;
     QWaitCondition nothingToDoCond_;
     QString fileName_;
 
-    // Set when the thread must die
-    bool terminate_;
     bool interruptRequested_;
     IndexOperation* operationRequested_;
+    // Id of the task running operationRequested_
+    TaskScheduler::TaskId taskId_;
+    std::atomic<bool> foreground_;
 
     // Pointer to the owner's indexing data (we modify it)
     IndexingData* indexing_data_;
 
     // To guess the encoding
     EncodingSpeculator encodingSpeculator_;
+
+    // The file is kept open between indexing operations so only
+    // the appended data have to be read when it grows.
+    // (only used by the operations, in the worker thread)
+    TailFile tailFile_;
 };
 
 #endif
@@ -28,7 +28,7 @@
 #include <limits>
 
 #include "utils.h"
-#include "logdata.h"
+#include "abstractlogsource.h"
 #include "marks.h"
 #include "logfiltereddata.h"
 
@@ -52,7 +52,7 @@ LogFilteredData::LogFilteredData() : AbstractLogData(),
 }
 
 // Usual constructor: just copy the data, the search is started by runSearch()
-LogFilteredData::LogFilteredData( const LogData* logData )
+LogFilteredData::LogFilteredData( const AbstractLogSource* logData )
     : AbstractLogData(),
     matching_lines_( SearchResultArray() ),
     currentRegExp_(),
@@ -77,9 +77,6 @@ LogFilteredData::LogFilteredData( const LogData* logData )
     // Forward the update signal
     connect( &workerThread_, SIGNAL( searchProgressed( int, int, qint64 ) ),
             this, SLOT( handleSearchProgressed( int, int, qint64 ) ) );
-
-    // Starts the worker thread
-    workerThread_.start();
 }
 
 LogFilteredData::~LogFilteredData()
@@ -100,14 +97,51 @@ void LogFilteredData::runSearch( const QRegularExpression& regExp )
     clearSearch();
     currentRegExp_ = regExp;
 
+    searchTimer_.start();
+    searchStartLine_ = 0;
     workerThread_.search( currentRegExp_ );
 }
 
+void LogFilteredData::runFieldSearch( const FieldQuery& query )
+{
+    LOG(logDEBUG) << "Entering runFieldSearch";
+
+    clearSearch();
+    currentFieldQuery_ = query;
+
+    searchTimer_.start();
+    searchStartLine_ = 0;
+    workerThread_.search( currentFieldQuery_ );
+}
+
+void LogFilteredData::runTemplateSearch(
+        const std::shared_ptr<const TemplateIndex>& templateIndex,
+        const std::vector<bool>& selected )
+{
+    LOG(logDEBUG) << "Entering runTemplateSearch";
+
+    clearSearch();
+    currentTemplateIndex_ = templateIndex;
+    currentTemplates_     = selected;
+
+    searchTimer_.start();
+    searchStartLine_ = 0;
+    workerThread_.search( currentTemplateIndex_, currentTemplates_ );
+}
+
 void LogFilteredData::updateSearch()
 {
     LOG(logDEBUG) << "Entering updateSearch";
 
-    workerThread_.updateSearch( currentRegExp_, nbLinesProcessed_ );
+    searchTimer_.start();
+    searchStartLine_ = nbLinesProcessed_;
+    if ( currentTemplateIndex_ )
+        workerThread_.updateSearch( currentTemplateIndex_, currentTemplates_,
+                nbLinesProcessed_ );
+    else if ( ! currentFieldQuery_.isEmpty() )
+        workerThread_.updateSearch( currentFieldQuery_, nbLinesProcessed_ );
+    else
+        workerThread_.updateSearch( currentRegExp_, nbLinesProcessed_ );
 }
 
 void LogFilteredData::interruptSearch()
@@ -120,12 +154,20 @@ void LogFilteredData::interruptSearch()
 void LogFilteredData::clearSearch()
 {
     currentRegExp_ = QRegularExpression();
+    currentFieldQuery_ = FieldQuery();
+    currentTemplateIndex_.reset();
+    currentTemplates_.clear();
     matching_lines_.clear();
     maxLength_        = 0;
     nbLinesProcessed_ = 0;
     filteredItemsCacheDirty_ = true;
 }
 
+void LogFilteredData::clearFieldIndex()
+{
+    workerThread_.clearFieldIndex();
+}
+
 qint64 LogFilteredData::getMatchingLineNumber( int matchNum ) const
 {
     qint64 matchingLine = findLogDataLine( matchNum );
@@ -133,6 +175,11 @@ qint64 LogFilteredData::getMatchingLineNumber( int matchNum ) const
     return matchingLine;
 }
 
+int LogFilteredData::getLineSource( int index ) const
+{
+    return sourceLogData_->getLineSource( findLogDataLine( index ) );
+}
+
 // Scan the list for the 'lineNumber' passed
 bool LogFilteredData::isLineInMatchingList( qint64 lineNumber )
 {
@@ -141,6 +188,27 @@ bool LogFilteredData::isLineInMatchingList( qint64 lineNumber )
             matching_lines_, lineNumber, &index);
 }
 
+MatchSpanList LogFilteredData::getMatchSpans( int index ) const
+{
+    const qint64 line = findLogDataLine( index );
+    int match_index;
+    if ( lookupLineNumber<SearchResultArray>(
+                matching_lines_, line, &match_index ) )
+        return workerThread_.getMatchSpans( line );
+    else
+        return MatchSpanList();
+}
+
+void LogFilteredData::setMatchSpansRecorded( bool record )
+{
+    workerThread_.setMatchSpansRecorded( record );
+}
+
+void LogFilteredData::setForeground( bool foreground )
+{
+    workerThread_.setForeground( foreground );
+}
+
 int LogFilteredData::getLineIndexNumber( quint64 lineNumber ) const
 {
     int lineIndex = findFilteredLine( lineNumber );
@@ -162,6 +230,22 @@ LineNumber LogFilteredData::getNbMarks() const
     return marks_.size();
 }
 
+qint64 LogFilteredData::getNbLinesProcessed() const
+{
+    return nbLinesProcessed_;
+}
+
+LogFilteredData::SearchStatistics LogFilteredData::getSearchStatistics() const
+{
+    SearchStatistics statistics = searchStatistics_;
+
+    statistics.resultsMemory = matching_lines_.capacity() * sizeof( MatchingLine )
+        + filteredItemsCache_.capacity() * sizeof( FilteredItem )
+        + workerThread_.getMatchSpansSize();
+
+    return statistics;
+}
+
 LogFilteredData::FilteredLineType
     LogFilteredData::filteredLineTypeByIndex( int index ) const
 {
@@ -284,6 +368,12 @@ void LogFilteredData::handleSearchProgressed( int nbMatches, int progress, qint6
     workerThread_.getSearchResult( &maxLength_, &matching_lines_, &nbLinesProcessed_ );
     filteredItemsCacheDirty_ = true;
 
+    if ( progress == 100 && searchTimer_.isValid() ) {
+        searchStatistics_.lastSearchLines = nbLinesProcessed_ - searchStartLine_;
+        searchStatistics_.lastSearchDuration = searchTimer_.elapsed();
+        searchTimer_.invalidate();
+    }
+
     emit searchProgressed( nbMatches, progress, initial_position );
 }
 
@@ -27,17 +27,19 @@
 #include <QList>
 #include <QStringList>
 #include <QRegularExpression>
+#include <QElapsedTimer>
 
 #include "abstractlogdata.h"
 #include "logfiltereddataworkerthread.h"
 #include "marks.h"
 
-class LogData;
+class AbstractLogSource;
 class Marks;
 
-// A list of matches found in a LogData, it stores all the matching lines,
-// which can be accessed using the AbstractLogData interface, together with
-// the original line number where they were found.
+// A list of matches found in a LogData (or another AbstractLogSource),
+// it stores all the matching lines, which can be accessed using the
+// AbstractLogData interface, together with the original line number
+// where they were found.
 // Constructing such objet does not start the search.
 // This object should be constructed by a LogData.
 class LogFilteredData : public AbstractLogData {
@@ -47,7 +49,7 @@ class LogFilteredData : public AbstractLogData {
     // Creates an empty LogFilteredData
     LogFilteredData();
     // Constructor used by LogData
-    LogFilteredData( const LogData* logData );
+    LogFilteredData( const AbstractLogSource* logData );
 
     ~LogFilteredData();
 
@@ -55,6 +57,12 @@ class LogFilteredData : public AbstractLogData {
     // If a search is already in progress this function will block until
     // it is done, so the application should call interruptSearch() first.
     void runSearch(const QRegularExpression &regExp );
+    // Same for the lines of a structured log matching the field query.
+    void runFieldSearch( const FieldQuery& query );
+    // Same for the lines whose template (in the passed index, built
+    // from the source) is selected.
+    void runTemplateSearch( const std::shared_ptr<const TemplateIndex>& templateIndex,
+            const std::vector<bool>& selected );
     // Add to the existing search, starting at the line when the search was
     // last stopped. Used when the file on disk has been added too.
     void updateSearch();
@@ -63,11 +71,27 @@ class LogFilteredData : public AbstractLogData {
     void interruptSearch();
     // Clear the search and the list of results.
     void clearSearch();
+    // Drop the index used by the field searches, to be called when
+    // the source has been truncated or reloaded.
+    void clearFieldIndex();
     // Returns the line number in the original LogData where the element
     // 'index' was found.
     qint64 getMatchingLineNumber( int index ) const;
+    // Returns the index of the file the element 'index' comes from,
+    // -1 if the original data is not made of several files.
+    int getLineSource( int index ) const;
     // Returns whether the line number passed is in our list of matching ones.
     bool isLineInMatchingList( qint64 lineNumber );
+    // Returns the position of the matches in the element 'index'
+    // (in the expanded line), the list is empty if the element is not
+    // a match or if the positions have not been recorded.
+    MatchSpanList getMatchSpans( int index ) const;
+    // Set whether the searches record the position of the matches
+    // within the lines (default is no, the filtered view turns it on)
+    void setMatchSpansRecorded( bool record );
+    // Tells whether the search results are displayed, the searches
+    // are then run before the other files'.
+    void setForeground( bool foreground );
 
     // Returns the line 'index' in filterd log data that matches
     // given original line number
@@ -79,6 +103,19 @@ class LogFilteredData : public AbstractLogData {
     LineNumber getNbMatches() const;
     // Returns the number of marks (independently of the visibility)
     LineNumber getNbMarks() const;
+    // Returns the number of lines of the source the search has processed
+    qint64 getNbLinesProcessed() const;
+
+    // Statistics about the search
+    struct SearchStatistics {
+        // Memory used by the results (in bytes)
+        qint64 resultsMemory = 0;
+        // Lines searched by the last search (or update) and its
+        // duration (in ms)
+        qint64 lastSearchLines = 0;
+        qint64 lastSearchDuration = 0;
+    };
+    SearchStatistics getSearchStatistics() const;
 
     // Returns the reason why the line at the passed index is in the filtered
     // data.  It can be because it is either a mark or a match.
@@ -138,14 +175,24 @@ class LogFilteredData : public AbstractLogData {
     // List of the matching line numbers
     SearchResultArray matching_lines_;
 
-    const LogData* sourceLogData_;
+    const AbstractLogSource* sourceLogData_;
     QRegularExpression currentRegExp_;
+    // The current search is a field one if the query is not empty
+    FieldQuery currentFieldQuery_;
+    // The current search is a template one if the index is not null
+    std::shared_ptr<const TemplateIndex> currentTemplateIndex_;
+    std::vector<bool> currentTemplates_;
     bool searchDone_;
     int maxLength_;
     int maxLengthMarks_;
     // Number of lines of the LogData that has been searched for:
     qint64 nbLinesProcessed_;
 
+    // Time and lines processed when the current search started
+    QElapsedTimer searchTimer_;
+    qint64 searchStartLine_ = 0;
+    SearchStatistics searchStatistics_;
+
     Visibility visibility_;
 
     // Cache used to combine Marks and Matches
@@ -17,15 +17,106 @@
  * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 #include <QFile>
 
 #include "log.h"
+#include "tracing.h"
 
 #include "logfiltereddataworkerthread.h"
-#include "logdata.h"
+#include "abstractlogsource.h"
+#include "fieldindex.h"
+#include "templateminer.h"
 
 // Number of lines in each chunk to read
 const int SearchOperation::nbLinesInChunk = 5000;
+const int SearchOperation::maxSpansPerLine = 64;
+
+namespace {
+// Returns the column in the expanded (untabified) line corresponding
+// to the passed column in the raw line.
+int expandedColumn( const QString& line, int column )
+{
+    int expanded = 0;
+    for ( int i = 0; i < column; i++ ) {
+        if ( line[i] == '\t' )
+            expanded += AbstractLogData::tabStop - ( expanded % AbstractLogData::tabStop );
+        else
+            expanded++;
+    }
+
+    return expanded;
+}
+}
+
+void MatchSpanTable::append( LineNumber line, const MatchSpanList& spans )
+{
+    // The line searched again replaces the previous result
+    while ( ! lines_.empty() && lines_.back() >= line ) {
+        spans_.resize( firstSpans_.back() );
+        lines_.pop_back();
+        firstSpans_.pop_back();
+    }
+
+    lines_.push_back( line );
+    firstSpans_.push_back( spans_.size() );
+    spans_.insert( spans_.end(), spans.begin(), spans.end() );
+}
+
+void MatchSpanTable::append( const MatchSpanTable& other )
+{
+    if ( other.lines_.empty() )
+        return;
+
+    // Drop what the other table searched again, then shift its offsets
+    while ( ! lines_.empty() && lines_.back() >= other.lines_.front() ) {
+        spans_.resize( firstSpans_.back() );
+        lines_.pop_back();
+        firstSpans_.pop_back();
+    }
+
+    const uint32_t offset = spans_.size();
+    lines_.insert( lines_.end(), other.lines_.begin(), other.lines_.end() );
+    for ( uint32_t first : other.firstSpans_ )
+        firstSpans_.push_back( first + offset );
+    spans_.insert( spans_.end(), other.spans_.begin(), other.spans_.end() );
+}
+
+MatchSpanList MatchSpanTable::get( LineNumber line ) const
+{
+    const auto found = std::lower_bound( lines_.begin(), lines_.end(), line );
+    if ( found == lines_.end() || *found != line )
+        return MatchSpanList();
+
+    const size_t i = found - lines_.begin();
+    const uint32_t end = ( i + 1 < firstSpans_.size() ) ?
+        firstSpans_[i + 1] : spans_.size();
+
+    MatchSpanList spans;
+    spans.reserve( end - firstSpans_[i] );
+    for ( uint32_t j = firstSpans_[i]; j < end; ++j )
+        spans.append( spans_[j] );
+
+    return spans;
+}
+
+void MatchSpanTable::clear()
+{
+    lines_.clear();
+    firstSpans_.clear();
+    spans_.clear();
+}
+
+size_t MatchSpanTable::allocatedSize() const
+{
+    return lines_.capacity() * sizeof( LineNumber )
+        + firstSpans_.capacity() * sizeof( uint32_t )
+        + spans_.capacity() * sizeof( MatchSpan );
+}
 
 void SearchData::getAll( int* length, SearchResultArray* matches,
         qint64* lines) const
@@ -49,7 +140,8 @@ void SearchData::setAll( int length,
 }
 
 void SearchData::addAll( int length,
-        const SearchResultArray& matches, LineNumber lines )
+        const SearchResultArray& matches, LineNumber lines,
+        const MatchSpanTable* spans )
 {
     QMutexLocker locker( &dataMutex_ );
 
@@ -60,6 +152,23 @@ void SearchData::addAll( int length,
     // linear.
     matches_.insert( std::end( matches_ ),
             std::begin( matches ), std::end( matches ) );
+
+    if ( spans )
+        spans_.append( *spans );
+}
+
+MatchSpanList SearchData::getMatchSpans( LineNumber line ) const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return spans_.get( line );
+}
+
+size_t SearchData::getMatchSpansSize() const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return spans_.allocatedSize();
 }
 
 LineNumber SearchData::getNbMatches() const
@@ -96,14 +205,17 @@ void SearchData::clear()
     maxLength_        = 0;
     nbLinesProcessed_ = 0;
     matches_.clear();
+    spans_.clear();
 }
 
 LogFilteredDataWorkerThread::LogFilteredDataWorkerThread(
-        const LogData* sourceLogData )
-    : QThread(), mutex_(), operationRequestedCond_(), nothingToDoCond_(), searchData_()
+        const AbstractLogSource* sourceLogData )
+    : QObject(), mutex_(), nothingToDoCond_(),
+    taskId_( 0 ), foreground_( false ), searchData_(),
+    fieldIndex_( new FieldIndex() )
 {
-    terminate_          = false;
     interruptRequested_ = false;
+    recordMatchSpans_   = false;
     operationRequested_ = NULL;
 
     sourceLogData_ = sourceLogData;
@@ -111,44 +223,70 @@ LogFilteredDataWorkerThread::LogFilteredDataWorkerThread(
 
 LogFilteredDataWorkerThread::~LogFilteredDataWorkerThread()
 {
-    {
-        QMutexLocker locker( &mutex_ );
-        terminate_ = true;
-        operationRequestedCond_.wakeAll();
-    }
-    wait();
+    interrupt();
 }
 
 void LogFilteredDataWorkerThread::search( const QRegularExpression& regExp )
 {
-    QMutexLocker locker( &mutex_ );  // to protect operationRequested_
-
     LOG(logDEBUG) << "Search requested";
 
-    // If an operation is ongoing, we will block
-    while ( (operationRequested_ != NULL) )
-        nothingToDoCond_.wait( &mutex_ );
-
-    interruptRequested_ = false;
-    operationRequested_ = new FullSearchOperation( sourceLogData_,
-            regExp, &interruptRequested_ );
-    operationRequestedCond_.wakeAll();
+    startOperation( new FullSearchOperation( sourceLogData_,
+                regExp, recordMatchSpans_, &interruptRequested_ ) );
 }
 
 void LogFilteredDataWorkerThread::updateSearch(const QRegularExpression &regExp, qint64 position )
 {
-    QMutexLocker locker( &mutex_ );  // to protect operationRequested_
+    LOG(logDEBUG) << "Search update requested";
 
-    LOG(logDEBUG) << "Search requested";
+    startOperation( new UpdateSearchOperation( sourceLogData_,
+                regExp, recordMatchSpans_, &interruptRequested_, position ) );
+}
 
-    // If an operation is ongoing, we will block
+void LogFilteredDataWorkerThread::search( const FieldQuery& query )
+{
+    LOG(logDEBUG) << "Field search requested";
+
+    startOperation( new FieldSearchOperation( sourceLogData_,
+                query, fieldIndex_.get(), &interruptRequested_, -1 ) );
+}
+
+void LogFilteredDataWorkerThread::updateSearch( const FieldQuery& query, qint64 position )
+{
+    LOG(logDEBUG) << "Field search update requested";
+
+    startOperation( new FieldSearchOperation( sourceLogData_,
+                query, fieldIndex_.get(), &interruptRequested_, position ) );
+}
+
+void LogFilteredDataWorkerThread::search(
+        const std::shared_ptr<const TemplateIndex>& templateIndex,
+        const std::vector<bool>& selected )
+{
+    LOG(logDEBUG) << "Template search requested";
+
+    startOperation( new TemplateSearchOperation( sourceLogData_,
+                templateIndex, selected, &interruptRequested_, -1 ) );
+}
+
+void LogFilteredDataWorkerThread::updateSearch(
+        const std::shared_ptr<const TemplateIndex>& templateIndex,
+        const std::vector<bool>& selected, qint64 position )
+{
+    LOG(logDEBUG) << "Template search update requested";
+
+    startOperation( new TemplateSearchOperation( sourceLogData_,
+                templateIndex, selected, &interruptRequested_, position ) );
+}
+
+void LogFilteredDataWorkerThread::clearFieldIndex()
+{
+    QMutexLocker locker( &mutex_ );
+
+    // The index is used by the operation running
     while ( (operationRequested_ != NULL) )
         nothingToDoCond_.wait( &mutex_ );
 
-    interruptRequested_ = false;
-    operationRequested_ = new UpdateSearchOperation( sourceLogData_,
-            regExp, &interruptRequested_, position );
-    operationRequestedCond_.wakeAll();
+    fieldIndex_->clear();
 }
 
 void LogFilteredDataWorkerThread::interrupt()
@@ -158,12 +296,42 @@ void LogFilteredDataWorkerThread::interrupt()
     // No mutex here, setting a bool is probably atomic!
     interruptRequested_ = true;
 
-    // We wait for the interruption to be done
-    {
-        QMutexLocker locker( &mutex_ );
-        while ( (operationRequested_ != NULL) )
-            nothingToDoCond_.wait( &mutex_ );
+    QMutexLocker locker( &mutex_ );
+
+    // A search still waiting for a thread is simply dropped
+    if ( operationRequested_ &&
+            TaskScheduler::instance().cancel( taskId_ ) ) {
+        operationRequested_->cancel( searchData_ );
+        delete operationRequested_;
+        operationRequested_ = NULL;
+        nothingToDoCond_.wakeAll();
     }
+
+    // We wait for the interruption to be done
+    while ( (operationRequested_ != NULL) )
+        nothingToDoCond_.wait( &mutex_ );
+}
+
+void LogFilteredDataWorkerThread::setForeground( bool foreground )
+{
+    foreground_ = foreground;
+}
+
+void LogFilteredDataWorkerThread::setMatchSpansRecorded( bool record )
+{
+    QMutexLocker locker( &mutex_ );
+
+    recordMatchSpans_ = record;
+}
+
+MatchSpanList LogFilteredDataWorkerThread::getMatchSpans( LineNumber line ) const
+{
+    return searchData_.getMatchSpans( line );
+}
+
+size_t LogFilteredDataWorkerThread::getMatchSpansSize() const
+{
+    return searchData_.getMatchSpansSize();
 }
 
 // This will do an atomic copy of the object
@@ -173,44 +341,69 @@ void LogFilteredDataWorkerThread::getSearchResult(
     searchData_.getAll( maxLength, searchMatches, nbLinesProcessed );
 }
 
-// This is the thread's main loop
-void LogFilteredDataWorkerThread::run()
-{
-    QMutexLocker locker( &mutex_ );
+//
+// Private functions
+//
 
-    forever {
-        while ( (terminate_ == false) && (operationRequested_ == NULL) )
-            operationRequestedCond_.wait( &mutex_ );
-        LOG(logDEBUG) << "Worker thread signaled";
+// Wait for the operation in progress (if any) and start the passed one,
+// which is then owned by the thread.
+void LogFilteredDataWorkerThread::startOperation( SearchOperation* operation )
+{
+    QMutexLocker locker( &mutex_ );  // to protect operationRequested_
 
-        // Look at what needs to be done
-        if ( terminate_ )
-            return;      // We must die
+    // If an operation is ongoing, we will block
+    while ( (operationRequested_ != NULL) )
+        nothingToDoCond_.wait( &mutex_ );
 
-        if ( operationRequested_ ) {
-            connect( operationRequested_, SIGNAL( searchProgressed( int, int, qint64 ) ),
-                    this, SIGNAL( searchProgressed( int, int, qint64 ) ) );
+    interruptRequested_ = false;
+    operationRequested_ = operation;
+    submitOperation();
+}
 
-            // Run the search operation
-            operationRequested_->start( searchData_ );
+// Called with mutex_ held
+void LogFilteredDataWorkerThread::submitOperation()
+{
+    connect( operationRequested_, SIGNAL( searchProgressed( int, int, qint64 ) ),
+            this, SIGNAL( searchProgressed( int, int, qint64 ) ) );
 
-            LOG(logDEBUG) << "... finished copy in workerThread.";
+    taskId_ = TaskScheduler::instance().submit( TaskPriority::Search,
+            &foreground_, [this] { runOperation(); } );
+}
 
-            emit searchFinished();
-            delete operationRequested_;
-            operationRequested_ = NULL;
-            nothingToDoCond_.wakeAll();
-        }
+// Run in a thread of the scheduler, the operation can only be
+// replaced once it is finished so mutex_ is not held while it runs.
+void LogFilteredDataWorkerThread::runOperation()
+{
+    SearchOperation* operation;
+    {
+        QMutexLocker locker( &mutex_ );
+        operation = operationRequested_;
     }
+
+    LOG(logDEBUG) << "Search task started";
+
+    // Run the search operation
+    operation->start( searchData_ );
+
+    LOG(logDEBUG) << "... finished copy in workerThread.";
+
+    emit searchFinished();
+
+    QMutexLocker locker( &mutex_ );
+    delete operationRequested_;
+    operationRequested_ = NULL;
+    nothingToDoCond_.wakeAll();
 }
 
 //
 // Operations implementation
 //
 
-SearchOperation::SearchOperation( const LogData* sourceLogData,
-        const QRegularExpression& regExp, bool* interruptRequest )
-    : regexp_( regExp ), sourceLogData_( sourceLogData )
+SearchOperation::SearchOperation( const AbstractLogSource* sourceLogData,
+        const QRegularExpression& regExp, bool recordSpans,
+        bool* interruptRequest )
+    : regexp_( regExp ), recordSpans_( recordSpans ),
+    sourceLogData_( sourceLogData )
 {
     interruptRequested_ = interruptRequest;
 }
@@ -218,9 +411,27 @@ SearchOperation::SearchOperation( const LogData* sourceLogData,
 void SearchOperation::doSearch( SearchData& searchData, qint64 initialLine )
 {
     const qint64 nbSourceLines = sourceLogData_->getNbLine();
+
+    // The parts of the source that are left to search
+    std::vector<std::pair<qint64, qint64>> parts;
+    const std::vector<qint64> partitions = sourceLogData_->getSearchPartitions();
+    for ( size_t p = 0; p < partitions.size(); ++p ) {
+        const qint64 begin = qMax( partitions[p], initialLine );
+        const qint64 end = ( p + 1 < partitions.size() ) ?
+            qMin( partitions[p + 1], nbSourceLines ) : nbSourceLines;
+        if ( begin < end )
+            parts.push_back( { begin, end } );
+    }
+
+    if ( parts.size() > 1 ) {
+        doParallelSearch( searchData, initialLine, parts );
+        return;
+    }
+
     int maxLength = 0;
     int nbMatches = searchData.getNbMatches();
     SearchResultArray currentList = SearchResultArray();
+    MatchSpanTable currentSpans;
 
     // Ensure no re-alloc will be done
     currentList.reserve( nbLinesInChunk );
@@ -239,27 +450,179 @@ void SearchOperation::doSearch( SearchData& searchData, qint64 initialLine )
         LOG(logDEBUG) << "Chunk starting at " << i <<
             ", " << lines.size() << " lines read.";
 
-        int j = 0;
-        for ( ; j < lines.size(); j++ ) {
-            if ( regexp_.match( lines[j] ).hasMatch() ) {
-                // FIXME: increase perf by removing temporary
-                const int length = sourceLogData_->getExpandedLineString(i+j).length();
-                if ( length > maxLength )
-                    maxLength = length;
-                currentList.push_back( MatchingLine( i+j ) );
-                nbMatches++;
-            }
-        }
+        maxLength = qMax( maxLength, searchLines( lines, i, &currentList, &currentSpans ) );
+        nbMatches += currentList.size();
 
         // After each block, copy the data to shared data
         // and update the client
-        searchData.addAll( maxLength, currentList, i+j );
+        searchData.addAll( maxLength, currentList, i + lines.size(),
+                recordSpans_ ? &currentSpans : nullptr );
         currentList.clear();
+        currentSpans.clear();
     }
 
     emit searchProgressed( nbMatches, 100, initialLine );
 }
 
+void SearchOperation::doParallelSearch( SearchData& searchData, qint64 initialLine,
+        const std::vector<std::pair<qint64, qint64>>& parts )
+{
+    struct PartResult {
+        SearchResultArray matches;
+        MatchSpanTable spans;
+        int maxLength = 0;
+        // Where the search of the part stopped (if interrupted)
+        qint64 endLine = 0;
+        bool done = false;
+    };
+
+    const qint64 nbSourceLines = parts.back().second;
+    std::vector<PartResult> results( parts.size() );
+
+    LOG(logDEBUG) << "Searching " << parts.size() << " parts from line "
+        << initialLine << " to " << nbSourceLines;
+
+    // The parts are taken in order by helper tasks on the scheduler and by
+    // this task itself when the result it needs next is not ready, so the
+    // search progresses even if all the threads of the scheduler are busy.
+    std::mutex mutex;
+    std::condition_variable part_done;
+    std::atomic<size_t> next_part { 0 };
+    auto search_part = [&]( size_t p ) {
+        PartResult& result = results[p];
+        qint64 i = parts[p].first;
+        while ( i < parts[p].second && ! *interruptRequested_ ) {
+            const QStringList lines = sourceLogData_->getLines( i,
+                    qMin<qint64>( nbLinesInChunk, parts[p].second - i ) );
+            if ( lines.isEmpty() )
+                break;
+            result.maxLength = qMax( result.maxLength,
+                    searchLines( lines, i, &result.matches, &result.spans ) );
+            i += lines.size();
+        }
+
+        std::lock_guard<std::mutex> lock( mutex );
+        result.endLine = i;
+        result.done = true;
+        part_done.notify_all();
+    };
+    auto search_parts = [&]() {
+        size_t p;
+        while ( ( p = next_part++ ) < parts.size() )
+            search_part( p );
+    };
+
+    TaskScheduler& scheduler = TaskScheduler::instance();
+    TaskGroup helpers( scheduler, TaskPriority::Search );
+    helpers.submit( std::min<size_t>( parts.size(), scheduler.nbThreads() ) - 1,
+            search_parts );
+
+    // The results are added in order, so the matches stay sorted
+    int maxLength = 0;
+    int nbMatches = searchData.getNbMatches();
+    for ( size_t p = 0; p < parts.size(); ++p ) {
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock( mutex );
+                if ( results[p].done )
+                    break;
+            }
+
+            const size_t own_part = next_part++;
+            if ( own_part < parts.size() ) {
+                search_part( own_part );
+            }
+            else {
+                std::unique_lock<std::mutex> lock( mutex );
+                part_done.wait( lock, [&]() { return results[p].done; } );
+                break;
+            }
+        }
+
+        maxLength = qMax( maxLength, results[p].maxLength );
+        nbMatches += results[p].matches.size();
+        searchData.addAll( maxLength, results[p].matches, results[p].endLine,
+                recordSpans_ ? &results[p].spans : nullptr );
+        results[p].matches = SearchResultArray();
+        results[p].spans = MatchSpanTable();
+
+        const int percentage = ( results[p].endLine - initialLine ) * 100
+            / ( nbSourceLines - initialLine );
+        emit searchProgressed( nbMatches, percentage, initialLine );
+
+        // If the part has not been fully searched, the next ones can't
+        // be added
+        if ( results[p].endLine < parts[p].second )
+            break;
+    }
+
+    // Stop the helpers still searching (if we broke out), the ones
+    // not started are removed from the queue, the others waited for.
+    const bool interrupted = *interruptRequested_;
+    next_part = parts.size();
+    helpers.cancelAndWait();
+
+    if ( ! interrupted )
+        emit searchProgressed( nbMatches, 100, initialLine );
+}
+
+int SearchOperation::searchLines( const QStringList& lines, qint64 first_line,
+        SearchResultArray* matches, MatchSpanTable* spans_table ) const
+{
+    TRACE_SPAN( "search", "LogFilteredData search chunk", lines.size() );
+
+    int maxLength = 0;
+
+    for ( int j = 0; j < lines.size(); j++ ) {
+        MatchSpanList spans;
+        if ( matchLine( lines[j], &spans ) ) {
+            const int length = expandedColumn( lines[j], lines[j].length() );
+            if ( length > maxLength )
+                maxLength = length;
+            matches->push_back( MatchingLine( first_line + j ) );
+            if ( ! spans.isEmpty() )
+                spans_table->append( first_line + j, spans );
+        }
+    }
+
+    return maxLength;
+}
+
+bool SearchOperation::matchLine( const QString& line,
+        MatchSpanList* spans ) const
+{
+    if ( ! recordSpans_ )
+        return regexp_.match( line ).hasMatch();
+
+    QRegularExpressionMatchIterator matches = regexp_.globalMatch( line );
+    if ( ! matches.hasNext() )
+        return false;
+
+    const bool has_tabs = line.contains( '\t' );
+    while ( matches.hasNext() ) {
+        const QRegularExpressionMatch match = matches.next();
+
+        int start = match.capturedStart();
+        int end   = match.capturedEnd();
+        if ( has_tabs ) {
+            start = expandedColumn( line, start );
+            end   = expandedColumn( line, end );
+        }
+
+        // Spans we can't store are all dropped, the client
+        // will have to find them itself.
+        if ( ( spans->size() >= maxSpansPerLine )
+                || ! MatchSpan::fits( start, end - start ) ) {
+            spans->clear();
+            break;
+        }
+
+        spans->append( MatchSpan( start, end - start ) );
+    }
+
+    return true;
+}
+
 // Called in the worker thread's context
 void FullSearchOperation::start( SearchData& searchData )
 {
@@ -269,6 +632,12 @@ void FullSearchOperation::start( SearchData& searchData )
     doSearch( searchData, 0 );
 }
 
+void FullSearchOperation::cancel( SearchData& searchData )
+{
+    // The previous results are not valid anymore
+    searchData.clear();
+}
+
 // Called in the worker thread's context
 void UpdateSearchOperation::start( SearchData& searchData )
 {
@@ -284,3 +653,71 @@ void UpdateSearchOperation::start( SearchData& searchData )
 
     doSearch( searchData, initial_line );
 }
+
+// Called in the worker thread's context
+void FieldSearchOperation::start( SearchData& searchData )
+{
+    qint64 initial_line = 0;
+
+    if ( initialPosition_ < 0 ) {
+        searchData.clear();
+    }
+    else if ( initialPosition_ >= 1 ) {
+        // As for the regexp search, the last line is searched again
+        initial_line = initialPosition_ - 1;
+        searchData.deleteMatch( initial_line );
+    }
+    const int nbMatches = searchData.getNbMatches();
+
+    // The indexing is most of the work, the matching is done in one go
+    const bool indexed = fieldIndex_->update( sourceLogData_, query_.keys(),
+            interruptRequested_, [&]( int percent ) {
+                emit searchProgressed( nbMatches, percent * 9 / 10, initial_line );
+            } );
+    if ( ! indexed )
+        return;
+
+    SearchResultArray matches;
+    const LineNumber nbLines = fieldIndex_->getNbLines();
+    const int maxLength = fieldIndex_->match( query_, initial_line, nbLines, &matches );
+    searchData.addAll( maxLength, matches, nbLines );
+
+    LOG(logDEBUG) << "Field search from line " << initial_line << " found "
+        << matches.size() << " matches";
+
+    emit searchProgressed( nbMatches + matches.size(), 100, initial_line );
+}
+
+void FieldSearchOperation::cancel( SearchData& searchData )
+{
+    if ( initialPosition_ < 0 )
+        searchData.clear();
+}
+
+// Called in the worker thread's context
+void TemplateSearchOperation::start( SearchData& searchData )
+{
+    if ( initialPosition_ < 0 )
+        searchData.clear();
+
+    // The index is not updated by the searches, so an update only
+    // searches the lines indexed but not searched yet (if any).
+    const LineNumber nbLines = templateIndex_->getNbLines();
+    const qint64 initial_line = qMin<qint64>( qMax<qint64>( initialPosition_, 0 ), nbLines );
+    const int nbMatches = searchData.getNbMatches();
+
+    SearchResultArray matches;
+    const int maxLength = templateIndex_->match( selected_, initial_line, nbLines, &matches );
+    searchData.addAll( maxLength, matches, nbLines );
+
+    LOG(logDEBUG) << "Template search from line " << initial_line << " found "
+        << matches.size() << " matches";
+
+    emit searchProgressed( nbMatches + matches.size(), 100, initial_line );
+}
+
+void TemplateSearchOperation::cancel( SearchData& searchData )
+{
+    if ( initialPosition_ < 0 )
+        searchData.clear();
+}
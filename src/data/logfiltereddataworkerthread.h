@@ -20,20 +20,85 @@
 #ifndef LOGFILTEREDDATAWORKERTHREAD_H
 #define LOGFILTEREDDATAWORKERTHREAD_H
 
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include <QObject>
-#include <QThread>
 #include <QMutex>
 #include <QWaitCondition>
 #include <QRegularExpression>
 #include <QList>
+#include <QVector>
+
+#include "taskscheduler.h"
+#include "fieldquery.h"
 
-class LogData;
+class AbstractLogSource;
+class FieldIndex;
+class TemplateIndex;
 
 // Line number are unsigned 32 bits for now.
 typedef uint32_t LineNumber;
 
+// Position of a match within a line, in the expanded (untabified) line.
+// The start column and length are packed in 32 bits, spans which
+// don't fit are not recorded.
+class MatchSpan {
+  public:
+    MatchSpan() { packed_ = 0; }
+    MatchSpan( int start_column, int length )
+    { packed_ = ( static_cast<uint32_t>( start_column ) << LENGTH_BITS ) | length; }
+
+    // Returns whether a span can be stored
+    static bool fits( int start_column, int length )
+    { return ( start_column >= 0 ) && ( start_column < ( 1 << START_BITS ) )
+        && ( length > 0 ) && ( length < ( 1 << LENGTH_BITS ) ); }
+
+    // Accessors
+    int startColumn() const { return packed_ >> LENGTH_BITS; }
+    int length() const { return packed_ & ( ( 1 << LENGTH_BITS ) - 1 ); }
+
+  private:
+    static const int LENGTH_BITS = 10;
+    static const int START_BITS = 22;
+
+    uint32_t packed_;
+};
+
+// The spans of all the matches in a line
+typedef QVector<MatchSpan> MatchSpanList;
+
+// The spans of the matches of a search, kept apart from the matching
+// lines as only the searches displayed record them.
+// The lines are added in increasing order, adding a line replaces
+// the ones from it (e.g. the last line searched again by an update).
+class MatchSpanTable {
+  public:
+    MatchSpanTable() : lines_(), firstSpans_(), spans_() {}
+
+    // Add the spans of the matches in line
+    void append( LineNumber line, const MatchSpanList& spans );
+    // Add the lines of another table
+    void append( const MatchSpanTable& other );
+    // Returns the spans of the matches in line, empty if they have
+    // not been recorded
+    MatchSpanList get( LineNumber line ) const;
+    void clear();
+
+    // Returns the memory used (in bytes)
+    size_t allocatedSize() const;
+
+  private:
+    std::vector<LineNumber> lines_;
+    // Position in spans_ of the first span of each line
+    std::vector<uint32_t> firstSpans_;
+    std::vector<MatchSpan> spans_;
+};
+
 // Class encapsulating a single matching line
-// Contains the line number the line was found in and its content.
+// Contains the line number the line was found in.
 class MatchingLine {
   public:
     MatchingLine( LineNumber line ) { lineNumber_ = line; };
@@ -67,8 +132,14 @@ class SearchData
     // (overwriting the existing)
     // (the matches are always moved)
     void setAll( int length, SearchResultArray&& matches );
-    // Atomically add to all the existing search data.
-    void addAll( int length, const SearchResultArray& matches, LineNumber nbLinesProcessed );
+    // Atomically add to all the existing search data
+    // (and the spans of the matches if they are recorded).
+    void addAll( int length, const SearchResultArray& matches,
+            LineNumber nbLinesProcessed, const MatchSpanTable* spans = nullptr );
+    // Get the spans of the matches in line (if recorded)
+    MatchSpanList getMatchSpans( LineNumber line ) const;
+    // Get the memory used by the spans (in bytes)
+    size_t getMatchSpansSize() const;
     // Get the number of matches
     LineNumber getNbMatches() const;
     // Delete the match for the passed line (if it exist)
@@ -80,6 +151,7 @@ class SearchData
     mutable QMutex dataMutex_;
 
     SearchResultArray matches_;
+    MatchSpanTable spans_;
     int maxLength_;
     LineNumber nbLinesProcessed_;
 };
@@ -88,45 +160,68 @@ class SearchOperation : public QObject
 {
   Q_OBJECT
   public:
-    SearchOperation(const LogData* sourceLogData,
-            const QRegularExpression &regExp, bool* interruptRequest );
+    SearchOperation(const AbstractLogSource* sourceLogData,
+            const QRegularExpression &regExp, bool recordSpans,
+            bool* interruptRequest );
 
     virtual ~SearchOperation() { }
 
     // Start the search operation, returns true if it has been done
     // and false if it has been cancelled (results not copied)
     virtual void start( SearchData& result ) = 0;
+    // Called instead of start() if the operation is interrupted
+    // before being started, leaves the results as an interrupted
+    // search would.
+    virtual void cancel( SearchData& ) { }
 
   signals:
     void searchProgressed( int percent, int nbMatches, qint64 started );
 
   protected:
     static const int nbLinesInChunk;
+    // Lines with more matches than this don't get their spans recorded
+    static const int maxSpansPerLine;
 
     // Implement the common part of the search, passing
     // the shared results and the line to begin the search from.
     void doSearch( SearchData& result, qint64 initialLine );
+    // Search the passed parts of the source (pairs of first/end lines)
+    // in parallel, the results are added in order as the parts finish.
+    void doParallelSearch( SearchData& result, qint64 initialLine,
+            const std::vector<std::pair<qint64, qint64>>& parts );
+
+    // Add the matches found in the lines passed (read from first_line)
+    // to the passed list (and their spans to the table if recorded),
+    // returns the length of the longest match.
+    int searchLines( const QStringList& lines, qint64 first_line,
+            SearchResultArray* matches, MatchSpanTable* spans ) const;
+
+    // Returns whether the line matches, recording the spans of
+    // the matches in the passed list if requested.
+    bool matchLine( const QString& line, MatchSpanList* spans ) const;
 
     bool* interruptRequested_;
     const QRegularExpression regexp_;
-    const LogData* sourceLogData_;
+    const bool recordSpans_;
+    const AbstractLogSource* sourceLogData_;
 };
 
 class FullSearchOperation : public SearchOperation
 {
   public:
-    FullSearchOperation( const LogData* sourceLogData, const QRegularExpression& regExp,
-            bool* interruptRequest )
-        : SearchOperation( sourceLogData, regExp, interruptRequest ) {}
+    FullSearchOperation( const AbstractLogSource* sourceLogData, const QRegularExpression& regExp,
+            bool recordSpans, bool* interruptRequest )
+        : SearchOperation( sourceLogData, regExp, recordSpans, interruptRequest ) {}
     virtual void start( SearchData& result );
+    virtual void cancel( SearchData& result );
 };
 
 class UpdateSearchOperation : public SearchOperation
 {
   public:
-    UpdateSearchOperation( const LogData* sourceLogData, const QRegularExpression& regExp,
-            bool* interruptRequest, qint64 position )
-        : SearchOperation( sourceLogData, regExp, interruptRequest ),
+    UpdateSearchOperation( const AbstractLogSource* sourceLogData, const QRegularExpression& regExp,
+            bool recordSpans, bool* interruptRequest, qint64 position )
+        : SearchOperation( sourceLogData, regExp, recordSpans, interruptRequest ),
         initialPosition_( position ) {}
     virtual void start( SearchData& result );
 
@@ -134,17 +229,59 @@ class UpdateSearchOperation : public SearchOperation
     qint64 initialPosition_;
 };
 
-// Create and manage the thread doing loading/indexing for
-// the creating LogData. One LogDataWorkerThread is used
-// per LogData instance.
-// Note everything except the run() function is in the LogData's
-// thread.
-class LogFilteredDataWorkerThread : public QThread
+// Search of the lines matching a field query, run against the field
+// index (which is updated first).
+class FieldSearchOperation : public SearchOperation
+{
+  public:
+    // The search is a full one if position is -1, else it continues
+    // the previous one from position.
+    FieldSearchOperation( const AbstractLogSource* sourceLogData, const FieldQuery& query,
+            FieldIndex* fieldIndex, bool* interruptRequest, qint64 position )
+        : SearchOperation( sourceLogData, QRegularExpression(), false, interruptRequest ),
+        query_( query ), fieldIndex_( fieldIndex ), initialPosition_( position ) {}
+    virtual void start( SearchData& result );
+    virtual void cancel( SearchData& result );
+
+  private:
+    const FieldQuery query_;
+    FieldIndex* fieldIndex_;
+    qint64 initialPosition_;
+};
+
+// Search of the lines of some templates, run against a template index
+// (the lines past the ones indexed are not searched).
+class TemplateSearchOperation : public SearchOperation
+{
+  public:
+    // The search is a full one if position is -1, else it continues
+    // the previous one from position.
+    TemplateSearchOperation( const AbstractLogSource* sourceLogData,
+            const std::shared_ptr<const TemplateIndex>& templateIndex,
+            const std::vector<bool>& selected, bool* interruptRequest, qint64 position )
+        : SearchOperation( sourceLogData, QRegularExpression(), false, interruptRequest ),
+        templateIndex_( templateIndex ), selected_( selected ),
+        initialPosition_( position ) {}
+    virtual void start( SearchData& result );
+    virtual void cancel( SearchData& result );
+
+  private:
+    const std::shared_ptr<const TemplateIndex> templateIndex_;
+    const std::vector<bool> selected_;
+    qint64 initialPosition_;
+};
+
+// Manage the searches for the creating LogFilteredData.
+// One LogFilteredDataWorkerThread is used per LogFilteredData instance,
+// the searches are run by the shared TaskScheduler.
+// Note everything except the runOperation() function is in the
+// LogFilteredData's thread.
+class LogFilteredDataWorkerThread : public QObject
 {
   Q_OBJECT
 
   public:
-    LogFilteredDataWorkerThread( const LogData* sourceLogData );
+    LogFilteredDataWorkerThread( const AbstractLogSource* sourceLogData );
     ~LogFilteredDataWorkerThread();
 
     // Start the search with the passed regexp
@@ -152,8 +289,30 @@ class LogFilteredDataWorkerThread : public QThread
     // Continue the previous search starting at the passed position
     // in the source file (line number)
     void updateSearch( const QRegularExpression& regExp, qint64 position );
+    // Same for a search of the lines matching the passed field query
+    void search( const FieldQuery& query );
+    void updateSearch( const FieldQuery& query, qint64 position );
+    // Same for a search of the lines whose template (in the passed
+    // index) is selected
+    void search( const std::shared_ptr<const TemplateIndex>& templateIndex,
+            const std::vector<bool>& selected );
+    void updateSearch( const std::shared_ptr<const TemplateIndex>& templateIndex,
+            const std::vector<bool>& selected, qint64 position );
+    // Drop the field index (e.g. when the file has been truncated),
+    // it will be rebuilt by the next field search.
+    void clearFieldIndex();
     // Interrupts the search if one is in progress
     void interrupt();
+    // Tells whether the file is the one displayed, its searches
+    // are then run before the other files'.
+    void setForeground( bool foreground );
+    // Set whether the next searches record the position of the
+    // matches within the lines (default is no)
+    void setMatchSpansRecorded( bool record );
+    // Returns the position of the matches within line (if recorded)
+    MatchSpanList getMatchSpans( LineNumber line ) const;
+    // Returns the memory used by the positions recorded (in bytes)
+    size_t getMatchSpansSize() const;
 
     // Returns a copy of the current indexing data
     void getSearchResult( int* maxLength, SearchResultArray* searchMatches,
@@ -167,24 +326,33 @@ class LogFilteredDataWorkerThread : public QThread
     // to copy the new data back.
     void searchFinished();
 
-  protected:
-    void run();
-
   private:
-    const LogData* sourceLogData_;
+    // Replace the operation requested by the passed one once the
+    // current one is done, and submit it
+    void startOperation( SearchOperation* operation );
+    // Submit the operation requested to the scheduler
+    void submitOperation();
+    // Run the operation requested (in a thread of the scheduler)
+    void runOperation();
+
+    const AbstractLogSource* sourceLogData_;
 
     // Mutex to protect operationRequested_ and friends
     QMutex mutex_;
-    QWaitCondition operationRequestedCond_;
     QWaitCondition nothingToDoCond_;
 
-    // Set when the thread must die
-    bool terminate_;
     bool interruptRequested_;
+    bool recordMatchSpans_;
     SearchOperation* operationRequested_;
+    // Id of the task running operationRequested_
+    TaskScheduler::TaskId taskId_;
+    std::atomic<bool> foreground_;
 
     // Shared indexing data
     SearchData searchData_;
+
+    // Only used by the operations, which run one at a time
+    std::unique_ptr<FieldIndex> fieldIndex_;
 };
 
 #endif
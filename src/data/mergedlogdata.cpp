@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements MergedLogData, a set of files displayed
+// as a single log in timestamp order.
+
+#include "mergedlogdata.h"
+
+#include <QThread>
+
+#include "log.h"
+
+#include "logdata.h"
+
+MergedLogData::MergedLogData() : CompositeLogData(),
+    mergeThread_( members_ ),
+    membersStatus_( LoadingStatus::Successful ),
+    restartNeeded_( false )
+{
+    connect( &mergeThread_, SIGNAL( mergeProgressed( int ) ),
+            this, SIGNAL( loadingProgressed( int ) ) );
+    connect( &mergeThread_, SIGNAL( mergeFinished( LoadingStatus ) ),
+            this, SLOT( mergeFinished( LoadingStatus ) ) );
+}
+
+MergedLogData::~MergedLogData()
+{
+}
+
+//
+// Slots
+//
+
+void MergedLogData::mergeFinished( LoadingStatus status )
+{
+    LOG(logDEBUG) << "MergedLogData: " << doGetNbLine() << " lines merged";
+
+    if ( status == LoadingStatus::Successful )
+        status = membersStatus_;
+
+    emit loadingFinished( status );
+}
+
+//
+// Protected functions
+//
+
+void MergedLogData::membersLoaded( LoadingStatus status )
+{
+    membersStatus_ = status;
+
+    mergeThread_.merge( restartNeeded_ );
+    restartNeeded_ = false;
+}
+
+AbstractLogSource::MonitoredFileStatus MergedLogData::memberChanged(
+        int, MonitoredFileStatus status )
+{
+    // The lines of a truncated/rewritten file are everywhere in the
+    // merged view, the merge is redone once the file is reindexed.
+    if ( status == Truncated || status == Rewritten ) {
+        mergeThread_.interrupt();
+        restartNeeded_ = true;
+        return Rewritten;
+    }
+    else
+        return status;
+}
+
+//
+// Implementation of virtual functions
+//
+
+QString MergedLogData::doGetLineString( qint64 line ) const
+{
+    MergedLine merged;
+    if ( ! mergeThread_.index().getLine( line, &merged ) )
+        return QString();
+
+    return members_[merged.source]->getLineString( merged.line );
+}
+
+QString MergedLogData::doGetExpandedLineString( qint64 line ) const
+{
+    MergedLine merged;
+    if ( ! mergeThread_.index().getLine( line, &merged ) )
+        return QString();
+
+    return members_[merged.source]->getExpandedLineString( merged.line );
+}
+
+QStringList MergedLogData::doGetLines( qint64 first_line, int number ) const
+{
+    return getLinesFromFiles( first_line, number, false );
+}
+
+QStringList MergedLogData::doGetExpandedLines( qint64 first_line, int number ) const
+{
+    return getLinesFromFiles( first_line, number, true );
+}
+
+qint64 MergedLogData::doGetNbLine() const
+{
+    return mergeThread_.index().getNbLines();
+}
+
+int MergedLogData::doGetLineLength( qint64 line ) const
+{
+    MergedLine merged;
+    if ( ! mergeThread_.index().getLine( line, &merged ) )
+        return 0;
+
+    return members_[merged.source]->getLineLength( merged.line );
+}
+
+void MergedLogData::doInterruptLoading()
+{
+    CompositeLogData::doInterruptLoading();
+    mergeThread_.interrupt();
+}
+
+void MergedLogData::doReload()
+{
+    mergeThread_.interrupt();
+    restartNeeded_ = true;
+
+    CompositeLogData::doReload();
+}
+
+void MergedLogData::doSetForeground( bool foreground )
+{
+    CompositeLogData::doSetForeground( foreground );
+    mergeThread_.setForeground( foreground );
+}
+
+// The merged lines are searched in equal slices
+std::vector<qint64> MergedLogData::doGetSearchPartitions() const
+{
+    const qint64 nb_lines = doGetNbLine();
+    const int nb_slices = qMax( 1, QThread::idealThreadCount() );
+
+    std::vector<qint64> partitions;
+    for ( int i = 0; i < nb_slices; ++i )
+        partitions.push_back( nb_lines * i / nb_slices );
+
+    return partitions;
+}
+
+int MergedLogData::doGetLineSource( qint64 line ) const
+{
+    MergedLine merged;
+    if ( ! mergeThread_.index().getLine( line, &merged ) )
+        return -1;
+
+    return merged.source;
+}
+
+//
+// Private functions
+//
+
+QStringList MergedLogData::getLinesFromFiles( qint64 first_line, int number,
+        bool expanded ) const
+{
+    const std::vector<MergedLine> merged =
+        mergeThread_.index().getLines( first_line, number );
+
+    if ( first_line < 0 || static_cast<int>( merged.size() ) < number ) {
+        LOG(logWARNING) << "MergedLogData::getLines Lines out of bound asked for";
+        return QStringList(); /* exception? */
+    }
+
+    // The lines of each file in the range are consecutive in the file,
+    // they are read at once.
+    std::vector<qint64> first_lines( members_.size(), -1 );
+    std::vector<int> counts( members_.size(), 0 );
+    for ( const auto& line: merged ) {
+        if ( first_lines[line.source] < 0 )
+            first_lines[line.source] = line.line;
+        ++counts[line.source];
+    }
+
+    std::vector<QStringList> file_lines( members_.size() );
+    for ( size_t s = 0; s < members_.size(); ++s ) {
+        if ( counts[s] > 0 )
+            file_lines[s] = expanded ?
+                members_[s]->getExpandedLines( first_lines[s], counts[s] ) :
+                members_[s]->getLines( first_lines[s], counts[s] );
+    }
+
+    QStringList lines;
+    lines.reserve( number );
+    for ( const auto& line: merged ) {
+        // If the file has been truncated since, the missing lines are empty
+        const int index = line.line - first_lines[line.source];
+        if ( index < file_lines[line.source].size() )
+            lines.append( file_lines[line.source][index] );
+        else
+            lines.append( QString() );
+    }
+
+    return lines;
+}
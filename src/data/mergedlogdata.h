@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MERGEDLOGDATA_H
+#define MERGEDLOGDATA_H
+
+#include <vector>
+
+#include "compositelogdata.h"
+#include "mergedlogdataworkerthread.h"
+
+// Represents a set of files displayed as one log, the lines of all
+// the files being interleaved in timestamp order (e.g. the logs of
+// several services taking part in the same operations).
+// The lines without a timestamp stay after the line preceding them
+// in their file.
+// Lines appended to the files are merged together and displayed after
+// the existing ones.
+// This class is thread-safe.
+class MergedLogData : public CompositeLogData {
+  Q_OBJECT
+
+  public:
+    // Creates an empty MergedLogData
+    MergedLogData();
+    ~MergedLogData();
+
+  private slots:
+    // Called when the merge is finished
+    void mergeFinished( LoadingStatus status );
+
+  protected:
+    void membersLoaded( LoadingStatus status ) override;
+    MonitoredFileStatus memberChanged( int index, MonitoredFileStatus status ) override;
+
+  private:
+    // Implementation of virtual functions
+    QString doGetLineString( qint64 line ) const override;
+    QString doGetExpandedLineString( qint64 line ) const override;
+    QStringList doGetLines( qint64 first, int number ) const override;
+    QStringList doGetExpandedLines( qint64 first, int number ) const override;
+    qint64 doGetNbLine() const override;
+    int doGetLineLength( qint64 line ) const override;
+    void doInterruptLoading() override;
+    void doReload() override;
+    void doSetForeground( bool foreground ) override;
+    std::vector<qint64> doGetSearchPartitions() const override;
+    int doGetLineSource( qint64 line ) const override;
+
+    // Get the lines from each file, expanded or not
+    QStringList getLinesFromFiles( qint64 first_line, int number,
+            bool expanded ) const;
+
+    MergeWorkerThread mergeThread_;
+
+    // Status of the indexing of the files, reported at the end of the merge
+    LoadingStatus membersStatus_;
+    // Whether the lines merged so far must be discarded (a file has
+    // been truncated or rewritten)
+    bool restartNeeded_;
+};
+
+#endif
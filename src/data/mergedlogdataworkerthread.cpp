@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "log.h"
+
+#include "mergedlogdataworkerthread.h"
+#include "logdata.h"
+
+// Number of lines in each chunk to read
+const int MergeWorkerThread::nbLinesInChunk = 5000;
+
+qint64 MergeIndex::getNbLines() const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    return lines_.size();
+}
+
+bool MergeIndex::getLine( qint64 index, MergedLine* line ) const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    if ( index < 0 || index >= static_cast<qint64>( lines_.size() ) )
+        return false;
+
+    *line = lines_[index];
+    return true;
+}
+
+std::vector<MergedLine> MergeIndex::getLines( qint64 first, int number ) const
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    const qint64 end = qMin<qint64>( first + number, lines_.size() );
+    if ( first < 0 || first >= end )
+        return std::vector<MergedLine>();
+
+    return std::vector<MergedLine>( lines_.begin() + first, lines_.begin() + end );
+}
+
+void MergeIndex::append( const std::vector<MergedLine>& lines )
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    lines_.insert( lines_.end(), lines.begin(), lines.end() );
+}
+
+void MergeIndex::clear()
+{
+    QMutexLocker locker( &dataMutex_ );
+
+    lines_.clear();
+}
+
+MergeWorkerThread::MergeWorkerThread(
+        const std::vector<std::unique_ptr<LogData>>& sources )
+    : QObject(), sources_( sources ), mutex_(), nothingToDoCond_(),
+    taskId_( 0 ), foreground_( false ), mergeIndex_()
+{
+    interruptRequested_ = false;
+    mergeRequested_     = false;
+    restartRequested_   = false;
+    mergeTaskActive_    = false;
+}
+
+MergeWorkerThread::~MergeWorkerThread()
+{
+    interrupt();
+}
+
+void MergeWorkerThread::merge( bool restart )
+{
+    QMutexLocker locker( &mutex_ );
+
+    LOG(logDEBUG) << "Merge requested (restart: " << restart << ")";
+
+    mergeRequested_ = true;
+    restartRequested_ = restartRequested_ || restart;
+
+    // A task already active will do this merge after the current one
+    if ( ! mergeTaskActive_ ) {
+        mergeTaskActive_ = true;
+        taskId_ = TaskScheduler::instance().submit( TaskPriority::Indexing,
+                &foreground_, [this] { runMerges(); } );
+    }
+}
+
+void MergeWorkerThread::interrupt()
+{
+    LOG(logDEBUG) << "Merge interruption requested";
+
+    QMutexLocker locker( &mutex_ );
+
+    // A pending restart is kept for the next merge
+    mergeRequested_ = false;
+
+    // No mutex needed by the worker here, setting a bool is probably atomic!
+    interruptRequested_ = true;
+
+    // A task not started yet is simply dropped
+    if ( mergeTaskActive_ && TaskScheduler::instance().cancel( taskId_ ) )
+        mergeTaskActive_ = false;
+
+    // We wait for the interruption to be done
+    while ( mergeTaskActive_ )
+        nothingToDoCond_.wait( &mutex_ );
+
+    interruptRequested_ = false;
+}
+
+void MergeWorkerThread::setForeground( bool foreground )
+{
+    foreground_ = foreground;
+
+    if ( foreground )
+        TaskScheduler::instance().foregroundChanged();
+}
+
+//
+// Private functions
+//
+
+// Run in a thread of the scheduler, until no more merge is requested
+void MergeWorkerThread::runMerges()
+{
+    QMutexLocker locker( &mutex_ );
+
+    while ( mergeRequested_ ) {
+        const bool restart = restartRequested_;
+        mergeRequested_    = false;
+        restartRequested_  = false;
+
+        // New requests can be made during the merge
+        locker.unlock();
+
+        if ( restart || mergedLines_.size() != sources_.size() ) {
+            mergeIndex_.clear();
+            resetPositions();
+        }
+
+        const bool finished = doMerge();
+
+        locker.relock();
+
+        emit mergeFinished( finished ?
+                LoadingStatus::Successful : LoadingStatus::Interrupted );
+    }
+
+    mergeTaskActive_ = false;
+    nothingToDoCond_.wakeAll();
+}
+
+bool MergeWorkerThread::doMerge()
+{
+    const size_t nb_sources = sources_.size();
+
+    // The lines to merge in this pass, the lines added to the files
+    // after this point will be merged in the next one.
+    std::vector<qint64> end_lines( nb_sources );
+    qint64 nb_lines_to_merge = 0;
+    for ( size_t s = 0; s < nb_sources; ++s ) {
+        end_lines[s] = qMax( mergedLines_[s], sources_[s]->getNbLine() );
+        nb_lines_to_merge += end_lines[s] - mergedLines_[s];
+    }
+
+    LOG(logDEBUG) << "Merging " << nb_lines_to_merge << " lines from "
+        << nb_sources << " files";
+
+    // The chunk of lines read from each file and its first line
+    std::vector<QStringList> chunks( nb_sources );
+    std::vector<qint64> chunk_first_lines( nb_sources, 0 );
+
+    // The next line of each file, ordered by (timestamp, file),
+    // the earliest one first.
+    typedef std::pair<qint64, uint32_t> Head;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+
+    // Read the next line to merge from the file and add it to the heads
+    auto push_next_line = [&]( uint32_t s ) {
+        const qint64 line = mergedLines_[s];
+        if ( line >= end_lines[s] )
+            return;
+
+        if ( line - chunk_first_lines[s] >= chunks[s].size() ) {
+            chunk_first_lines[s] = line;
+            chunks[s] = sources_[s]->getLines( line,
+                    qMin<qint64>( nbLinesInChunk, end_lines[s] - line ) );
+            if ( chunks[s].isEmpty() ) {
+                // The file has been truncated since, a restart will follow
+                end_lines[s] = line;
+                return;
+            }
+        }
+
+        // Lines without a timestamp stay after the previous line of the file
+        qint64 timestamp = parsers_[s].parse( chunks[s][line - chunk_first_lines[s]] );
+        if ( timestamp == TimestampParser::NO_TIMESTAMP )
+            timestamp = lastTimestamps_[s];
+        else
+            lastTimestamps_[s] = timestamp;
+
+        heads.push( { timestamp, s } );
+    };
+
+    for ( uint32_t s = 0; s < nb_sources; ++s )
+        push_next_line( s );
+
+    std::vector<MergedLine> merged;
+    merged.reserve( nbLinesInChunk );
+    qint64 nb_lines_merged = 0;
+
+    while ( ! heads.empty() ) {
+        const uint32_t s = heads.top().second;
+        heads.pop();
+
+        merged.push_back( { static_cast<uint32_t>( mergedLines_[s] ), s } );
+        ++mergedLines_[s];
+        push_next_line( s );
+
+        if ( merged.size() >= static_cast<size_t>( nbLinesInChunk ) ) {
+            mergeIndex_.append( merged );
+            nb_lines_merged += merged.size();
+            merged.clear();
+
+            emit mergeProgressed( nb_lines_merged * 100 / nb_lines_to_merge );
+
+            if ( interruptRequested_ )
+                return false;
+        }
+    }
+
+    mergeIndex_.append( merged );
+
+    emit mergeProgressed( 100 );
+
+    return true;
+}
+
+void MergeWorkerThread::resetPositions()
+{
+    const size_t nb_sources = sources_.size();
+
+    mergedLines_.assign( nb_sources, 0 );
+    lastTimestamps_.assign( nb_sources, TimestampParser::NO_TIMESTAMP );
+    parsers_.assign( nb_sources, TimestampParser() );
+}
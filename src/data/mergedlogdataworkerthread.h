@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MERGEDLOGDATAWORKERTHREAD_H
+#define MERGEDLOGDATAWORKERTHREAD_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "loadingstatus.h"
+#include "timestampparser.h"
+#include "taskscheduler.h"
+
+class LogData;
+
+// A line of the merged view: the file it comes from and its
+// line number in this file.
+struct MergedLine {
+    uint32_t line;
+    uint32_t source;
+};
+
+// This class is a mutex protected index of the merged lines.
+// It is thread safe.
+class MergeIndex
+{
+  public:
+    MergeIndex() : dataMutex_(), lines_() { }
+
+    // Get the number of merged lines
+    qint64 getNbLines() const;
+    // Get the merged line at the passed index, returns false if
+    // there is no such line.
+    bool getLine( qint64 index, MergedLine* line ) const;
+    // Get the merged lines in the passed range, truncated if
+    // it goes past the end.
+    std::vector<MergedLine> getLines( qint64 first, int number ) const;
+
+    // Atomically add the passed lines at the end of the index.
+    void append( const std::vector<MergedLine>& lines );
+    // Atomically clear the index.
+    void clear();
+
+  private:
+    mutable QMutex dataMutex_;
+
+    std::vector<MergedLine> lines_;
+};
+
+// Manage the merge of the lines of the files of a MergedLogData in
+// timestamp order, run by the shared TaskScheduler.
+// The merge is incremental: the lines added to the files since the
+// previous merge are merged together and added at the end of the index.
+// Note everything except the runMerges() function is in the
+// MergedLogData's thread.
+class MergeWorkerThread : public QObject
+{
+  Q_OBJECT
+
+  public:
+    // The files are read from the passed vector, which must outlive
+    // this object.
+    MergeWorkerThread( const std::vector<std::unique_ptr<LogData>>& sources );
+    ~MergeWorkerThread();
+
+    // Merge the lines added to the files since the previous merge, or
+    // all the lines if restart is true. Returns immediately, requests
+    // made while a merge is in progress are grouped.
+    void merge( bool restart );
+    // Interrupts the merge if one is in progress, and wait for
+    // the interruption to be done.
+    void interrupt();
+    // Tells whether the file is the one displayed, the merge
+    // is then run before the other files' operations.
+    void setForeground( bool foreground );
+
+    // Returns the shared index
+    const MergeIndex& index() const { return mergeIndex_; }
+
+  signals:
+    // Sent during the merge to signal progress
+    // percent being the percentage of completion.
+    void mergeProgressed( int percent );
+    // Sent when the merge is finished (or interrupted)
+    void mergeFinished( LoadingStatus status );
+
+  private:
+    // Run the merges requested (in a thread of the scheduler)
+    void runMerges();
+    // Merge the new lines, returns false if interrupted
+    bool doMerge();
+    // Forget what has been merged
+    void resetPositions();
+
+    // Number of lines read at once from each file
+    static const int nbLinesInChunk;
+
+    const std::vector<std::unique_ptr<LogData>>& sources_;
+
+    // Mutex to protect the requests
+    QMutex mutex_;
+    QWaitCondition nothingToDoCond_;
+
+    bool interruptRequested_;
+    bool mergeRequested_;
+    bool restartRequested_;
+    // Set while a task is queued or running the merges
+    bool mergeTaskActive_;
+    TaskScheduler::TaskId taskId_;
+    std::atomic<bool> foreground_;
+
+    // State of the merge, only used by the merge task
+    // Number of lines of each file already in the index
+    std::vector<qint64> mergedLines_;
+    // Timestamp of the last line of each file merged, used
+    // for the lines without a timestamp.
+    std::vector<qint64> lastTimestamps_;
+    std::vector<TimestampParser> parsers_;
+
+    // Shared merge index
+    MergeIndex mergeIndex_;
+};
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PACKEDARRAY_H
+#define PACKEDARRAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Array of unsigned integers stored on as few bytes (1, 2 or 4) as
+// the largest of them needs, used for the codes of the lines of a
+// block in the indexes built from the lines (fields, templates...).
+class PackedArray
+{
+  public:
+    PackedArray() : width_( 1 ), bytes_() {}
+    explicit PackedArray( const std::vector<uint32_t>& values )
+        : width_( 1 ), bytes_()
+    {
+        uint32_t max = 0;
+        for ( const auto value: values )
+            max = ( value > max ) ? value : max;
+        width_ = ( max <= 0xFF ) ? 1 : ( max <= 0xFFFF ) ? 2 : 4;
+
+        bytes_.resize( values.size() * width_ );
+        for ( size_t i = 0; i < values.size(); ++i ) {
+            for ( int byte = 0; byte < width_; ++byte )
+                bytes_[ i * width_ + byte ] =
+                    static_cast<uint8_t>( values[i] >> ( 8 * byte ) );
+        }
+    }
+
+    uint32_t operator[]( size_t i ) const
+    {
+        const uint8_t* bytes = &bytes_[ i * width_ ];
+        switch ( width_ ) {
+            case 1:
+                return bytes[0];
+            case 2:
+                return bytes[0] | ( bytes[1] << 8 );
+            default:
+                return bytes[0] | ( bytes[1] << 8 ) | ( bytes[2] << 16 )
+                    | ( static_cast<uint32_t>( bytes[3] ) << 24 );
+        }
+    }
+
+    size_t size() const { return bytes_.size() / width_; }
+
+    // Returns the memory used by the array (in bytes)
+    size_t allocatedSize() const { return bytes_.capacity(); }
+
+  private:
+    int width_;
+    std::vector<uint8_t> bytes_;
+};
+
+#endif
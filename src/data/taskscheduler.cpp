@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements TaskScheduler, the pool of threads shared
+// by all the files, and TaskGroup.
+
+#include "taskscheduler.h"
+
+#include <algorithm>
+
+#include "log.h"
+
+TaskScheduler::TaskScheduler( int nb_threads )
+    : mutex_(), taskQueuedCond_(), queue_(), nextId_( 1 ), terminate_( false ),
+    maxRunningBackground_( std::max( 1, nb_threads - 1 ) ), nbRunningBackground_( 0 )
+{
+    LOG(logDEBUG) << "TaskScheduler: starting " << nb_threads << " threads";
+
+    for ( int i = 0; i < nb_threads; ++i )
+        threads_.emplace_back( &TaskScheduler::run, this );
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        terminate_ = true;
+        queue_.clear();
+    }
+    taskQueuedCond_.notify_all();
+
+    for ( auto& thread: threads_ )
+        thread.join();
+}
+
+TaskScheduler& TaskScheduler::instance()
+{
+    static TaskScheduler scheduler(
+            std::max( 2u, std::thread::hardware_concurrency() ) );
+
+    return scheduler;
+}
+
+TaskScheduler::TaskId TaskScheduler::submit( TaskPriority priority,
+        const std::atomic<bool>* foreground, std::function<void()> task )
+{
+    TaskId id;
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+
+        id = nextId_++;
+        queue_.push_back( { id, priority, foreground, std::move( task ) } );
+    }
+    taskQueuedCond_.notify_one();
+
+    return id;
+}
+
+bool TaskScheduler::cancel( TaskId id )
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    auto task = std::find_if( queue_.begin(), queue_.end(),
+            [id]( const Task& t ) { return t.id == id; } );
+
+    if ( task == queue_.end() )
+        return false;
+
+    queue_.erase( task );
+    return true;
+}
+
+void TaskScheduler::foregroundChanged()
+{
+    // Taken so a thread can't miss it between its check and its wait
+    { std::lock_guard<std::mutex> lock( mutex_ ); }
+    taskQueuedCond_.notify_all();
+}
+
+int TaskScheduler::nbQueuedTasks() const
+{
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    return queue_.size();
+}
+
+//
+// Private functions
+//
+
+void TaskScheduler::run()
+{
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    for (;;) {
+        taskQueuedCond_.wait( lock,
+                [this] { return terminate_ || canStartTask(); } );
+
+        if ( terminate_ )
+            return;
+
+        auto next = nextTask();
+        const bool background = isBackground( *next );
+        std::function<void()> task = std::move( next->function );
+        queue_.erase( next );
+
+        if ( background )
+            ++nbRunningBackground_;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        if ( background ) {
+            --nbRunningBackground_;
+            // Another thread might be waiting for this one to finish
+            taskQueuedCond_.notify_one();
+        }
+    }
+}
+
+// The queue is short (at most a few tasks per open file),
+// a linear search is fine.
+std::deque<TaskScheduler::Task>::iterator TaskScheduler::nextTask()
+{
+    auto rank = []( const Task& task ) {
+        const bool foreground = task.foreground && task.foreground->load();
+        return std::make_pair( foreground, static_cast<int>( task.priority ) );
+    };
+
+    auto next = queue_.begin();
+    for ( auto task = queue_.begin() + 1; task != queue_.end(); ++task ) {
+        // The first submitted wins in case of a tie
+        if ( rank( *task ) > rank( *next ) )
+            next = task;
+    }
+
+    return next;
+}
+
+// Called with mutex_ held
+bool TaskScheduler::canStartTask()
+{
+    if ( queue_.empty() )
+        return false;
+
+    // The background tasks come last, if the next one is in the
+    // background, they all are.
+    return ( ! isBackground( *nextTask() ) )
+        || ( nbRunningBackground_ < maxRunningBackground_ );
+}
+
+bool TaskScheduler::isBackground( const Task& task )
+{
+    return ( task.priority == TaskPriority::Indexing )
+        && ! ( task.foreground && task.foreground->load() );
+}
+
+//
+// TaskGroup
+//
+
+TaskGroup::TaskGroup( TaskScheduler& scheduler, TaskPriority priority )
+    : scheduler_( scheduler ), priority_( priority ), mutex_(),
+    finishedCond_(), tasks_(), nbDone_( 0 ), nbFinished_( 0 )
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    cancelAndWait();
+}
+
+void TaskGroup::submit( int nb_tasks, std::function<void()> function,
+        std::function<void()> last_finished )
+{
+    // Locked so none of the tasks finishes before all are counted
+    std::lock_guard<std::mutex> lock( mutex_ );
+
+    for ( int i = 0; i < nb_tasks; ++i )
+        tasks_.push_back( scheduler_.submit( priority_, nullptr,
+                    [this, function, last_finished] {
+                        function();
+                        taskFinished( last_finished ); } ) );
+}
+
+void TaskGroup::cancelAndWait()
+{
+    std::unique_lock<std::mutex> lock( mutex_ );
+
+    int nb_tasks_started = 0;
+    for ( const auto id: tasks_ ) {
+        if ( ! scheduler_.cancel( id ) )
+            ++nb_tasks_started;
+    }
+    finishedCond_.wait( lock,
+            [this, nb_tasks_started] { return nbFinished_ == nb_tasks_started; } );
+
+    tasks_.clear();
+    nbDone_     = 0;
+    nbFinished_ = 0;
+}
+
+void TaskGroup::taskFinished( const std::function<void()>& last_finished )
+{
+    bool last;
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        last = ( ++nbDone_ == static_cast<int>( tasks_.size() ) );
+    }
+
+    // Run before the task is counted as finished, so the owner
+    // waiting for it is still there.
+    if ( last && last_finished )
+        last_finished();
+
+    // Notified with the lock held, the group can be destroyed as
+    // soon as it is released.
+    std::lock_guard<std::mutex> lock( mutex_ );
+    ++nbFinished_;
+    finishedCond_.notify_all();
+}
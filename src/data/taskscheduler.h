@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Priority of a task, the higher first
+enum class TaskPriority {
+    Indexing,
+    Search,     // Interactive, the user is waiting for the results
+};
+
+// Runs the background work of all the files (indexing, searching...)
+// on a fixed pool of threads, instead of each file having its own threads.
+// The queued tasks of the foreground file (the one displayed) are run
+// first, then the ones with the highest priority, in the order they were
+// submitted otherwise.
+// The indexing of the files in the background never takes all the
+// threads (unless there is only one), so the searches and the work on
+// the foreground file don't wait for a whole file to be indexed.
+// Running tasks are not preempted: the cancellation is cooperative
+// (the owner of a task tells it to stop), only the queued ones can be
+// removed from the queue.
+// This class is thread-safe.
+class TaskScheduler {
+  public:
+    typedef uint64_t TaskId;
+
+    // Create a scheduler running nb_threads tasks at the same time
+    explicit TaskScheduler( int nb_threads );
+    // The running tasks are waited for, the queued ones are dropped.
+    ~TaskScheduler();
+
+    // No copy/assignment please
+    TaskScheduler( const TaskScheduler& ) = delete;
+    TaskScheduler& operator =( const TaskScheduler& ) = delete;
+
+    // Returns the scheduler shared by the application, it has one
+    // thread per core (and at least two).
+    static TaskScheduler& instance();
+
+    // Submit a task for execution. foreground (if not null) is read
+    // when choosing the next task to run and must live until the task
+    // is started or cancelled.
+    // Returns an id to cancel the task.
+    TaskId submit( TaskPriority priority, const std::atomic<bool>* foreground,
+            std::function<void()> task );
+    // Remove the task from the queue if it has not been started,
+    // returns whether it has been removed.
+    bool cancel( TaskId id );
+    // To be called when a file comes to the foreground, so its queued
+    // tasks can use the threads kept for the foreground.
+    void foregroundChanged();
+
+    // Returns the number of threads running the tasks
+    int nbThreads() const { return threads_.size(); }
+    // Returns the number of tasks waiting for a thread
+    int nbQueuedTasks() const;
+
+  private:
+    struct Task {
+        TaskId id;
+        TaskPriority priority;
+        const std::atomic<bool>* foreground;
+        std::function<void()> function;
+    };
+
+    // Loop run by each thread of the pool
+    void run();
+    // Returns the position of the next task to run (the queue is not empty)
+    std::deque<Task>::iterator nextTask();
+    // Returns whether a queued task can be started now
+    bool canStartTask();
+    // Returns whether the task is the indexing of a background file
+    static bool isBackground( const Task& task );
+
+    mutable std::mutex mutex_;
+    std::condition_variable taskQueuedCond_;
+    std::deque<Task> queue_;
+    TaskId nextId_;
+    bool terminate_;
+    // Background tasks running, they can use all the threads but one
+    const int maxRunningBackground_;
+    int nbRunningBackground_;
+
+    std::vector<std::thread> threads_;
+};
+
+// Tasks doing the same work in parallel (e.g. taking the parts of a
+// file in turn), submitted together by their owner, who can then stop
+// them: the ones not started are removed from the queue and the others
+// waited for.
+// submit() and cancelAndWait() are called by the owner only, telling
+// the running tasks to stop early is left to it.
+class TaskGroup {
+  public:
+    TaskGroup( TaskScheduler& scheduler, TaskPriority priority );
+    // The tasks are cancelled and waited for.
+    ~TaskGroup();
+
+    // No copy/assignment please
+    TaskGroup( const TaskGroup& ) = delete;
+    TaskGroup& operator =( const TaskGroup& ) = delete;
+
+    // Submit nb_tasks tasks running function, last_finished (if any)
+    // is then run by the last one to finish, unless some have been
+    // cancelled. The tasks previously submitted must have been waited for.
+    void submit( int nb_tasks, std::function<void()> function,
+            std::function<void()> last_finished = nullptr );
+    // Remove the tasks not started from the queue and wait for the
+    // others to finish, the group can then be reused.
+    void cancelAndWait();
+
+  private:
+    void taskFinished( const std::function<void()>& last_finished );
+
+    TaskScheduler& scheduler_;
+    const TaskPriority priority_;
+
+    std::mutex mutex_;
+    std::condition_variable finishedCond_;
+    std::vector<TaskScheduler::TaskId> tasks_;
+    // Tasks whose function has returned
+    int nbDone_;
+    // Tasks completely finished (last_finished run)
+    int nbFinished_;
+};
+
+#endif
@@ -0,0 +1,386 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements DrainTree, TemplateIndex and TemplateMiner,
+// mining the templates of the lines on the shared TaskScheduler.
+
+#include "templateminer.h"
+
+#include <algorithm>
+
+#include "log.h"
+
+#include "abstractlogdata.h"
+#include "abstractlogsource.h"
+
+namespace {
+    // Number of blocks in the parts taken by the tasks
+    const int nbBlocksInPart = 16;
+
+    // Returns the length of the line once tabs are expanded
+    int expandedLength( const QString& line )
+    {
+        int length = 0;
+        for ( const QChar c: line ) {
+            if ( c == '\t' )
+                length += AbstractLogData::tabStop - ( length % AbstractLogData::tabStop );
+            else
+                ++length;
+        }
+
+        return length;
+    }
+}
+
+//
+// DrainTree
+//
+
+const QString DrainTree::WILDCARD = "<*>";
+
+DrainTree::DrainTree( int depth, double similarity, int maxChildren )
+    : depth_( depth ), similarity_( similarity ), maxChildren_( maxChildren ),
+    nodes_( 1 ), clusters_()
+{
+}
+
+int DrainTree::add( const QStringList& tokens, qint64 count )
+{
+    // The lines are sorted by number of tokens, then by first tokens
+    int node = child( 0, QString::number( tokens.size() ) );
+    const int depth = qMin( depth_, tokens.size() );
+    for ( int i = 0; i < depth; ++i )
+        node = child( node, tokens[i] );
+
+    int best = -1;
+    double best_similarity = -1.0;
+    for ( const int id: nodes_[node].clusters ) {
+        const double s = similarity( clusters_[id].tokens, tokens );
+        if ( s > best_similarity ) {
+            best = id;
+            best_similarity = s;
+        }
+    }
+
+    if ( best >= 0 && best_similarity >= similarity_ ) {
+        // The tokens differing are variables
+        QStringList& templ = clusters_[best].tokens;
+        for ( int i = 0; i < templ.size(); ++i ) {
+            if ( templ[i] != tokens[i] )
+                templ[i] = WILDCARD;
+        }
+        clusters_[best].count += count;
+
+        return best;
+    }
+
+    const int id = nbTemplates();
+    clusters_.push_back( { tokens, count } );
+    nodes_[node].clusters.push_back( id );
+
+    return id;
+}
+
+QStringList DrainTree::tokenize( const QString& line )
+{
+    QStringList tokens;
+
+    int start = -1;
+    bool digit = false;
+    for ( int i = 0; i <= line.size(); ++i ) {
+        if ( i == line.size() || line[i].isSpace() ) {
+            if ( start >= 0 )
+                tokens.append( digit ? WILDCARD : line.mid( start, i - start ) );
+            start = -1;
+            digit = false;
+        }
+        else {
+            if ( start < 0 )
+                start = i;
+            digit = digit || line[i].isDigit();
+        }
+    }
+
+    return tokens;
+}
+
+int DrainTree::child( int node, const QString& key )
+{
+    const auto i = nodes_[node].children.constFind( key );
+    if ( i != nodes_[node].children.constEnd() )
+        return *i;
+
+    // Past maxChildren, the new tokens share a wildcard child
+    if ( nodes_[node].children.size() >= maxChildren_ ) {
+        const auto wildcard = nodes_[node].children.constFind( WILDCARD );
+        if ( wildcard != nodes_[node].children.constEnd() )
+            return *wildcard;
+    }
+
+    const int id = static_cast<int>( nodes_.size() );
+    nodes_.push_back( Node() );
+    nodes_[node].children.insert(
+            nodes_[node].children.size() < maxChildren_ ? key : WILDCARD, id );
+
+    return id;
+}
+
+double DrainTree::similarity( const QStringList& templ, const QStringList& tokens ) const
+{
+    if ( tokens.isEmpty() )
+        return 1.0;
+
+    int nb_same = 0;
+    for ( int i = 0; i < templ.size(); ++i ) {
+        if ( templ[i] == WILDCARD || templ[i] == tokens[i] )
+            ++nb_same;
+    }
+
+    return static_cast<double>( nb_same ) / tokens.size();
+}
+
+//
+// TemplateIndex
+//
+
+const int TemplateIndex::BLOCK_LINES = 4096;
+
+TemplateIndex::TemplateIndex()
+    : templates_(), blocks_(), blockMaxLengths_(), nbLines_( 0 )
+{
+}
+
+int TemplateIndex::templateOf( LineNumber line ) const
+{
+    return blocks_[ line / BLOCK_LINES ][ line % BLOCK_LINES ];
+}
+
+int TemplateIndex::match( const std::vector<bool>& selected, LineNumber first_line,
+        LineNumber end_line, SearchResultArray* matches ) const
+{
+    int max_length = 0;
+
+    end_line = std::min( end_line, nbLines_ );
+    LineNumber line = first_line;
+    while ( line < end_line ) {
+        const size_t b = line / BLOCK_LINES;
+        const LineNumber block_first = b * BLOCK_LINES;
+        const LineNumber block_end = std::min<LineNumber>( end_line, block_first + BLOCK_LINES );
+
+        bool found = false;
+        for ( ; line < block_end; ++line ) {
+            const uint32_t id = blocks_[b][ line - block_first ];
+            if ( id < selected.size() && selected[id] ) {
+                matches->push_back( MatchingLine( line ) );
+                found = true;
+            }
+        }
+
+        if ( found )
+            max_length = std::max( max_length, blockMaxLengths_[b] );
+    }
+
+    return max_length;
+}
+
+qint64 TemplateIndex::getAllocatedSize() const
+{
+    qint64 size = blockMaxLengths_.capacity() * sizeof( int )
+        + blocks_.capacity() * sizeof( PackedArray );
+    for ( const auto& block: blocks_ )
+        size += block.allocatedSize();
+    for ( const auto& templ: templates_ )
+        size += sizeof( Template ) + templ.text.capacity() * sizeof( QChar );
+
+    return size;
+}
+
+//
+// TemplateMiner
+//
+
+TemplateMiner::TemplateMiner()
+    : QObject(), nbLines_( 0 ), nbBlocks_( 0 ), nbParts_( 0 ),
+    interruptRequested_( false ), nextPart_( 0 ), nbLinesMined_( 0 ),
+    finished_( false ),
+    tasks_( TaskScheduler::instance(), TaskPriority::Search ), tree_(), examples_(), index_()
+{
+}
+
+TemplateMiner::~TemplateMiner()
+{
+    interrupt();
+}
+
+void TemplateMiner::start( const std::shared_ptr<const AbstractLogSource>& source )
+{
+    interrupt();
+
+    source_       = source;
+    nbLines_      = source->getNbLine();
+    nbBlocks_     = ( nbLines_ + TemplateIndex::BLOCK_LINES - 1 ) / TemplateIndex::BLOCK_LINES;
+    nbParts_      = ( nbBlocks_ + nbBlocksInPart - 1 ) / nbBlocksInPart;
+    nextPart_     = 0;
+    nbLinesMined_ = 0;
+    finished_     = false;
+    {
+        QMutexLocker locker( &indexMutex_ );
+        tree_ = DrainTree();
+        examples_.clear();
+        // The parts store their blocks as they are done
+        index_ = std::make_shared<TemplateIndex>();
+        index_->blocks_.resize( nbBlocks_ );
+        index_->blockMaxLengths_.resize( nbBlocks_ );
+        index_->nbLines_ = nbLines_;
+    }
+
+    LOG(logDEBUG) << "TemplateMiner::start on " << nbLines_ << " lines";
+
+    if ( nbParts_ == 0 ) {
+        finishIndex();
+        finished_ = true;
+        emit finished();
+        return;
+    }
+
+    // The last task to finish completes the index
+    tasks_.submit( qMin( TaskScheduler::instance().nbThreads(), nbParts_ ),
+            [this] { mineParts(); },
+            [this] {
+                if ( interruptRequested_ )
+                    return;
+                finishIndex();
+                LOG(logDEBUG) << "TemplateMiner: all lines mined, "
+                    << index_->templates_.size() << " templates";
+                finished_ = true;
+                emit finished();
+            } );
+}
+
+void TemplateMiner::interrupt()
+{
+    interruptRequested_ = true;
+    tasks_.cancelAndWait();
+    interruptRequested_ = false;
+}
+
+std::shared_ptr<const TemplateIndex> TemplateMiner::getIndex() const
+{
+    QMutexLocker locker( &indexMutex_ );
+
+    if ( ! finished_ )
+        return nullptr;
+
+    return index_;
+}
+
+//
+// Private functions
+//
+
+void TemplateMiner::mineParts()
+{
+    const int block_lines = TemplateIndex::BLOCK_LINES;
+
+    int part;
+    while ( ( part = nextPart_++ ) < nbParts_ && ! interruptRequested_ ) {
+        const int first_block = part * nbBlocksInPart;
+        const qint64 begin = static_cast<qint64>( first_block ) * block_lines;
+        const qint64 end = qMin<qint64>( begin + nbBlocksInPart * block_lines, nbLines_ );
+
+        DrainTree tree;
+        std::vector<qint64> examples;
+        std::vector<uint32_t> ids;
+        std::vector<int> max_lengths;
+        ids.reserve( end - begin );
+
+        for ( qint64 block_first = begin;
+                block_first < end && ! interruptRequested_; block_first += block_lines ) {
+            const int nb_lines = qMin<qint64>( block_lines, end - block_first );
+            const QStringList lines = source_->getLines( block_first, nb_lines );
+
+            int max_length = 0;
+            for ( int i = 0; i < nb_lines; ++i ) {
+                // A missing line (the file being truncated) is empty
+                const QString line = lines.value( i );
+                const int id = tree.add( DrainTree::tokenize( line ) );
+                if ( id == static_cast<int>( examples.size() ) )
+                    examples.push_back( block_first + i );
+                ids.push_back( id );
+                max_length = std::max( max_length, expandedLength( line ) );
+            }
+            max_lengths.push_back( max_length );
+        }
+
+        if ( interruptRequested_ )
+            break;
+
+        addPart( tree, examples, ids, max_lengths, first_block );
+
+        const qint64 nb_mined = nbLinesMined_ += end - begin;
+        emit progressed( static_cast<int>( nb_mined * 100 / nbLines_ ) );
+    }
+}
+
+void TemplateMiner::addPart( const DrainTree& tree, const std::vector<qint64>& examples,
+        const std::vector<uint32_t>& ids, const std::vector<int>& maxLengths,
+        int first_block )
+{
+    std::vector<uint32_t> global_ids( tree.nbTemplates() );
+    {
+        QMutexLocker locker( &indexMutex_ );
+
+        for ( int id = 0; id < tree.nbTemplates(); ++id ) {
+            const int global_id = tree_.add( tree.tokens( id ), tree.count( id ) );
+            if ( global_id == static_cast<int>( examples_.size() ) )
+                examples_.push_back( examples[id] );
+            else
+                examples_[global_id] = std::min( examples_[global_id], examples[id] );
+            global_ids[id] = global_id;
+        }
+    }
+
+    // Each part has its own blocks of the (pre-sized) index
+    const size_t block_lines = TemplateIndex::BLOCK_LINES;
+    std::vector<uint32_t> block_ids;
+    block_ids.reserve( block_lines );
+    for ( size_t b = 0; b < maxLengths.size(); ++b ) {
+        const size_t first = b * block_lines;
+        const size_t end = std::min( first + block_lines, ids.size() );
+
+        block_ids.clear();
+        for ( size_t i = first; i < end; ++i )
+            block_ids.push_back( global_ids[ ids[i] ] );
+
+        index_->blocks_[ first_block + b ] = PackedArray( block_ids );
+        index_->blockMaxLengths_[ first_block + b ] = maxLengths[b];
+    }
+}
+
+void TemplateMiner::finishIndex()
+{
+    QMutexLocker locker( &indexMutex_ );
+
+    index_->templates_.clear();
+    index_->templates_.reserve( tree_.nbTemplates() );
+    for ( int id = 0; id < tree_.nbTemplates(); ++id )
+        index_->templates_.push_back( { tree_.tokens( id ).join( ' ' ),
+                tree_.count( id ), examples_[id] } );
+}
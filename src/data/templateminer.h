@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TEMPLATEMINER_H
+#define TEMPLATEMINER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+#include "packedarray.h"
+#include "taskscheduler.h"
+#include "logfiltereddataworkerthread.h"
+
+class AbstractLogSource;
+
+// Clustering of log lines into templates, after Drain (He et al.):
+// the lines are split in tokens, the ones looking like variables
+// (containing a digit) being replaced by a wildcard, then sorted in a
+// tree of fixed depth by their number of tokens and their first tokens.
+// A line joins the most similar template of its leaf (the one having
+// the most tokens in common) if similar enough, the tokens differing
+// becoming wildcards, else it starts a new template.
+class DrainTree {
+  public:
+    // depth is the number of first tokens used to sort the lines,
+    // similarity the proportion of tokens in common needed to join a
+    // template and maxChildren the number of children of a node
+    // before the new tokens share a wildcard child.
+    explicit DrainTree( int depth = 2, double similarity = 0.5,
+            int maxChildren = 100 );
+
+    // Add a line (or a template of another tree, count being its
+    // number of lines) and returns the id of its template.
+    int add( const QStringList& tokens, qint64 count = 1 );
+
+    // Returns the number of templates
+    int nbTemplates() const { return static_cast<int>( clusters_.size() ); }
+    // Returns the tokens of a template
+    const QStringList& tokens( int id ) const { return clusters_[id].tokens; }
+    // Returns the number of lines of a template
+    qint64 count( int id ) const { return clusters_[id].count; }
+
+    // Returns the tokens of a line
+    static QStringList tokenize( const QString& line );
+
+    // Token replacing the variable parts of the lines
+    static const QString WILDCARD;
+
+  private:
+    struct Node {
+        QHash<QString, int> children;
+        // The templates, for the leaves
+        std::vector<int> clusters;
+    };
+    struct Cluster {
+        QStringList tokens;
+        qint64 count;
+    };
+
+    // Returns the child of node for key, creating it if needed
+    int child( int node, const QString& key );
+    // Returns the proportion of the tokens of the template matching
+    double similarity( const QStringList& templ, const QStringList& tokens ) const;
+
+    int depth_;
+    double similarity_;
+    int maxChildren_;
+
+    // The root is the first node
+    std::vector<Node> nodes_;
+    std::vector<Cluster> clusters_;
+};
+
+// The templates found in the lines of a source and the template of
+// each line, stored by block of lines as packed arrays of ids, so the
+// lines of a set of templates are found with a single pass on a few
+// bytes per line, without reading the source.
+// The index is not modified once built and can be shared.
+class TemplateIndex {
+  public:
+    struct Template {
+        QString text;
+        qint64 count;
+        // The first line of the template
+        qint64 exampleLine;
+    };
+
+    TemplateIndex();
+
+    // Returns the templates, their id being their index
+    const std::vector<Template>& getTemplates() const { return templates_; }
+    // Returns the id of the template of a line
+    int templateOf( LineNumber line ) const;
+
+    // Add the lines in [first_line, end_line) whose template is
+    // selected (the vector being indexed by template id) to matches,
+    // returns the length of the longest block they were found in.
+    int match( const std::vector<bool>& selected, LineNumber first_line,
+            LineNumber end_line, SearchResultArray* matches ) const;
+
+    // Returns the number of lines indexed
+    LineNumber getNbLines() const { return nbLines_; }
+    // Returns the memory used by the index (in bytes)
+    qint64 getAllocatedSize() const;
+
+    // Number of lines in a block
+    static const int BLOCK_LINES;
+
+  private:
+    friend class TemplateMiner;
+
+    std::vector<Template> templates_;
+    // The template id of each line, by block
+    std::vector<PackedArray> blocks_;
+    // Length of the longest line of each block
+    std::vector<int> blockMaxLengths_;
+    LineNumber nbLines_;
+};
+
+// Builds the TemplateIndex of a source in the background. The blocks
+// of lines are split in parts mined in parallel by tasks on the
+// TaskScheduler, each one with its own DrainTree, whose templates are
+// added (as lines weighted by their count) to the tree of the whole
+// source when the part is done.
+class TemplateMiner : public QObject
+{
+  Q_OBJECT
+
+  public:
+    TemplateMiner();
+    ~TemplateMiner();
+
+    // Mine the lines of source, the mining in progress (if any)
+    // is interrupted.
+    void start( const std::shared_ptr<const AbstractLogSource>& source );
+    // Interrupts the mining if one is in progress and wait for
+    // the interruption to be done.
+    void interrupt();
+
+    // Returns the index built (to be called once finished has been
+    // received), nullptr if the mining has not finished.
+    std::shared_ptr<const TemplateIndex> getIndex() const;
+    // Returns whether all the lines have been mined
+    bool isFinished() const { return finished_; }
+
+  signals:
+    // Sent (from the tasks) when some lines have been mined
+    void progressed( int percent );
+    // Sent when all the lines have been mined (not sent if the
+    // mining is interrupted)
+    void finished();
+
+  private:
+    // Run by the tasks, mine the parts not taken by another task
+    void mineParts();
+    // Add the templates of a part to the whole tree and store the
+    // ids of its lines, first_block being the first block of the part
+    void addPart( const DrainTree& tree, const std::vector<qint64>& examples,
+            const std::vector<uint32_t>& ids, const std::vector<int>& maxLengths,
+            int first_block );
+    // Fill the templates of the index
+    void finishIndex();
+
+    std::shared_ptr<const AbstractLogSource> source_;
+
+    LineNumber nbLines_;
+    int nbBlocks_;
+    int nbParts_;
+    std::atomic<bool> interruptRequested_;
+    std::atomic<int> nextPart_;
+    std::atomic<qint64> nbLinesMined_;
+    std::atomic<bool> finished_;
+
+    // Tasks of the current mining
+    TaskGroup tasks_;
+
+    // Templates of the parts mined
+    mutable QMutex indexMutex_;
+    DrainTree tree_;
+    // The first line of each template of tree_
+    std::vector<qint64> examples_;
+    std::shared_ptr<TemplateIndex> index_;
+};
+
+#endif
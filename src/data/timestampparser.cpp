@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "timestampparser.h"
+
+#include <limits>
+
+#include <QDate>
+
+const qint64 TimestampParser::NO_TIMESTAMP = std::numeric_limits<qint64>::min();
+const int TimestampParser::MAX_PREFIX_LENGTH = 80;
+
+namespace {
+    // Number of days between 1970-01-01 and the passed date
+    // (proleptic Gregorian calendar)
+    qint64 daysFromCivil( int year, int month, int day )
+    {
+        year -= ( month <= 2 ) ? 1 : 0;
+        const qint64 era = ( year >= 0 ? year : year - 399 ) / 400;
+        const qint64 year_of_era = year - era * 400;
+        const qint64 day_of_year = ( 153 * ( month + ( month > 2 ? -3 : 9 ) ) + 2 ) / 5 + day - 1;
+        const qint64 day_of_era = year_of_era * 365 + year_of_era / 4
+            - year_of_era / 100 + day_of_year;
+        return era * 146097 + day_of_era - 719468;
+    }
+
+    // Returns the month (1-12) from its English abbreviation, 0 if unknown
+    int monthFromName( const QStringRef& name )
+    {
+        static const QString months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+        const int position = months.indexOf( name );
+        return ( position >= 0 && position % 3 == 0 ) ? position / 3 + 1 : 0;
+    }
+
+    // Returns the number of ms from the (variable length) decimal fraction
+    int milliseconds( const QStringRef& fraction )
+    {
+        if ( fraction.isEmpty() )
+            return 0;
+
+        return ( fraction.toString() + "00" ).left( 3 ).toInt();
+    }
+};
+
+TimestampParser::TimestampParser() : currentYear_( QDate::currentDate().year() )
+{
+    formats_.push_back( { Kind::Iso, QRegularExpression(
+        "(\\d{4})-(\\d{2})-(\\d{2})[T ](\\d{2}):(\\d{2}):(\\d{2})(?:[.,](\\d{1,9}))?" ) } );
+    formats_.push_back( { Kind::Apache, QRegularExpression(
+        "(\\d{2})/([A-Z][a-z]{2})/(\\d{4}):(\\d{2}):(\\d{2}):(\\d{2})" ) } );
+    formats_.push_back( { Kind::Syslog, QRegularExpression(
+        "\\b([A-Z][a-z]{2}) +(\\d{1,2}) (\\d{2}):(\\d{2}):(\\d{2})(?:\\.(\\d{1,9}))?" ) } );
+
+    for ( auto& format: formats_ )
+        format.regexp.optimize();
+}
+
+qint64 TimestampParser::parse( const QString& line )
+{
+    const QString prefix = line.left( MAX_PREFIX_LENGTH );
+
+    for ( size_t i = 0; i < formats_.size(); ++i ) {
+        // Try the format that matched last time first
+        const size_t format = ( lastFormat_ + i ) % formats_.size();
+
+        const QRegularExpressionMatch match = formats_[format].regexp.match( prefix );
+        if ( match.hasMatch() ) {
+            const qint64 result = timestamp( formats_[format].kind, match );
+            if ( result != NO_TIMESTAMP ) {
+                lastFormat_ = format;
+                return result;
+            }
+        }
+    }
+
+    return NO_TIMESTAMP;
+}
+
+qint64 TimestampParser::timestamp( Kind kind, const QRegularExpressionMatch& match ) const
+{
+    int year = 0, month = 0, day = 0, ms = 0;
+    int first_time_field = 0;
+
+    switch ( kind ) {
+        case Kind::Iso:
+            year  = match.capturedRef( 1 ).toInt();
+            month = match.capturedRef( 2 ).toInt();
+            day   = match.capturedRef( 3 ).toInt();
+            ms    = milliseconds( match.capturedRef( 7 ) );
+            first_time_field = 4;
+            break;
+        case Kind::Apache:
+            day   = match.capturedRef( 1 ).toInt();
+            month = monthFromName( match.capturedRef( 2 ) );
+            year  = match.capturedRef( 3 ).toInt();
+            first_time_field = 4;
+            break;
+        case Kind::Syslog:
+            month = monthFromName( match.capturedRef( 1 ) );
+            day   = match.capturedRef( 2 ).toInt();
+            year  = currentYear_;
+            ms    = milliseconds( match.capturedRef( 6 ) );
+            first_time_field = 3;
+            break;
+    }
+
+    if ( month < 1 || month > 12 || day < 1 || day > 31 )
+        return NO_TIMESTAMP;
+
+    const int hours   = match.capturedRef( first_time_field ).toInt();
+    const int minutes = match.capturedRef( first_time_field + 1 ).toInt();
+    const int seconds = match.capturedRef( first_time_field + 2 ).toInt();
+
+    const qint64 days = daysFromCivil( year, month, day );
+    return ( ( days * 24 + hours ) * 60 + minutes ) * 60000
+        + seconds * 1000 + ms;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TIMESTAMPPARSER_H
+#define TIMESTAMPPARSER_H
+
+#include <vector>
+
+#include <QString>
+#include <QRegularExpression>
+
+// Finds the timestamp of a log line, recognising the common formats:
+//   ISO 8601   2016-03-12 17:04:21.123 (or 2016-03-12T17:04:21,123)
+//   Apache     [12/Mar/2016:17:04:21 +0100]
+//   syslog     Mar 12 17:04:21 (the current year is assumed)
+// Time zones are ignored.
+// The format of the previous line is tried first, so a parser should
+// be used for one file (and is not thread-safe).
+class TimestampParser {
+  public:
+    // Returned when no timestamp is found in the line
+    static const qint64 NO_TIMESTAMP;
+
+    TimestampParser();
+
+    // Returns the timestamp found near the beginning of the line
+    // (in ms since the epoch) or NO_TIMESTAMP.
+    qint64 parse( const QString& line );
+
+  private:
+    enum class Kind { Iso, Apache, Syslog };
+    struct Format {
+        Kind kind;
+        QRegularExpression regexp;
+    };
+
+    qint64 timestamp( Kind kind, const QRegularExpressionMatch& match ) const;
+
+    // Only the beginning of the line is looked at
+    static const int MAX_PREFIX_LENGTH;
+
+    std::vector<Format> formats_;
+    size_t lastFormat_ = 0;
+    int currentYear_;
+};
+
+#endif
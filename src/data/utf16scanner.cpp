@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements Utf16Scanner, used to index UTF-16 files.
+
+#include "utf16scanner.h"
+
+#if defined( __SSE2__ )
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const uint16_t LINE_FEED = 0x000A;
+    const uint16_t TAB = 0x0009;
+
+#if defined( __SSE2__ )
+    // Returns the code unit as loaded in a 16 bits lane (SSE2 is
+    // little endian)
+    short laneValue( uint16_t code_unit, bool big_endian )
+    {
+        return static_cast<short>( big_endian ?
+                ( code_unit >> 8 ) | ( code_unit << 8 ) : code_unit );
+    }
+#endif
+
+    // A low surrogate continues the code point started by
+    // the high surrogate before it.
+    bool isLowSurrogate( uint16_t code_unit )
+    {
+        return code_unit >= 0xDC00 && code_unit <= 0xDFFF;
+    }
+}
+
+Utf16Scanner::Utf16Scanner( bool big_endian, int tab_stop )
+    : bigEndian_( big_endian ), tabStop_( tab_stop )
+{
+}
+
+int Utf16Scanner::findLineFeed( const char* data, int begin, int end ) const
+{
+    int i = begin;
+
+#if defined( __SSE2__ )
+    const __m128i line_feed = _mm_set1_epi16( laneValue( LINE_FEED, bigEndian_ ) );
+    for ( ; i + 16 <= end; i += 16 ) {
+        const __m128i units = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>( data + i ) );
+        const int found = _mm_movemask_epi8( _mm_cmpeq_epi16( units, line_feed ) );
+        if ( found )
+            return i + __builtin_ctz( found );
+    }
+#endif
+
+    for ( ; i + 1 < end; i += 2 ) {
+        if ( codeUnit( data + i ) == LINE_FEED )
+            return i;
+    }
+
+    return -1;
+}
+
+int Utf16Scanner::expandedLength( const char* data, int begin, int end, int column ) const
+{
+    int i = begin;
+
+#if defined( __SSE2__ )
+    // Only the groups containing a tab or a surrogate are looked
+    // at one code unit at a time.
+    const __m128i tab = _mm_set1_epi16( laneValue( TAB, bigEndian_ ) );
+    const __m128i surrogate_mask = _mm_set1_epi16( laneValue( 0xF800, bigEndian_ ) );
+    const __m128i surrogate = _mm_set1_epi16( laneValue( 0xD800, bigEndian_ ) );
+    for ( ; i + 16 <= end; i += 16 ) {
+        const __m128i units = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>( data + i ) );
+        const __m128i special = _mm_or_si128(
+                _mm_cmpeq_epi16( units, tab ),
+                _mm_cmpeq_epi16( _mm_and_si128( units, surrogate_mask ), surrogate ) );
+        if ( _mm_movemask_epi8( special ) )
+            column = scalarExpandedLength( data, i, i + 16, column );
+        else
+            column += 8;
+    }
+#endif
+
+    return scalarExpandedLength( data, i, end, column );
+}
+
+uint16_t Utf16Scanner::codeUnit( const char* data ) const
+{
+    const uint8_t first = static_cast<uint8_t>( data[0] );
+    const uint8_t second = static_cast<uint8_t>( data[1] );
+
+    return bigEndian_ ? ( first << 8 ) | second : ( second << 8 ) | first;
+}
+
+int Utf16Scanner::scalarExpandedLength( const char* data,
+        int begin, int end, int column ) const
+{
+    for ( int i = begin; i + 1 < end; i += 2 ) {
+        const uint16_t code_unit = codeUnit( data + i );
+        if ( code_unit == TAB )
+            column += tabStop_ - column % tabStop_;
+        else if ( ! isLowSurrogate( code_unit ) )
+            ++column;
+    }
+
+    return column;
+}
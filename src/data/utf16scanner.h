@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef UTF16SCANNER_H
+#define UTF16SCANNER_H
+
+#include <cstdint>
+
+// Scans UTF-16 text, by code units, for the line feeds and works out
+// the length of the lines as displayed (in code points, tabs expanded).
+// The positions passed are in bytes from data, and must be at the
+// beginning of a code unit.
+// 8 code units are checked at a time where SSE2 is available.
+class Utf16Scanner {
+  public:
+    Utf16Scanner( bool big_endian, int tab_stop );
+
+    // Returns the position of the first line feed (U+000A) in
+    // [begin, end), or -1 if there is none.
+    int findLineFeed( const char* data, int begin, int end ) const;
+
+    // Returns the column reached when displaying [begin, end) from column.
+    int expandedLength( const char* data, int begin, int end, int column ) const;
+
+  private:
+    uint16_t codeUnit( const char* data ) const;
+    int scalarExpandedLength( const char* data, int begin, int end, int column ) const;
+
+    const bool bigEndian_;
+    const int tabStop_;
+};
+
+#endif
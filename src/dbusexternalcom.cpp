@@ -34,7 +34,7 @@ DBusExternalCommunicator::DBusExternalCommunicator()
         throw CantCreateExternalErr();
     }
 
-    dbus_iface_object_ = std::make_shared<DBusInterfaceExternalCommunicator>();
+    dbus_iface_object_ = std::make_shared<DBusInterfaceExternalCommunicator>( this );
 
     connect( dbus_iface_object_.get(), SIGNAL( signalLoadFile( const QString& ) ),
              this, SIGNAL( loadFile( const QString& ) ) );
@@ -75,6 +75,11 @@ qint32 DBusInterfaceExternalCommunicator::version() const
     return 0x010000;
 }
 
+QString DBusInterfaceExternalCommunicator::statistics() const
+{
+    return communicator_->statistics();
+}
+
 void DBusInterfaceExternalCommunicator::loadFile( const QString& file_name )
 {
     LOG(logDEBUG) << "DBusInterfaceExternalCommunicator::loadFile()";
@@ -114,3 +119,16 @@ uint32_t DBusExternalInstance::getVersion() const
 
     return (uint32_t) reply.value();
 }
+
+QString DBusExternalInstance::getStatistics() const
+{
+    QDBusReply<QString> reply = dbusInterface_->call( "statistics" );
+
+    if ( ! reply.isValid() ) {
+        LOG( logWARNING ) << "Invalid reply from D-Bus call: "
+            << qPrintable( reply.error().message() );
+        return QString();
+    }
+
+    return reply.value();
+}
@@ -34,6 +34,7 @@ class DBusExternalInstance : public ExternalInstance {
 
     virtual void loadFile( const QString& file_name ) const;
     virtual uint32_t getVersion() const;
+    virtual QString getStatistics() const;
 
   private:
     std::shared_ptr<QDBusInterface> dbusInterface_;
@@ -44,15 +45,20 @@ class DBusInterfaceExternalCommunicator : public QObject
   Q_OBJECT
 
   public:
-    DBusInterfaceExternalCommunicator() : QObject() {}
+    DBusInterfaceExternalCommunicator( const ExternalCommunicator* communicator )
+        : QObject(), communicator_( communicator ) {}
     ~DBusInterfaceExternalCommunicator() {}
 
   public slots:
     void loadFile( const QString& file_name );
     qint32 version() const;
+    QString statistics() const;
 
   signals:
     void signalLoadFile( const QString& file_name );
+
+  private:
+    const ExternalCommunicator* communicator_;
 };
 
 // An implementation of ExternalCommunicator using D-Bus via Qt
@@ -47,6 +47,10 @@ class EncodingSpeculator {
     // Returns the current guess based on the previously injected bytes
     Encoding guess() const;
 
+    // Returns whether the text is made of 2 bytes code units
+    static bool isUtf16( Encoding encoding )
+    { return encoding == Encoding::UTF16LE || encoding == Encoding::UTF16BE; }
+
   private:
     enum class State {
         Start,
@@ -20,7 +20,10 @@
 #ifndef EXTERNALCOM_H
 #define EXTERNALCOM_H
 
+#include <functional>
+
 #include <QObject>
+#include <QString>
 
 class CantCreateExternalErr {};
 
@@ -37,6 +40,8 @@ class ExternalInstance
 
     virtual void loadFile( const QString& file_name ) const = 0;
     virtual uint32_t getVersion() const = 0;
+    // Returns the statistics of the files open in the instance
+    virtual QString getStatistics() const = 0;
 };
 
 /*
@@ -56,11 +61,22 @@ class ExternalCommunicator : public QObject
      * remote initiated operations */
     virtual void startListening() = 0;
 
+    // Set the function returning the statistics sent to the other
+    // instances requesting them
+    void setStatisticsProvider( std::function<QString()> provider )
+    { statisticsProvider_ = provider; }
+    // Returns the statistics to send to another instance
+    QString statistics() const
+    { return statisticsProvider_ ? statisticsProvider_() : QString(); }
+
   signals:
     void loadFile( const QString& file_name );
 
   public slots:
     virtual qint32 version() const = 0;
+
+  private:
+    std::function<QString()> statisticsProvider_;
 };
 
 #endif
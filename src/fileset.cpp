@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "fileset.h"
+
+#include <algorithm>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QPair>
+#include <QRegularExpression>
+
+const QString FileSet::SET_PREFIX = "set:";
+const QString FileSet::MERGED_PREFIX = "merged:";
+
+namespace {
+    // Split a rotated file name in its base name and its generation:
+    // "app.log.12" is ( "app.log", 12 ), "app.log" is ( "app.log", 0 )
+    QPair<QString, int> rotationGeneration( const QString& file_name )
+    {
+        static const QRegularExpression suffix( "^(.*)\\.(\\d+)$" );
+
+        const QRegularExpressionMatch match = suffix.match( file_name );
+        if ( match.hasMatch() )
+            return { match.captured( 1 ), match.captured( 2 ).toInt() };
+        else
+            return { file_name, 0 };
+    }
+};
+
+QString FileSet::nameForFiles( const QStringList& files, Kind kind )
+{
+    if ( files.isEmpty() )
+        return QString();
+    else if ( ( kind == Kind::Concatenated ) && ( files.size() == 1 ) )
+        return files.first();
+
+    const QByteArray list = QJsonDocument( QJsonArray::fromStringList( files ) )
+        .toJson( QJsonDocument::Compact );
+
+    return ( kind == Kind::Merged ? MERGED_PREFIX : SET_PREFIX )
+        + QString::fromUtf8( list );
+}
+
+bool FileSet::isFileSet( const QString& name )
+{
+    QStringList set_files;
+    return ( name.startsWith( SET_PREFIX )
+            && parseFiles( name, SET_PREFIX.size(), &set_files ) )
+        || isMergedSet( name );
+}
+
+bool FileSet::isMergedSet( const QString& name )
+{
+    QStringList set_files;
+    return name.startsWith( MERGED_PREFIX )
+        && parseFiles( name, MERGED_PREFIX.size(), &set_files );
+}
+
+QStringList FileSet::files( const QString& name )
+{
+    QStringList set_files;
+
+    // Anything which doesn't parse is a (strangely named) file
+    if ( name.startsWith( SET_PREFIX )
+            && parseFiles( name, SET_PREFIX.size(), &set_files ) )
+        return set_files;
+    else if ( name.startsWith( MERGED_PREFIX )
+            && parseFiles( name, MERGED_PREFIX.size(), &set_files ) )
+        return set_files;
+    else if ( name.isEmpty() )
+        return QStringList();
+    else
+        return QStringList() << name;
+}
+
+bool FileSet::parseFiles( const QString& name, int prefix_length,
+        QStringList* files )
+{
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(
+            name.mid( prefix_length ).toUtf8(), &error );
+
+    if ( ( error.error != QJsonParseError::NoError ) || ( ! document.isArray() ) )
+        return false;
+
+    files->clear();
+    for ( const auto& value: document.array() ) {
+        if ( ! value.isString() )
+            return false;
+        files->append( value.toString() );
+    }
+
+    return ! files->isEmpty();
+}
+
+QString FileSet::displayName( const QString& name )
+{
+    const QStringList set_files = files( name );
+
+    if ( isMergedSet( name ) )
+        return QString( "%1 (+%2 merged)" )
+            .arg( set_files.value( 0 ) ).arg( set_files.size() - 1 );
+    else if ( set_files.size() > 1 )
+        return QString( "%1 (+%2)" )
+            .arg( set_files.last() ).arg( set_files.size() - 1 );
+    else
+        return name;
+}
+
+QStringList FileSet::filesMatching( const QString& pattern )
+{
+    const QFileInfo info( pattern );
+    const QDir dir = info.absoluteDir();
+
+    QStringList matching;
+    for ( const auto& file_name: dir.entryList(
+                QStringList() << info.fileName(), QDir::Files | QDir::Readable ) )
+        matching.append( dir.absoluteFilePath( file_name ) );
+
+    sortByRotation( &matching );
+
+    return matching;
+}
+
+void FileSet::sortByRotation( QStringList* files )
+{
+    std::stable_sort( files->begin(), files->end(),
+            []( const QString& a, const QString& b ) {
+                const auto rotation_a = rotationGeneration( a );
+                const auto rotation_b = rotationGeneration( b );
+
+                if ( rotation_a.first != rotation_b.first )
+                    return rotation_a.first < rotation_b.first;
+                else
+                    return rotation_a.second > rotation_b.second;
+            } );
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FILESET_H
+#define FILESET_H
+
+#include <QString>
+#include <QStringList>
+
+// A set of files opened together and displayed as one log, either
+// one file after the other (typically a log and its rotated versions)
+// or merged in timestamp order.
+// The set is identified (in the session, the recent files...) by
+// a name made of a prefix giving its kind ("set:" or "merged:")
+// followed by the names of its files as a JSON array.
+// A concatenated set of one file is named after the file itself.
+class FileSet {
+  public:
+    enum class Kind { Concatenated, Merged };
+
+    // Returns the name identifying the set of the passed files (in order),
+    // an empty name if there is no file.
+    static QString nameForFiles( const QStringList& files,
+            Kind kind = Kind::Concatenated );
+    // Returns whether the passed name identifies a set of files
+    // (rather than a single file)
+    static bool isFileSet( const QString& name );
+    // Returns whether the passed name identifies a set of files
+    // merged in timestamp order
+    static bool isMergedSet( const QString& name );
+    // Returns the files in the set identified by the passed name,
+    // for a single file, the file itself.
+    static QStringList files( const QString& name );
+    // Returns a name suitable to present the set to the user
+    // (the last file followed by the number of other files),
+    // for a single file, the file itself.
+    static QString displayName( const QString& name );
+
+    // Returns the files matching the passed glob pattern (wildcards are
+    // only allowed in the file name, not in the directory part),
+    // in rotation order.
+    static QStringList filesMatching( const QString& pattern );
+    // Sort the passed file names in rotation order: the oldest file
+    // first, e.g. app.log.2, app.log.1, app.log
+    static void sortByRotation( QStringList* files );
+
+  private:
+    static const QString SET_PREFIX;
+    static const QString MERGED_PREFIX;
+
+    // Parse the list of files following the prefix of a set name,
+    // returns whether it is valid.
+    static bool parseFiles( const QString& name, int prefix_length,
+            QStringList* files );
+};
+
+#endif
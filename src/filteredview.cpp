@@ -25,12 +25,18 @@
 
 #include "filteredview.h"
 
+#include "quickfindpattern.h"
+
 FilteredView::FilteredView( LogFilteredData* newLogData,
         const QuickFindPattern* const quickFindPattern, QWidget* parent )
     : AbstractLogView( newLogData, quickFindPattern, parent )
 {
     // We keep a copy of the filtered data for fast lookup of the line type
     logFilteredData_ = newLogData;
+
+    // The spans are only recorded for the searches displayed
+    if ( logFilteredData_ )
+        logFilteredData_->setMatchSpansRecorded( true );
 }
 
 void FilteredView::setVisibility( Visibility visi )
@@ -67,6 +73,11 @@ AbstractLogView::LineType FilteredView::lineType( int lineNumber ) const
         return Match;
 }
 
+int FilteredView::lineSource( int lineNumber ) const
+{
+    return logFilteredData_->getLineSource( lineNumber );
+}
+
 qint64 FilteredView::displayLineNumber( int lineNumber ) const
 {
     // Display a 1-based index
@@ -78,6 +89,19 @@ qint64 FilteredView::maxDisplayLineNumber() const
     return logFilteredData_->getNbTotalLines();
 }
 
+// The positions have been recorded by the search,
+// so no need to run the regexp again.
+bool FilteredView::searchMatchesForLine( int lineNumber,
+        QList<QuickFindMatch>& matches ) const
+{
+    foreach ( const MatchSpan& span,
+            logFilteredData_->getMatchSpans( lineNumber ) ) {
+        matches << QuickFindMatch( span.startColumn(), span.length() );
+    }
+
+    return ( ! matches.isEmpty() );
+}
+
 void FilteredView::keyPressEvent( QKeyEvent* keyEvent )
 {
     bool noModifier = keyEvent->modifiers() == Qt::NoModifier;
@@ -40,10 +40,17 @@ class FilteredView : public AbstractLogView
 
   protected:
     virtual LineType lineType( int lineNumber ) const;
+    virtual int lineSource( int lineNumber ) const;
 
     // Number of the filtered line relative to the unfiltered source
     virtual qint64 displayLineNumber( int lineNumber ) const;
     virtual qint64 maxDisplayLineNumber() const;
+    // Use the match positions recorded by the search
+    virtual bool searchMatchesForLine( int lineNumber,
+            QList<QuickFindMatch>& matches ) const;
+
+    // Matches can be added anywhere in the filtered data
+    virtual bool isDataAppendOnly() const { return false; }
 
     virtual void keyPressEvent( QKeyEvent* keyEvent );
 
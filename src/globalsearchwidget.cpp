@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements GlobalSearchWidget, the panel used to search
+// all the open files.
+
+#include "log.h"
+
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QRegularExpression>
+
+#include "persistentinfo.h"
+#include "configuration.h"
+#include "data/globalsearch.h"
+
+#include "globalsearchwidget.h"
+
+GlobalSearchWidget::GlobalSearchWidget( QWidget* parent ) : QWidget( parent ),
+    nbMatches_( 0 )
+{
+    searchLineEdit_ = new QLineEdit( this );
+    searchLineEdit_->setMinimumSize( QSize( 150, 0 ) );
+
+    ignoreCaseCheck_ = new QCheckBox( tr( "Ignore &case" ) );
+    searchButton_ = new QPushButton( tr( "&Search" ) );
+    stopButton_ = new QPushButton( tr( "St&op" ) );
+    stopButton_->setEnabled( false );
+    statusLabel_ = new QLabel();
+
+    resultsTree_ = new QTreeWidget();
+    resultsTree_->setColumnCount( 2 );
+    resultsTree_->setHeaderLabels( QStringList() << tr( "Line" ) << tr( "Text" ) );
+    resultsTree_->setRootIsDecorated( true );
+    resultsTree_->setUniformRowHeights( true );
+
+    QHBoxLayout* search_layout = new QHBoxLayout();
+    search_layout->setContentsMargins( 0, 0, 0, 0 );
+    search_layout->addWidget( searchLineEdit_ );
+    search_layout->addWidget( ignoreCaseCheck_ );
+    search_layout->addWidget( searchButton_ );
+    search_layout->addWidget( stopButton_ );
+    search_layout->addWidget( statusLabel_ );
+
+    QVBoxLayout* main_layout = new QVBoxLayout( this );
+    main_layout->setContentsMargins( 2, 2, 2, 2 );
+    main_layout->addLayout( search_layout );
+    main_layout->addWidget( resultsTree_ );
+
+    // Behaviour
+    connect( searchLineEdit_, SIGNAL( returnPressed() ),
+            this, SIGNAL( searchRequested() ) );
+    connect( searchButton_, SIGNAL( clicked() ),
+            this, SIGNAL( searchRequested() ) );
+    connect( stopButton_, SIGNAL( clicked() ),
+            this, SLOT( stopHandler() ) );
+    connect( resultsTree_, SIGNAL( itemActivated( QTreeWidgetItem*, int ) ),
+            this, SLOT( itemActivatedHandler( QTreeWidgetItem*, int ) ) );
+}
+
+GlobalSearchWidget::~GlobalSearchWidget()
+{
+}
+
+void GlobalSearchWidget::userActivate()
+{
+    searchLineEdit_->setFocus( Qt::ShortcutFocusReason );
+    searchLineEdit_->selectAll();
+}
+
+void GlobalSearchWidget::search( const QStringList& file_names,
+        const std::vector<std::shared_ptr<const AbstractLogSource>>& files )
+{
+    const QString search_text = searchLineEdit_->text();
+
+    LOG(logDEBUG) << "GlobalSearchWidget::search " << search_text.toStdString();
+
+    // Stop the previous search (its matches are not wanted anymore)
+    globalSearch_.reset();
+
+    resultsTree_->clear();
+    fileNames_ = file_names;
+    fileItems_.assign( file_names.size(), nullptr );
+    nbMatches_ = 0;
+
+    if ( search_text.isEmpty() ) {
+        statusLabel_->clear();
+        return;
+    }
+
+    // Same regexp as the one used to search in a file
+    std::shared_ptr<Configuration> config =
+        Persistent<Configuration>( "settings" );
+
+    QString pattern;
+    if ( config->mainRegexpType() == FixedString )
+        pattern = QRegularExpression::escape( search_text );
+    else
+        pattern = search_text;
+
+    QRegularExpression::PatternOptions pattern_options =
+        QRegularExpression::UseUnicodePropertiesOption
+        | QRegularExpression::OptimizeOnFirstUsageOption;
+    if ( ignoreCaseCheck_->isChecked() )
+        pattern_options |= QRegularExpression::CaseInsensitiveOption;
+
+    const QRegularExpression regexp( pattern, pattern_options );
+    if ( ! regexp.isValid() ) {
+        statusLabel_->setText( tr( "Error in expression: " ) + regexp.errorString() );
+        return;
+    }
+
+    // The searches are limited to what the disks can sustain
+    globalSearch_.reset( new GlobalSearch( config->searchParallelFiles() ) );
+    connect( globalSearch_.get(), SIGNAL( matchesAvailable() ),
+            this, SLOT( matchesAvailableHandler() ), Qt::QueuedConnection );
+    connect( globalSearch_.get(), SIGNAL( searchFinished() ),
+            this, SLOT( searchFinishedHandler() ), Qt::QueuedConnection );
+
+    stopButton_->setEnabled( true );
+    updateStatus( false );
+
+    globalSearch_->start( files, regexp );
+}
+
+void GlobalSearchWidget::waitForFiles( int nb_files )
+{
+    // Stop the previous search (its matches are not wanted anymore)
+    globalSearch_.reset();
+
+    resultsTree_->clear();
+    fileNames_.clear();
+    fileItems_.clear();
+    nbMatches_ = 0;
+
+    stopButton_->setEnabled( true );
+    statusLabel_->setText( tr( "Waiting for %1 files to load..." ).arg( nb_files ) );
+}
+
+//
+// Slots
+//
+
+void GlobalSearchWidget::stopHandler()
+{
+    // Interrupts the search and releases the files
+    globalSearch_.reset();
+
+    stopButton_->setEnabled( false );
+    statusLabel_->setText( tr( "%1 matches (stopped)" ).arg( nbMatches_ ) );
+
+    emit searchStopped();
+}
+
+void GlobalSearchWidget::matchesAvailableHandler()
+{
+    if ( ! globalSearch_ )
+        return;
+
+    for ( const auto& match: globalSearch_->takeNewMatches() ) {
+        QTreeWidgetItem*& file_item = fileItems_[match.file];
+        if ( ! file_item ) {
+            file_item = new QTreeWidgetItem( resultsTree_ );
+            file_item->setText( 0, fileNames_[match.file] );
+            file_item->setFirstColumnSpanned( true );
+            file_item->setExpanded( true );
+        }
+
+        QTreeWidgetItem* match_item = new QTreeWidgetItem( file_item );
+        match_item->setText( 0, QString::number( match.line + 1 ) );
+        match_item->setText( 1, match.text );
+        match_item->setData( 0, Qt::UserRole, match.file );
+        match_item->setData( 1, Qt::UserRole, match.line );
+
+        ++nbMatches_;
+    }
+
+    updateStatus( false );
+}
+
+void GlobalSearchWidget::searchFinishedHandler()
+{
+    // The signal might come from a search replaced since
+    if ( ! globalSearch_ || ! globalSearch_->isFinished() )
+        return;
+
+    // Some matches might still be waiting
+    matchesAvailableHandler();
+
+    stopButton_->setEnabled( false );
+    updateStatus( true );
+
+    // The files (possibly closed since) are not needed anymore
+    globalSearch_.reset();
+}
+
+void GlobalSearchWidget::itemActivatedHandler( QTreeWidgetItem* item, int )
+{
+    // The file items have no line
+    if ( item->data( 1, Qt::UserRole ).isValid() )
+        emit matchActivated( item->data( 0, Qt::UserRole ).toInt(),
+                item->data( 1, Qt::UserRole ).toLongLong() );
+}
+
+//
+// Private functions
+//
+
+void GlobalSearchWidget::updateStatus( bool finished )
+{
+    if ( ! globalSearch_ )
+        return;
+
+    QString status = tr( "%1 matches in %2/%3 files" )
+        .arg( nbMatches_ )
+        .arg( globalSearch_->getNbFilesSearched() )
+        .arg( fileNames_.size() );
+
+    if ( finished && globalSearch_->isTruncated() )
+        status += tr( " (only the first %1 matches are shown)" ).arg( nbMatches_ );
+
+    statusLabel_->setText( status );
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef GLOBALSEARCHWIDGET_H
+#define GLOBALSEARCHWIDGET_H
+
+#include <memory>
+#include <vector>
+
+#include <QWidget>
+#include <QStringList>
+
+class QLineEdit;
+class QCheckBox;
+class QPushButton;
+class QLabel;
+class QTreeWidget;
+class QTreeWidgetItem;
+class GlobalSearch;
+class AbstractLogSource;
+
+// Panel searching all the open files at once and displaying the
+// combined results, grouped by file.
+class GlobalSearchWidget : public QWidget
+{
+  Q_OBJECT
+
+  public:
+    GlobalSearchWidget( QWidget* parent = 0 );
+    ~GlobalSearchWidget();
+
+    // Give the focus to the search field
+    void userActivate();
+
+    // Search the pattern entered in the passed files (names are the
+    // ones displayed), called in response to searchRequested.
+    void search( const QStringList& file_names,
+            const std::vector<std::shared_ptr<const AbstractLogSource>>& files );
+    // Clear the results and tell the user the search will start once
+    // the passed number of files are loaded.
+    void waitForFiles( int nb_files );
+
+  signals:
+    // Sent when the user starts a search, the client is expected to
+    // call search() with the files to search.
+    void searchRequested();
+    // Sent when the user stops the search (or the wait before it).
+    void searchStopped();
+    // Sent when the user selects a match, file_index being the position
+    // of the file in the list passed to search().
+    void matchActivated( int file_index, qint64 line );
+
+  private slots:
+    void stopHandler();
+    void matchesAvailableHandler();
+    void searchFinishedHandler();
+    void itemActivatedHandler( QTreeWidgetItem* item, int column );
+
+  private:
+    // Update the status text with the number of matches
+    void updateStatus( bool finished );
+
+    QLineEdit*   searchLineEdit_;
+    QCheckBox*   ignoreCaseCheck_;
+    QPushButton* searchButton_;
+    QPushButton* stopButton_;
+    QLabel*      statusLabel_;
+    QTreeWidget* resultsTree_;
+
+    std::unique_ptr<GlobalSearch> globalSearch_;
+
+    // The files searched and the item of each one in the results
+    // (created with its first match)
+    QStringList fileNames_;
+    std::vector<QTreeWidgetItem*> fileItems_;
+    int nbMatches_;
+};
+
+#endif
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements GroupByWidget, the panel used to count the
+// values of capture groups.
+
+#include "log.h"
+
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QRegularExpression>
+
+#include "data/groupby.h"
+
+#include "groupbywidget.h"
+
+namespace {
+    // Columns of the results
+    enum { CountColumn, PercentColumn, ValueColumn };
+}
+
+GroupByWidget::GroupByWidget( QWidget* parent ) : QWidget( parent )
+{
+    regexpLineEdit_ = new QLineEdit( this );
+    regexpLineEdit_->setMinimumSize( QSize( 150, 0 ) );
+    regexpLineEdit_->setPlaceholderText( tr( "Expression with capture groups, e.g. user=(\\w+)" ) );
+
+    ignoreCaseCheck_ = new QCheckBox( tr( "Ignore &case" ) );
+    filteredOnlyCheck_ = new QCheckBox( tr( "&Filtered lines only" ) );
+    groupByButton_ = new QPushButton( tr( "&Count" ) );
+    stopButton_ = new QPushButton( tr( "St&op" ) );
+    stopButton_->setEnabled( false );
+    statusLabel_ = new QLabel();
+
+    resultsTree_ = new QTreeWidget();
+    resultsTree_->setColumnCount( 3 );
+    resultsTree_->setHeaderLabels( QStringList()
+            << tr( "Count" ) << tr( "%" ) << tr( "Value" ) );
+    resultsTree_->setRootIsDecorated( false );
+    resultsTree_->setUniformRowHeights( true );
+    resultsTree_->setSortingEnabled( true );
+    resultsTree_->sortByColumn( CountColumn, Qt::DescendingOrder );
+
+    QHBoxLayout* regexp_layout = new QHBoxLayout();
+    regexp_layout->setContentsMargins( 0, 0, 0, 0 );
+    regexp_layout->addWidget( regexpLineEdit_ );
+    regexp_layout->addWidget( ignoreCaseCheck_ );
+    regexp_layout->addWidget( filteredOnlyCheck_ );
+    regexp_layout->addWidget( groupByButton_ );
+    regexp_layout->addWidget( stopButton_ );
+    regexp_layout->addWidget( statusLabel_ );
+
+    QVBoxLayout* main_layout = new QVBoxLayout( this );
+    main_layout->setContentsMargins( 2, 2, 2, 2 );
+    main_layout->addLayout( regexp_layout );
+    main_layout->addWidget( resultsTree_ );
+
+    // Behaviour
+    connect( regexpLineEdit_, SIGNAL( returnPressed() ),
+            this, SIGNAL( groupByRequested() ) );
+    connect( groupByButton_, SIGNAL( clicked() ),
+            this, SIGNAL( groupByRequested() ) );
+    connect( stopButton_, SIGNAL( clicked() ),
+            this, SLOT( stopHandler() ) );
+    connect( resultsTree_, SIGNAL( itemActivated( QTreeWidgetItem*, int ) ),
+            this, SLOT( itemActivatedHandler( QTreeWidgetItem*, int ) ) );
+}
+
+GroupByWidget::~GroupByWidget()
+{
+}
+
+void GroupByWidget::userActivate()
+{
+    regexpLineEdit_->setFocus( Qt::ShortcutFocusReason );
+    regexpLineEdit_->selectAll();
+}
+
+bool GroupByWidget::isFilteredOnly() const
+{
+    return filteredOnlyCheck_->isChecked();
+}
+
+void GroupByWidget::groupBy( const std::shared_ptr<const AbstractLogSource>& source )
+{
+    QRegularExpression regexp;
+    if ( prepare( &regexp ) )
+        groupBy_->start( source, regexp );
+}
+
+void GroupByWidget::groupBy( const std::shared_ptr<const AbstractLogSource>& source,
+        std::vector<qint64> lines )
+{
+    QRegularExpression regexp;
+    if ( prepare( &regexp ) )
+        groupBy_->start( source, regexp, std::move( lines ) );
+}
+
+//
+// Slots
+//
+
+void GroupByWidget::stopHandler()
+{
+    // Interrupts the count and releases the file
+    groupBy_.reset();
+
+    stopButton_->setEnabled( false );
+    statusLabel_->setText( tr( "Stopped" ) );
+}
+
+void GroupByWidget::progressedHandler( int percent )
+{
+    if ( groupBy_ )
+        statusLabel_->setText( tr( "Counting (%1 %)" ).arg( percent ) );
+}
+
+void GroupByWidget::finishedHandler()
+{
+    // The signal might come from a count replaced since
+    if ( ! groupBy_ || ! groupBy_->isFinished() )
+        return;
+
+    const qint64 nb_lines = groupBy_->getNbMatchingLines();
+    const bool exact = groupBy_->isExact();
+
+    // The items are sorted once all of them have been added
+    resultsTree_->setSortingEnabled( false );
+    for ( const auto& entry: groupBy_->getResults() ) {
+        QTreeWidgetItem* item = new QTreeWidgetItem( resultsTree_ );
+        item->setData( CountColumn, Qt::DisplayRole, entry.count );
+        item->setData( PercentColumn, Qt::DisplayRole,
+                qRound( entry.count * 1000.0 / nb_lines ) / 10.0 );
+        item->setText( ValueColumn, GroupBy::displayText( entry.value ) );
+        item->setData( ValueColumn, Qt::UserRole, entry.value );
+        item->setTextAlignment( CountColumn, Qt::AlignRight );
+        item->setTextAlignment( PercentColumn, Qt::AlignRight );
+        if ( entry.error > 0 )
+            item->setToolTip( CountColumn,
+                    tr( "Between %1 and %2" ).arg( entry.count - entry.error ).arg( entry.count ) );
+    }
+    resultsTree_->setSortingEnabled( true );
+
+    QString status = tr( "%1 values in %2 lines" )
+        .arg( resultsTree_->topLevelItemCount() ).arg( nb_lines );
+    if ( ! exact )
+        status += tr( " (approximate counts)" );
+    statusLabel_->setText( status );
+    stopButton_->setEnabled( false );
+
+    // The file (possibly closed since) is not needed anymore
+    groupBy_.reset();
+}
+
+void GroupByWidget::itemActivatedHandler( QTreeWidgetItem* item, int )
+{
+    emit valueActivated( GroupBy::filterPattern(
+                pattern_, item->data( ValueColumn, Qt::UserRole ).toString() ) );
+}
+
+//
+// Private functions
+//
+
+bool GroupByWidget::prepare( QRegularExpression* regexp )
+{
+    pattern_ = regexpLineEdit_->text();
+
+    LOG(logDEBUG) << "GroupByWidget::groupBy " << pattern_.toStdString();
+
+    // Stop the previous count (its results are not wanted anymore)
+    groupBy_.reset();
+    resultsTree_->clear();
+
+    if ( pattern_.isEmpty() ) {
+        statusLabel_->clear();
+        return false;
+    }
+
+    QRegularExpression::PatternOptions pattern_options =
+        QRegularExpression::UseUnicodePropertiesOption
+        | QRegularExpression::OptimizeOnFirstUsageOption;
+    if ( ignoreCaseCheck_->isChecked() )
+        pattern_options |= QRegularExpression::CaseInsensitiveOption;
+
+    *regexp = QRegularExpression( pattern_, pattern_options );
+    if ( ! regexp->isValid() ) {
+        statusLabel_->setText( tr( "Error in expression: " ) + regexp->errorString() );
+        return false;
+    }
+
+    groupBy_.reset( new GroupBy() );
+    connect( groupBy_.get(), SIGNAL( progressed( int ) ),
+            this, SLOT( progressedHandler( int ) ), Qt::QueuedConnection );
+    connect( groupBy_.get(), SIGNAL( finished() ),
+            this, SLOT( finishedHandler() ), Qt::QueuedConnection );
+
+    stopButton_->setEnabled( true );
+    statusLabel_->setText( tr( "Counting" ) );
+
+    return true;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef GROUPBYWIDGET_H
+#define GROUPBYWIDGET_H
+
+#include <memory>
+#include <vector>
+
+#include <QWidget>
+
+class QLineEdit;
+class QCheckBox;
+class QPushButton;
+class QLabel;
+class QTreeWidget;
+class QTreeWidgetItem;
+class QRegularExpression;
+class GroupBy;
+class AbstractLogSource;
+
+// Panel counting the values of the capture groups of a regexp in the
+// current file and displaying the most frequent ones.
+class GroupByWidget : public QWidget
+{
+  Q_OBJECT
+
+  public:
+    GroupByWidget( QWidget* parent = 0 );
+    ~GroupByWidget();
+
+    // Give the focus to the expression field
+    void userActivate();
+
+    // Returns whether only the lines of the filtered view are counted
+    bool isFilteredOnly() const;
+
+    // Count the values in the lines of the passed file (all of them,
+    // or the lines passed), called in response to groupByRequested.
+    void groupBy( const std::shared_ptr<const AbstractLogSource>& source );
+    void groupBy( const std::shared_ptr<const AbstractLogSource>& source,
+            std::vector<qint64> lines );
+
+  signals:
+    // Sent when the user starts a count, the client is expected to
+    // call groupBy() with the current file.
+    void groupByRequested();
+    // Sent when the user selects a value, pattern matching the lines
+    // having this value.
+    void valueActivated( const QString& pattern );
+
+  private slots:
+    void stopHandler();
+    void progressedHandler( int percent );
+    void finishedHandler();
+    void itemActivatedHandler( QTreeWidgetItem* item, int column );
+
+  private:
+    // Clear the results and build the regexp entered, returns false
+    // (reporting the error) if there is nothing to count.
+    bool prepare( QRegularExpression* regexp );
+
+    QLineEdit*   regexpLineEdit_;
+    QCheckBox*   ignoreCaseCheck_;
+    QCheckBox*   filteredOnlyCheck_;
+    QPushButton* groupByButton_;
+    QPushButton* stopButton_;
+    QLabel*      statusLabel_;
+    QTreeWidget* resultsTree_;
+
+    std::unique_ptr<GroupBy> groupBy_;
+    // The pattern of the values displayed
+    QString pattern_;
+};
+
+#endif
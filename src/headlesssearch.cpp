@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements HeadlessSearch, the command line mode
+// searching files without a display.
+
+#include "headlesssearch.h"
+
+#include <iostream>
+
+#include <QFileInfo>
+
+#include "log.h"
+
+#include "fileset.h"
+#include "data/logdata.h"
+#include "data/concatenatedlogdata.h"
+#include "data/mergedlogdata.h"
+#include "data/logfiltereddata.h"
+
+HeadlessSearch::HeadlessSearch( const std::vector<std::string>& file_names,
+        const Options& options, std::ostream& out )
+    : QObject(), fileNames_( file_names ), options_( options ), out_( out ),
+    currentFile_( 0 ), nbMatchesWritten_( 0 ), timer_(),
+    matchFound_( false ), error_( false )
+{
+}
+
+HeadlessSearch::~HeadlessSearch()
+{
+    // The filtered data uses the data
+    logFilteredData_.reset();
+    logData_.reset();
+}
+
+void HeadlessSearch::start()
+{
+    currentFile_ = 0;
+
+    // Run from the event loop, so finished() can't be sent before
+    // the client is ready to receive it.
+    QMetaObject::invokeMethod( this, "processNextFile", Qt::QueuedConnection );
+}
+
+int HeadlessSearch::exitStatus() const
+{
+    if ( error_ )
+        return 2;
+    else if ( options_.regexp.pattern().isEmpty() )
+        return 0;
+    else
+        return matchFound_ ? 0 : 1;
+}
+
+//
+// Slots
+//
+
+// Called from the event loop, the data of the previous file
+// can be safely destroyed.
+void HeadlessSearch::processNextFile()
+{
+    logFilteredData_.reset();
+    logData_.reset();
+
+    if ( currentFile_ >= fileNames_.size() ) {
+        out_.flush();
+        emit finished();
+        return;
+    }
+
+    const QString name = QString::fromStdString( fileNames_[currentFile_] );
+
+    const QStringList files = FileSet::files( name );
+    for ( const auto& file: files ) {
+        if ( ! QFileInfo( file ).isReadable() ) {
+            std::cerr << "glogg: " << file.toLocal8Bit().constData()
+                << ": cannot read the file" << std::endl;
+            error_ = true;
+            ++currentFile_;
+            QMetaObject::invokeMethod( this, "processNextFile", Qt::QueuedConnection );
+            return;
+        }
+    }
+
+    LOG(logDEBUG) << "HeadlessSearch: loading " << name.toStdString();
+
+    timer_.start();
+
+    // Same data as the one a view would use
+    if ( FileSet::isMergedSet( name ) || FileSet::isFileSet( name ) ) {
+        std::shared_ptr<CompositeLogData> set_data;
+        if ( FileSet::isMergedSet( name ) )
+            set_data = std::make_shared<MergedLogData>();
+        else
+            set_data = std::make_shared<ConcatenatedLogData>();
+        logData_ = set_data;
+        connect( logData_.get(), SIGNAL( loadingFinished( LoadingStatus ) ),
+                this, SLOT( loadingFinished( LoadingStatus ) ) );
+        set_data->attachFiles( files );
+    }
+    else {
+        auto file_data = std::make_shared<LogData>();
+        logData_ = file_data;
+        connect( logData_.get(), SIGNAL( loadingFinished( LoadingStatus ) ),
+                this, SLOT( loadingFinished( LoadingStatus ) ) );
+        file_data->attachFile( name );
+    }
+}
+
+void HeadlessSearch::loadingFinished( LoadingStatus status )
+{
+    // The data is only loaded once, later changes are ignored
+    disconnect( logData_.get(), SIGNAL( loadingFinished( LoadingStatus ) ),
+            this, SLOT( loadingFinished( LoadingStatus ) ) );
+
+    if ( status != LoadingStatus::Successful ) {
+        std::cerr << "glogg: " << fileNames_[currentFile_]
+            << ": cannot index the file" << std::endl;
+        error_ = true;
+        ++currentFile_;
+        QMetaObject::invokeMethod( this, "processNextFile", Qt::QueuedConnection );
+        return;
+    }
+
+    LOG(logINFO) << "HeadlessSearch: " << logData_->getNbLine()
+        << " lines indexed in " << timer_.elapsed() << " ms";
+
+    if ( options_.regexp.pattern().isEmpty() ) {
+        out_ << filePrefix() << logData_->getNbLine() << std::endl;
+        ++currentFile_;
+        QMetaObject::invokeMethod( this, "processNextFile", Qt::QueuedConnection );
+        return;
+    }
+
+    timer_.start();
+
+    logFilteredData_.reset( logData_->getNewFilteredData() );
+    connect( logFilteredData_.get(), SIGNAL( searchProgressed( int, int, qint64 ) ),
+            this, SLOT( searchProgressed( int, int, qint64 ) ) );
+
+    nbMatchesWritten_ = 0;
+    logFilteredData_->runSearch( options_.regexp );
+}
+
+void HeadlessSearch::searchProgressed( int nb_matches, int progress, qint64 )
+{
+    if ( nb_matches > 0 )
+        matchFound_ = true;
+
+    if ( ! options_.count )
+        writeNewMatches();
+
+    if ( progress == 100 ) {
+        LOG(logINFO) << "HeadlessSearch: " << nb_matches
+            << " matches found in " << timer_.elapsed() << " ms";
+
+        if ( options_.count )
+            out_ << filePrefix() << nb_matches << std::endl;
+
+        ++currentFile_;
+        QMetaObject::invokeMethod( this, "processNextFile", Qt::QueuedConnection );
+    }
+}
+
+//
+// Private functions
+//
+
+void HeadlessSearch::writeNewMatches()
+{
+    const int nb_matches = logFilteredData_->getNbMatches();
+    const std::string prefix = filePrefix();
+
+    for ( int i = nbMatchesWritten_; i < nb_matches; ++i ) {
+        const qint64 line = logFilteredData_->getMatchingLineNumber( i );
+
+        out_ << prefix;
+        if ( options_.lineNumbers )
+            out_ << line + 1 << ':';
+        out_ << logData_->getLineString( line ).toLocal8Bit().constData() << '\n';
+    }
+
+    nbMatchesWritten_ = nb_matches;
+    out_.flush();
+}
+
+// The file is named as grep does, when there are several
+std::string HeadlessSearch::filePrefix() const
+{
+    if ( fileNames_.size() < 2 )
+        return std::string();
+
+    return FileSet::displayName( QString::fromStdString(
+                fileNames_[currentFile_] ) ).toStdString() + ':';
+}
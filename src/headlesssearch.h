@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef HEADLESSSEARCH_H
+#define HEADLESSSEARCH_H
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+
+#include "loadingstatus.h"
+
+class AbstractLogSource;
+class LogFilteredData;
+
+// Index and search files without any display (glogg --headless), using
+// the same LogData/LogFilteredData as the views. The files are processed
+// one after the other and the results are written as they are found:
+// the matching lines, their number or, if no search is requested, the
+// number of lines of each file.
+// An event loop must be running, finished() is sent when all the files
+// have been processed.
+class HeadlessSearch : public QObject
+{
+  Q_OBJECT
+
+  public:
+    struct Options {
+        // Only index the files if empty
+        QRegularExpression regexp;
+        // Only output the number of matching lines
+        bool count = false;
+        // Prefix the matching lines with their line number (from 1)
+        bool lineNumbers = false;
+    };
+
+    // The names can identify sets of files (see FileSet), the results
+    // are written to out (prefixed by the file name if there are several).
+    HeadlessSearch( const std::vector<std::string>& file_names,
+            const Options& options, std::ostream& out );
+    ~HeadlessSearch();
+
+    // Start processing the files (asynchronously)
+    void start();
+
+    // Returns the exit status of the processing, as grep does:
+    // 0 if a line matched (or all the files have been indexed),
+    // 1 if no line matched and 2 if a file could not be read.
+    int exitStatus() const;
+
+  signals:
+    // Sent when all the files have been processed
+    void finished();
+
+  private slots:
+    void processNextFile();
+    void loadingFinished( LoadingStatus status );
+    void searchProgressed( int nb_matches, int progress, qint64 initial_position );
+
+  private:
+    // Write the matches found since the previous call
+    void writeNewMatches();
+    // Returns the prefix of the lines written for the current file
+    std::string filePrefix() const;
+
+    const std::vector<std::string> fileNames_;
+    const Options options_;
+    std::ostream& out_;
+
+    // Index of the file being processed
+    size_t currentFile_;
+    std::shared_ptr<AbstractLogSource> logData_;
+    std::unique_ptr<LogFilteredData> logFilteredData_;
+    // Number of matches of the current file already written
+    int nbMatchesWritten_;
+    QElapsedTimer timer_;
+
+    bool matchFound_;
+    bool error_;
+};
+
+#endif
@@ -23,12 +23,25 @@
 #include <poll.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <errno.h>
+
+#include <unordered_set>
+#include <algorithm>
 
 #include "log.h"
 
 #include "watchtowerlist.h"
 
-INotifyWatchTowerDriver::INotifyWatchTowerDriver() : inotify_fd_( inotify_init() )
+namespace {
+    // Remove the duplicated elements of the vector, keeping
+    // the first occurence of each so the order is preserved.
+    template <typename T>
+    void removeDuplicates( std::vector<T*>* elements );
+};
+
+// The inotify fd is non blocking so all pending events can be drained
+// once poll says there is something to read.
+INotifyWatchTowerDriver::INotifyWatchTowerDriver() : inotify_fd_( inotify_init1( IN_NONBLOCK ) )
 {
     int pipefd[2];
 
@@ -103,7 +116,10 @@ void INotifyWatchTowerDriver::removeDir( const DirId& dir_id )
         inotify_rm_watch( inotify_fd_, dir_id.wd_ );
 }
 
-static constexpr size_t INOTIFY_BUFFER_SIZE = 4096;
+static constexpr size_t INOTIFY_BUFFER_SIZE = 16384;
+// Maximum number of bytes of events treated in one batch,
+// a storm of events won't delay the notifications more than that.
+static constexpr size_t INOTIFY_MAX_BATCH_SIZE = 1024 * 1024;
 
 std::vector<INotifyWatchTowerDriver::INotifyObservedFile*>
 INotifyWatchTowerDriver::waitAndProcessEvents(
@@ -135,23 +151,39 @@ INotifyWatchTowerDriver::waitAndProcessEvents(
             char buffer[ INOTIFY_BUFFER_SIZE ]
                 __attribute__ ((aligned(__alignof__(struct inotify_event))));
 
-            ssize_t nb = read( inotify_fd_, buffer, sizeof( buffer ) );
-            LOG(logDEBUG) << "Read " << nb << " bytes";
-            if ( nb > 0 )
+            // Drain all the events already queued so a burst of events
+            // results in a single notification per file.
+            size_t batch_size = 0;
+            while ( batch_size < INOTIFY_MAX_BATCH_SIZE )
             {
-                ssize_t offset = 0;
-                while ( offset < nb ) {
-                    const inotify_event* event =
-                        reinterpret_cast<const inotify_event*>( buffer + offset );
-
-                    offset += processINotifyEvent( event, list,
-                            &files_to_notify, files_needing_readding );
+                ssize_t nb = read( inotify_fd_, buffer, sizeof( buffer ) );
+                LOG(logDEBUG) << "Read " << nb << " bytes";
+                if ( nb > 0 )
+                {
+                    ssize_t offset = 0;
+                    while ( offset < nb ) {
+                        const inotify_event* event =
+                            reinterpret_cast<const inotify_event*>( buffer + offset );
+
+                        offset += processINotifyEvent( event, list,
+                                &files_to_notify, files_needing_readding );
+                    }
+                    batch_size += nb;
+                }
+                else
+                {
+                    if ( nb < 0 && errno != EAGAIN && errno != EWOULDBLOCK ) {
+                        LOG(logWARNING) << "Error reading from inotify " << errno;
+                    }
+                    break;
                 }
             }
-            else
-            {
-                LOG(logWARNING) << "Error reading from inotify " << errno;
-            }
+
+            LOG(logDEBUG) << "Batch of " << batch_size << " bytes, "
+                << files_to_notify.size() << " notifications";
+
+            removeDuplicates( &files_to_notify );
+            removeDuplicates( files_needing_readding );
         }
 
         if ( fds[1].revents & POLLIN )
@@ -217,3 +249,15 @@ void INotifyWatchTowerDriver::interruptWait()
 
     (void) write( breaking_pipe_write_fd_, (void*) &byte, sizeof byte );
 }
+
+namespace {
+    template <typename T>
+    void removeDuplicates( std::vector<T*>* elements )
+    {
+        std::unordered_set<T*> seen;
+
+        elements->erase( std::remove_if( elements->begin(), elements->end(),
+                    [&seen] (T* element) { return ! seen.insert( element ).second; } ),
+                elements->end() );
+    }
+};
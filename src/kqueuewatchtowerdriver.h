@@ -20,6 +20,7 @@
 #ifndef KQUEUEWATCHTOWERDRIVER_H
 #define KQUEUEWATCHTOWERDRIVER_H
 
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -38,6 +39,10 @@ class KQueueWatchTowerDriver {
         FileId() { fd_ = -1; }
         bool operator==( const FileId& other ) const
         { return fd_ == other.fd_; }
+        bool valid() const
+        { return (fd_ != -1); }
+        std::size_t hash() const
+        { return std::hash<int>()( fd_ ); }
       private:
         FileId( int fd ) { fd_ = fd; }
         int fd_;
@@ -51,6 +56,8 @@ class KQueueWatchTowerDriver {
         { return wd_ == other.wd_; }
         bool valid() const
         { return (wd_ != -1); }
+        std::size_t hash() const
+        { return std::hash<int>()( wd_ ); }
       private:
         DirId( int wd ) { wd_ = wd; }
         int wd_;
@@ -62,6 +69,10 @@ class KQueueWatchTowerDriver {
         SymlinkId() { wd_ = -1; }
         bool operator==( const SymlinkId& other ) const
         { return wd_ == other.wd_; }
+        bool valid() const
+        { return (wd_ != -1); }
+        std::size_t hash() const
+        { return std::hash<int>()( wd_ ); }
       private:
         SymlinkId( int wd ) { wd_ = wd; }
         int wd_;
@@ -29,12 +29,13 @@
 
 #include <QKeyEvent>
 
-LogMainView::LogMainView( const LogData* newLogData,
+LogMainView::LogMainView( const AbstractLogSource* newLogData,
         const QuickFindPattern* const quickFindPattern,
         Overview* overview,
         OverviewWidget* overview_widget,
         QWidget* parent)
-    : AbstractLogView( newLogData, quickFindPattern, parent )
+    : AbstractLogView( newLogData, quickFindPattern, parent ),
+    logSource_( newLogData )
 {
     filteredData_ = NULL;
 
@@ -68,6 +69,11 @@ AbstractLogView::LineType LogMainView::lineType( int lineNumber ) const
         return Normal;
 }
 
+int LogMainView::lineSource( int lineNumber ) const
+{
+    return logSource_->getLineSource( lineNumber );
+}
+
 void LogMainView::keyPressEvent( QKeyEvent* keyEvent )
 {
     bool noModifier = keyEvent->modifiers() == Qt::NoModifier;
@@ -22,13 +22,13 @@
 #define LOGMAINVIEW_H
 
 #include "abstractlogview.h"
-#include "data/logdata.h"
+#include "data/abstractlogsource.h"
 
 // Class implementing the main (top) view widget.
 class LogMainView : public AbstractLogView
 {
   public:
-    LogMainView( const LogData* newLogData,
+    LogMainView( const AbstractLogSource* newLogData,
             const QuickFindPattern* const quickFindPattern,
             Overview* overview,
             OverviewWidget* overview_widget,
@@ -42,10 +42,12 @@ class LogMainView : public AbstractLogView
   protected:
     // Implements the virtual function
     virtual LineType lineType( int lineNumber ) const;
+    virtual int lineSource( int lineNumber ) const;
 
     virtual void keyPressEvent( QKeyEvent* keyEvent );
 
   private:
+    const AbstractLogSource* logSource_;
     LogFilteredData* filteredData_;
 };
 
@@ -18,7 +18,10 @@
  */
 
 #include <QFileInfo>
+#include <QElapsedTimer>
+#include <QRegularExpression>
 
+#include <algorithm>
 #include <memory>
 
 #include <boost/program_options.hpp>
@@ -39,9 +42,12 @@ using namespace std;
 #include "filterset.h"
 #include "recentfiles.h"
 #include "session.h"
+#include "fileset.h"
 #include "mainwindow.h"
+#include "headlesssearch.h"
 #include "savedsearches.h"
 #include "loadingstatus.h"
+#include "data/inputspooler.h"
 
 #include "externalcom.h"
 
@@ -53,19 +59,36 @@ using namespace std;
 
 
 #include "log.h"
+#include "tracing.h"
 
 static void print_version();
+static void write_trace( const string& file_name );
 
 int main(int argc, char *argv[])
 {
-    GloggApp app(argc, argv);
+    // Measure the time until the first view is usable
+    QElapsedTimer startup_timer;
+    startup_timer.start();
+
+    // The headless mode must work without a display, so it can't
+    // create a QApplication.
+    const bool headless = std::any_of( argv + 1, argv + argc,
+            []( const char* arg ) { return string( arg ) == "--headless"; } );
+    unique_ptr<QCoreApplication> app( headless ?
+            new QCoreApplication( argc, argv ) : new GloggApp( argc, argv ) );
 
     vector<string> filenames;
+    HeadlessSearch::Options headless_options;
 
     // Configuration
     bool new_session = false;
     bool load_session = false;
     bool multi_instance = false;
+    bool concatenate = false;
+    bool merge = false;
+    bool print_statistics = false;
+    string trace_file;
+    qint64 spool_limit = 1024;
 #ifdef _WIN32
     bool log_to_file = false;
 #endif
@@ -80,11 +103,25 @@ int main(int argc, char *argv[])
             ("multi,m", "allow multiple instance of glogg to run simultaneously (use together with -s)")
             ("load-session,s", "load the previous session (default when no file is passed)")
             ("new-session,n", "do not load the previous session (default when a file is passed)")
+            ("concatenate,c", "open all the files passed in one view, one after the other (a quoted pattern like 'app.log*' opens a log and its rotated versions, oldest first)")
+            ("merge,g", "open all the files passed in one view, their lines interleaved in timestamp order (patterns are allowed as for -c)")
 #ifdef _WIN32
             ("log,l", "save the log to a file (Windows only)")
 #endif
             ("debug,d", "output more debug (include multiple times for more verbosity e.g. -dddd)")
+            ("statistics", "print the resources used for each file open in the running instance of glogg")
+            ("spool-limit", po::value<qint64>(), "maximum size in MiB of the copy kept of the standard input (passed as -) or of a named pipe, 0 for no limit (default 1024)")
+            ("trace", po::value<string>(), "record the duration of the internal operations and write them to the file on exit, in Chrome trace format (for chrome://tracing or Perfetto)")
+            ;
+        po::options_description desc_headless("Headless mode");
+        desc_headless.add_options()
+            ("headless", "index and search the files passed without displaying them, the results are written to the standard output (without --search, the number of lines of each file is written)")
+            ("search,e", po::value<string>(), "regular expression to search for")
+            ("ignore-case,i", "ignore the case when searching")
+            ("count", "only write the number of matching lines")
+            ("line-numbers", "write the line number before each matching line")
             ;
+        desc.add( desc_headless );
         po::options_description desc_hidden("Hidden options");
         // For -dd, -ddd...
         for ( string s = "dd"; s.length() <= 10; s.append("d") )
@@ -135,6 +172,21 @@ int main(int argc, char *argv[])
         if ( vm.count( "load-session" ) )
             load_session = true;
 
+        if ( vm.count( "concatenate" ) )
+            concatenate = true;
+
+        if ( vm.count( "merge" ) )
+            merge = true;
+
+        if ( vm.count( "statistics" ) )
+            print_statistics = true;
+
+        if ( vm.count( "spool-limit" ) )
+            spool_limit = vm["spool-limit"].as<qint64>();
+
+        if ( vm.count( "trace" ) )
+            trace_file = vm["trace"].as<string>();
+
 #ifdef _WIN32
         if ( vm.count( "log" ) )
             log_to_file = true;
@@ -147,6 +199,27 @@ int main(int argc, char *argv[])
         if ( vm.count("input-file") ) {
             filenames = vm["input-file"].as<vector<string>>();
         }
+
+        if ( vm.count( "search" ) ) {
+            headless_options.regexp = QRegularExpression(
+                    QString::fromStdString( vm["search"].as<string>() ),
+                    vm.count( "ignore-case" ) ?
+                        QRegularExpression::CaseInsensitiveOption :
+                        QRegularExpression::NoPatternOption );
+            if ( ! headless_options.regexp.isValid() ) {
+                cerr << "Invalid regular expression: "
+                    << headless_options.regexp.errorString().toStdString() << endl;
+                return 2;
+            }
+        }
+
+        headless_options.count = vm.count( "count" );
+        headless_options.lineNumbers = vm.count( "line-numbers" );
+
+        if ( headless && filenames.empty() ) {
+            cerr << "No file to search." << endl;
+            return 2;
+        }
     }
     catch(exception& e) {
         cerr << "Option processing error: " << e.what() << endl;
@@ -168,6 +241,25 @@ int main(int argc, char *argv[])
 
     FILELog::setReportingLevel( logLevel );
 
+    if ( ! trace_file.empty() )
+        Tracing::setEnabled( true );
+
+    // The standard input and named pipes cannot be seeked, they are
+    // copied to a file as they are read and the file is opened instead.
+    vector<unique_ptr<InputSpooler>> spoolers;
+    for ( auto& filename: filenames ) {
+        const QString name = QString::fromLocal8Bit( filename.c_str() );
+        if ( InputSpooler::isStream( name ) ) {
+            spoolers.emplace_back( new InputSpooler( name, spool_limit * 1024 * 1024 ) );
+            spoolers.back()->start();
+            filename = spoolers.back()->spoolFileName().toLocal8Bit().toStdString();
+
+            // The spool is removed when we exit, so it cannot be
+            // passed to another instance.
+            multi_instance = true;
+        }
+    }
+
     for ( auto& filename: filenames ) {
         if ( ! filename.empty() ) {
             // Convert to absolute path
@@ -177,6 +269,46 @@ int main(int argc, char *argv[])
         }
     }
 
+    // The files are replaced by the set they make
+    if ( ( concatenate || merge ) && ! filenames.empty() ) {
+        QStringList files;
+        for ( const auto& filename: filenames ) {
+            const QString name = QString::fromStdString( filename );
+            if ( name.contains( QRegularExpression( "[*?[]" ) ) ) {
+                const QStringList matching = FileSet::filesMatching( name );
+                if ( matching.isEmpty() ) {
+                    cerr << "No file matching " << filename << endl;
+                    return 1;
+                }
+                files.append( matching );
+            }
+            else {
+                files.append( name );
+            }
+        }
+
+        filenames = { FileSet::nameForFiles( files,
+                merge ? FileSet::Kind::Merged : FileSet::Kind::Concatenated )
+            .toStdString() };
+    }
+
+    if ( headless ) {
+        // As grep does, the whole input is searched
+        for ( const auto& spooler: spoolers )
+            spooler->waitForEnd();
+
+        HeadlessSearch search( filenames, headless_options, cout );
+        QObject::connect( &search, SIGNAL( finished() ), app.get(), SLOT( quit() ) );
+
+        search.start();
+        app->exec();
+
+        if ( ! trace_file.empty() )
+            write_trace( trace_file );
+
+        return search.exitStatus();
+    }
+
     // External communicator
     shared_ptr<ExternalCommunicator> externalCommunicator = nullptr;
     shared_ptr<ExternalInstance> externalInstance = nullptr;
@@ -197,7 +329,16 @@ int main(int argc, char *argv[])
     }
 
     LOG(logDEBUG) << "externalInstance = " << externalInstance;
-    if ( ( ! multi_instance ) && externalInstance ) {
+    if ( print_statistics ) {
+        if ( ! externalInstance ) {
+            cerr << "No running instance of glogg." << endl;
+            return 1;
+        }
+
+        cout << externalInstance->getStatistics().toStdString();
+        return 0;
+    }
+    else if ( ( ! multi_instance ) && externalInstance ) {
         uint32_t version = externalInstance->getVersion();
         LOG(logINFO) << "Found another glogg (version = "
             << std::setbase(16) << version << ")";
@@ -243,10 +384,10 @@ int main(int argc, char *argv[])
 #endif
 
     // We support high-dpi (aka Retina) displays
-    app.setAttribute( Qt::AA_UseHighDpiPixmaps );
+    QCoreApplication::setAttribute( Qt::AA_UseHighDpiPixmaps );
 
     // No icon in menus
-    app.setAttribute( Qt::AA_DontShowIconsInMenus );
+    QCoreApplication::setAttribute( Qt::AA_DontShowIconsInMenus );
 
     // FIXME: should be replaced by a two staged init of MainWindow
     GetPersistentInfo().retrieve( QString( "settings" ) );
@@ -254,6 +395,8 @@ int main(int argc, char *argv[])
     std::unique_ptr<Session> session( new Session() );
     MainWindow mw( std::move( session ), externalCommunicator );
 
+    mw.setStartupTimer( startup_timer );
+
     // Geometry
     mw.reloadGeometry();
 
@@ -272,7 +415,12 @@ int main(int argc, char *argv[])
 
     mw.startBackgroundTasks();
 
-    return app.exec();
+    const int result = app->exec();
+
+    if ( ! trace_file.empty() )
+        write_trace( trace_file );
+
+    return result;
 }
 
 static void print_version()
@@ -286,3 +434,9 @@ static void print_version()
     cout << "the GNU General Public License <http://www.gnu.org/licenses/gpl.html>.\n";
     cout << "There is NO WARRANTY, to the extent permitted by law.\n";
 }
+
+static void write_trace( const string& file_name )
+{
+    if ( ! Tracing::exportChromeTrace( file_name ) )
+        cerr << "Cannot write the trace to " << file_name << endl;
+}
@@ -26,6 +26,7 @@
 
 #include <QAction>
 #include <QDesktopWidget>
+#include <QDockWidget>
 #include <QMenuBar>
 #include <QToolBar>
 #include <QFileInfo>
@@ -38,11 +39,13 @@
 #include <QUrl>
 
 #include "log.h"
+#include "tracing.h"
 
 #include "mainwindow.h"
 
 #include "sessioninfo.h"
 #include "recentfiles.h"
+#include "fileset.h"
 #include "crawlerwidget.h"
 #include "filtersdialog.h"
 #include "optionsdialog.h"
@@ -50,6 +53,7 @@
 #include "menuactiontooltipbehavior.h"
 #include "tabbedcrawlerwidget.h"
 #include "externalcom.h"
+#include "data/templateminer.h"
 
 // Returns the size in human readable format
 static QString readableSize( qint64 size );
@@ -62,7 +66,8 @@ MainWindow::MainWindow( std::unique_ptr<Session> session,
     mainIcon_(),
     signalMux_(),
     quickFindMux_( session_->getQuickFindPattern() ),
-    mainTabWidget_()
+    mainTabWidget_(),
+    globalSearchPending_( false )
 #ifdef GLOGG_SUPPORTS_VERSION_CHECKING
     ,versionChecker_()
 #endif
@@ -176,6 +181,68 @@ MainWindow::MainWindow( std::unique_ptr<Session> session,
     central_widget->setLayout( main_layout );
 
     setCentralWidget( central_widget );
+
+    // The global search panel, shown on request
+    globalSearchDock_ = new QDockWidget( tr( "Search all open files" ), this );
+    globalSearchDock_->setObjectName( "globalSearchDock" );
+    globalSearchDock_->setWidget( &globalSearchWidget_ );
+    addDockWidget( Qt::BottomDockWidgetArea, globalSearchDock_ );
+    globalSearchDock_->hide();
+
+    connect( &globalSearchWidget_, SIGNAL( searchRequested() ),
+            this, SLOT( startGlobalSearch() ) );
+    connect( &globalSearchWidget_, SIGNAL( searchStopped() ),
+            this, SLOT( stopGlobalSearch() ) );
+    connect( &globalSearchWidget_, SIGNAL( matchActivated( int, qint64 ) ),
+            this, SLOT( displayGlobalSearchMatch( int, qint64 ) ) );
+
+    // The group by panel, shown on request
+    groupByDock_ = new QDockWidget( tr( "Group by" ), this );
+    groupByDock_->setObjectName( "groupByDock" );
+    groupByDock_->setWidget( &groupByWidget_ );
+    addDockWidget( Qt::BottomDockWidgetArea, groupByDock_ );
+    groupByDock_->hide();
+
+    connect( &groupByWidget_, SIGNAL( groupByRequested() ),
+            this, SLOT( startGroupBy() ) );
+    connect( &groupByWidget_, SIGNAL( valueActivated( const QString& ) ),
+            this, SLOT( filterGroupByValue( const QString& ) ) );
+
+    // The templates panel, shown on request
+    templatesDock_ = new QDockWidget( tr( "Templates" ), this );
+    templatesDock_->setObjectName( "templatesDock" );
+    templatesDock_->setWidget( &templatesWidget_ );
+    addDockWidget( Qt::BottomDockWidgetArea, templatesDock_ );
+    templatesDock_->hide();
+
+    connect( &templatesWidget_, SIGNAL( analyseRequested() ),
+            this, SLOT( startTemplateMining() ) );
+    connect( &templatesWidget_, SIGNAL( showRequested() ),
+            this, SLOT( showTemplates() ) );
+    connect( &templatesWidget_, SIGNAL( exampleActivated( qint64 ) ),
+            this, SLOT( displayTemplateExample( qint64 ) ) );
+
+    // The statistics panel, refreshed every second while it is shown
+    statisticsDock_ = new QDockWidget( tr( "Statistics" ), this );
+    statisticsDock_->setObjectName( "statisticsDock" );
+    statisticsDock_->setWidget( &statisticsWidget_ );
+    addDockWidget( Qt::RightDockWidgetArea, statisticsDock_ );
+    statisticsDock_->hide();
+
+    statisticsDock_->toggleViewAction()->setText( tr( "&Statistics" ) );
+    viewMenu->addSeparator();
+    viewMenu->addAction( statisticsDock_->toggleViewAction() );
+
+    statisticsTimer_.setInterval( 1000 );
+    connect( &statisticsTimer_, SIGNAL( timeout() ),
+            this, SLOT( updateStatistics() ) );
+    connect( statisticsDock_, SIGNAL( visibilityChanged( bool ) ),
+            this, SLOT( statisticsVisibilityChanged( bool ) ) );
+
+    // Other instances can query the statistics
+    if ( externalCommunicator_ )
+        externalCommunicator_->setStatisticsProvider(
+                [this] { return statisticsReport(); } );
 }
 
 void MainWindow::reloadGeometry()
@@ -186,6 +253,11 @@ void MainWindow::reloadGeometry()
     restoreGeometry( geometry );
 }
 
+void MainWindow::setStartupTimer( const QElapsedTimer& timer )
+{
+    startupTimer_ = timer;
+}
+
 void MainWindow::reloadSession()
 {
     int current_file_index = -1;
@@ -205,6 +277,10 @@ void MainWindow::reloadSession()
 
     if ( current_file_index >= 0 )
         mainTabWidget_.setCurrentIndex( current_file_index );
+
+    // The current tab is loaded (the others are when selected)
+    if ( CrawlerWidget* current = currentCrawlerWidget() )
+        session_->activate( current );
 }
 
 void MainWindow::loadInitialFile( QString fileName )
@@ -223,12 +299,38 @@ void MainWindow::startBackgroundTasks()
 #ifdef GLOGG_SUPPORTS_VERSION_CHECKING
     versionChecker_.startCheck();
 #endif
+
+    // Without any file, the window is usable as soon as it is shown
+    if ( mainTabWidget_.count() == 0 )
+        reportStartupTime();
 }
 
 //
 // Private functions
 //
 
+void MainWindow::openFiles( FileSet::Kind kind )
+{
+    QString defaultDir = ".";
+
+    // Default to the path of the current file if there is one
+    if ( auto current = currentCrawlerWidget() )
+    {
+        std::string current_file = session_->getFilename( current );
+        QFileInfo fileInfo = QFileInfo(
+                FileSet::files( QString( current_file.c_str() ) ).last() );
+        defaultDir = fileInfo.path();
+    }
+
+    // Several files selected are opened together (in rotation order,
+    // or merged)
+    QStringList fileNames = QFileDialog::getOpenFileNames(this,
+            tr("Open file"), defaultDir, tr("All files (*)"));
+    FileSet::sortByRotation( &fileNames );
+    if (!fileNames.isEmpty())
+        loadFile( FileSet::nameForFiles( fileNames, kind ) );
+}
+
 const MainWindow::EncodingList MainWindow::encoding_list[] = {
     { "&Auto" },
     { "ASCII / &ISO-8859-1" },
@@ -255,6 +357,10 @@ void MainWindow::createActions()
     openAction->setStatusTip(tr("Open a file"));
     connect(openAction, SIGNAL(triggered()), this, SLOT(open()));
 
+    openMergedAction = new QAction(tr("Open &merged..."), this);
+    openMergedAction->setStatusTip(tr("Open files with their lines interleaved in timestamp order"));
+    connect(openMergedAction, SIGNAL(triggered()), this, SLOT(openMerged()));
+
     closeAction = new QAction(tr("&Close"), this);
     closeAction->setShortcut(tr("Ctrl+W"));
     closeAction->setStatusTip(tr("Close document"));
@@ -294,6 +400,24 @@ void MainWindow::createActions()
     connect( findAction, SIGNAL(triggered()),
             this, SLOT( find() ) );
 
+    searchAllFilesAction = new QAction(tr("Search &all open files..."), this);
+    searchAllFilesAction->setShortcut(tr("Ctrl+Shift+F"));
+    searchAllFilesAction->setStatusTip(tr("Search the text in all the open files"));
+    connect( searchAllFilesAction, SIGNAL(triggered()),
+            this, SLOT( searchAllFiles() ) );
+
+    groupByAction = new QAction(tr("&Group by..."), this);
+    groupByAction->setShortcut(tr("Ctrl+Shift+G"));
+    groupByAction->setStatusTip(tr("Count the values of an expression in the current file"));
+    connect( groupByAction, SIGNAL(triggered()),
+            this, SLOT( groupBy() ) );
+
+    templatesAction = new QAction(tr("&Templates..."), this);
+    templatesAction->setShortcut(tr("Ctrl+Shift+T"));
+    templatesAction->setStatusTip(tr("Group the lines of the current file by template"));
+    connect( templatesAction, SIGNAL(triggered()),
+            this, SLOT( templates() ) );
+
     overviewVisibleAction = new QAction( tr("Matches &overview"), this );
     overviewVisibleAction->setCheckable( true );
     overviewVisibleAction->setChecked( config->isOverviewVisible() );
@@ -338,6 +462,17 @@ void MainWindow::createActions()
     optionsAction->setStatusTip(tr("Show the Options box"));
     connect( optionsAction, SIGNAL(triggered()), this, SLOT(options()) );
 
+    recordTraceAction = new QAction(tr("&Record Trace"), this);
+    recordTraceAction->setStatusTip(tr("Record the duration of the internal operations"));
+    recordTraceAction->setCheckable( true );
+    recordTraceAction->setChecked( Tracing::isEnabled() );
+    connect( recordTraceAction, SIGNAL(toggled( bool )),
+            this, SLOT(toggleTracing( bool )) );
+
+    saveTraceAction = new QAction(tr("&Save Trace..."), this);
+    saveTraceAction->setStatusTip(tr("Save the trace recorded in Chrome trace format"));
+    connect( saveTraceAction, SIGNAL(triggered()), this, SLOT(saveTrace()) );
+
     aboutAction = new QAction(tr("&About"), this);
     aboutAction->setStatusTip(tr("Show the About box"));
     connect( aboutAction, SIGNAL(triggered()), this, SLOT(about()) );
@@ -365,6 +500,7 @@ void MainWindow::createMenus()
 {
     fileMenu = menuBar()->addMenu( tr("&File") );
     fileMenu->addAction( openAction );
+    fileMenu->addAction( openMergedAction );
     fileMenu->addAction( closeAction );
     fileMenu->addAction( closeAllAction );
     fileMenu->addSeparator();
@@ -381,6 +517,9 @@ void MainWindow::createMenus()
     editMenu->addAction( selectAllAction );
     editMenu->addSeparator();
     editMenu->addAction( findAction );
+    editMenu->addAction( searchAllFilesAction );
+    editMenu->addAction( groupByAction );
+    editMenu->addAction( templatesAction );
 
     viewMenu = menuBar()->addMenu( tr("&View") );
     viewMenu->addAction( overviewVisibleAction );
@@ -396,6 +535,9 @@ void MainWindow::createMenus()
     toolsMenu->addAction( filtersAction );
     toolsMenu->addSeparator();
     toolsMenu->addAction( optionsAction );
+    toolsMenu->addSeparator();
+    toolsMenu->addAction( recordTraceAction );
+    toolsMenu->addAction( saveTraceAction );
 
     encodingMenu = menuBar()->addMenu( tr("En&coding") );
     encodingMenu->addAction( encodingAction[0] );
@@ -439,20 +581,13 @@ void MainWindow::createToolBars()
 // Opens the file selection dialog to select a new log file
 void MainWindow::open()
 {
-    QString defaultDir = ".";
-
-    // Default to the path of the current file if there is one
-    if ( auto current = currentCrawlerWidget() )
-    {
-        std::string current_file = session_->getFilename( current );
-        QFileInfo fileInfo = QFileInfo( QString( current_file.c_str() ) );
-        defaultDir = fileInfo.path();
-    }
+    openFiles( FileSet::Kind::Concatenated );
+}
 
-    QString fileName = QFileDialog::getOpenFileName(this,
-            tr("Open file"), defaultDir, tr("All files (*)"));
-    if (!fileName.isEmpty())
-        loadFile(fileName);
+// Opens the file selection dialog to select logs to merge
+void MainWindow::openMerged()
+{
+    openFiles( FileSet::Kind::Merged );
 }
 
 // Opens a log file from the recent files list
@@ -513,6 +648,27 @@ void MainWindow::find()
     displayQuickFindBar( QuickFindMux::Forward );
 }
 
+// Show the global search panel
+void MainWindow::searchAllFiles()
+{
+    globalSearchDock_->show();
+    globalSearchWidget_.userActivate();
+}
+
+// Show the group by panel
+void MainWindow::groupBy()
+{
+    groupByDock_->show();
+    groupByWidget_.userActivate();
+}
+
+// Show the templates panel
+void MainWindow::templates()
+{
+    templatesDock_->show();
+    templatesWidget_.userActivate();
+}
+
 // Opens the 'Filters' dialog box
 void MainWindow::filters()
 {
@@ -531,6 +687,29 @@ void MainWindow::options()
     signalMux_.disconnect(&dialog, SIGNAL( optionsChanged() ), SLOT( applyConfiguration() ));
 }
 
+// Starts or stops the recording of the trace
+void MainWindow::toggleTracing( bool enabled )
+{
+    // A new recording starts from scratch
+    if ( enabled )
+        Tracing::clear();
+
+    Tracing::setEnabled( enabled );
+}
+
+// Saves the trace recorded, to be opened in chrome://tracing or Perfetto
+void MainWindow::saveTrace()
+{
+    const QString file_name = QFileDialog::getSaveFileName( this,
+            tr("Save trace"), QString( "glogg_trace.json" ),
+            tr("Chrome trace (*.json)") );
+
+    if ( ! file_name.isEmpty()
+            && ! Tracing::exportChromeTrace( file_name.toStdString() ) )
+        QMessageBox::warning( this, tr("glogg"),
+                tr("Cannot write the trace to %1.").arg( file_name ) );
+}
+
 // Opens the 'About' dialog box.
 void MainWindow::about()
 {
@@ -601,8 +780,8 @@ void MainWindow::updateLoadingProgress( int progress )
 {
     LOG(logDEBUG) << "Loading progress: " << progress;
 
-    QString current_file =
-        session_->getFilename( currentCrawlerWidget() ).c_str();
+    QString current_file = FileSet::displayName(
+            session_->getFilename( currentCrawlerWidget() ).c_str() );
 
     // We ignore 0% and 100% to avoid a flash when the file (or update)
     // is very short.
@@ -634,6 +813,8 @@ void MainWindow::handleLoadingFinished( LoadingStatus status )
 
         // Now everything is ready, we can finally show the file!
         currentCrawlerWidget()->show();
+
+        reportStartupTime();
     }
     else
     {
@@ -676,6 +857,10 @@ void MainWindow::closeTab( int index )
     mainTabWidget_.removeTab( index );
     session_->close( widget );
     delete widget;
+
+    // The global search might have been waiting for this file
+    if ( globalSearchPending_ )
+        startGlobalSearch();
 }
 
 void MainWindow::currentTabChanged( int index )
@@ -689,6 +874,9 @@ void MainWindow::currentTabChanged( int index )
         signalMux_.setCurrentDocument( crawler_widget );
         quickFindMux_.registerSelector( crawler_widget );
 
+        // Files restored from the session are loaded when first displayed
+        session_->activate( crawler_widget );
+
         // New tab is set up with fonts etc...
         emit optionsChanged();
 
@@ -717,6 +905,170 @@ void MainWindow::changeQFPattern( const QString& newPattern )
     quickFindWidget_.changeDisplayedPattern( newPattern );
 }
 
+// Search all the open files, in the order of the tabs
+void MainWindow::startGlobalSearch()
+{
+    // The files not loaded yet would report no match, the search
+    // waits for them. The ones restored from the session and not
+    // displayed yet are loaded one at a time, once nothing else is,
+    // so they don't delay the loading of the displayed file.
+    int nb_loading = 0;
+    bool loading_running = false;
+    CrawlerWidget* next_deferred = nullptr;
+    for ( int i = 0; i < mainTabWidget_.count(); ++i ) {
+        auto crawler_widget = dynamic_cast<CrawlerWidget*>(
+                mainTabWidget_.widget( i ) );
+        assert( crawler_widget );
+
+        if ( crawler_widget->isLoading() ) {
+            ++nb_loading;
+            if ( session_->isLoadingDeferred( crawler_widget ) ) {
+                if ( ! next_deferred )
+                    next_deferred = crawler_widget;
+            }
+            else {
+                connect( crawler_widget, SIGNAL( loadingFinished( LoadingStatus ) ),
+                        this, SLOT( globalSearchFileLoaded() ), Qt::UniqueConnection );
+                loading_running = true;
+            }
+        }
+    }
+
+    if ( next_deferred && ! loading_running ) {
+        connect( next_deferred, SIGNAL( loadingFinished( LoadingStatus ) ),
+                this, SLOT( globalSearchFileLoaded() ), Qt::UniqueConnection );
+        session_->activate( next_deferred );
+    }
+
+    globalSearchPending_ = ( nb_loading > 0 );
+    if ( globalSearchPending_ ) {
+        LOG(logDEBUG) << "Global search waiting for " << nb_loading << " files";
+        globalSearchWidget_.waitForFiles( nb_loading );
+        return;
+    }
+
+    QStringList file_names;
+    std::vector<std::shared_ptr<const AbstractLogSource>> files;
+
+    globalSearchCrawlers_.clear();
+    for ( int i = 0; i < mainTabWidget_.count(); ++i ) {
+        auto crawler_widget = dynamic_cast<CrawlerWidget*>(
+                mainTabWidget_.widget( i ) );
+        assert( crawler_widget );
+
+        file_names.append( FileSet::displayName(
+                    QString::fromStdString( session_->getFilename( crawler_widget ) ) ) );
+        files.push_back( session_->getLogData( crawler_widget ) );
+        globalSearchCrawlers_.push_back( crawler_widget );
+    }
+
+    globalSearchWidget_.search( file_names, files );
+}
+
+void MainWindow::globalSearchFileLoaded()
+{
+    disconnect( sender(), SIGNAL( loadingFinished( LoadingStatus ) ),
+            this, SLOT( globalSearchFileLoaded() ) );
+
+    if ( globalSearchPending_ )
+        startGlobalSearch();
+}
+
+void MainWindow::stopGlobalSearch()
+{
+    globalSearchPending_ = false;
+}
+
+void MainWindow::displayGlobalSearchMatch( int file_index, qint64 line )
+{
+    CrawlerWidget* crawler_widget = globalSearchCrawlers_[file_index];
+
+    // The file might have been closed since the search
+    if ( crawler_widget ) {
+        mainTabWidget_.setCurrentWidget( crawler_widget );
+        crawler_widget->displayLine( line );
+    }
+}
+
+// Count the values in the current file (or the lines of its filtered view)
+void MainWindow::startGroupBy()
+{
+    groupByCrawler_ = currentCrawlerWidget();
+    if ( ! groupByCrawler_ )
+        return;
+
+    const auto source = session_->getLogData( groupByCrawler_ );
+    if ( groupByWidget_.isFilteredOnly() )
+        groupByWidget_.groupBy( source, groupByCrawler_->getFilteredLines() );
+    else
+        groupByWidget_.groupBy( source );
+}
+
+void MainWindow::filterGroupByValue( const QString& pattern )
+{
+    // The file might have been closed since the count
+    if ( groupByCrawler_ ) {
+        mainTabWidget_.setCurrentWidget( groupByCrawler_ );
+        groupByCrawler_->searchFor( pattern );
+    }
+}
+
+// Mine the templates of the current file
+void MainWindow::startTemplateMining()
+{
+    templatesCrawler_ = currentCrawlerWidget();
+    if ( ! templatesCrawler_ )
+        return;
+
+    templatesWidget_.analyse( session_->getLogData( templatesCrawler_ ) );
+}
+
+void MainWindow::showTemplates()
+{
+    const auto index = templatesWidget_.getIndex();
+
+    // The file might have been closed since the analysis
+    if ( ! templatesCrawler_ || ! index )
+        return;
+
+    // or truncated, the lines analysed are not the same anymore
+    if ( session_->getLogData( templatesCrawler_ )->getNbLine() < index->getNbLines() ) {
+        templatesWidget_.setStatus( tr( "The file has been truncated, analyse it again" ) );
+        return;
+    }
+
+    mainTabWidget_.setCurrentWidget( templatesCrawler_ );
+    templatesCrawler_->showTemplates( index, templatesWidget_.getCheckedTemplates() );
+}
+
+void MainWindow::displayTemplateExample( qint64 line )
+{
+    if ( templatesCrawler_ ) {
+        mainTabWidget_.setCurrentWidget( templatesCrawler_ );
+        templatesCrawler_->displayLine( line );
+    }
+}
+
+void MainWindow::statisticsVisibilityChanged( bool visible )
+{
+    if ( visible ) {
+        updateStatistics();
+        statisticsTimer_.start();
+    }
+    else {
+        statisticsTimer_.stop();
+    }
+}
+
+void MainWindow::updateStatistics()
+{
+    QStringList file_names;
+    std::vector<CrawlerWidget::Statistics> statistics;
+    collectStatistics( &file_names, &statistics );
+
+    statisticsWidget_.display( file_names, statistics );
+}
+
 void MainWindow::loadFileNonInteractive( const QString& file_name )
 {
     LOG(logDEBUG) << "loadFileNonInteractive( "
@@ -876,7 +1228,7 @@ bool MainWindow::loadFile( const QString& fileName )
 // Strips the passed filename from its directory part.
 QString MainWindow::strippedName( const QString& fullFileName ) const
 {
-    return QFileInfo( fullFileName ).fileName();
+    return QFileInfo( FileSet::displayName( fullFileName ) ).fileName();
 }
 
 // Return the currently active CrawlerWidget, or NULL if none
@@ -888,6 +1240,29 @@ CrawlerWidget* MainWindow::currentCrawlerWidget() const
     return current;
 }
 
+void MainWindow::collectStatistics( QStringList* file_names,
+        std::vector<CrawlerWidget::Statistics>* statistics ) const
+{
+    for ( int i = 0; i < mainTabWidget_.count(); ++i ) {
+        auto crawler_widget = dynamic_cast<CrawlerWidget*>(
+                mainTabWidget_.widget( i ) );
+        assert( crawler_widget );
+
+        file_names->append( FileSet::displayName(
+                    QString::fromStdString( session_->getFilename( crawler_widget ) ) ) );
+        statistics->push_back( crawler_widget->getStatistics() );
+    }
+}
+
+QString MainWindow::statisticsReport() const
+{
+    QStringList file_names;
+    std::vector<CrawlerWidget::Statistics> statistics;
+    collectStatistics( &file_names, &statistics );
+
+    return StatisticsWidget::report( file_names, statistics );
+}
+
 // Update the title bar.
 void MainWindow::updateTitleBar( const QString& file_name )
 {
@@ -942,8 +1317,8 @@ void MainWindow::updateInfoLine()
 
     // Following should always work as we will only receive enter
     // this slot if there is a crawler connected.
-    QString current_file =
-        session_->getFilename( currentCrawlerWidget() ).c_str();
+    QString current_file = FileSet::displayName(
+            session_->getFilename( currentCrawlerWidget() ).c_str() );
 
     uint64_t fileSize;
     uint32_t fileNbLine;
@@ -967,6 +1342,17 @@ void MainWindow::updateInfoLine()
     }
 }
 
+// Log the time from launch to the first view usable, only once
+void MainWindow::reportStartupTime()
+{
+    if ( ! startupTimer_.isValid() )
+        return;
+
+    LOG(logINFO) << "Startup: first view usable after "
+        << startupTimer_.elapsed() << " ms";
+    startupTimer_.invalidate();
+}
+
 // Write settings to permanent storage
 void MainWindow::writeSettings()
 {
@@ -21,14 +21,23 @@
 #define MAINWINDOW_H
 
 #include <memory>
+#include <vector>
 #include <QMainWindow>
+#include <QPointer>
+#include <QElapsedTimer>
+#include <QTimer>
 
 #include "session.h"
+#include "fileset.h"
 #include "crawlerwidget.h"
 #include "infoline.h"
 #include "signalmux.h"
 #include "tabbedcrawlerwidget.h"
 #include "quickfindwidget.h"
+#include "globalsearchwidget.h"
+#include "groupbywidget.h"
+#include "templateswidget.h"
+#include "statisticswidget.h"
 #include "quickfindmux.h"
 #ifdef GLOGG_SUPPORTS_VERSION_CHECKING
 #include "versionchecker.h"
@@ -37,6 +46,7 @@
 
 class QAction;
 class QActionGroup;
+class QDockWidget;
 class Session;
 class RecentFiles;
 class MenuActionToolTipBehavior;
@@ -57,7 +67,11 @@ class MainWindow : public QMainWindow
     // Re-install the geometry stored in config file
     // (should be done before 'Widget::show()')
     void reloadGeometry();
-    // Re-load the files from the previous session
+    // Pass the timer started at launch, the time until the first
+    // view is usable is then logged.
+    void setStartupTimer( const QElapsedTimer& timer );
+    // Re-load the files from the previous session, the file displayed
+    // is loaded first, the others in the background once it is.
     void reloadSession();
     // Loads the initial file (parameter passed or from config file)
     void loadInitialFile( QString fileName );
@@ -74,14 +88,20 @@ class MainWindow : public QMainWindow
 
   private slots:
     void open();
+    void openMerged();
     void openRecentFile();
     void closeTab();
     void closeAll();
     void selectAll();
     void copy();
     void find();
+    void searchAllFiles();
+    void groupBy();
+    void templates();
     void filters();
     void options();
+    void toggleTracing( bool enabled );
+    void saveTrace();
     void about();
     void aboutQt();
     void encodingChanged( QAction* action );
@@ -119,6 +139,32 @@ class MainWindow : public QMainWindow
     // and confirm it.
     void changeQFPattern( const QString& newPattern );
 
+    // Start a search of all the open files from the global search panel
+    // (once they are all loaded)
+    void startGlobalSearch();
+    // Called when a file the global search waits for is loaded
+    void globalSearchFileLoaded();
+    // Forget the global search waiting for files to load
+    void stopGlobalSearch();
+    // Display a line found by the global search
+    void displayGlobalSearchMatch( int file_index, qint64 line );
+
+    // Count the values in the current file from the group by panel
+    void startGroupBy();
+    // Search the lines having a value selected in the group by panel
+    void filterGroupByValue( const QString& pattern );
+
+    // Mine the templates of the current file from the templates panel
+    void startTemplateMining();
+    // Show the lines of the templates checked in the templates panel
+    void showTemplates();
+    // Display the example line of a template
+    void displayTemplateExample( qint64 line );
+
+    // Refresh the statistics panel (periodically while it is visible)
+    void statisticsVisibilityChanged( bool visible );
+    void updateStatistics();
+
     // Load a file in a new tab (non-interactive)
     // (for use from e.g. IPC)
     void loadFileNonInteractive( const QString& file_name );
@@ -138,6 +184,8 @@ class MainWindow : public QMainWindow
     void exitingQuickFind();
 
   private:
+    // Ask the user for files and open them (together if several)
+    void openFiles( FileSet::Kind kind );
     void createActions();
     void createMenus();
     void createContextMenu();
@@ -151,9 +199,15 @@ class MainWindow : public QMainWindow
     void updateRecentFileActions();
     QString strippedName( const QString& fullFileName ) const;
     CrawlerWidget* currentCrawlerWidget() const;
+    // Get the statistics of all the open files, in the order of the tabs
+    void collectStatistics( QStringList* file_names,
+            std::vector<CrawlerWidget::Statistics>* statistics ) const;
+    // Returns the statistics of the open files as text (for other instances)
+    QString statisticsReport() const;
     void displayQuickFindBar( QuickFindMux::QFDirection direction );
     void updateMenuBarFromDocument( const CrawlerWidget* crawler );
     void updateInfoLine();
+    void reportStartupTime();
 
     std::unique_ptr<Session> session_;
     std::shared_ptr<ExternalCommunicator> externalCommunicator_;
@@ -184,12 +238,16 @@ class MainWindow : public QMainWindow
     QToolBar *toolBar;
 
     QAction *openAction;
+    QAction *openMergedAction;
     QAction *closeAction;
     QAction *closeAllAction;
     QAction *exitAction;
     QAction *copyAction;
     QAction *selectAllAction;
     QAction *findAction;
+    QAction *searchAllFilesAction;
+    QAction *groupByAction;
+    QAction *templatesAction;
     QAction *overviewVisibleAction;
     QAction *lineNumbersVisibleInMainAction;
     QAction *lineNumbersVisibleInFilteredAction;
@@ -198,6 +256,8 @@ class MainWindow : public QMainWindow
     QAction *stopAction;
     QAction *filtersAction;
     QAction *optionsAction;
+    QAction *recordTraceAction;
+    QAction *saveTraceAction;
     QAction *aboutAction;
     QAction *aboutQtAction;
     QActionGroup *encodingGroup;
@@ -217,6 +277,34 @@ class MainWindow : public QMainWindow
     // The main widget
     TabbedCrawlerWidget mainTabWidget_;
 
+    // Panel searching all the open files
+    GlobalSearchWidget globalSearchWidget_;
+    QDockWidget* globalSearchDock_;
+    // The views of the files searched (some might have been closed since)
+    std::vector<QPointer<CrawlerWidget>> globalSearchCrawlers_;
+    // Is a global search waiting for files to load
+    bool globalSearchPending_;
+
+    // Panel counting the values of capture groups in the current file
+    GroupByWidget groupByWidget_;
+    QDockWidget* groupByDock_;
+    // The view of the file counted (it might have been closed since)
+    QPointer<CrawlerWidget> groupByCrawler_;
+
+    // Panel mining the templates of the lines of the current file
+    TemplatesWidget templatesWidget_;
+    QDockWidget* templatesDock_;
+    // The view of the file analysed (it might have been closed since)
+    QPointer<CrawlerWidget> templatesCrawler_;
+
+    // Panel showing the resources used for each file
+    StatisticsWidget statisticsWidget_;
+    QDockWidget* statisticsDock_;
+    QTimer statisticsTimer_;
+
+    // Started at launch, invalid once the first view is usable
+    QElapsedTimer startupTimer_;
+
     // Version checker
 #ifdef GLOGG_SUPPORTS_VERSION_CHECKING
     VersionChecker versionChecker_;
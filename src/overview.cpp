@@ -22,14 +22,17 @@
 // the actual drawing is done in AbstractLogView which uses this class.
 
 #include "log.h"
+#include "tracing.h"
 
 #include "data/logfiltereddata.h"
+#include "quickfindindex.h"
 
 #include "overview.h"
 
-Overview::Overview() : matchLines_(), markLines_()
+Overview::Overview() : matchLines_(), markLines_(), quickFindLines_()
 {
     logFilteredData_ = NULL;
+    quickFindIndex_  = NULL;
     linesInFile_     = 0;
     topLine_         = 0;
     nbLines_         = 0;
@@ -47,6 +50,12 @@ void Overview::setFilteredData( const LogFilteredData* logFilteredData )
     logFilteredData_ = logFilteredData;
 }
 
+void Overview::setQuickFindIndex( const QuickFindIndex* quickFindIndex )
+{
+    quickFindIndex_ = quickFindIndex;
+    dirty_ = true;
+}
+
 void Overview::updateData( int totalNbLine )
 {
     LOG(logDEBUG) << "OverviewWidget::updateData " << totalNbLine;
@@ -75,6 +84,11 @@ const QVector<Overview::WeightedLine>* Overview::getMarkLines() const
     return &markLines_;
 }
 
+const QVector<Overview::WeightedLine>* Overview::getQuickFindLines() const
+{
+    return &quickFindLines_;
+}
+
 std::pair<int,int> Overview::getViewLines() const
 {
     int top = 0;
@@ -109,6 +123,7 @@ int Overview::yFromFileLine( int file_line ) const
 void Overview::recalculatesLines()
 {
     LOG(logDEBUG) << "OverviewWidget::recalculatesLines";
+    TRACE_SPAN( "overview", "Overview::recalculatesLines" );
 
     if ( logFilteredData_ != NULL ) {
         matchLines_.clear();
@@ -146,5 +161,32 @@ void Overview::recalculatesLines()
     else
         LOG(logDEBUG) << "Overview::recalculatesLines: logFilteredData_ == NULL";
 
+    recalculatesQuickFindLines();
+
     dirty_ = false;
 }
+
+// Only complete indexes are displayed, a partial one would show
+// a misleading picture of the file.
+void Overview::recalculatesQuickFindLines()
+{
+    TRACE_SPAN( "overview", "Overview::recalculatesQuickFindLines" );
+
+    quickFindLines_.clear();
+
+    if ( ( quickFindIndex_ != NULL ) && quickFindIndex_->isComplete()
+            && ( linesInFile_ > 0 ) ) {
+        for ( int i = 0; i < quickFindIndex_->nbOccurrences(); i++ ) {
+            int line = (int) quickFindIndex_->occurrence( i ).line();
+            int position = (int)( (qint64)line * height_ / linesInFile_ );
+            if ( ( ! quickFindLines_.isEmpty() ) && quickFindLines_.last().position() == position ) {
+                // If the line is already there, we increase its weight
+                quickFindLines_.last().load();
+            }
+            else {
+                // If not we just add it
+                quickFindLines_.append( WeightedLine( position ) );
+            }
+        }
+    }
+}
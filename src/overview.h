@@ -24,6 +24,7 @@
 #include <QVector>
 
 class LogFilteredData;
+class QuickFindIndex;
 
 // Class implementing the logic behind the matches overview bar.
 // This class converts the matches found in a LogFilteredData in
@@ -58,6 +59,10 @@ class Overview
 
     // Associate the passed filteredData to this Overview
     void setFilteredData( const LogFilteredData* logFilteredData );
+    // Associate the passed QuickFind index to this Overview
+    void setQuickFindIndex( const QuickFindIndex* quickFindIndex );
+    // Signal the overview the QuickFind index has been changed
+    void updateQuickFind() { dirty_ = true; }
     // Signal the overview its attached LogFilteredData has been changed and
     // the overview must be updated with the provided total number
     // of line of the file.
@@ -80,6 +85,10 @@ class Overview
     // Returns a list of lines (between 0 and 'height') representing marks.
     // (pointer returned is valid until next call to update*()
     const QVector<WeightedLine>* getMarkLines() const;
+    // Returns a list of lines (between 0 and 'height') representing
+    // QuickFind occurrences.
+    // (pointer returned is valid until next call to update*()
+    const QVector<WeightedLine>* getQuickFindLines() const;
     // Return a pair of lines (between 0 and 'height') representing the current view.
     std::pair<int,int> getViewLines() const;
 
@@ -91,6 +100,8 @@ class Overview
   private:
     // List of matches associated with this Overview.
     const LogFilteredData* logFilteredData_;
+    // Index of QuickFind occurrences (if any)
+    const QuickFindIndex* quickFindIndex_;
     // Total number of lines in the file.
     int linesInFile_;
     // Whether the overview is visible.
@@ -106,8 +117,10 @@ class Overview
     // List of lines representing matches and marks (are shared with the client)
     QVector<WeightedLine> matchLines_;
     QVector<WeightedLine> markLines_;
+    QVector<WeightedLine> quickFindLines_;
 
     void recalculatesLines();
+    void recalculatesQuickFindLines();
 };
 
 #endif
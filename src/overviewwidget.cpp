@@ -153,6 +153,7 @@ void OverviewWidget::paintEvent( QPaintEvent* /* paintEvent */ )
 {
     static const QColor match_color("red");
     static const QColor mark_color("dodgerblue");
+    static const QColor quickfind_color("orange");
 
     static const QPixmap highlight_pixmap[] = {
         QPixmap( highlight_xpm[0] ),
@@ -196,6 +197,15 @@ void OverviewWidget::paintEvent( QPaintEvent* /* paintEvent */ )
                     line.position(), width() - LINE_MARGIN - 1, line.position() );
         }
 
+        // The QuickFind occurrences (shorter lines on the left)
+        painter.setPen( quickfind_color );
+        foreach (Overview::WeightedLine line, *(overview_->getQuickFindLines()) ) {
+            painter.setOpacity( ( 1.0 / Overview::WeightedLine::WEIGHT_STEPS )
+                   * ( line.weight() + 1 ) );
+            painter.drawLine( 1 + LINE_MARGIN,
+                    line.position(), width() / 2, line.position() );
+        }
+
         // The 'view' lines
         painter.setOpacity( 1 );
         painter.setPen( palette().color(QPalette::Text) );
@@ -49,10 +49,35 @@ class PerfCounter {
     uint32_t readAndReset() {
         uint32_t value = counter_;
         counter_ = 0;
+        last_counter_ = value;
+        last_event_date_ = first_event_date_;
         return value;
     }
 
+    // Returns the number of events that occured in the last complete second
+    // (without resetting the counter), 0 if the last event is more than a
+    // second old.
+    uint32_t rate() const {
+        using namespace std::chrono;
+        if ( counter_ == 0 )
+            return 0;
+
+        const auto elapsed = duration_cast<microseconds>(
+                steady_clock::now() - first_event_date_ ).count();
+        if ( elapsed < 1000000 )
+            // The previous second, if it was just before
+            return ( duration_cast<microseconds>( first_event_date_
+                        - last_event_date_ ).count() < 2000000 ) ? last_counter_ : 0;
+        else if ( elapsed < 2000000 )
+            return counter_;
+        else
+            return 0;
+    }
+
   private:
     uint32_t counter_ = 0;
+    uint32_t last_counter_ = 0;
     std::chrono::steady_clock::time_point first_event_date_;
+    // Date of the first event of the previous second
+    std::chrono::steady_clock::time_point last_event_date_;
 };
@@ -70,4 +70,20 @@ class QFNotificationProgress : public QFNotification {
     int progressPercent_;
 };
 
+class QFNotificationOccurrence : public QFNotification {
+  public:
+    // Constructor taking the (1-based) occurrence reached and
+    // the total number of occurrences
+    QFNotificationOccurrence( int occurrence, int nb_occurrences )
+    { occurrence_ = occurrence; nbOccurrences_ = nb_occurrences; }
+
+    QString message() const {
+        return QString( QObject::tr("Match %L1 of %L2")
+                .arg( occurrence_ ).arg( nbOccurrences_ ) );
+    }
+  private:
+    int occurrence_;
+    int nbOccurrences_;
+};
+
 #endif
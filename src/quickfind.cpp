@@ -22,12 +22,13 @@
 // to the logData, the QFP and the selection passed.
 // Search is started just after the selection and the selection is updated
 // if a match is found.
-
-#include <QApplication>
+// The search itself is done in chunks of lines, from the event loop, and
+// interrupted when another search is started.
 
 #include "log.h"
 #include "quickfindpattern.h"
 #include "selection.h"
+#include "timeslice.h"
 #include "data/abstractlogdata.h"
 
 #include "quickfind.h"
@@ -47,7 +48,6 @@ void SearchingNotifier::sendNotification( qint64 current_line, qint64 nb_lines )
         progress = current_line * 100 / nb_lines;
     emit notify( QFNotificationProgress( progress ) );
 
-    QApplication::processEvents( QEventLoop::ExcludeUserInputEvents );
     startTime_ = QTime::currentTime();
 }
 
@@ -100,16 +100,27 @@ bool QuickFind::LastMatchPosition::isSooner( const FilePosition &position ) cons
     return isSooner( position.line(), position.column() );
 }
 
+const int QuickFind::LINES_IN_CHUNK = 1000;
+const int QuickFind::SEARCH_SLICE_MS = 20;
+
 QuickFind::QuickFind( const AbstractLogData* const logData,
         Selection* selection,
         const QuickFindPattern* const quickFindPattern ) :
     logData_( logData ), selection_( selection ),
     quickFindPattern_( quickFindPattern ),
     lastMatch_(), firstMatch_(), searchingNotifier_(),
-    incrementalSearchStatus_()
+    incrementalSearchStatus_(), index_( logData, quickFindPattern ),
+    searchOperation_(), searchTimer_()
 {
     connect( &searchingNotifier_, SIGNAL( notify( const QFNotification& ) ),
             this, SIGNAL( notify( const QFNotification& ) ) );
+    connect( &index_, SIGNAL( indexUpdated() ),
+            this, SIGNAL( indexUpdated() ) );
+
+    searchTimer_.setSingleShot( true );
+    searchTimer_.setInterval( 0 );
+    connect( &searchTimer_, SIGNAL( timeout() ),
+            this, SLOT( searchNextChunk() ) );
 }
 
 void QuickFind::incrementalSearchStop()
@@ -128,13 +139,16 @@ void QuickFind::incrementalSearchStop()
 void QuickFind::incrementalSearchAbort()
 {
     if ( incrementalSearchStatus_.isOngoing() ) {
+        if ( searchOperation_.isIncremental() )
+            cancelSearch();
+
         // We reset the selection to what it was
         *selection_ = incrementalSearchStatus_.initialSelection();
         incrementalSearchStatus_ = IncrementalSearchStatus();
     }
 }
 
-qint64 QuickFind::incrementallySearchForward()
+void QuickFind::incrementallySearchForward()
 {
     LOG( logDEBUG ) << "QuickFind::incrementallySearchForward";
 
@@ -155,22 +169,10 @@ qint64 QuickFind::incrementallySearchForward()
                 *selection_ );
     }
 
-    qint64 line_found = doSearchForward( start_position );
-
-    if ( line_found >= 0 ) {
-        // We have found a result...
-        // ... the caller will jump to this line.
-        return line_found;
-    }
-    else {
-        // No result...
-        // ... we want the client to show the initial line.
-        selection_->clear();
-        return incrementalSearchStatus_.position().line();
-    }
+    doSearchForward( start_position, true );
 }
 
-qint64 QuickFind::incrementallySearchBackward()
+void QuickFind::incrementallySearchBackward()
 {
     LOG( logDEBUG ) << "QuickFind::incrementallySearchBackward";
 
@@ -191,60 +193,67 @@ qint64 QuickFind::incrementallySearchBackward()
                 *selection_ );
     }
 
-    qint64 line_found = doSearchBackward( start_position );
-
-    if ( line_found >= 0 ) {
-        // We have found a result...
-        // ... the caller will jump to this line.
-        return line_found;
-    }
-    else {
-        // No result...
-        // ... we want the client to show the initial line.
-        selection_->clear();
-        return incrementalSearchStatus_.position().line();
-    }
+    doSearchBackward( start_position, true );
 }
 
-qint64 QuickFind::searchForward()
+void QuickFind::searchForward()
 {
     incrementalSearchStatus_ = IncrementalSearchStatus();
 
     // Position where we start the search from
     FilePosition start_position = selection_->getNextPosition();
 
-    return doSearchForward( start_position );
+    doSearchForward( start_position, false );
 }
 
 
-qint64 QuickFind::searchBackward()
+void QuickFind::searchBackward()
 {
     incrementalSearchStatus_ = IncrementalSearchStatus();
 
     // Position where we start the search from
     FilePosition start_position = selection_->getPreviousPosition();
 
-    return doSearchBackward( start_position );
+    doSearchBackward( start_position, false );
+}
+
+void QuickFind::cancelSearch()
+{
+    if ( searchOperation_.isOngoing() ) {
+        LOG( logDEBUG ) << "QuickFind: search interrupted at line "
+            << searchOperation_.nextLine();
+
+        searchTimer_.stop();
+        searchOperation_ = SearchOperation();
+
+        // Remove the progress notification
+        emit clearNotification();
+    }
+}
+
+bool QuickFind::isSearching() const
+{
+    return searchOperation_.isOngoing();
 }
 
 // Internal implementation of forward search,
-// returns the line where the pattern is found or -1 if not found.
+// the rest of the line is searched straight away, the remaining lines
+// are searched in the background.
 // Parameters are the position the search shall start
-qint64 QuickFind::doSearchForward( const FilePosition &start_position )
+void QuickFind::doSearchForward( const FilePosition &start_position,
+        bool incremental )
 {
-    bool found = false;
     int found_start_col;
     int found_end_col;
 
-    if ( searchState_ == SearchState::OnGoing ) {
-        // This happens if this function is re-entered via the notifier
-        // We want the top most call to restart the search
-        searchState_ = SearchState::RestartNeeded;
-        return -1;
-    }
+    // This search replaces the one in progress (if any)
+    cancelSearch();
 
-    if ( ! quickFindPattern_->isActive() )
-        return -1;
+    if ( ! quickFindPattern_->isActive() ) {
+        if ( incremental )
+            incrementalSearchNotFound();
+        return;
+    }
 
     // Optimisation: if we are already after the last match,
     // we don't do any search at all.
@@ -252,7 +261,27 @@ qint64 QuickFind::doSearchForward( const FilePosition &start_position )
         // Send a notification
         emit notify( QFNotificationReachedEndOfFile() );
 
-        return -1;
+        if ( incremental )
+            incrementalSearchNotFound();
+        return;
+    }
+
+    // Use the index if it covers the searched lines
+    index_.extend();
+    if ( index_.isUsable() ) {
+        const int next = index_.findNext( start_position );
+        if ( next >= 0 ) {
+            const QuickFindOccurrence& occurrence = index_.occurrence( next );
+            searchFound( occurrence.line(),
+                    occurrence.startColumn(), occurrence.endColumn() );
+            return;
+        }
+        else if ( index_.isComplete() ) {
+            searchOperation_ = SearchOperation( Forward, incremental,
+                    -1, selection_->getPreviousPosition() );
+            searchNotFound();
+            return;
+        }
     }
 
     qint64 line = start_position.line();
@@ -262,73 +291,35 @@ qint64 QuickFind::doSearchForward( const FilePosition &start_position )
                 logData_->getExpandedLineString( line ),
                 start_position.column() ) ) {
         quickFindPattern_->getLastMatch( &found_start_col, &found_end_col );
-        found = true;
+        searchFound( line, found_start_col, found_end_col );
     }
     else {
-        searchingNotifier_.reset();
-        searchState_ = SearchState::OnGoing;
         // And then the rest of the file
-        qint64 nb_lines = logData_->getNbLine();
-        int start_line = ++line;
-        while ( line < nb_lines ) {
-            // Check if someone has changed the search within this loop
-            if ( searchState_ == SearchState::RestartNeeded ) {
-                line = start_line;
-                searchState_ = SearchState::OnGoing;
-                LOG( logDEBUG ) << "QuickFind restarted at line " << line;
-            }
-
-            if ( quickFindPattern_->isLineMatching(
-                        logData_->getExpandedLineString( line ) ) ) {
-                quickFindPattern_->getLastMatch(
-                        &found_start_col, &found_end_col );
-                found = true;
-                LOG( logDEBUG ) << "QuickFind found!";
-                break;
-            }
-            line++;
-
-            // See if we need to notify of the ongoing search
-            // Note this could re-enter this function if the pattern is
-            // modified whilst the search is on-going, this is okay.
-            searchingNotifier_.ping( line, nb_lines );
-        }
-
-        searchState_ = SearchState::Idle;
-    }
-
-    if ( found ) {
-        selection_->selectPortion(
-                line, found_start_col, found_end_col );
-
-        // Clear any notification
-        emit clearNotification();
-
-        return line;
-    }
-    else {
-        // Update the position of the last match
-        FilePosition last_match_position = selection_->getPreviousPosition();
-        lastMatch_.set( last_match_position );
-
-        // Send a notification
-        emit notify( QFNotificationReachedEndOfFile() );
-
-        return -1;
+        searchOperation_ = SearchOperation( Forward, incremental,
+                line + 1, selection_->getPreviousPosition() );
+        searchingNotifier_.reset();
+        searchNextChunk();
     }
 }
 
 // Internal implementation of backward search,
-// returns the line where the pattern is found or -1 if not found.
+// the beginning of the line is searched straight away, the remaining lines
+// are searched in the background.
 // Parameters are the position the search shall start
-qint64 QuickFind::doSearchBackward( const FilePosition &start_position )
+void QuickFind::doSearchBackward( const FilePosition &start_position,
+        bool incremental )
 {
-    bool found = false;
     int start_col;
     int end_col;
 
-    if ( ! quickFindPattern_->isActive() )
-        return -1;
+    // This search replaces the one in progress (if any)
+    cancelSearch();
+
+    if ( ! quickFindPattern_->isActive() ) {
+        if ( incremental )
+            incrementalSearchNotFound();
+        return;
+    }
 
     // Optimisation: if we are already before the first match,
     // we don't do any search at all.
@@ -336,7 +327,27 @@ qint64 QuickFind::doSearchBackward( const FilePosition &start_position )
         // Send a notification
         emit notify( QFNotificationReachedBegininningOfFile() );
 
-        return -1;
+        if ( incremental )
+            incrementalSearchNotFound();
+        return;
+    }
+
+    // Use the index if it covers the searched lines
+    index_.extend();
+    if ( index_.isUsable()
+            && ( start_position.line() < index_.nbIndexedLines() ) ) {
+        const int previous = index_.findPrevious( start_position );
+        if ( previous >= 0 ) {
+            const QuickFindOccurrence& occurrence = index_.occurrence( previous );
+            searchFound( occurrence.line(),
+                    occurrence.startColumn(), occurrence.endColumn() );
+        }
+        else {
+            searchOperation_ = SearchOperation( Backward, incremental,
+                    -1, selection_->getNextPosition() );
+            searchNotFound();
+        }
+        return;
     }
 
     qint64 line = start_position.line();
@@ -348,46 +359,160 @@ qint64 QuickFind::doSearchBackward( const FilePosition &start_position )
                  start_position.column() ) )
        ) {
         quickFindPattern_->getLastMatch( &start_col, &end_col );
-        found = true;
+        searchFound( line, start_col, end_col );
     }
     else {
-        searchingNotifier_.reset();
         // And then the rest of the file
-        qint64 nb_lines = logData_->getNbLine();
-        line--;
-        while ( line >= 0 ) {
-            if ( quickFindPattern_->isLineMatchingBackward(
-                        logData_->getExpandedLineString( line ) ) ) {
-                quickFindPattern_->getLastMatch( &start_col, &end_col );
-                found = true;
-                break;
+        searchOperation_ = SearchOperation( Backward, incremental,
+                line - 1, selection_->getNextPosition() );
+        searchingNotifier_.reset();
+        searchNextChunk();
+    }
+}
+
+// Search the lines following (or preceding) the ones already searched,
+// going back to the event loop every SEARCH_SLICE_MS.
+// The lines are read at most LINES_IN_CHUNK at a time, fewer if they
+// would not be searched before the deadline, which is checked after
+// each line as matching long lines can be slow.
+void QuickFind::searchNextChunk()
+{
+    if ( ! searchOperation_.isOngoing() )
+        return;
+
+    int start_col;
+    int end_col;
+
+    const bool forward = ( searchOperation_.direction() == Forward );
+    // The data might have changed since the last chunk
+    const qint64 nb_lines = logData_->getNbLine();
+    qint64 line = searchOperation_.nextLine();
+
+    TimeSlice slice( SEARCH_SLICE_MS );
+
+    do {
+        if ( forward ) {
+            if ( line >= nb_lines ) {
+                searchNotFound();
+                return;
             }
-            line--;
 
-            // See if we need to notify of the ongoing search
-            searchingNotifier_.ping( -line, nb_lines );
+            const int nb_read = slice.linesToRead(
+                    qMin<qint64>( LINES_IN_CHUNK, nb_lines - line ) );
+            const QStringList lines = logData_->getExpandedLines( line, nb_read );
+            if ( lines.isEmpty() ) {
+                // The data have been truncated
+                searchNotFound();
+                return;
+            }
+            for ( int i = 0; i < lines.size(); ++i ) {
+                if ( quickFindPattern_->isLineMatching( lines[i] ) ) {
+                    LOG( logDEBUG ) << "QuickFind found!";
+                    quickFindPattern_->getLastMatch( &start_col, &end_col );
+                    searchFound( line, start_col, end_col );
+                    return;
+                }
+                ++line;
+                slice.lineProcessed();
+
+                if ( slice.isOver() )
+                    break;
+            }
         }
-    }
+        else {
+            line = qMin( line, nb_lines - 1 );
+            if ( line < 0 ) {
+                searchNotFound();
+                return;
+            }
 
-    if ( found )
-    {
-        selection_->selectPortion( line, start_col, end_col );
+            // Read the chunk ending at the current line and
+            // search it in reverse
+            const qint64 first_line = qMax<qint64>( 0,
+                    line - slice.linesToRead( LINES_IN_CHUNK ) + 1 );
+            const QStringList lines = logData_->getExpandedLines(
+                    first_line, line - first_line + 1 );
+            if ( lines.isEmpty() ) {
+                searchNotFound();
+                return;
+            }
+            line = first_line + lines.size() - 1;
+            for ( int i = lines.size() - 1; i >= 0; --i ) {
+                if ( quickFindPattern_->isLineMatchingBackward( lines[i] ) ) {
+                    quickFindPattern_->getLastMatch( &start_col, &end_col );
+                    searchFound( line, start_col, end_col );
+                    return;
+                }
+                --line;
+                slice.lineProcessed();
+
+                if ( slice.isOver() )
+                    break;
+            }
+        }
+    } while ( ! slice.isOver() );
+
+    searchOperation_.setNextLine( line );
+
+    // See if we need to notify of the ongoing search
+    searchingNotifier_.ping( forward ? line : -line, nb_lines );
+
+    // And leave the event loop run before the next chunk
+    searchTimer_.start();
+}
+
+void QuickFind::searchFound( qint64 line, int start_col, int end_col )
+{
+    searchOperation_ = SearchOperation();
 
-        // Clear any notification
+    selection_->selectPortion( line, start_col, end_col );
+
+    // Tell the user where we are if all the occurrences are known,
+    // clear any notification if not.
+    const int index = index_.isComplete() ?
+        index_.findNext( FilePosition( line, start_col ) ) : -1;
+    if ( index >= 0 )
+        emit notify( QFNotificationOccurrence( index + 1, index_.nbOccurrences() ) );
+    else
         emit clearNotification();
 
-        return line;
+    emit searchDone( line );
+}
+
+void QuickFind::searchNotFound()
+{
+    const SearchOperation operation = searchOperation_;
+    searchOperation_ = SearchOperation();
+
+    if ( operation.direction() == Forward ) {
+        // Update the position of the last match
+        lastMatch_.set( operation.limitPosition() );
+
+        // Send a notification
+        emit notify( QFNotificationReachedEndOfFile() );
     }
     else {
         // Update the position of the first match
-        FilePosition first_match_position = selection_->getNextPosition();
-        firstMatch_.set( first_match_position );
+        firstMatch_.set( operation.limitPosition() );
 
         // Send a notification
         LOG( logDEBUG ) << "QF: Send BOF notification.";
         emit notify( QFNotificationReachedBegininningOfFile() );
+    }
+
+    if ( operation.isIncremental() )
+        incrementalSearchNotFound();
+    else
+        emit searchDone( -1 );
+}
 
-        return -1;
+void QuickFind::incrementalSearchNotFound()
+{
+    // The incremental search might have been stopped in the meantime
+    if ( incrementalSearchStatus_.isOngoing() ) {
+        // ... we want the client to show the initial line.
+        selection_->clear();
+        emit searchDone( incrementalSearchStatus_.position().line() );
     }
 }
 
@@ -396,3 +521,18 @@ void QuickFind::resetLimits()
     lastMatch_.reset();
     firstMatch_.reset();
 }
+
+void QuickFind::rebuildIndex()
+{
+    index_.rebuild();
+}
+
+void QuickFind::clearIndex()
+{
+    index_.clear();
+}
+
+void QuickFind::extendIndex()
+{
+    index_.extend();
+}
@@ -23,10 +23,12 @@
 #include <QObject>
 #include <QPoint>
 #include <QTime>
+#include <QTimer>
 
 #include "utils.h"
 #include "qfnotifications.h"
 #include "selection.h"
+#include "quickfindindex.h"
 
 class QuickFindPattern;
 class AbstractLogData;
@@ -36,6 +38,8 @@ class Portion;
 // reset() shall be called at the beginning of the search
 // and then ping() should be called periodically during the processing.
 // The notify() signal should be forwarded to the UI.
+// (the search runs from the event loop, so the notifier never
+// processes events itself)
 class SearchingNotifier : public QObject
 {
   Q_OBJECT
@@ -46,7 +50,7 @@ class SearchingNotifier : public QObject
     // Reset internal timers at the beiginning of the processing
     void reset();
     // Shall be called frequently during processing, send the notification
-    // and call the event loop when appropriate.
+    // when appropriate.
     // Pass the current line number and total number of line so that
     // a progress percentage is calculated and displayed.
     // (line shall be negative if ging in reverse)
@@ -69,6 +73,10 @@ class SearchingNotifier : public QObject
 // Represents a search made with Quick Find (without its results)
 // it keeps a pointer to a set of data and to a QuickFindPattern which
 // are used for the searches. (the caller retains ownership of both).
+//
+// Searches are asynchronous: they are run in chunks of lines from
+// the event loop, so the UI stays responsive, and their result is
+// sent through the searchDone() signal.
 class QuickFind : public QObject
 {
   Q_OBJECT
@@ -82,12 +90,12 @@ class QuickFind : public QObject
     void setSearchStartPoint( QPoint startPoint );
 
     // Used for incremental searches
-    // Return the first occurence of the passed pattern from the starting
-    // point.  These searches don't use the QFP and don't change the
-    // starting point.
-    // TODO Update comment
-    qint64 incrementallySearchForward();
-    qint64 incrementallySearchBackward();
+    // Start looking for the first occurence of the passed pattern from
+    // the starting point.  These searches don't use the QFP and don't
+    // change the starting point.
+    // If nothing is found, searchDone() is sent with the initial line.
+    void incrementallySearchForward();
+    void incrementallySearchBackward();
 
     // Stop the currently ongoing incremental search, leave the selection
     // where it is if a match has been found, restore the old one
@@ -99,27 +107,48 @@ class QuickFind : public QObject
     // position/selection
     void incrementalSearchAbort();
 
-    // Used for 'repeated' (n/N) QF searches using the current direction
-    // Return the line of the first occurence of the QFP and
-    // update the selection. It returns -1 if nothing is found.
-    /*
-    int searchNext();
-    int searchPrevious();
-    */
+    // Used for 'repeated' (n/N) QF searches
+    // Start looking for the next occurence of the QFP, in the
+    // specified direction, the selection is updated when a match
+    // is found.
+    void searchForward();
+    void searchBackward();
 
-    // Idem but ignore the direction and always search in the
-    // specified direction
-    qint64 searchForward();
-    qint64 searchBackward();
+    // Interrupt the search in progress (if any) without changing
+    // the selection.
+    void cancelSearch();
+
+    // Returns whether a search is in progress
+    bool isSearching() const;
 
     // Make the object forget the 'no more match' flag.
     void resetLimits();
 
+    // Start indexing the occurrences of the pattern from scratch
+    // (when the pattern has changed)
+    void rebuildIndex();
+    // Throw away the index, it will be rebuilt when needed
+    // (when the pattern has changed or the data have been modified)
+    void clearIndex();
+    // Index the lines appended to the data
+    void extendIndex();
+    // Index of the occurrences of the pattern (owned by the QuickFind)
+    const QuickFindIndex* index() const { return &index_; }
+
   signals:
     // Sent when the UI shall display a message to the user.
     void notify( const QFNotification& message );
     // Sent when the UI shall clear the notification.
     void clearNotification();
+    // Sent when a search is finished, passing the line the view
+    // shall display, or -1 if it shall stay where it is.
+    void searchDone( qint64 line );
+    // Sent when the occurrence index has been rebuilt or cleared
+    void indexUpdated();
+
+  private slots:
+    // Search the next chunk of lines of the ongoing search
+    void searchNextChunk();
 
   private:
     enum QFDirection {
@@ -128,12 +157,6 @@ class QuickFind : public QObject
         Backward,
     };
 
-    enum class SearchState {
-        Idle,
-        OnGoing,
-        RestartNeeded,
-    };
-
     class LastMatchPosition {
       public:
         LastMatchPosition() : line_( -1 ), column_( -1 ) {}
@@ -175,6 +198,39 @@ class QuickFind : public QObject
         Selection initialSelection_;
     };
 
+    // A search running in the background
+    class SearchOperation {
+      public:
+        SearchOperation() :
+            direction_( None ), incremental_( false ),
+            nextLine_( -1 ), limitPosition_() {}
+        SearchOperation( QFDirection direction, bool incremental,
+                qint64 next_line, const FilePosition& limit_position ) :
+            direction_( direction ), incremental_( incremental ),
+            nextLine_( next_line ), limitPosition_( limit_position ) {}
+
+        bool isOngoing() const { return ( direction_ != None ); }
+        QFDirection direction() const { return direction_; }
+        // Was it started by an incremental search
+        bool isIncremental() const { return incremental_; }
+        // Next line to be searched
+        qint64 nextLine() const { return nextLine_; }
+        void setNextLine( qint64 line ) { nextLine_ = line; }
+        // Position to record as the last/first match if nothing is found
+        FilePosition limitPosition() const { return limitPosition_; }
+
+      private:
+        QFDirection direction_;
+        bool incremental_;
+        qint64 nextLine_;
+        FilePosition limitPosition_;
+    };
+
+    // Maximum number of lines read at once from the data
+    static const int LINES_IN_CHUNK;
+    // Maximum time spent searching before going back to the event loop
+    static const int SEARCH_SLICE_MS;
+
     // Pointers to external objects
     const AbstractLogData* const logData_;
     Selection* selection_;
@@ -192,13 +248,24 @@ class QuickFind : public QObject
     // Incremental search status
     IncrementalSearchStatus incrementalSearchStatus_;
 
-    // Flag to request stopping the search
-    // (e.g. on key press)
-    SearchState searchState_;
+    // Occurrences of the pattern, used to avoid searching
+    QuickFindIndex index_;
+
+    // Search in progress
+    SearchOperation searchOperation_;
+    // Schedules the next chunk of the search
+    QTimer searchTimer_;
 
     // Private functions
-    qint64 doSearchForward( const FilePosition &start_position );
-    qint64 doSearchBackward( const FilePosition &start_position );
+    void doSearchForward( const FilePosition &start_position,
+            bool incremental );
+    void doSearchBackward( const FilePosition &start_position,
+            bool incremental );
+    // Called when the ongoing search is finished
+    void searchFound( qint64 line, int start_col, int end_col );
+    void searchNotFound();
+    // Called when nothing is found by an incremental search
+    void incrementalSearchNotFound();
 };
 
 #endif
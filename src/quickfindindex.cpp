@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements QuickFindIndex.
+// The index is built from the event loop, a few chunks of lines at a time,
+// so it does not need any locking and never blocks the UI for long.
+
+#include <algorithm>
+
+#include "log.h"
+#include "quickfindpattern.h"
+#include "timeslice.h"
+#include "data/abstractlogdata.h"
+
+#include "quickfindindex.h"
+
+const int QuickFindIndex::MAX_OCCURRENCES = 1000000;
+const int QuickFindIndex::LINES_IN_CHUNK = 5000;
+const int QuickFindIndex::INDEX_SLICE_MS = 20;
+
+QuickFindIndex::QuickFindIndex( const AbstractLogData* const logData,
+        const QuickFindPattern* const quickFindPattern ) :
+    QObject(), logData_( logData ), quickFindPattern_( quickFindPattern ),
+    occurrences_(), indexTimer_()
+{
+    indexedLines_ = 0;
+    overflowed_   = false;
+
+    indexTimer_.setSingleShot( true );
+    indexTimer_.setInterval( 0 );
+    connect( &indexTimer_, SIGNAL( timeout() ),
+            this, SLOT( indexNextChunk() ) );
+}
+
+void QuickFindIndex::rebuild()
+{
+    clear();
+
+    if ( quickFindPattern_->isActive() )
+        indexTimer_.start();
+}
+
+void QuickFindIndex::clear()
+{
+    indexTimer_.stop();
+
+    occurrences_.clear();
+    indexedLines_ = 0;
+    overflowed_   = false;
+
+    emit indexUpdated();
+}
+
+void QuickFindIndex::extend()
+{
+    if ( ( ! quickFindPattern_->isActive() ) || overflowed_ )
+        return;
+
+    const qint64 nb_lines = logData_->getNbLine();
+    if ( nb_lines < indexedLines_ ) {
+        LOG(logDEBUG) << "QuickFindIndex: lines removed, rebuilding";
+        rebuild();
+    }
+    else if ( ( nb_lines > indexedLines_ ) && ( ! indexTimer_.isActive() ) ) {
+        indexTimer_.start();
+    }
+}
+
+bool QuickFindIndex::isUsable() const
+{
+    return quickFindPattern_->isActive() && ( ! overflowed_ );
+}
+
+bool QuickFindIndex::isComplete() const
+{
+    return isUsable() && ( indexedLines_ >= logData_->getNbLine() );
+}
+
+int QuickFindIndex::findNext( const FilePosition& position ) const
+{
+    auto it = std::lower_bound( occurrences_.begin(), occurrences_.end(),
+            position,
+            [] ( const QuickFindOccurrence& occurrence, const FilePosition& pos )
+            {
+                return ( occurrence.line() < pos.line() ) ||
+                    ( ( occurrence.line() == pos.line() ) &&
+                      ( occurrence.startColumn() < pos.column() ) );
+            } );
+
+    if ( it != occurrences_.end() )
+        return std::distance( occurrences_.begin(), it );
+    else
+        return -1;
+}
+
+int QuickFindIndex::findPrevious( const FilePosition& position ) const
+{
+    // Occurrences on the same line are sorted by end column as well
+    // as they don't overlap.
+    auto it = std::partition_point( occurrences_.begin(), occurrences_.end(),
+            [ &position ] ( const QuickFindOccurrence& occurrence )
+            {
+                return ( occurrence.line() < position.line() ) ||
+                    ( ( occurrence.line() == position.line() ) &&
+                      ( position.column() > 0 ) &&
+                      ( occurrence.endColumn() + 1 < position.column() ) );
+            } );
+
+    return std::distance( occurrences_.begin(), it ) - 1;
+}
+
+bool QuickFindIndex::getLineOccurrences( qint64 line,
+        QList<QuickFindMatch>* matches ) const
+{
+    if ( ( ! isUsable() ) || ( line >= indexedLines_ ) )
+        return false;
+
+    for ( int i = findNext( FilePosition( line, 0 ) );
+            ( i >= 0 ) && ( i < nbOccurrences() )
+            && ( occurrences_[i].line() == line ); ++i ) {
+        const QuickFindOccurrence& occurrence = occurrences_[i];
+        matches->append( QuickFindMatch( occurrence.startColumn(),
+                    occurrence.endColumn() - occurrence.startColumn() + 1 ) );
+    }
+
+    return true;
+}
+
+void QuickFindIndex::indexNextChunk()
+{
+    QList<QuickFindMatch> matches;
+    const qint64 nb_lines = logData_->getNbLine();
+
+    TimeSlice slice( INDEX_SLICE_MS );
+
+    while ( ( indexedLines_ < nb_lines ) && ( ! slice.isOver() ) ) {
+        // Only read what can be indexed before the deadline
+        const int nb_read = slice.linesToRead(
+                qMin<qint64>( LINES_IN_CHUNK, nb_lines - indexedLines_ ) );
+        const QStringList lines = logData_->getExpandedLines( indexedLines_, nb_read );
+
+        for ( int i = 0; i < lines.size(); ++i ) {
+            if ( quickFindPattern_->matchLine( lines[i], matches ) ) {
+                foreach ( const QuickFindMatch& match, matches ) {
+                    occurrences_.emplace_back( indexedLines_,
+                            match.startColumn(),
+                            match.startColumn() + match.length() - 1 );
+                }
+            }
+            ++indexedLines_;
+            slice.lineProcessed();
+
+            // Long lines can make a chunk longer than the slice
+            if ( slice.isOver() )
+                break;
+        }
+
+        if ( occurrences_.size() > static_cast<size_t>( MAX_OCCURRENCES ) ) {
+            LOG(logDEBUG) << "QuickFindIndex: too many occurrences, giving up";
+            occurrences_.clear();
+            occurrences_.shrink_to_fit();
+            overflowed_ = true;
+
+            emit indexUpdated();
+            return;
+        }
+    }
+
+    if ( indexedLines_ < nb_lines ) {
+        indexTimer_.start();
+    }
+    else {
+        LOG(logDEBUG) << "QuickFindIndex: " << occurrences_.size()
+            << " occurrences in " << indexedLines_ << " lines";
+
+        // Only signal complete indexes, the clients have
+        // nothing to do with partial ones.
+        emit indexUpdated();
+    }
+}
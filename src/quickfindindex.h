@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUICKFINDINDEX_H
+#define QUICKFINDINDEX_H
+
+#include <vector>
+
+#include <QObject>
+#include <QList>
+#include <QTimer>
+
+#include "utils.h"
+
+class AbstractLogData;
+class QuickFindPattern;
+class QuickFindMatch;
+
+// An occurrence of the QuickFind pattern in the data
+// (columns are in the expanded line, end column is included)
+class QuickFindOccurrence {
+  public:
+    QuickFindOccurrence( LineNumber line, int start_column, int end_column )
+        : line_( line ), startColumn_( start_column ),
+          endColumn_( end_column ) {}
+
+    LineNumber line() const { return line_; }
+    int startColumn() const { return startColumn_; }
+    int endColumn() const { return endColumn_; }
+
+  private:
+    LineNumber line_;
+    int startColumn_;
+    int endColumn_;
+};
+
+// Index of all the occurrences of the QuickFind pattern in a set of data,
+// it is built in the background (from the event loop) once the pattern is
+// set and allows n/N to move between occurrences without searching.
+// Only the lines containing an occurrence take memory, if the pattern
+// is too frequent the index gives up and the QuickFind falls back
+// to searching.
+class QuickFindIndex : public QObject
+{
+  Q_OBJECT
+
+  public:
+    // Maximum number of occurrences stored
+    static const int MAX_OCCURRENCES;
+
+    QuickFindIndex( const AbstractLogData* const logData,
+            const QuickFindPattern* const quickFindPattern );
+
+    // Throw away the index and start indexing from the beginning
+    // (e.g. when the pattern has changed)
+    void rebuild();
+    // Throw away the index (and stop indexing)
+    void clear();
+    // Index the lines which have been added to the data since
+    // the last call, or rebuild if lines have been removed.
+    void extend();
+
+    // Returns whether the index can be used (pattern active and
+    // not too many occurrences), even if it is not complete yet.
+    bool isUsable() const;
+    // Returns whether all the lines of the data have been indexed
+    bool isComplete() const;
+    // Number of lines indexed so far (from the beginning)
+    qint64 nbIndexedLines() const { return indexedLines_; }
+
+    // Number of occurrences indexed so far
+    int nbOccurrences() const { return occurrences_.size(); }
+    const QuickFindOccurrence& occurrence( int index ) const
+    { return occurrences_[index]; }
+
+    // Returns the index of the first occurrence starting at or after
+    // the passed position, -1 if there is none in the indexed lines.
+    int findNext( const FilePosition& position ) const;
+    // Returns the index of the last occurrence ending strictly before
+    // the passed position (the whole line if column is negative or 0),
+    // -1 if there is none.
+    int findPrevious( const FilePosition& position ) const;
+    // Returns whether the passed line has been indexed, if so the
+    // occurrences in the line are added to matches.
+    bool getLineOccurrences( qint64 line, QList<QuickFindMatch>* matches ) const;
+
+  signals:
+    // Sent when the content of the index has changed
+    void indexUpdated();
+
+  private slots:
+    void indexNextChunk();
+
+  private:
+    // Maximum number of lines read at once from the data
+    static const int LINES_IN_CHUNK;
+    // Maximum time spent indexing before going back to the event loop
+    static const int INDEX_SLICE_MS;
+
+    const AbstractLogData* const logData_;
+    const QuickFindPattern* const quickFindPattern_;
+
+    std::vector<QuickFindOccurrence> occurrences_;
+    qint64 indexedLines_;
+    bool overflowed_;
+
+    QTimer indexTimer_;
+};
+
+#endif
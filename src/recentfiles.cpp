@@ -19,11 +19,14 @@
 
 // This file implements class RecentFiles
 
+#include <algorithm>
+
 #include <QSettings>
 #include <QFile>
 
 #include "log.h"
 #include "recentfiles.h"
+#include "fileset.h"
 
 const int RecentFiles::RECENTFILES_VERSION = 1;
 const int RecentFiles::MAX_NUMBER_OF_FILES = 10;
@@ -34,10 +37,12 @@ RecentFiles::RecentFiles() : recentFiles_()
 
 void RecentFiles::addRecent( const QString& text )
 {
-    // First prune non existent files
+    // First prune non existent files (or sets with a missing file)
     QMutableStringListIterator i(recentFiles_);
     while ( i.hasNext() ) {
-        if ( !QFile::exists(i.next()) )
+        const QStringList files = FileSet::files( i.next() );
+        if ( files.isEmpty() || std::any_of( files.begin(), files.end(),
+                    []( const QString& file ) { return !QFile::exists( file ); } ) )
             i.remove();
     }
 
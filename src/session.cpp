@@ -29,7 +29,11 @@
 #include "persistentinfo.h"
 #include "savedsearches.h"
 #include "sessioninfo.h"
+#include "fileset.h"
+#include "configuration.h"
 #include "data/logdata.h"
+#include "data/concatenatedlogdata.h"
+#include "data/mergedlogdata.h"
 #include "data/logfiltereddata.h"
 
 Session::Session()
@@ -65,8 +69,11 @@ ViewInterface* Session::open( const std::string& file_name,
 {
     ViewInterface* view = nullptr;
 
-    QFileInfo fileInfo( file_name.c_str() );
-    if ( fileInfo.isReadable() ) {
+    const QStringList files = FileSet::files( QString( file_name.c_str() ) );
+    const bool readable = ! files.isEmpty() && std::all_of( files.begin(), files.end(),
+            []( const QString& file ) { return QFileInfo( file ).isReadable(); } );
+
+    if ( readable ) {
         return openAlways( file_name, view_factory, nullptr );
     }
     else {
@@ -127,7 +134,8 @@ std::vector<std::pair<std::string, ViewInterface*>> Session::restore(
     for ( auto file: session_files )
     {
         LOG(logDEBUG) << "Create view for " << file.fileName;
-        ViewInterface* view = openAlways( file.fileName, view_factory, file.viewContext.c_str() );
+        ViewInterface* view = openAlways( file.fileName, view_factory,
+                file.viewContext.c_str(), true );
         result.push_back( { file.fileName, view } );
     }
 
@@ -136,6 +144,24 @@ std::vector<std::pair<std::string, ViewInterface*>> Session::restore(
     return result;
 }
 
+void Session::activate( const ViewInterface* view )
+{
+    OpenFile* file = findOpenFileFromView( view );
+
+    if ( file->deferredLoading ) {
+        LOG(logDEBUG) << "Start deferred loading of " << file->fileName;
+
+        auto loading = std::move( file->deferredLoading );
+        file->deferredLoading = nullptr;
+        loading();
+    }
+}
+
+bool Session::isLoadingDeferred( const ViewInterface* view ) const
+{
+    return static_cast<bool>( openFiles_.at( view ).deferredLoading );
+}
+
 void Session::storedGeometry( QByteArray* geometry ) const
 {
     GetPersistentInfo().retrieve( QString( "session" ) );
@@ -166,6 +192,16 @@ void Session::getFileInfo( const ViewInterface* view, uint64_t* fileSize,
     *lastModified = file->logData->getLastModifiedDate();
 }
 
+std::shared_ptr<const AbstractLogSource> Session::getLogData(
+        const ViewInterface* view ) const
+{
+    const OpenFile* file = findOpenFileFromView( view );
+
+    assert( file );
+
+    return file->logData;
+}
+
 
 /*
  * Private methods
@@ -173,10 +209,27 @@ void Session::getFileInfo( const ViewInterface* view, uint64_t* fileSize,
 
 ViewInterface* Session::openAlways( const std::string& file_name,
         std::function<ViewInterface*()> view_factory,
-        const char* view_context )
+        const char* view_context, bool defer_loading )
 {
     // Create the data objects
-    auto log_data          = std::make_shared<LogData>();
+    const QString name = QString( file_name.c_str() );
+    std::shared_ptr<LogData> file_data;
+    std::shared_ptr<CompositeLogData> set_data;
+    std::shared_ptr<AbstractLogSource> log_data;
+    if ( FileSet::isMergedSet( name ) ) {
+        set_data = std::make_shared<MergedLogData>();
+        log_data = set_data;
+    }
+    else if ( FileSet::isFileSet( name ) ) {
+        set_data = std::make_shared<ConcatenatedLogData>();
+        log_data = set_data;
+    }
+    else {
+        file_data = std::make_shared<LogData>();
+        file_data->setMaxRotatedFiles(
+                Persistent<Configuration>( "settings" )->maxRotatedFiles() );
+        log_data = file_data;
+    }
     auto log_filtered_data =
         std::shared_ptr<LogFilteredData>( log_data->getNewFilteredData() );
 
@@ -193,10 +246,21 @@ ViewInterface* Session::openAlways( const std::string& file_name,
             { file_name,
             log_data,
             log_filtered_data,
-            view } } );
-
-    // Start loading the file
-    log_data->attachFile( QString( file_name.c_str() ) );
+            view,
+            nullptr } } );
+
+    // Start loading the file(s)
+    auto loading = [name, set_data, file_data]() {
+        if ( set_data )
+            set_data->attachFiles( FileSet::files( name ) );
+        else
+            file_data->attachFile( name );
+    };
+
+    if ( defer_loading )
+        openFiles_.at( view ).deferredLoading = loading;
+    else
+        loading();
 
     return view;
 }
@@ -34,7 +34,7 @@
 
 class ViewInterface;
 class ViewContextInterface;
-class LogData;
+class AbstractLogSource;
 class LogFilteredData;
 class SavedSearches;
 
@@ -62,6 +62,8 @@ class Session {
     // view for it (the caller passes a factory to build the concrete view)
     // The ownership of the view is given to the caller
     // Throw exceptions if the file is already open or if it cannot be open.
+    // The name can also identify a set of files (see FileSet) that are
+    // opened in the same view.
     ViewInterface* open( const std::string& file_name,
             std::function<ViewInterface*()> view_factory );
     // Close the file identified by the view passed
@@ -69,12 +71,18 @@ class Session {
     void close( const ViewInterface* view );
 
     // Open all the files listed in the stored session
-    // (see ::open)
+    // (see ::open), their loading is deferred until they are activated.
     // returns a vector of pairs (file_name, view) and the index of the
     // current file (or -1 if none).
     std::vector<std::pair<std::string, ViewInterface*>> restore(
             std::function<ViewInterface*()> view_factory,
             int *current_file_index );
+    // Tell the session the passed view is displayed, the loading of
+    // its file starts if it has been deferred.
+    void activate( const ViewInterface* view );
+    // Returns whether the loading of the file of the passed view is
+    // deferred (it has not been activated yet).
+    bool isLoadingDeferred( const ViewInterface* view ) const;
     // Save the session to persistent storage. An ordered list of
     // (view, topline, ViewContextInterface) is passed, this is because only
     // the main window know the order in which the views are presented to
@@ -94,6 +102,10 @@ class Session {
     // The file is identified by the view attached to it.
     void getFileInfo( const ViewInterface* view, uint64_t* fileSize,
             uint32_t* fileNbLine, QDateTime* lastModified ) const;
+    // Get the data of the file attached to the passed view
+    // (e.g. to search all the open files).
+    std::shared_ptr<const AbstractLogSource> getLogData(
+            const ViewInterface* view ) const;
     // Get a (non-const) reference to the QuickFind pattern.
     std::shared_ptr<QuickFindPattern> getQuickFindPattern() const
     { return quickFindPattern_; }
@@ -101,15 +113,18 @@ class Session {
   private:
     struct OpenFile {
         std::string fileName;
-        std::shared_ptr<LogData> logData;
+        std::shared_ptr<AbstractLogSource> logData;
         std::shared_ptr<LogFilteredData> logFilteredData;
         ViewInterface* view;
+        // Starts the loading if it has been deferred (empty otherwise)
+        std::function<void()> deferredLoading;
     };
 
     // Open a file without checking if it is existing/readable
+    // The loading starts immediately unless defer_loading is true.
     ViewInterface* openAlways( const std::string& file_name,
             std::function<ViewInterface*()> view_factory,
-            const char* view_context );
+            const char* view_context, bool defer_loading = false );
     // Find an open file from its associated view
     OpenFile* findOpenFileFromView( const ViewInterface* view );
     const OpenFile* findOpenFileFromView( const ViewInterface* view ) const;
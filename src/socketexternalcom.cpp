@@ -12,6 +12,9 @@
 #include "log.h"
 
 static const char* GLOG_SERVICE_NAME = "org.bonnefon.glogg";
+// Sent instead of a file name to get the statistics back
+// (a file name cannot contain a NUL)
+static const QByteArray STATISTICS_REQUEST( "\0statistics", 11 );
 
 #ifdef Q_OS_UNIX
 QSharedMemory* g_staticSharedMemory = nullptr;
@@ -77,6 +80,31 @@ uint32_t SocketExternalInstance::getVersion() const
     return *reinterpret_cast<uint32_t*>(memory_->data());
 }
 
+QString SocketExternalInstance::getStatistics() const
+{
+    QLocalSocket socket;
+    socket.connectToServer(GLOG_SERVICE_NAME);
+    if (!socket.waitForConnected(1000)) {
+        LOG( logERROR ) << "Failed to connect to socket";
+        return QString();
+    }
+
+    socket.write(STATISTICS_REQUEST);
+    if (!socket.waitForBytesWritten(1000)) {
+        LOG( logERROR ) << "Failed to send the statistics request";
+        return QString();
+    }
+
+    // The other instance replies and closes the connection
+    QByteArray data;
+    while(socket.waitForReadyRead(5000)) {
+        data.append(socket.readAll());
+    }
+    data.append(socket.readAll());
+
+    return QString::fromUtf8(data);
+}
+
 SocketExternalCommunicator::SocketExternalCommunicator()
     : ExternalCommunicator()
     , memory_(new QSharedMemory(GLOG_SERVICE_NAME))
@@ -131,6 +159,13 @@ void SocketExternalCommunicator::onConnection()
          data.append(socket->readAll());
      }
 
+     if (data == STATISTICS_REQUEST) {
+         socket->write(statistics().toUtf8());
+         socket->waitForBytesWritten(1000);
+         socket->close();
+         return;
+     }
+
      socket->close();
 
      emit loadFile(QString::fromUtf8(data));
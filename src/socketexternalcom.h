@@ -13,6 +13,7 @@ public:
 
     void loadFile( const QString& file_name ) const override;
     uint32_t getVersion() const override;
+    QString getStatistics() const override;
 private:
     QSharedMemory* memory_;
 };
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements StatisticsWidget, the panel showing the resources
+// used for each open file.
+
+#include "log.h"
+
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "statisticswidget.h"
+
+namespace {
+
+QString readableSize( qint64 size )
+{
+    static const QString unit[] = { "B", "KiB", "MiB", "GiB" };
+    double human_size = size;
+    int i = 0;
+
+    while ( human_size >= 1024.0 && i < 3 ) {
+        human_size /= 1024.0;
+        ++i;
+    }
+
+    return QString( "%1 %2" ).arg( human_size, 0, 'f', i ? 1 : 0 ).arg( unit[i] );
+}
+
+// Returns the rate of an amount over a duration (in ms), per second
+double perSecond( qint64 amount, qint64 duration_ms )
+{
+    return duration_ms > 0 ? amount * 1000.0 / duration_ms : 0.0;
+}
+
+QString hitRate( const AbstractLogView::DrawingStatistics& view )
+{
+    const uint64_t total = view.textCacheHits + view.textCacheMisses;
+    if ( total == 0 )
+        return "-";
+
+    return QString( "%1 %" ).arg( view.textCacheHits * 100.0 / total, 0, 'f', 1 );
+}
+
+// The (name, value) pairs displayed for a file
+std::vector<std::pair<QString, QString>> describe(
+        const CrawlerWidget::Statistics& statistics )
+{
+    const auto& indexing = statistics.indexing;
+    const auto& search = statistics.search;
+
+    std::vector<std::pair<QString, QString>> items;
+
+    items.emplace_back( QObject::tr( "Size" ), QObject::tr( "%1 (%2 lines)" )
+            .arg( readableSize( statistics.fileSize ) ).arg( statistics.nbLines ) );
+    items.emplace_back( QObject::tr( "Index memory" ), QObject::tr( "%1 (%2 bytes/line)" )
+            .arg( readableSize( indexing.indexMemory ) )
+            .arg( statistics.nbLines > 0 ?
+                static_cast<double>( indexing.indexMemory ) / statistics.nbLines : 0.0,
+                0, 'f', 2 ) );
+    items.emplace_back( QObject::tr( "Search results memory" ),
+            readableSize( search.resultsMemory ) );
+    items.emplace_back( QObject::tr( "View caches memory" ),
+            readableSize( statistics.mainView.cacheMemory
+                + statistics.filteredView.cacheMemory ) );
+    items.emplace_back( QObject::tr( "Text cache hit rate" ),
+            QObject::tr( "%1 (main view), %2 (filtered view)" )
+            .arg( hitRate( statistics.mainView ) )
+            .arg( hitRate( statistics.filteredView ) ) );
+    items.emplace_back( QObject::tr( "Indexing" ), QObject::tr( "%1/s (last: %2 in %3 ms)" )
+            .arg( readableSize( perSecond( indexing.lastIndexingBytes,
+                        indexing.lastIndexingDuration ) ) )
+            .arg( readableSize( indexing.lastIndexingBytes ) )
+            .arg( indexing.lastIndexingDuration ) );
+    items.emplace_back( QObject::tr( "Search" ), QObject::tr( "%1 lines/s (last: %2 lines in %3 ms)" )
+            .arg( perSecond( search.lastSearchLines, search.lastSearchDuration ), 0, 'f', 0 )
+            .arg( search.lastSearchLines )
+            .arg( search.lastSearchDuration ) );
+    items.emplace_back( QObject::tr( "File growth" ), QObject::tr( "%1/s" )
+            .arg( readableSize( perSecond( indexing.bytesAppended,
+                        indexing.followedDuration ) ) ) );
+    items.emplace_back( QObject::tr( "Paints per second" ),
+            QObject::tr( "%1 (main view), %2 (filtered view)" )
+            .arg( statistics.mainView.paintRate )
+            .arg( statistics.filteredView.paintRate ) );
+
+    return items;
+}
+
+}
+
+StatisticsWidget::StatisticsWidget( QWidget* parent ) : QWidget( parent )
+{
+    statisticsTree_ = new QTreeWidget();
+    statisticsTree_->setColumnCount( 2 );
+    statisticsTree_->setHeaderLabels( QStringList() << tr( "File" ) << tr( "Value" ) );
+    statisticsTree_->setRootIsDecorated( true );
+    statisticsTree_->setUniformRowHeights( true );
+
+    QVBoxLayout* main_layout = new QVBoxLayout( this );
+    main_layout->setContentsMargins( 2, 2, 2, 2 );
+    main_layout->addWidget( statisticsTree_ );
+}
+
+// The items are updated in place, so the tree keeps its state
+// (scrolling, items collapsed) as it is refreshed.
+void StatisticsWidget::display( const QStringList& file_names,
+        const std::vector<CrawlerWidget::Statistics>& statistics )
+{
+    while ( statisticsTree_->topLevelItemCount() > file_names.size() )
+        delete statisticsTree_->takeTopLevelItem(
+                statisticsTree_->topLevelItemCount() - 1 );
+
+    for ( int i = 0; i < file_names.size(); ++i ) {
+        QTreeWidgetItem* file_item = statisticsTree_->topLevelItem( i );
+        if ( ! file_item ) {
+            file_item = new QTreeWidgetItem( statisticsTree_ );
+            file_item->setExpanded( true );
+        }
+        file_item->setText( 0, file_names[i] );
+
+        const auto items = describe( statistics[i] );
+        for ( int j = 0; j < static_cast<int>( items.size() ); ++j ) {
+            QTreeWidgetItem* item = file_item->child( j );
+            if ( ! item )
+                item = new QTreeWidgetItem( file_item );
+            item->setText( 0, items[j].first );
+            item->setText( 1, items[j].second );
+        }
+    }
+}
+
+QString StatisticsWidget::report( const QStringList& file_names,
+        const std::vector<CrawlerWidget::Statistics>& statistics )
+{
+    QString text;
+
+    for ( int i = 0; i < file_names.size(); ++i ) {
+        text += file_names[i] + "\n";
+        for ( const auto& item: describe( statistics[i] ) )
+            text += QString( "  %1: %2\n" ).arg( item.first, item.second );
+    }
+
+    return text;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef STATISTICSWIDGET_H
+#define STATISTICSWIDGET_H
+
+#include <vector>
+
+#include <QWidget>
+#include <QStringList>
+
+#include "crawlerwidget.h"
+
+class QTreeWidget;
+
+// Panel displaying the resources (memory, CPU...) used for each open file,
+// the statistics are passed by the client which refreshes them while the
+// panel is visible.
+class StatisticsWidget : public QWidget
+{
+  Q_OBJECT
+
+  public:
+    StatisticsWidget( QWidget* parent = 0 );
+
+    // Display the statistics of the passed files (names are the ones
+    // displayed), in the same order.
+    void display( const QStringList& file_names,
+            const std::vector<CrawlerWidget::Statistics>& statistics );
+
+    // Returns the statistics of the passed files as text
+    static QString report( const QStringList& file_names,
+            const std::vector<CrawlerWidget::Statistics>& statistics );
+
+  private:
+    QTreeWidget* statisticsTree_;
+};
+
+#endif
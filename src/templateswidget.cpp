@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// This file implements TemplatesWidget, the panel used to mine the
+// templates of the lines of a file.
+
+#include "log.h"
+
+#include <QPushButton>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+
+#include "data/templateminer.h"
+
+#include "templateswidget.h"
+
+namespace {
+    // Columns of the templates
+    enum { CountColumn, PercentColumn, TemplateColumn, ExampleColumn };
+}
+
+TemplatesWidget::TemplatesWidget( QWidget* parent ) : QWidget( parent )
+{
+    analyseButton_ = new QPushButton( tr( "&Analyse" ) );
+    analyseButton_->setToolTip( tr( "Group the lines of the current file by template" ) );
+    stopButton_ = new QPushButton( tr( "St&op" ) );
+    stopButton_->setEnabled( false );
+    checkAllButton_ = new QPushButton( tr( "Check &all" ) );
+    uncheckAllButton_ = new QPushButton( tr( "Check &none" ) );
+    showButton_ = new QPushButton( tr( "&Show checked" ) );
+    showButton_->setToolTip( tr( "Show the lines of the templates checked in the filtered view" ) );
+    showButton_->setEnabled( false );
+    statusLabel_ = new QLabel();
+
+    templatesTree_ = new QTreeWidget();
+    templatesTree_->setColumnCount( 4 );
+    templatesTree_->setHeaderLabels( QStringList()
+            << tr( "Count" ) << tr( "%" ) << tr( "Template" ) << tr( "Example" ) );
+    templatesTree_->setRootIsDecorated( false );
+    templatesTree_->setUniformRowHeights( true );
+    templatesTree_->setSortingEnabled( true );
+    templatesTree_->sortByColumn( CountColumn, Qt::DescendingOrder );
+
+    QHBoxLayout* buttons_layout = new QHBoxLayout();
+    buttons_layout->setContentsMargins( 0, 0, 0, 0 );
+    buttons_layout->addWidget( analyseButton_ );
+    buttons_layout->addWidget( stopButton_ );
+    buttons_layout->addWidget( statusLabel_ );
+    buttons_layout->addStretch();
+    buttons_layout->addWidget( checkAllButton_ );
+    buttons_layout->addWidget( uncheckAllButton_ );
+    buttons_layout->addWidget( showButton_ );
+
+    QVBoxLayout* main_layout = new QVBoxLayout( this );
+    main_layout->setContentsMargins( 2, 2, 2, 2 );
+    main_layout->addLayout( buttons_layout );
+    main_layout->addWidget( templatesTree_ );
+
+    // Behaviour
+    connect( analyseButton_, SIGNAL( clicked() ),
+            this, SIGNAL( analyseRequested() ) );
+    connect( stopButton_, SIGNAL( clicked() ),
+            this, SLOT( stopHandler() ) );
+    connect( checkAllButton_, SIGNAL( clicked() ),
+            this, SLOT( checkAllHandler() ) );
+    connect( uncheckAllButton_, SIGNAL( clicked() ),
+            this, SLOT( uncheckAllHandler() ) );
+    connect( showButton_, SIGNAL( clicked() ),
+            this, SIGNAL( showRequested() ) );
+    connect( templatesTree_, SIGNAL( itemActivated( QTreeWidgetItem*, int ) ),
+            this, SLOT( itemActivatedHandler( QTreeWidgetItem*, int ) ) );
+}
+
+TemplatesWidget::~TemplatesWidget()
+{
+}
+
+void TemplatesWidget::userActivate()
+{
+    analyseButton_->setFocus( Qt::ShortcutFocusReason );
+}
+
+void TemplatesWidget::analyse( const std::shared_ptr<const AbstractLogSource>& source )
+{
+    LOG(logDEBUG) << "TemplatesWidget::analyse";
+
+    // Stop the previous analysis (its results are not wanted anymore)
+    miner_.reset();
+    index_.reset();
+    templatesTree_->clear();
+    showButton_->setEnabled( false );
+
+    miner_.reset( new TemplateMiner() );
+    connect( miner_.get(), SIGNAL( progressed( int ) ),
+            this, SLOT( progressedHandler( int ) ), Qt::QueuedConnection );
+    connect( miner_.get(), SIGNAL( finished() ),
+            this, SLOT( finishedHandler() ), Qt::QueuedConnection );
+
+    stopButton_->setEnabled( true );
+    statusLabel_->setText( tr( "Analysing" ) );
+
+    miner_->start( source );
+}
+
+std::vector<bool> TemplatesWidget::getCheckedTemplates() const
+{
+    std::vector<bool> checked( index_ ? index_->getTemplates().size() : 0, false );
+    for ( int i = 0; i < templatesTree_->topLevelItemCount(); ++i ) {
+        const QTreeWidgetItem* item = templatesTree_->topLevelItem( i );
+        const int id = item->data( TemplateColumn, Qt::UserRole ).toInt();
+        if ( id < static_cast<int>( checked.size() ) )
+            checked[id] = ( item->checkState( TemplateColumn ) == Qt::Checked );
+    }
+
+    return checked;
+}
+
+void TemplatesWidget::setStatus( const QString& status )
+{
+    statusLabel_->setText( status );
+}
+
+//
+// Slots
+//
+
+void TemplatesWidget::stopHandler()
+{
+    // Interrupts the analysis and releases the file
+    miner_.reset();
+
+    stopButton_->setEnabled( false );
+    statusLabel_->setText( tr( "Stopped" ) );
+}
+
+void TemplatesWidget::checkAllHandler()
+{
+    setAllChecked( true );
+}
+
+void TemplatesWidget::uncheckAllHandler()
+{
+    setAllChecked( false );
+}
+
+void TemplatesWidget::progressedHandler( int percent )
+{
+    if ( miner_ )
+        statusLabel_->setText( tr( "Analysing (%1 %)" ).arg( percent ) );
+}
+
+void TemplatesWidget::finishedHandler()
+{
+    // The signal might come from an analysis replaced since
+    if ( ! miner_ || ! miner_->isFinished() )
+        return;
+
+    index_ = miner_->getIndex();
+    const qint64 nb_lines = index_->getNbLines();
+    const auto& templates = index_->getTemplates();
+
+    // The items are sorted once all of them have been added,
+    // all the templates are shown to begin with
+    templatesTree_->setSortingEnabled( false );
+    for ( size_t id = 0; id < templates.size(); ++id ) {
+        const TemplateIndex::Template& templ = templates[id];
+        QTreeWidgetItem* item = new QTreeWidgetItem( templatesTree_ );
+        item->setData( CountColumn, Qt::DisplayRole, templ.count );
+        item->setData( PercentColumn, Qt::DisplayRole,
+                qRound( templ.count * 1000.0 / nb_lines ) / 10.0 );
+        item->setText( TemplateColumn, templ.text );
+        item->setData( TemplateColumn, Qt::UserRole, static_cast<int>( id ) );
+        item->setCheckState( TemplateColumn, Qt::Checked );
+        // Lines are displayed starting at 1
+        item->setData( ExampleColumn, Qt::DisplayRole, templ.exampleLine + 1 );
+        item->setTextAlignment( CountColumn, Qt::AlignRight );
+        item->setTextAlignment( PercentColumn, Qt::AlignRight );
+    }
+    templatesTree_->setSortingEnabled( true );
+
+    statusLabel_->setText( tr( "%1 templates in %2 lines" )
+            .arg( templates.size() ).arg( nb_lines ) );
+    stopButton_->setEnabled( false );
+    showButton_->setEnabled( true );
+
+    // The file (possibly closed since) is not needed anymore
+    miner_.reset();
+}
+
+void TemplatesWidget::itemActivatedHandler( QTreeWidgetItem* item, int )
+{
+    emit exampleActivated( item->data( ExampleColumn, Qt::DisplayRole ).toLongLong() - 1 );
+}
+
+//
+// Private functions
+//
+
+void TemplatesWidget::setAllChecked( bool checked )
+{
+    for ( int i = 0; i < templatesTree_->topLevelItemCount(); ++i )
+        templatesTree_->topLevelItem( i )->setCheckState( TemplateColumn,
+                checked ? Qt::Checked : Qt::Unchecked );
+}
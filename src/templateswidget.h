@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TEMPLATESWIDGET_H
+#define TEMPLATESWIDGET_H
+
+#include <memory>
+#include <vector>
+
+#include <QWidget>
+
+class QPushButton;
+class QLabel;
+class QTreeWidget;
+class QTreeWidgetItem;
+class TemplateMiner;
+class TemplateIndex;
+class AbstractLogSource;
+
+// Panel mining the templates of the lines of the current file and
+// displaying them, the lines of the templates checked can then be
+// shown in the filtered view (hiding the other ones).
+class TemplatesWidget : public QWidget
+{
+  Q_OBJECT
+
+  public:
+    TemplatesWidget( QWidget* parent = 0 );
+    ~TemplatesWidget();
+
+    // Give the focus to the analyse button
+    void userActivate();
+
+    // Mine the templates of the passed file, called in response
+    // to analyseRequested.
+    void analyse( const std::shared_ptr<const AbstractLogSource>& source );
+
+    // Returns the index of the last analysis, nullptr if none is done
+    std::shared_ptr<const TemplateIndex> getIndex() const { return index_; }
+    // Returns whether each template (by id) is checked
+    std::vector<bool> getCheckedTemplates() const;
+    // Display a message in the status line
+    void setStatus( const QString& status );
+
+  signals:
+    // Sent when the user starts an analysis, the client is expected
+    // to call analyse() with the current file.
+    void analyseRequested();
+    // Sent when the user asks for the lines of the templates checked,
+    // available from getIndex() and getCheckedTemplates().
+    void showRequested();
+    // Sent when the user selects a template, line being its example
+    void exampleActivated( qint64 line );
+
+  private slots:
+    void stopHandler();
+    void checkAllHandler();
+    void uncheckAllHandler();
+    void progressedHandler( int percent );
+    void finishedHandler();
+    void itemActivatedHandler( QTreeWidgetItem* item, int column );
+
+  private:
+    void setAllChecked( bool checked );
+
+    QPushButton* analyseButton_;
+    QPushButton* stopButton_;
+    QPushButton* checkAllButton_;
+    QPushButton* uncheckAllButton_;
+    QPushButton* showButton_;
+    QLabel*      statusLabel_;
+    QTreeWidget* templatesTree_;
+
+    std::unique_ptr<TemplateMiner> miner_;
+    std::shared_ptr<const TemplateIndex> index_;
+};
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMESLICE_H
+#define TIMESLICE_H
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+// Time given to a background job working on lines before it goes back
+// to the event loop.
+// The lines are read in batches sized from the time taken by the ones
+// already processed, so that a batch doesn't take much longer than
+// what is left of the slice: the lines read past the deadline are
+// thrown away and read again in the next slice.
+class TimeSlice {
+  public:
+    // Starts a slice of the passed duration
+    TimeSlice( int duration_ms ) :
+        timer_(), duration_( duration_ms ), processedLines_( 0 ), lastRead_( 0 )
+    { timer_.start(); }
+
+    // Returns whether the slice is over
+    bool isOver() const { return timer_.elapsed() >= duration_; }
+
+    // Returns the number of lines to read next, at most max_lines
+    int linesToRead( int max_lines )
+    {
+        const qint64 elapsed = timer_.elapsed();
+        qint64 nb_lines;
+        if ( processedLines_ == 0 )
+            nb_lines = FIRST_READ;
+        else if ( elapsed == 0 )
+            // Too fast to be measured
+            nb_lines = 2 * lastRead_;
+        else
+            nb_lines = processedLines_ * ( duration_ - elapsed ) / elapsed;
+
+        lastRead_ = static_cast<int>( qBound<qint64>( 1, nb_lines, max_lines ) );
+        return lastRead_;
+    }
+
+    // To be called after each line processed
+    void lineProcessed() { ++processedLines_; }
+
+  private:
+    // Size of the first read, before the time per line is known
+    static const int FIRST_READ = 16;
+
+    QElapsedTimer timer_;
+    int duration_;
+    qint64 processedLines_;
+    int lastRead_;
+};
+
+#endif
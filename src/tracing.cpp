@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "tracing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Tracing::enabled_( false );
+
+namespace {
+
+struct Span {
+    const char* category;
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int64_t arg;
+    int thread;
+};
+
+// Written by one thread at a time, read when exporting
+struct ThreadBuffer {
+    ThreadBuffer() : spans( Tracing::bufferSize ), count( 0 ) {}
+
+    std::vector<Span> spans;
+    // Number of spans written, the next one goes to count % bufferSize
+    std::atomic<uint64_t> count;
+    // Identifies the thread using it in the exported events
+    int thread = 0;
+    bool inUse = false;
+};
+
+// Protects the list of buffers, only locked when a thread records its
+// first span (or exits) and when exporting.
+std::mutex buffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+int nbThreads = 0;
+
+// Spans started before this time have been cleared
+std::atomic<uint64_t> clearedAt( 0 );
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+// Gives the buffer back (with its spans) when the thread exits
+struct BufferHolder {
+    ~BufferHolder()
+    {
+        if ( buffer ) {
+            std::lock_guard<std::mutex> lock( buffersMutex );
+            buffer->inUse = false;
+        }
+    }
+
+    ThreadBuffer* buffer = nullptr;
+};
+
+ThreadBuffer* threadBuffer()
+{
+    thread_local BufferHolder holder;
+
+    if ( ! holder.buffer ) {
+        std::lock_guard<std::mutex> lock( buffersMutex );
+
+        auto free_buffer = std::find_if( buffers.begin(), buffers.end(),
+                []( const std::unique_ptr<ThreadBuffer>& buffer ) {
+                    return ! buffer->inUse; } );
+        if ( free_buffer == buffers.end() ) {
+            buffers.emplace_back( new ThreadBuffer() );
+            free_buffer = buffers.end() - 1;
+        }
+
+        holder.buffer = free_buffer->get();
+        holder.buffer->inUse = true;
+        holder.buffer->thread = ++nbThreads;
+    }
+
+    return holder.buffer;
+}
+
+std::string jsonString( const char* text )
+{
+    std::string result = "\"";
+    for ( const char* c = text; *c; ++c ) {
+        if ( *c == '"' || *c == '\\' )
+            result += '\\';
+        result += *c;
+    }
+
+    return result + '"';
+}
+
+}
+
+void Tracing::setEnabled( bool enabled )
+{
+    enabled_.store( enabled, std::memory_order_relaxed );
+}
+
+void Tracing::record( const char* category, const char* name,
+        uint64_t start_ns, uint64_t end_ns, int64_t arg )
+{
+    ThreadBuffer* buffer = threadBuffer();
+
+    // Only this thread writes to the buffer
+    const uint64_t index = buffer->count.load( std::memory_order_relaxed );
+    buffer->spans[ index % bufferSize ] =
+        { category, name, start_ns, end_ns, arg, buffer->thread };
+    buffer->count.store( index + 1, std::memory_order_release );
+}
+
+uint64_t Tracing::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch ).count();
+}
+
+void Tracing::clear()
+{
+    clearedAt.store( now() );
+}
+
+void Tracing::exportChromeTrace( std::ostream& out )
+{
+    std::vector<Span> spans;
+
+    {
+        std::lock_guard<std::mutex> lock( buffersMutex );
+        for ( const auto& buffer: buffers ) {
+            const uint64_t end = buffer->count.load( std::memory_order_acquire );
+            const uint64_t begin = end > bufferSize ? end - bufferSize : 0;
+
+            std::vector<Span> copy;
+            for ( uint64_t i = begin; i < end; ++i )
+                copy.push_back( buffer->spans[ i % bufferSize ] );
+
+            // Drop the spans the thread may have overwritten whilst
+            // we were copying them, including the slot it might be
+            // writing (the one of the span new_end) right now.
+            const uint64_t new_end = buffer->count.load( std::memory_order_acquire );
+            const uint64_t first_valid =
+                new_end >= bufferSize ? new_end - bufferSize + 1 : 0;
+            const uint64_t skipped = std::min<uint64_t>(
+                    first_valid > begin ? first_valid - begin : 0, copy.size() );
+            spans.insert( spans.end(), copy.begin() + skipped, copy.end() );
+        }
+    }
+
+    const uint64_t cleared_at = clearedAt.load();
+    spans.erase( std::remove_if( spans.begin(), spans.end(),
+                [cleared_at]( const Span& span ) {
+                    return span.start_ns < cleared_at; } ),
+            spans.end() );
+    std::sort( spans.begin(), spans.end(),
+            []( const Span& a, const Span& b ) { return a.start_ns < b.start_ns; } );
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+        << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"glogg\"}}";
+
+    out << std::fixed << std::setprecision( 3 );
+    for ( const auto& span: spans ) {
+        out << ",\n{\"name\":" << jsonString( span.name )
+            << ",\"cat\":" << jsonString( span.category )
+            << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << span.thread
+            << ",\"ts\":" << span.start_ns / 1000.0
+            << ",\"dur\":" << ( span.end_ns - span.start_ns ) / 1000.0;
+        if ( span.arg >= 0 )
+            out << ",\"args\":{\"value\":" << span.arg << "}";
+        out << "}";
+    }
+
+    out << "\n]}\n";
+}
+
+bool Tracing::exportChromeTrace( const std::string& file_name )
+{
+    std::ofstream file( file_name );
+    exportChromeTrace( file );
+
+    return file.good();
+}
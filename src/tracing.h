@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Lightweight tracing of the duration of operations ("spans"), always
+// compiled but only recording when enabled at run time (costing a relaxed
+// atomic load otherwise).
+// Each thread records to its own ring buffer, without locking, keeping
+// its latest spans; they can be exported in the Chrome trace event format
+// (readable by chrome://tracing or Perfetto).
+class Tracing {
+  public:
+    // Enable or disable the recording (disabled by default)
+    static void setEnabled( bool enabled );
+    static bool isEnabled()
+    { return enabled_.load( std::memory_order_relaxed ); }
+
+    // Record a span, name and category must be string literals
+    // (only their pointers are kept), arg is added to the exported
+    // event if positive.
+    static void record( const char* category, const char* name,
+            uint64_t start_ns, uint64_t end_ns, int64_t arg );
+
+    // Returns the current time, in ns since the tracing epoch
+    static uint64_t now();
+
+    // Forget all the spans recorded
+    static void clear();
+
+    // Write the spans recorded as Chrome trace JSON, oldest first
+    static void exportChromeTrace( std::ostream& out );
+    // Same, to a file, returns false if it cannot be written
+    static bool exportChromeTrace( const std::string& file_name );
+
+    // Number of spans kept per thread
+    static const int bufferSize = 16384;
+
+  private:
+    static std::atomic<bool> enabled_;
+};
+
+// Records the time between its construction and its destruction
+// (or the call to end()) if tracing is enabled at construction.
+class TraceSpan {
+  public:
+    TraceSpan( const char* category, const char* name, int64_t arg = -1 )
+        : category_( category ), name_( Tracing::isEnabled() ? name : nullptr ),
+        arg_( arg ), start_( name_ ? Tracing::now() : 0 ) {}
+    ~TraceSpan() { end(); }
+
+    // Set the argument recorded with the span (e.g. the number of lines)
+    void setArg( int64_t arg ) { arg_ = arg; }
+
+    // End the span now
+    void end()
+    {
+        if ( name_ ) {
+            Tracing::record( category_, name_, start_, Tracing::now(), arg_ );
+            name_ = nullptr;
+        }
+    }
+
+  private:
+    TraceSpan( const TraceSpan& );
+    TraceSpan& operator=( const TraceSpan& );
+
+    const char* category_;
+    const char* name_;
+    int64_t arg_;
+    uint64_t start_;
+};
+
+#define TRACE_SPAN_NAME2( line ) trace_span_##line
+#define TRACE_SPAN_NAME( line ) TRACE_SPAN_NAME2( line )
+// Trace the rest of the current scope
+#define TRACE_SPAN( ... ) TraceSpan TRACE_SPAN_NAME( __LINE__ )( __VA_ARGS__ )
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// This file implements the UpdateScheduler class.
+// It batches the refreshes triggered by the file watcher (follow mode)
+// so each tab is updated at most once per frame, and only when shown.
+
+#include "log.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "updatescheduler.h"
+
+UpdateScheduler::UpdateScheduler() : QObject(), pending_(), frameTimer_()
+{
+    frameTimer_.setInterval( FRAME_INTERVAL_MS );
+    connect( &frameTimer_, SIGNAL( timeout() ),
+            this, SLOT( processFrame() ) );
+}
+
+void UpdateScheduler::requestUpdate( ScheduledUpdateClientInterface* client )
+{
+    ++statistics_.requested;
+
+    if ( isPending( client ) )
+        ++statistics_.coalesced;
+    else
+        pending_.push_back( client );
+
+    if ( ! frameTimer_.isActive() )
+        frameTimer_.start();
+}
+
+void UpdateScheduler::flush( ScheduledUpdateClientInterface* client )
+{
+    auto it = std::find( pending_.begin(), pending_.end(), client );
+    if ( it != pending_.end() ) {
+        LOG(logDEBUG) << "UpdateScheduler: catching up with " << client;
+        pending_.erase( it );
+        ++statistics_.processed;
+        client->applyScheduledUpdate();
+    }
+}
+
+void UpdateScheduler::cancel( ScheduledUpdateClientInterface* client )
+{
+    pending_.remove( client );
+}
+
+bool UpdateScheduler::isPending(
+        const ScheduledUpdateClientInterface* client ) const
+{
+    return std::find( pending_.begin(), pending_.end(), client )
+        != pending_.end();
+}
+
+void UpdateScheduler::processFrame()
+{
+    // Take the clients ready for update out of the list first,
+    // as applying an update might request a new one.
+    std::list<ScheduledUpdateClientInterface*> ready;
+    auto it = pending_.begin();
+    while ( it != pending_.end() ) {
+        auto next = std::next( it );
+        if ( (*it)->isShownForUpdate() )
+            ready.splice( ready.end(), pending_, it );
+        else
+            ++statistics_.deferred;
+        it = next;
+    }
+
+    for ( auto client: ready ) {
+        ++statistics_.processed;
+        client->applyScheduledUpdate();
+    }
+
+    // Hidden clients will be updated by flush() when shown again,
+    // no need to wake up for them.
+    if ( std::none_of( pending_.begin(), pending_.end(),
+                [] ( ScheduledUpdateClientInterface* client )
+                { return client->isShownForUpdate(); } ) )
+        frameTimer_.stop();
+
+    if ( ! reportCounter_.addEvent() ) {
+        logStatistics();
+        reportCounter_.readAndReset();
+        reportCounter_.addEvent();
+    }
+}
+
+void UpdateScheduler::logStatistics()
+{
+    LOG(logDEBUG) << "UpdateScheduler: "
+        << statistics_.requested - lastReported_.requested << " requested, "
+        << statistics_.processed - lastReported_.processed << " processed, "
+        << statistics_.coalesced - lastReported_.coalesced << " dropped (coalesced), "
+        << statistics_.deferred - lastReported_.deferred << " deferred (hidden)";
+
+    lastReported_ = statistics_;
+}
+
+UpdateScheduler& GetUpdateScheduler()
+{
+    static UpdateScheduler scheduler;
+
+    return scheduler;
+}
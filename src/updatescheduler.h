@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2016 Nicolas Bonnefon and other contributors
+ *
+ * This file is part of glogg.
+ *
+ * glogg is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * glogg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with glogg.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UPDATESCHEDULER_H
+#define UPDATESCHEDULER_H
+
+#include <cstdint>
+#include <list>
+
+#include <QObject>
+#include <QTimer>
+
+#include "perfcounter.h"
+
+// Interface implemented by the widgets whose refresh is driven by
+// the UpdateScheduler.
+class ScheduledUpdateClientInterface {
+  public:
+    virtual ~ScheduledUpdateClientInterface() {}
+
+    // Is the client currently displayed on screen
+    bool isShownForUpdate() const
+    { return doIsShownForUpdate(); }
+    // Apply all the updates accumulated since the last call
+    void applyScheduledUpdate()
+    { doApplyScheduledUpdate(); }
+
+  protected:
+    virtual bool doIsShownForUpdate() const = 0;
+    virtual void doApplyScheduledUpdate() = 0;
+};
+
+// Global scheduler coalescing the view refreshes caused by file changes.
+// Update requests are batched and applied at most once per display frame
+// for every client, clients not shown on screen keep their request
+// pending until they are shown again.
+//
+// This class is NOT thread-safe and must be used from the GUI thread.
+class UpdateScheduler : public QObject {
+  Q_OBJECT
+
+  public:
+    // Counters reported by the scheduler
+    struct Statistics {
+        // Update requests received
+        uint64_t requested = 0;
+        // Requests merged with an already pending one
+        uint64_t coalesced = 0;
+        // Updates actually applied to a client
+        uint64_t processed = 0;
+        // Frames where a pending update was held back because
+        // its client was hidden
+        uint64_t deferred = 0;
+    };
+
+    // Interval between two frames, in ms.
+    static const int FRAME_INTERVAL_MS = 16;
+
+    // Request an update of the passed client, it will be applied
+    // at the next frame if the client is visible.
+    void requestUpdate( ScheduledUpdateClientInterface* client );
+    // Apply the pending update of the client (if any) straight away,
+    // typically when it is shown again.
+    void flush( ScheduledUpdateClientInterface* client );
+    // Forget the pending update of a client about to be destroyed.
+    void cancel( ScheduledUpdateClientInterface* client );
+
+    // Returns whether an update is pending for this client
+    bool isPending( const ScheduledUpdateClientInterface* client ) const;
+
+    Statistics statistics() const { return statistics_; }
+
+  private slots:
+    // Called once per frame when updates are pending
+    void processFrame();
+
+  private:
+    // Constructor is private, use GetUpdateScheduler()
+    UpdateScheduler();
+
+    void logStatistics();
+
+    std::list<ScheduledUpdateClientInterface*> pending_;
+    QTimer frameTimer_;
+
+    Statistics statistics_;
+    // Statistics at the time of the last report
+    Statistics lastReported_;
+    PerfCounter reportCounter_;
+
+    friend UpdateScheduler& GetUpdateScheduler();
+};
+
+// Access the global UpdateScheduler
+UpdateScheduler& GetUpdateScheduler();
+
+#endif
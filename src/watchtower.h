@@ -173,7 +173,7 @@ Registration WatchTower<Driver>::addFile(
                             driver_.removeDir( dir->dir_id_ );
                         } } );
 
-            dir->dir_id_ = driver_.addDir( dir->path );
+            observed_file_list_.setDirectoryId( dir, driver_.addDir( dir->path ) );
 
             if ( ! dir->dir_id_.valid() ) {
                 LOG(logWARNING) << "WatchTower::addFile driver failed to add dir";
@@ -191,7 +191,7 @@ Registration WatchTower<Driver>::addFile(
     else
     {
         LOG(logDEBUG) << "WatchTower::addFile add extra callback for already monitored " << file_name;
-        existing_observed_file->addCallback( ptr );
+        observed_file_list_.addCallback( existing_observed_file, ptr );
     }
 
     // Returns a shared pointer that removes its own entry
@@ -274,8 +274,11 @@ void WatchTower<Driver>::run()
             driver_.removeFile( file->file_id_ );
             driver_.removeSymlink( file->symlink_id_ );
 
-            std::tie( file->file_id_, file->symlink_id_ ) =
-                addFileToDriver( file->file_name_ );
+            typename Driver::FileId file_id;
+            typename Driver::SymlinkId symlink_id;
+
+            std::tie( file_id, symlink_id ) = addFileToDriver( file->file_name_ );
+            observed_file_list_.updateFileIds( file, file_id, symlink_id );
         }
 
         for ( auto file: files ) {
@@ -8,6 +8,8 @@
 #include <vector>
 #include <map>
 #include <list>
+#include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <algorithm>
 #include <chrono>
@@ -24,6 +26,13 @@ struct ProtocolInfo {
     char buffer_[buffer_length_];
 };
 
+// Hash functor for the ids (file/symlink/dir) of a driver,
+// they have to provide a hash() member function.
+template <typename Id>
+struct DriverIdHash {
+    std::size_t operator()( const Id& id ) const { return id.hash(); }
+};
+
 // List of files and observers
 template <typename Driver>
 struct ObservedDir {
@@ -99,6 +108,9 @@ struct ObservedFile {
 };
 
 // A list of the observed files and directories
+// Files are indexed by name, directory, watch ids and callbacks so
+// the lookups done for each event don't depend on the number of
+// observed files.
 // This class is not thread safe
 template<typename Driver>
 class ObservedFileList {
@@ -124,6 +136,14 @@ class ObservedFileList {
         // Add a new file, the list returns a pointer to the added file,
         // but has ownership of the file.
         ObservedFile<Driver>* addNewObservedFile( ObservedFile<Driver> new_observed );
+        // Add an extra callback to a file already in the list.
+        void addCallback( ObservedFile<Driver>* file,
+                std::shared_ptr<void> callback );
+        // Change the ids of a file already in the list
+        // (e.g. after it has been readded to the driver).
+        void updateFileIds( ObservedFile<Driver>* file,
+                typename Driver::FileId file_id,
+                typename Driver::SymlinkId symlink_id );
         // Remove a callback, remove and returns the file object if
         // it was the last callback on this object, nullptr if not.
         // The caller has ownership of the object.
@@ -146,12 +166,18 @@ class ObservedFileList {
         std::shared_ptr<ObservedDir<Driver>> watchedDirectoryForFile( const std::string& file_name );
         std::shared_ptr<ObservedDir<Driver>> addWatchedDirectoryForFile( const std::string& file_name,
                 std::function<void( ObservedDir<Driver>* )> remove_notification );
+        // Record the id the driver has given to a watched directory,
+        // events for this id can then be mapped back to the directory.
+        void setDirectoryId( std::shared_ptr<ObservedDir<Driver>> dir,
+                typename Driver::DirId dir_id );
 
         // Removal of directories is done when there is no shared reference
         // left (RAII)
 
         // Number of watched directories (for tests)
         unsigned int numberWatchedDirectories() const;
+        // Number of observed files (for tests)
+        unsigned int numberObservedFiles() const;
 
         // Iterator
         template<typename Container>
@@ -184,16 +210,30 @@ class ObservedFileList {
         { return iterator<std::list<ObservedFile<Driver>>>( &observed_files_, observed_files_.end() ); }
 
     private:
+        typedef typename std::list<ObservedFile<Driver>>::iterator FileIterator;
+
         // List of observed files
         std::list<ObservedFile<Driver>> observed_files_;
 
         // List of observed dirs, key-ed by name
         std::map<std::string, std::weak_ptr<ObservedDir<Driver>>> observed_dirs_;
 
-        // Map the inotify file (including symlinks) wds to the observed file
-        std::map<int, ObservedFile<Driver>*> by_file_wd_;
-        // Map the inotify directory wds to the observed files
-        std::map<int, ObservedFile<Driver>*> by_dir_wd_;
+        // Indexes of the observed files
+        // (names are unique, whereas several names can share the same inode
+        // and thus the same driver id)
+        std::unordered_map<std::string, FileIterator> by_name_;
+        std::unordered_map<std::string,
+            std::unordered_set<ObservedFile<Driver>*>> by_dir_name_;
+        std::unordered_multimap<typename Driver::FileId, ObservedFile<Driver>*,
+            DriverIdHash<typename Driver::FileId>> by_file_id_;
+        std::unordered_multimap<typename Driver::SymlinkId, ObservedFile<Driver>*,
+            DriverIdHash<typename Driver::SymlinkId>> by_symlink_id_;
+        std::unordered_map<const void*, FileIterator> by_callback_;
+
+        // Map the driver's directory ids to the observed dirs
+        std::unordered_map<typename Driver::DirId,
+            std::weak_ptr<ObservedDir<Driver>>,
+            DriverIdHash<typename Driver::DirId>> by_dir_id_;
 
         // A shared_ptr to self.
         // weak_ptr's from this can check if the list is still alive.
@@ -202,6 +242,12 @@ class ObservedFileList {
 
         // Clean all reference to any expired directory
         void cleanRefsToExpiredDirs();
+        // Add/remove the file ids to/from the indexes
+        void indexFileIds( ObservedFile<Driver>* file );
+        void unindexFileIds( ObservedFile<Driver>* file );
+        // Returns the directory watched with the passed id or nullptr
+        std::shared_ptr<ObservedDir<Driver>> directoryById(
+                typename Driver::DirId id );
 };
 
 namespace {
@@ -214,20 +260,15 @@ ObservedFile<Driver>* ObservedFileList<Driver>::searchByName(
         const std::string& file_name )
 {
     // Look for an existing observer on this file
-    auto existing_observer = observed_files_.begin();
-    for ( ; existing_observer != observed_files_.end(); ++existing_observer )
-    {
-        if ( existing_observer->file_name_ == file_name )
-        {
-            LOG(logDEBUG) << "Found " << file_name;
-            break;
-        }
-    }
+    auto existing_observer = by_name_.find( file_name );
 
-    if ( existing_observer != observed_files_.end() )
-        return &( *existing_observer );
-    else
+    if ( existing_observer != by_name_.end() ) {
+        LOG(logDEBUG) << "Found " << file_name;
+        return &( *existing_observer->second );
+    }
+    else {
         return nullptr;
+    }
 }
 
 template <typename Driver>
@@ -235,32 +276,23 @@ ObservedFile<Driver>* ObservedFileList<Driver>::searchByFileOrSymlinkWd(
         typename Driver::FileId file_id,
         typename Driver::SymlinkId symlink_id )
 {
-    auto result = find_if( observed_files_.begin(), observed_files_.end(),
-            [file_id, symlink_id] (ObservedFile<Driver> file) -> bool {
-                return ( file_id == file.file_id_ ) ||
-                    ( symlink_id == file.symlink_id_ );
-                } );
-
-    if ( result != observed_files_.end() )
-        return &( *result );
-    else
-        return nullptr;
+    auto by_file = by_file_id_.find( file_id );
+    if ( by_file != by_file_id_.end() )
+        return by_file->second;
+
+    auto by_symlink = by_symlink_id_.find( symlink_id );
+    if ( by_symlink != by_symlink_id_.end() )
+        return by_symlink->second;
+
+    return nullptr;
 }
 
 template <typename Driver>
 ObservedFile<Driver>* ObservedFileList<Driver>::searchByDirWdAndName(
         typename Driver::DirId id, const char* name )
 {
-    auto dir = find_if( observed_dirs_.begin(), observed_dirs_.end(),
-            [id] (std::pair<std::string,std::weak_ptr<ObservedDir<Driver>>> d) -> bool {
-            if ( auto dir = d.second.lock() ) {
-                return ( id == dir->dir_id_ );
-            }
-            else {
-                return false; } } );
-
-    if ( dir != observed_dirs_.end() ) {
-        std::string path = dir->first + "/" + name;
+    if ( auto dir = directoryById( id ) ) {
+        std::string path = dir->path + "/" + name;
 
         // LOG(logDEBUG) << "Testing path: " << path;
 
@@ -278,22 +310,10 @@ std::vector<ObservedFile<Driver>*> ObservedFileList<Driver>::searchByDirWd(
 {
     std::vector<ObservedFile<Driver>*> result;
 
-    auto dir = find_if( observed_dirs_.begin(), observed_dirs_.end(),
-            [id] (std::pair<std::string,std::weak_ptr<ObservedDir<Driver>>> d) -> bool {
-            if ( auto dir = d.second.lock() ) {
-                return ( id == dir->dir_id_ );
-            }
-            else {
-                return false; } } );
-
-    if ( dir != observed_dirs_.end() ) {
-        for ( auto i = observed_files_.begin(); i != observed_files_.end(); ++i ) {
-            if ( auto d = dir->second.lock() ) {
-                if ( d.get() == i->dir_.get() ) {
-                    result.push_back( &(*i) );
-                }
-            }
-        }
+    if ( auto dir = directoryById( id ) ) {
+        auto files = by_dir_name_.find( dir->path );
+        if ( files != by_dir_name_.end() )
+            result.assign( files->second.begin(), files->second.end() );
     }
 
     return result;
@@ -304,8 +324,41 @@ ObservedFile<Driver>* ObservedFileList<Driver>::addNewObservedFile(
         ObservedFile<Driver> new_observed )
 {
     auto new_file = observed_files_.insert( std::begin( observed_files_ ), new_observed );
+    ObservedFile<Driver>* file = &( *new_file );
+
+    by_name_[ file->file_name_ ] = new_file;
+    by_dir_name_[ directory_path( file->file_name_ ) ].insert( file );
+    for ( const auto& callback: file->callbacks )
+        by_callback_[ callback.get() ] = new_file;
+    indexFileIds( file );
 
-    return &( *new_file );
+    return file;
+}
+
+template <typename Driver>
+void ObservedFileList<Driver>::addCallback(
+        ObservedFile<Driver>* file, std::shared_ptr<void> callback )
+{
+    auto observer = by_name_.find( file->file_name_ );
+
+    if ( observer != by_name_.end() ) {
+        observer->second->addCallback( callback );
+        by_callback_[ callback.get() ] = observer->second;
+    }
+}
+
+template <typename Driver>
+void ObservedFileList<Driver>::updateFileIds(
+        ObservedFile<Driver>* file,
+        typename Driver::FileId file_id,
+        typename Driver::SymlinkId symlink_id )
+{
+    unindexFileIds( file );
+
+    file->file_id_    = file_id;
+    file->symlink_id_ = symlink_id;
+
+    indexFileIds( file );
 }
 
 template <typename Driver>
@@ -314,24 +367,35 @@ std::shared_ptr<ObservedFile<Driver>> ObservedFileList<Driver>::removeCallback(
 {
     std::shared_ptr<ObservedFile<Driver>> returned_file = nullptr;
 
-    for ( auto observer = std::begin( observed_files_ );
-            observer != std::end( observed_files_ ); )
-    {
-        std::vector<std::shared_ptr<void>>& callbacks = observer->callbacks;
-        callbacks.erase( std::remove(
-                    std::begin( callbacks ), std::end( callbacks ), callback ),
-                std::end( callbacks ) );
-
-        /* See if all notifications have been deleted for this file */
-        if ( callbacks.empty() ) {
-            LOG(logDEBUG) << "Empty notification list for " << observer->file_name_
-                << ", removing the watched file";
-            returned_file = std::make_shared<ObservedFile<Driver>>( *observer );
-            observer = observed_files_.erase( observer );
-        }
-        else {
-            ++observer;
+    auto by_callback = by_callback_.find( callback.get() );
+    if ( by_callback == by_callback_.end() )
+        return nullptr;
+
+    FileIterator observer = by_callback->second;
+    by_callback_.erase( by_callback );
+
+    std::vector<std::shared_ptr<void>>& callbacks = observer->callbacks;
+    callbacks.erase( std::remove(
+                std::begin( callbacks ), std::end( callbacks ), callback ),
+            std::end( callbacks ) );
+
+    /* See if all notifications have been deleted for this file */
+    if ( callbacks.empty() ) {
+        LOG(logDEBUG) << "Empty notification list for " << observer->file_name_
+            << ", removing the watched file";
+        ObservedFile<Driver>* file = &( *observer );
+
+        unindexFileIds( file );
+        auto dir_files = by_dir_name_.find( directory_path( file->file_name_ ) );
+        if ( dir_files != by_dir_name_.end() ) {
+            dir_files->second.erase( file );
+            if ( dir_files->second.empty() )
+                by_dir_name_.erase( dir_files );
         }
+        by_name_.erase( file->file_name_ );
+
+        returned_file = std::make_shared<ObservedFile<Driver>>( *observer );
+        observed_files_.erase( observer );
     }
 
     return returned_file;
@@ -386,12 +450,29 @@ std::shared_ptr<ObservedDir<Driver>> ObservedFileList<Driver>::addWatchedDirecto
             remove_notification );
 }
 
+template <typename Driver>
+void ObservedFileList<Driver>::setDirectoryId(
+        std::shared_ptr<ObservedDir<Driver>> dir,
+        typename Driver::DirId dir_id )
+{
+    dir->dir_id_ = dir_id;
+
+    if ( dir_id.valid() )
+        by_dir_id_[ dir_id ] = std::weak_ptr<ObservedDir<Driver>>( dir );
+}
+
 template <typename Driver>
 unsigned int ObservedFileList<Driver>::numberWatchedDirectories() const
 {
     return observed_dirs_.size();
 }
 
+template <typename Driver>
+unsigned int ObservedFileList<Driver>::numberObservedFiles() const
+{
+    return by_name_.size();
+}
+
 // Private functions
 template <typename Driver>
 void ObservedFileList<Driver>::cleanRefsToExpiredDirs()
@@ -406,6 +487,60 @@ void ObservedFileList<Driver>::cleanRefsToExpiredDirs()
             ++it;
         }
     }
+
+    for ( auto it = std::begin( by_dir_id_ );
+            it != std::end( by_dir_id_ ); )
+    {
+        if ( it->second.expired() ) {
+            it = by_dir_id_.erase( it );
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+template <typename Driver>
+void ObservedFileList<Driver>::indexFileIds( ObservedFile<Driver>* file )
+{
+    // Files the driver couldn't watch (e.g. not existing yet)
+    // share the same invalid id and are only found by name.
+    if ( file->file_id_.valid() )
+        by_file_id_.insert( std::make_pair( file->file_id_, file ) );
+    if ( file->symlink_id_.valid() )
+        by_symlink_id_.insert( std::make_pair( file->symlink_id_, file ) );
+}
+
+template <typename Driver>
+void ObservedFileList<Driver>::unindexFileIds( ObservedFile<Driver>* file )
+{
+    auto files = by_file_id_.equal_range( file->file_id_ );
+    for ( auto it = files.first; it != files.second; ++it ) {
+        if ( it->second == file ) {
+            by_file_id_.erase( it );
+            break;
+        }
+    }
+
+    auto symlinks = by_symlink_id_.equal_range( file->symlink_id_ );
+    for ( auto it = symlinks.first; it != symlinks.second; ++it ) {
+        if ( it->second == file ) {
+            by_symlink_id_.erase( it );
+            break;
+        }
+    }
+}
+
+template <typename Driver>
+std::shared_ptr<ObservedDir<Driver>> ObservedFileList<Driver>::directoryById(
+        typename Driver::DirId id )
+{
+    auto dir = by_dir_id_.find( id );
+
+    if ( dir != by_dir_id_.end() )
+        return dir->second.lock();
+    else
+        return nullptr;
 }
 
 namespace {
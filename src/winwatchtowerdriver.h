@@ -24,6 +24,7 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <functional>
 #include <iterator>
 #include <vector>
 
@@ -125,8 +126,25 @@ class WinWatchTowerDriver {
         char buffer_[buffer_length_];
     };
 
-    class FileId { };
-    class SymlinkId { };
+    // Files are not watched individually on Windows, only directories
+    class FileId {
+      public:
+        bool operator==( const FileId& ) const
+        { return true; }
+        bool valid() const
+        { return false; }
+        std::size_t hash() const
+        { return 0; }
+    };
+    class SymlinkId {
+      public:
+        bool operator==( const SymlinkId& ) const
+        { return true; }
+        bool valid() const
+        { return false; }
+        std::size_t hash() const
+        { return 0; }
+    };
     class DirId {
       public:
         friend class WinWatchTowerDriver;
@@ -136,6 +154,8 @@ class WinWatchTowerDriver {
         { return dir_record_ == other.dir_record_; }
         bool valid() const
         { return ( dir_record_ != nullptr ); }
+        std::size_t hash() const
+        { return std::hash<WinWatchedDirRecord*>()( dir_record_.get() ); }
       private:
         std::shared_ptr<WinWatchedDirRecord> dir_record_;
     };
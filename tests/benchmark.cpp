@@ -0,0 +1,157 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+namespace {
+double medianOf( std::vector<double> values )
+{
+    std::sort( values.begin(), values.end() );
+
+    const size_t middle = values.size() / 2;
+    return ( values.size() % 2 ) ? values[middle] :
+        ( values[middle - 1] + values[middle] ) / 2;
+}
+
+std::string jsonString( const std::string& text )
+{
+    std::string result = "\"";
+    for ( const char c: text ) {
+        if ( c == '"' || c == '\\' )
+            result += '\\';
+        result += c;
+    }
+
+    return result + '"';
+}
+}
+
+std::string BenchmarkCase::fullName() const
+{
+    std::string full_name = name;
+    for ( const auto& param: params )
+        full_name += "/" + param.first + "=" + param.second;
+
+    return full_name;
+}
+
+BenchmarkStats BenchmarkStats::compute( std::vector<double> durations )
+{
+    BenchmarkStats stats;
+
+    stats.runs = durations.size();
+    if ( durations.empty() )
+        return stats;
+
+    stats.min    = *std::min_element( durations.begin(), durations.end() );
+    stats.median = medianOf( durations );
+    stats.mean   = std::accumulate( durations.begin(), durations.end(), 0.0 )
+        / durations.size();
+
+    double square_sum = 0;
+    std::vector<double> deviations;
+    for ( const double duration: durations ) {
+        square_sum += ( duration - stats.mean ) * ( duration - stats.mean );
+        deviations.push_back( std::abs( duration - stats.median ) );
+    }
+    stats.stddev = std::sqrt( square_sum / durations.size() );
+    stats.mad    = medianOf( deviations );
+
+    return stats;
+}
+
+BenchmarkRunner::BenchmarkRunner( const Options& options )
+    : options_( options )
+{
+}
+
+void BenchmarkRunner::add( BenchmarkCase benchmark )
+{
+    cases_.push_back( std::move( benchmark ) );
+}
+
+void BenchmarkRunner::run( std::ostream& out )
+{
+    using namespace std::chrono;
+
+    out << std::left << std::setw( 64 ) << "benchmark"
+        << std::right << std::setw( 12 ) << "median ms"
+        << std::setw( 10 ) << "mad %"
+        << std::setw( 12 ) << "min ms"
+        << std::setw( 16 ) << "items/s" << std::endl;
+
+    for ( const auto& benchmark: cases_ ) {
+        const std::string full_name = benchmark.fullName();
+        if ( full_name.find( options_.filter ) == std::string::npos )
+            continue;
+
+        uint64_t items = 0;
+        std::vector<double> durations;
+        for ( int i = 0; i < options_.warmups + options_.repetitions; ++i ) {
+            if ( benchmark.setup )
+                benchmark.setup();
+
+            const auto start = steady_clock::now();
+            items = benchmark.run();
+            const auto end = steady_clock::now();
+
+            if ( i >= options_.warmups )
+                durations.push_back(
+                        duration_cast<nanoseconds>( end - start ).count() );
+        }
+
+        const BenchmarkStats stats = BenchmarkStats::compute( durations );
+        results_.push_back( { &benchmark, items, stats } );
+
+        out << std::left << std::setw( 64 ) << full_name << std::right
+            << std::fixed << std::setprecision( 3 )
+            << std::setw( 12 ) << stats.median / 1e6
+            << std::setprecision( 1 )
+            << std::setw( 10 ) << ( stats.median > 0 ? stats.mad * 100 / stats.median : 0 )
+            << std::setprecision( 3 )
+            << std::setw( 12 ) << stats.min / 1e6
+            << std::setprecision( 0 )
+            << std::setw( 16 ) << ( stats.median > 0 ? items * 1e9 / stats.median : 0 )
+            << " " << benchmark.unit << std::endl;
+    }
+}
+
+void BenchmarkRunner::writeJson( std::ostream& out ) const
+{
+    out << "{\n  \"repetitions\": " << options_.repetitions
+        << ",\n  \"warmups\": " << options_.warmups
+        << ",\n  \"benchmarks\": [";
+
+    bool first = true;
+    for ( const auto& result: results_ ) {
+        const BenchmarkCase& benchmark = *result.benchmark;
+
+        out << ( first ? "\n" : ",\n" ) << "    {\n"
+            << "      \"name\": " << jsonString( benchmark.name ) << ",\n"
+            << "      \"full_name\": " << jsonString( benchmark.fullName() ) << ",\n"
+            << "      \"params\": {";
+        for ( size_t i = 0; i < benchmark.params.size(); ++i ) {
+            out << ( i ? ", " : " " ) << jsonString( benchmark.params[i].first )
+                << ": " << jsonString( benchmark.params[i].second );
+        }
+        out << ( benchmark.params.empty() ? "},\n" : " },\n" )
+            << std::setprecision( 0 ) << std::fixed
+            << "      \"unit\": " << jsonString( benchmark.unit ) << ",\n"
+            << "      \"items\": " << result.items << ",\n"
+            << "      \"runs\": " << result.stats.runs << ",\n"
+            << "      \"min_ns\": " << result.stats.min << ",\n"
+            << "      \"median_ns\": " << result.stats.median << ",\n"
+            << "      \"mean_ns\": " << result.stats.mean << ",\n"
+            << "      \"stddev_ns\": " << result.stats.stddev << ",\n"
+            << "      \"mad_ns\": " << result.stats.mad << ",\n"
+            << "      \"items_per_second\": "
+            << ( result.stats.median > 0 ? result.items * 1e9 / result.stats.median : 0 )
+            << "\n    }";
+        first = false;
+    }
+
+    out << "\n  ]\n}\n";
+}
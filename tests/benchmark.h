@@ -0,0 +1,74 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal microbenchmark harness: each case is run a number of times
+// (after some warm-up runs) and the statistics of the durations are
+// written as a table, and as JSON so runs can be compared by a script.
+
+struct BenchmarkCase {
+    // e.g. "CompressedLinePositionStorage/append"
+    std::string name;
+    // Parameters of the case (e.g. line length distribution)
+    std::vector<std::pair<std::string, std::string>> params;
+    // Unit of the items processed by run() (e.g. "lines", "bytes")
+    std::string unit;
+    // Prepare a run, not timed (can be empty)
+    std::function<void()> setup;
+    // The timed part, returns the number of items processed
+    std::function<uint64_t()> run;
+
+    // Returns the name followed by the parameters
+    std::string fullName() const;
+};
+
+// Statistics of the durations of the runs of a case, in nanoseconds
+struct BenchmarkStats {
+    int runs = 0;
+    double min = 0;
+    double median = 0;
+    double mean = 0;
+    double stddev = 0;
+    // Median absolute deviation, less sensitive to outliers
+    double mad = 0;
+
+    static BenchmarkStats compute( std::vector<double> durations );
+};
+
+class BenchmarkRunner {
+  public:
+    struct Options {
+        int repetitions = 10;
+        int warmups = 1;
+        // Only the cases whose full name contains it are run
+        std::string filter;
+    };
+
+    explicit BenchmarkRunner( const Options& options );
+
+    void add( BenchmarkCase benchmark );
+
+    // Run the cases, writing their statistics to out as they finish
+    void run( std::ostream& out );
+    // Write the results of the cases run as JSON
+    void writeJson( std::ostream& out ) const;
+
+  private:
+    struct Result {
+        const BenchmarkCase* benchmark;
+        uint64_t items;
+        BenchmarkStats stats;
+    };
+
+    const Options options_;
+    std::vector<BenchmarkCase> cases_;
+    std::vector<Result> results_;
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QFileInfo>
+
+#include <memory>
+
+#include "log.h"
+#include "test_utils.h"
+
+#include "fileset.h"
+#include "data/concatenatedlogdata.h"
+#include "data/logfiltereddata.h"
+
+#include "gmock/gmock.h"
+
+#define TMPDIR "/tmp"
+
+static const char* cl_format="CONCATENATED log data, line %06d of %s\n";
+
+class ConcatenatedLogDataBehaviour : public testing::Test {
+  public:
+    ConcatenatedLogData log_data;
+    SafeQSignalSpy endSpy;
+
+    // The files, oldest first, the middle one is empty
+    const QStringList files = { TMPDIR "/concat.log.2",
+        TMPDIR "/concat.log.1", TMPDIR "/concat.log" };
+    const std::vector<int> nb_lines = { 100, 0, 50 };
+
+    ConcatenatedLogDataBehaviour()
+        : endSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) ) {
+        for ( int f = 0; f < files.size(); ++f )
+            writeLines( files[f], nb_lines[f], QIODevice::WriteOnly );
+
+        log_data.attachFiles( files );
+        endSpy.safeWait( 10000 );
+    }
+
+    void writeLines( const QString& file_name, int nb, QIODevice::OpenMode mode ) {
+        char newLine[90];
+
+        QFile file( file_name );
+        if ( file.open( mode ) ) {
+            for ( int i = 0; i < nb; i++ ) {
+                snprintf( newLine, 89, cl_format, i,
+                        QFileInfo( file_name ).fileName().toLatin1().constData() );
+                file.write( newLine, qstrlen( newLine ) );
+            }
+        }
+        file.close();
+    }
+};
+
+TEST_F( ConcatenatedLogDataBehaviour, loadingIsReportedOnce ) {
+    ASSERT_THAT( endSpy.count(), 1 );
+    ASSERT_THAT( log_data.getNbLine(), 150LL );
+}
+
+TEST_F( ConcatenatedLogDataBehaviour, linesAreNumberedAcrossFiles ) {
+    ASSERT_THAT( log_data.getLineString( 0 ).toStdString(),
+            testing::EndsWith( "line 000000 of concat.log.2" ) );
+    ASSERT_THAT( log_data.getLineString( 99 ).toStdString(),
+            testing::EndsWith( "line 000099 of concat.log.2" ) );
+    ASSERT_THAT( log_data.getLineString( 100 ).toStdString(),
+            testing::EndsWith( "line 000000 of concat.log" ) );
+    ASSERT_THAT( log_data.getLineString( 149 ).toStdString(),
+            testing::EndsWith( "line 000049 of concat.log" ) );
+}
+
+TEST_F( ConcatenatedLogDataBehaviour, linesCanBeReadAcrossFiles ) {
+    const QStringList lines = log_data.getExpandedLines( 98, 4 );
+
+    ASSERT_THAT( lines.size(), 4 );
+    ASSERT_THAT( lines[1].toStdString(),
+            testing::EndsWith( "line 000099 of concat.log.2" ) );
+    ASSERT_THAT( lines[2].toStdString(),
+            testing::EndsWith( "line 000000 of concat.log" ) );
+}
+
+TEST_F( ConcatenatedLogDataBehaviour, searchReturnsGlobalLineNumbers ) {
+    std::unique_ptr<LogFilteredData> filtered_data( log_data.getNewFilteredData() );
+    SafeQSignalSpy progressSpy( filtered_data.get(),
+            SIGNAL( searchProgressed( int, int, qint64 ) ) );
+
+    filtered_data->runSearch( QRegularExpression( "line 00001[0-9]" ) );
+
+    int percent = 0;
+    while ( percent < 100 ) {
+        if ( progressSpy.isEmpty() && ! progressSpy.wait( 10000 ) )
+            break;
+        percent = qvariant_cast<int>( progressSpy.takeFirst().at( 1 ) );
+    }
+
+    ASSERT_THAT( filtered_data->getNbMatches(), 20u );
+    ASSERT_THAT( filtered_data->getMatchingLineNumber( 0 ), 10LL );
+    ASSERT_THAT( filtered_data->getMatchingLineNumber( 9 ), 19LL );
+    ASSERT_THAT( filtered_data->getMatchingLineNumber( 10 ), 110LL );
+    ASSERT_THAT( filtered_data->getMatchingLineNumber( 19 ), 119LL );
+}
+
+TEST_F( ConcatenatedLogDataBehaviour, dataAppendedToTheLastFileIsAdded ) {
+    SafeQSignalSpy changedSpy( &log_data,
+            SIGNAL( fileChanged( AbstractLogSource::MonitoredFileStatus ) ) );
+    SafeQSignalSpy finishedSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+
+    writeLines( files.last(), 10, QIODevice::Append );
+
+    ASSERT_TRUE( finishedSpy.safeWait() );
+    ASSERT_THAT( changedSpy.count(), 1 );
+    ASSERT_THAT( changedSpy.last()[0].value<AbstractLogSource::MonitoredFileStatus>(),
+            AbstractLogSource::DataAdded );
+    ASSERT_THAT( log_data.getNbLine(), 160LL );
+}
+
+TEST_F( ConcatenatedLogDataBehaviour, dataAppendedToAnOlderFileIsARewrite ) {
+    SafeQSignalSpy changedSpy( &log_data,
+            SIGNAL( fileChanged( AbstractLogSource::MonitoredFileStatus ) ) );
+    SafeQSignalSpy finishedSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+
+    writeLines( files.first(), 10, QIODevice::Append );
+
+    ASSERT_TRUE( finishedSpy.safeWait() );
+    ASSERT_THAT( changedSpy.last()[0].value<AbstractLogSource::MonitoredFileStatus>(),
+            AbstractLogSource::Rewritten );
+    ASSERT_THAT( log_data.getNbLine(), 160LL );
+    ASSERT_THAT( log_data.getLineString( 110 ).toStdString(),
+            testing::EndsWith( "line 000000 of concat.log" ) );
+}
+
+TEST_F( ConcatenatedLogDataBehaviour, rotationDoesNotDuplicateLines ) {
+    SafeQSignalSpy finishedSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+
+    // Rotate as logrotate does, the oldest file is overwritten
+    QVERIFY( QFile::remove( files[0] ) );
+    QVERIFY( QFile::rename( files[1], files[0] ) );
+    QVERIFY( QFile::rename( files[2], files[1] ) );
+    writeLines( files[2], 10, QIODevice::WriteOnly );
+
+    // Wait for all the members to settle
+    while ( finishedSpy.wait( 1000 ) ) {}
+
+    // The lines of each file are only shown once
+    ASSERT_THAT( log_data.getNbLine(), 60LL );
+    ASSERT_THAT( log_data.getLineString( 0 ).toStdString(),
+            testing::EndsWith( "line 000000 of concat.log" ) );
+    ASSERT_THAT( log_data.getLineString( 49 ).toStdString(),
+            testing::EndsWith( "line 000049 of concat.log" ) );
+    ASSERT_THAT( log_data.getLineString( 50 ).toStdString(),
+            testing::EndsWith( "line 000000 of concat.log" ) );
+    ASSERT_THAT( log_data.getLineString( 59 ).toStdString(),
+            testing::EndsWith( "line 000009 of concat.log" ) );
+}
+
+TEST( FileSetBehaviour, filesAreSortedInRotationOrder ) {
+    QStringList files = { "/var/log/app.log", "/var/log/app.log.1",
+        "/var/log/app.log.10", "/var/log/app.log.2" };
+
+    FileSet::sortByRotation( &files );
+
+    ASSERT_THAT( files, testing::ElementsAre( "/var/log/app.log.10",
+                "/var/log/app.log.2", "/var/log/app.log.1", "/var/log/app.log" ) );
+}
+
+TEST( FileSetBehaviour, setNameGivesBackTheFiles ) {
+    const QStringList files = { "/var/log/app.log.1", "/var/log/app.log" };
+    const QString name = FileSet::nameForFiles( files );
+
+    ASSERT_TRUE( FileSet::isFileSet( name ) );
+    ASSERT_FALSE( FileSet::isFileSet( "/var/log/app.log" ) );
+    ASSERT_THAT( FileSet::files( name ), files );
+    ASSERT_THAT( FileSet::displayName( name ).toStdString(), "/var/log/app.log (+1)" );
+}
+
+TEST( FileSetBehaviour, setNameKeepsUnusualFileNames ) {
+    const QStringList files = { "/var/log/with\nnewline \"quoted\".log",
+        "/var/log/set:[].log" };
+    const QString name = FileSet::nameForFiles( files );
+
+    ASSERT_TRUE( FileSet::isFileSet( name ) );
+    ASSERT_THAT( FileSet::files( name ), files );
+}
+
+TEST( FileSetBehaviour, setOfOneFileIsTheFile ) {
+    ASSERT_THAT( FileSet::nameForFiles( { "/var/log/app.log" } ).toStdString(),
+            "/var/log/app.log" );
+    ASSERT_TRUE( FileSet::nameForFiles( {} ).isEmpty() );
+    ASSERT_TRUE( FileSet::files( "" ).isEmpty() );
+}
+
+TEST( FileSetBehaviour, invalidSetNameIsAFile ) {
+    ASSERT_FALSE( FileSet::isFileSet( "set:app.log" ) );
+    ASSERT_THAT( FileSet::files( "set:app.log" ), testing::ElementsAre( "set:app.log" ) );
+}
@@ -0,0 +1,123 @@
+#include "corpusgenerator.h"
+
+#include <cstdio>
+#include <vector>
+
+const char* const corpusNeedle = "NEEDLE";
+
+namespace {
+const std::vector<std::string> words = {
+    "connection", "request", "user", "id=4242", "failed", "ok", "GET",
+    "/api/v1/items", "took", "12ms", "retrying", "cache", "miss", "0x7f3a" };
+const std::vector<std::string> utf8Words = {
+    "café", "naïve", "Größe", "日本語", "ошибка" };
+const std::vector<std::string> levels = {
+    "DEBUG", "INFO", "WARN", "ERROR" };
+
+// 2016-03-12 17:04:21.123 UTC
+const uint64_t startTime = 1457802261123ULL;
+}
+
+CorpusGenerator::CorpusGenerator( const CorpusOptions& options )
+    : options_( options ), rng_( options.seed ),
+    time_ms_( startTime ), nb_lines_( 0 )
+{
+}
+
+std::string CorpusGenerator::nextLine()
+{
+    std::uniform_int_distribution<int> word( 0, words.size() - 1 );
+    std::uniform_int_distribution<int> percent( 0, 99 );
+
+    ++nb_lines_;
+    time_ms_ += std::uniform_int_distribution<int>( 0, 50 )( rng_ );
+
+    if ( options_.longLineEvery && nb_lines_ % options_.longLineEvery == 0 ) {
+        std::string line = timestamp() + " ERROR ";
+        line.reserve( options_.longLineLength );
+        while ( line.size() < static_cast<size_t>( options_.longLineLength ) )
+            line += "0123456789abcdef";
+        return line;
+    }
+
+    const size_t length = randomLineLength( rng_, options_.lengths );
+    std::string line = timestamp() + " "
+        + levels[ percent( rng_ ) % levels.size() ] + " ";
+
+    if ( std::uniform_real_distribution<double>( 0, 1 )( rng_ ) < options_.density )
+        line += std::string( corpusNeedle ) + " ";
+
+    while ( line.size() < length ) {
+        const int p = percent( rng_ );
+        if ( options_.utf8 && p < 10 )
+            line += utf8Words[ p % utf8Words.size() ];
+        else
+            line += words[ word( rng_ ) ];
+        line += ( p % 10 == 0 ) ? "\t" : " ";
+    }
+
+    return line;
+}
+
+const char* CorpusGenerator::endOfLine() const
+{
+    return options_.crlf ? "\r\n" : "\n";
+}
+
+uint64_t CorpusGenerator::write( std::ostream& out )
+{
+    const size_t eol_length = options_.crlf ? 2 : 1;
+
+    uint64_t nb_lines = 0;
+    uint64_t nb_bytes = 0;
+    while ( ( options_.maxLines == 0 || nb_lines < options_.maxLines )
+            && ( options_.maxBytes == 0 || nb_bytes < options_.maxBytes ) ) {
+        const std::string line = nextLine();
+        out << line << endOfLine();
+
+        ++nb_lines;
+        nb_bytes += line.size() + eol_length;
+    }
+
+    return nb_lines;
+}
+
+int CorpusGenerator::randomLineLength( std::mt19937& rng, const std::string& lengths )
+{
+    if ( lengths == "short" )
+        return std::uniform_int_distribution<int>( 20, 60 )( rng );
+    else if ( lengths == "long" )
+        return std::uniform_int_distribution<int>( 500, 2000 )( rng );
+    else if ( std::uniform_int_distribution<int>( 0, 99 )( rng ) == 0 )
+        return std::uniform_int_distribution<int>( 1024, 4096 )( rng );
+    else
+        return std::uniform_int_distribution<int>( 40, 200 )( rng );
+}
+
+std::string CorpusGenerator::timestamp()
+{
+    // Civil date from the number of days since the epoch
+    // (from http://howardhinnant.github.io/date_algorithms.html)
+    const int64_t days = time_ms_ / 86400000;
+    const uint64_t ms_of_day = time_ms_ % 86400000;
+
+    const int64_t z = days + 719468;
+    const int64_t era = z / 146097;
+    const unsigned doe = static_cast<unsigned>( z - era * 146097 );
+    const unsigned yoe = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;
+    const unsigned doy = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+    const unsigned mp = ( 5 * doy + 2 ) / 153;
+    const unsigned day = doy - ( 153 * mp + 2 ) / 5 + 1;
+    const unsigned month = mp < 10 ? mp + 3 : mp - 9;
+    const int64_t year = yoe + era * 400 + ( month <= 2 );
+
+    char buffer[48];
+    snprintf( buffer, sizeof buffer, "%04d-%02u-%02u %02u:%02u:%02u.%03u",
+            static_cast<int>( year ), month, day,
+            static_cast<unsigned>( ms_of_day / 3600000 ),
+            static_cast<unsigned>( ms_of_day / 60000 % 60 ),
+            static_cast<unsigned>( ms_of_day / 1000 % 60 ),
+            static_cast<unsigned>( ms_of_day % 1000 ) );
+
+    return buffer;
+}
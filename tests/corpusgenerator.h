@@ -0,0 +1,63 @@
+#ifndef CORPUSGENERATOR_H
+#define CORPUSGENERATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <random>
+#include <string>
+
+// Generates realistic log files for the benchmarks and the performance
+// scenarios: timestamped lines of varied lengths, with tabs, optionally
+// UTF-8 words, CRLF line endings and pathologically long lines.
+// The output only depends on the options (including the seed).
+
+// The word found on the proportion of lines given by CorpusOptions::density
+extern const char* const corpusNeedle;
+
+struct CorpusOptions {
+    // Generation stops when one of these is reached (0 for no limit)
+    uint64_t maxBytes = 0;
+    uint64_t maxLines = 0;
+    // Line length distribution:
+    //   short: 20 to 60 characters
+    //   mixed: mostly 40 to 200, with 1% of long lines (1 to 4 KiB)
+    //   long: 500 to 2000
+    std::string lengths = "mixed";
+    // Proportion of the lines containing corpusNeedle
+    double density = 0.01;
+    bool utf8 = false;
+    bool crlf = false;
+    // One line in this many is a pathological line of longLineLength
+    // characters without any space (0 for none)
+    uint64_t longLineEvery = 0;
+    int longLineLength = 1024 * 1024;
+    uint32_t seed = 42;
+};
+
+class CorpusGenerator {
+  public:
+    explicit CorpusGenerator( const CorpusOptions& options );
+
+    // Returns the next line, without its end of line
+    std::string nextLine();
+    // Returns the end of line of the lines
+    const char* endOfLine() const;
+
+    // Write lines until one of the limits is reached,
+    // returns the number of lines written.
+    uint64_t write( std::ostream& out );
+
+    // Returns a random length for the given distribution
+    static int randomLineLength( std::mt19937& rng, const std::string& lengths );
+
+  private:
+    std::string timestamp();
+
+    const CorpusOptions options_;
+    std::mt19937 rng_;
+    // Milliseconds since the epoch, increasing with each line
+    uint64_t time_ms_;
+    uint64_t nb_lines_;
+};
+
+#endif
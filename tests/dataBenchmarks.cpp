@@ -0,0 +1,410 @@
+// Microbenchmarks of the hot paths of the data layer, run with:
+//   glogg_benchmarks [--lines N] [--repetitions N] [--warmups N]
+//                    [--filter TEXT] [--json FILE]
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QSignalSpy>
+
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "log.h"
+#include "benchmark.h"
+#include "corpusgenerator.h"
+
+#include "encodingspeculator.h"
+#include "data/abstractlogdata.h"
+#include "data/compressedlinestorage.h"
+#include "data/logdata.h"
+#include "data/logdataworkerthread.h"
+#include "data/logfiltereddataworkerthread.h"
+
+#define TMPDIR "/tmp"
+
+namespace {
+
+// Number of lines of the generated files
+int nbLines = 200000;
+
+// Accumulates the results so the compiler can't drop the computation
+volatile uint64_t sink;
+
+// The line length distributions (see CorpusOptions)
+const std::vector<std::string> lineLengths = { "short", "mixed", "long" };
+// Proportion of the lines matching the searches
+const std::vector<std::string> matchDensities = { "0.001", "0.01", "0.1", "0.5" };
+
+std::vector<std::string> randomLines( const std::string& lengths,
+        double density, bool utf8, int nb_lines )
+{
+    CorpusOptions options;
+    options.lengths = lengths;
+    options.density = density;
+    options.utf8 = utf8;
+    CorpusGenerator generator( options );
+
+    std::vector<std::string> lines;
+    for ( int i = 0; i < nb_lines; ++i )
+        lines.push_back( generator.nextLine() );
+
+    return lines;
+}
+
+// Returns the name of a generated file, created the first time
+QString corpusFile( const std::string& lengths, const std::string& density )
+{
+    static std::map<std::string, QString> files;
+
+    const std::string key = lengths + "-" + density;
+    if ( files.count( key ) == 0 ) {
+        const QString name = QString( TMPDIR "/glogg_benchmark_%1.log" )
+            .arg( QString::fromStdString( key ) );
+
+        std::ofstream file( name.toStdString() );
+        for ( const auto& line: randomLines( lengths, std::stod( density ),
+                    false, nbLines ) )
+            file << line << '\n';
+
+        files[key] = name;
+    }
+
+    return files[key];
+}
+
+// Returns the name of a generated UTF-16LE file (with a BOM),
+// created the first time
+QString utf16CorpusFile( const std::string& lengths )
+{
+    static std::map<std::string, QString> files;
+
+    if ( files.count( lengths ) == 0 ) {
+        const QString name = QString( TMPDIR "/glogg_benchmark_%1-utf16le.log" )
+            .arg( QString::fromStdString( lengths ) );
+
+        // The lines are ASCII, each byte is a code unit
+        std::ofstream file( name.toStdString(), std::ios::binary );
+        file.write( "\xFF\xFE", 2 );
+        for ( const auto& line: randomLines( lengths, 0.01, false, nbLines ) ) {
+            for ( const char c: line + '\n' ) {
+                file.put( c );
+                file.put( '\0' );
+            }
+        }
+
+        files[lengths] = name;
+    }
+
+    return files[lengths];
+}
+
+// The LogData loaded, they must be destroyed before the application
+std::map<std::string, std::unique_ptr<LogData>> loadedData;
+
+// Returns a LogData attached to a generated file, loaded the first time
+const LogData* loadedLogData( const std::string& lengths, const std::string& density )
+{
+    const std::string key = lengths + "-" + density;
+    if ( loadedData.count( key ) == 0 ) {
+        const QString file_name = corpusFile( lengths, density );
+
+        auto log_data = std::unique_ptr<LogData>( new LogData() );
+        QSignalSpy endSpy( log_data.get(), SIGNAL( loadingFinished( LoadingStatus ) ) );
+        log_data->attachFile( file_name );
+        endSpy.wait( 600000 );
+
+        loadedData[key] = std::move( log_data );
+    }
+
+    return loadedData[key].get();
+}
+
+// Returns the end of line positions of the lines, starting at base
+std::vector<uint64_t> linePositions( const std::string& lengths, uint64_t base )
+{
+    std::mt19937 rng( 42 );
+
+    std::vector<uint64_t> positions;
+    uint64_t position = base;
+    for ( int i = 0; i < nbLines; ++i ) {
+        position += CorpusGenerator::randomLineLength( rng, lengths ) + 1;
+        positions.push_back( position );
+    }
+
+    return positions;
+}
+
+// To use the (protected) untabify functions
+struct Untabifier : public AbstractLogData {
+    using AbstractLogData::untabify;
+};
+
+void addLinePositionBenchmarks( BenchmarkRunner& runner )
+{
+    // Files smaller than 4 GiB use 32 bits blocks
+    const std::vector<std::pair<std::string, uint64_t>> bases = {
+        { "32", 0 }, { "64", 5ULL * 1024 * 1024 * 1024 } };
+
+    for ( const auto& lengths: lineLengths ) {
+        for ( const auto& base: bases ) {
+            auto positions = std::make_shared<std::vector<uint64_t>>();
+            auto storage = std::make_shared<std::unique_ptr<CompressedLinePositionStorage>>();
+
+            runner.add( { "CompressedLinePositionStorage/append",
+                    { { "lengths", lengths }, { "bits", base.first } }, "lines",
+                    [=]() {
+                        if ( positions->empty() )
+                            *positions = linePositions( lengths, base.second );
+                        storage->reset( new CompressedLinePositionStorage() );
+                    },
+                    [=]() {
+                        for ( const auto position: *positions )
+                            (*storage)->append( position );
+                        return positions->size();
+                    } } );
+
+            for ( const std::string order: { "sequential", "random" } ) {
+                auto indexes = std::make_shared<std::vector<uint32_t>>();
+
+                runner.add( { "CompressedLinePositionStorage/at",
+                        { { "lengths", lengths }, { "bits", base.first },
+                          { "order", order } }, "lines",
+                        [=]() {
+                            if ( positions->empty() )
+                                *positions = linePositions( lengths, base.second );
+                            if ( ! *storage || (*storage)->size() != positions->size() ) {
+                                storage->reset( new CompressedLinePositionStorage() );
+                                for ( const auto position: *positions )
+                                    (*storage)->append( position );
+                            }
+                            if ( indexes->empty() ) {
+                                for ( uint32_t i = 0; i < positions->size(); ++i )
+                                    indexes->push_back( i );
+                                if ( order == "random" )
+                                    std::shuffle( indexes->begin(), indexes->end(),
+                                            std::mt19937( 42 ) );
+                            }
+                        },
+                        [=]() {
+                            uint64_t sum = 0;
+                            for ( const auto i: *indexes )
+                                sum += (*storage)->at( i );
+                            sink = sum;
+                            return indexes->size();
+                        } } );
+            }
+        }
+    }
+}
+
+// Returns a benchmark indexing the file named
+std::function<uint64_t()> indexFile( std::shared_ptr<QString> file_name )
+{
+    return [=]() {
+        IndexingData indexing_data;
+        EncodingSpeculator speculator;
+        TailFile tail_file;
+        bool interrupt = false;
+
+        FullIndexOperation operation( *file_name, &tail_file,
+                &indexing_data, &interrupt, &speculator );
+        operation.start();
+
+        return static_cast<uint64_t>( indexing_data.getSize() );
+    };
+}
+
+void addIndexingBenchmarks( BenchmarkRunner& runner )
+{
+    for ( const auto& lengths: lineLengths ) {
+        auto file_name = std::make_shared<QString>();
+
+        runner.add( { "IndexOperation/doIndex", { { "lengths", lengths } }, "bytes",
+                [=]() { *file_name = corpusFile( lengths, "0.01" ); },
+                indexFile( file_name ) } );
+
+        auto utf16_file_name = std::make_shared<QString>();
+
+        runner.add( { "IndexOperation/doIndex",
+                { { "lengths", lengths }, { "encoding", "utf16le" } }, "bytes",
+                [=]() { *utf16_file_name = utf16CorpusFile( lengths ); },
+                indexFile( utf16_file_name ) } );
+    }
+}
+
+void addSearchBenchmarks( BenchmarkRunner& runner )
+{
+    for ( const auto& lengths: lineLengths ) {
+        for ( const auto& density: matchDensities ) {
+            for ( const std::string spans: { "no", "yes" } ) {
+                auto log_data = std::make_shared<const LogData*>();
+
+                runner.add( { "SearchOperation/doSearch",
+                        { { "lengths", lengths }, { "density", density },
+                          { "spans", spans } }, "lines",
+                        [=]() { *log_data = loadedLogData( lengths, density ); },
+                        [=]() {
+                            SearchData search_data;
+                            bool interrupt = false;
+
+                            FullSearchOperation operation( *log_data,
+                                    QRegularExpression( corpusNeedle ),
+                                    spans == "yes", &interrupt );
+                            operation.start( search_data );
+
+                            sink = search_data.getNbMatches();
+                            return static_cast<uint64_t>( (*log_data)->getNbLine() );
+                        } } );
+            }
+        }
+    }
+}
+
+void addUntabifyBenchmarks( BenchmarkRunner& runner )
+{
+    for ( const auto& lengths: lineLengths ) {
+        auto lines = std::make_shared<std::vector<QString>>();
+
+        runner.add( { "AbstractLogData/untabify", { { "lengths", lengths } }, "lines",
+                [=]() {
+                    if ( lines->empty() ) {
+                        for ( const auto& line: randomLines( lengths, 0, false, nbLines ) )
+                            lines->push_back( QString::fromStdString( line ) );
+                    }
+                },
+                [=]() {
+                    uint64_t total_length = 0;
+                    for ( const auto& line: *lines )
+                        total_length += Untabifier::untabify( line ).length();
+                    sink = total_length;
+                    return lines->size();
+                } } );
+    }
+}
+
+void addEncodingBenchmarks( BenchmarkRunner& runner )
+{
+    for ( const std::string content: { "ascii", "utf8" } ) {
+        auto bytes = std::make_shared<std::string>();
+
+        runner.add( { "EncodingSpeculator/inject_byte", { { "content", content } }, "bytes",
+                [=]() {
+                    if ( bytes->empty() ) {
+                        for ( const auto& line: randomLines( "mixed", 0,
+                                    content == "utf8", nbLines ) )
+                            *bytes += line + '\n';
+                    }
+                },
+                [=]() {
+                    EncodingSpeculator speculator;
+                    for ( const char byte: *bytes )
+                        speculator.inject_byte( byte );
+                    sink = static_cast<uint64_t>( speculator.guess() );
+                    return bytes->size();
+                } } );
+    }
+}
+
+void addLookupBenchmarks( BenchmarkRunner& runner )
+{
+    const int nb_lookups = 1000000;
+
+    for ( const auto& density: matchDensities ) {
+        auto matches = std::make_shared<SearchResultArray>();
+        auto lines = std::make_shared<std::vector<LineNumber>>();
+
+        auto setup = [=]() {
+            if ( ! matches->empty() )
+                return;
+
+            std::mt19937 rng( 42 );
+            std::uniform_real_distribution<double> uniform( 0, 1 );
+            for ( int i = 0; i < nbLines; ++i ) {
+                if ( uniform( rng ) < std::stod( density ) )
+                    matches->push_back( MatchingLine( i ) );
+            }
+
+            std::uniform_int_distribution<LineNumber> line( 0, nbLines - 1 );
+            for ( int i = 0; i < nb_lookups; ++i )
+                lines->push_back( line( rng ) );
+        };
+
+        runner.add( { "lookupLineNumber/bisection", { { "density", density } }, "lookups",
+                setup,
+                [=]() {
+                    uint64_t sum = 0;
+                    int index;
+                    for ( const auto line: *lines ) {
+                        lookupLineNumber<SearchResultArray>( *matches, line, &index );
+                        sum += index;
+                    }
+                    sink = sum;
+                    return lines->size();
+                } } );
+
+        runner.add( { "lookupLineNumber/lower_bound", { { "density", density } }, "lookups",
+                setup,
+                [=]() {
+                    uint64_t sum = 0;
+                    for ( const auto line: *lines )
+                        sum += lookupLineNumber( matches->begin(), matches->end(), line );
+                    sink = sum;
+                    return lines->size();
+                } } );
+    }
+}
+
+}
+
+int main( int argc, char* argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    FILELog::setReportingLevel( logERROR );
+
+    BenchmarkRunner::Options options;
+    std::string json_file;
+
+    const QStringList args = app.arguments();
+    for ( int i = 1; i + 1 < args.size(); i += 2 ) {
+        const QString& value = args[i + 1];
+        if ( args[i] == "--lines" )
+            nbLines = value.toInt();
+        else if ( args[i] == "--repetitions" )
+            options.repetitions = value.toInt();
+        else if ( args[i] == "--warmups" )
+            options.warmups = value.toInt();
+        else if ( args[i] == "--filter" )
+            options.filter = value.toStdString();
+        else if ( args[i] == "--json" )
+            json_file = value.toStdString();
+        else {
+            std::cerr << "Unknown option " << args[i].toStdString() << std::endl;
+            return 1;
+        }
+    }
+
+    BenchmarkRunner runner( options );
+    addLinePositionBenchmarks( runner );
+    addIndexingBenchmarks( runner );
+    addSearchBenchmarks( runner );
+    addUntabifyBenchmarks( runner );
+    addEncodingBenchmarks( runner );
+    addLookupBenchmarks( runner );
+
+    runner.run( std::cout );
+
+    if ( ! json_file.empty() ) {
+        std::ofstream json( json_file );
+        runner.writeJson( json );
+    }
+
+    loadedData.clear();
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include <cmath>
+
+#include "gmock/gmock.h"
+
+#include "data/fieldquery.h"
+
+using namespace std;
+using namespace testing;
+
+class FieldQueryBehaviour : public testing::Test {
+  public:
+    vector<QString> parse( const QString& line, const QStringList& keys ) {
+        vector<QString> values;
+        FieldParser::parse( line, keys, &values );
+        return values;
+    }
+};
+
+TEST_F( FieldQueryBehaviour, JsonFieldsAreRead ) {
+    const auto values = parse(
+            "{\"level\": \"warn\", \"ctx\": {\"a\": [1, 2]}, \"status\":503,"
+            " \"msg\": \"say \\\"hi\\\"\", \"empty\": \"\"}",
+            { "status", "msg", "ctx", "empty", "missing" } );
+
+    ASSERT_THAT( values[0], Eq( QString( "503" ) ) );
+    ASSERT_THAT( values[1], Eq( QString( "say \"hi\"" ) ) );
+    ASSERT_THAT( values[2], Eq( QString( "{\"a\": [1, 2]}" ) ) );
+    ASSERT_TRUE( ! values[3].isNull() && values[3].isEmpty() );
+    ASSERT_TRUE( values[4].isNull() );
+}
+
+TEST_F( FieldQueryBehaviour, LogfmtFieldsAreRead ) {
+    const auto values = parse(
+            "2016-03-12 ts=1 level=error msg=\"disk full\" retry= user.id=42",
+            { "msg", "user.id", "retry", "ts", "level", "missing" } );
+
+    ASSERT_THAT( values[0], Eq( QString( "disk full" ) ) );
+    ASSERT_THAT( values[1], Eq( QString( "42" ) ) );
+    ASSERT_TRUE( ! values[2].isNull() && values[2].isEmpty() );
+    ASSERT_THAT( values[3], Eq( QString( "1" ) ) );
+    ASSERT_THAT( values[4], Eq( QString( "error" ) ) );
+    ASSERT_TRUE( values[5].isNull() );
+}
+
+TEST_F( FieldQueryBehaviour, FormatIsDetected ) {
+    ASSERT_THAT( FieldParser::detect( { "{\"a\": 1}", "{\"a\": 2}", "" } ),
+            Eq( StructuredFormat::Json ) );
+    ASSERT_THAT( FieldParser::detect( { "a=1 b=2", "a=3 b=4 c", "a=5 b=\"x y\"" } ),
+            Eq( StructuredFormat::Logfmt ) );
+    ASSERT_THAT( FieldParser::detect( { "Started", "a=1 b=2", "x=1" } ),
+            Eq( StructuredFormat::None ) );
+}
+
+TEST_F( FieldQueryBehaviour, QueryIsParsed ) {
+    QString error;
+    const FieldQuery query = FieldQuery::parse(
+            "status=500..599 latency_ms>=250 trace^=4bf9 msg=\"disk full\"", &error );
+
+    ASSERT_THAT( query.filters().size(), Eq( 4u ) );
+    ASSERT_THAT( query.keys(), Eq( QStringList( { "status", "latency_ms", "trace", "msg" } ) ) );
+
+    const auto& filters = query.filters();
+    ASSERT_TRUE( filters[0].accepts( "503", 503 ) );
+    ASSERT_FALSE( filters[0].accepts( "200", 200 ) );
+    ASSERT_FALSE( filters[0].accepts( "abc", NAN ) );
+    ASSERT_TRUE( filters[1].accepts( "250", 250 ) );
+    ASSERT_FALSE( filters[1].accepts( "249.5", 249.5 ) );
+    ASSERT_TRUE( filters[2].accepts( "4bf92f", NAN ) );
+    ASSERT_THAT( filters[3].op(), Eq( FieldFilter::Operator::Equal ) );
+    ASSERT_THAT( filters[3].value(), Eq( QString( "disk full" ) ) );
+}
+
+TEST_F( FieldQueryBehaviour, RangesCanSkipBlocks ) {
+    QString error;
+    const FieldQuery query = FieldQuery::parse( "status=500.. latency<10", &error );
+
+    ASSERT_TRUE( query.filters()[0].acceptsSomeOf( 200, 500 ) );
+    ASSERT_FALSE( query.filters()[0].acceptsSomeOf( 200, 404 ) );
+    ASSERT_FALSE( query.filters()[1].acceptsSomeOf( 10, 20 ) );
+    // A block without numbers
+    ASSERT_FALSE( query.filters()[1].acceptsSomeOf( NAN, NAN ) );
+}
+
+TEST_F( FieldQueryBehaviour, InvalidQueriesAreReported ) {
+    QString error;
+
+    ASSERT_TRUE( FieldQuery::parse( "status", &error ).isEmpty() );
+    ASSERT_FALSE( error.isEmpty() );
+    ASSERT_TRUE( FieldQuery::parse( "latency>fast", &error ).isEmpty() );
+    ASSERT_TRUE( FieldQuery::parse( "  ", &error ).isEmpty() );
+}
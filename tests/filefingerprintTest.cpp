@@ -0,0 +1,91 @@
+#include "gmock/gmock.h"
+
+#include "config.h"
+
+#include <QBuffer>
+#include <QByteArray>
+
+#include "log.h"
+
+#include "data/filefingerprint.h"
+
+using namespace std;
+using namespace testing;
+
+class FileFingerprintBehaviour: public testing::Test {
+  public:
+    QByteArray content;
+    QBuffer buffer;
+    qint64 changed_from = -1;
+
+    FileFingerprintBehaviour() : buffer( &content ) {
+        // 2 MiB of lines, so a few sampled blocks are used
+        for ( int i = 0; content.size() < 2 * 1024 * 1024; ++i )
+            content.append( QString( "This is line %1 of the test file\n" )
+                    .arg( i ).toLatin1() );
+        buffer.open( QIODevice::ReadOnly );
+    }
+
+    FileFingerprint::Change compareWith( const FileFingerprint& fingerprint ) {
+        return fingerprint.compare( &buffer, content.size(), &changed_from );
+    }
+};
+
+TEST_F( FileFingerprintBehaviour, IdenticalFileIsUnchanged ) {
+    auto fingerprint = FileFingerprint::compute( &buffer, content.size() );
+
+    ASSERT_THAT( fingerprint.size(), Eq( content.size() ) );
+    ASSERT_THAT( compareWith( fingerprint ), Eq( FileFingerprint::Change::None ) );
+}
+
+TEST_F( FileFingerprintBehaviour, AppendedFileIsRecognised ) {
+    auto fingerprint = FileFingerprint::compute( &buffer, content.size() );
+
+    content.append( "Some more data\n" );
+    ASSERT_THAT( compareWith( fingerprint ), Eq( FileFingerprint::Change::Appended ) );
+}
+
+TEST_F( FileFingerprintBehaviour, EmptyFingerprintSeesAppendedData ) {
+    auto fingerprint = FileFingerprint::compute( &buffer, 0 );
+
+    ASSERT_THAT( compareWith( fingerprint ), Eq( FileFingerprint::Change::Appended ) );
+}
+
+TEST_F( FileFingerprintBehaviour, ChangedBeginningIsReplaced ) {
+    auto fingerprint = FileFingerprint::compute( &buffer, content.size() );
+
+    content[10] = 'X';
+    ASSERT_THAT( compareWith( fingerprint ), Eq( FileFingerprint::Change::Replaced ) );
+}
+
+TEST_F( FileFingerprintBehaviour, TruncatedFileIsReplaced ) {
+    auto fingerprint = FileFingerprint::compute( &buffer, content.size() );
+
+    content.clear();
+    ASSERT_THAT( compareWith( fingerprint ), Eq( FileFingerprint::Change::Replaced ) );
+}
+
+TEST_F( FileFingerprintBehaviour, ChangedTailIsRewritten ) {
+    auto fingerprint = FileFingerprint::compute( &buffer, content.size() );
+
+    content[ content.size() - 10 ] = 'X';
+    ASSERT_THAT( compareWith( fingerprint ), Eq( FileFingerprint::Change::Rewritten ) );
+    // The last sampled block before the tail is at 1 MiB
+    ASSERT_THAT( changed_from, Eq( 1024 * 1024 + FileFingerprint::BLOCK_SIZE ) );
+}
+
+TEST_F( FileFingerprintBehaviour, SameSizeRewriteIsSeen ) {
+    auto fingerprint = FileFingerprint::compute( &buffer, content.size() );
+
+    content[ 64 * 1024 + 100 ] = 'X';
+    ASSERT_THAT( compareWith( fingerprint ), Eq( FileFingerprint::Change::Rewritten ) );
+    ASSERT_THAT( changed_from, Eq( FileFingerprint::BLOCK_SIZE ) );
+}
+
+TEST_F( FileFingerprintBehaviour, ShrunkFileWithSamePrefixIsRewritten ) {
+    auto fingerprint = FileFingerprint::compute( &buffer, content.size() );
+
+    content.truncate( 100 * 1024 );
+    ASSERT_THAT( compareWith( fingerprint ), Eq( FileFingerprint::Change::Rewritten ) );
+    ASSERT_THAT( changed_from, Eq( 64 * 1024 + FileFingerprint::BLOCK_SIZE ) );
+}
@@ -0,0 +1,311 @@
+#include <QCoreApplication>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSignalSpy>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "log.h"
+#include "corpusgenerator.h"
+
+#include "data/logdata.h"
+#include "data/logfiltereddata.h"
+
+#include "gmock/gmock.h"
+
+#define TMPDIR "/tmp"
+
+using namespace std::chrono;
+using namespace testing;
+
+// How a followed file is written
+struct WritePattern {
+    int linesPerSecond;
+    // Lines are written in bursts of this many lines
+    int burstLines;
+    // The file is rotated after this many lines (0 never)
+    int rotateEvery;
+};
+
+struct SoakResults {
+    qint64 linesWritten = 0;
+    qint64 linesIndexed = 0;
+    qint64 linesSearched = 0;
+    uint64_t writes = 0;
+    LogData::NotificationStatistics notifications;
+    // Time between the end of each write and its lines being
+    // indexed, or processed by the search
+    std::vector<double> indexedLatenciesMs;
+    std::vector<double> searchedLatenciesMs;
+};
+
+// Appends to a file following a pattern in a separate thread, whilst a
+// LogData (and a LogFilteredData updated as the GUI would) follows it.
+class FollowSoak {
+  public:
+    FollowSoak( const WritePattern& pattern, bool search )
+        : pattern_( pattern ), search_( search ) {}
+
+    SoakResults run( int duration_ms );
+
+  private:
+    struct Write {
+        steady_clock::time_point time;
+        // Total number of lines once written
+        qint64 lines;
+    };
+
+    void writeLines( int duration_ms );
+    // Returns the latencies of the writes now visible in nb_lines lines,
+    // starting from *next_write.
+    std::vector<double> latencies( qint64 nb_lines, size_t* next_write );
+
+    const WritePattern pattern_;
+    const bool search_;
+
+    const QString fileName_ = TMPDIR "/glogg_follow_soak.log";
+    qint64 initialLines_ = 1000;
+
+    std::mutex writesMutex_;
+    std::vector<Write> writes_;
+    bool writing_ = false;
+};
+
+SoakResults FollowSoak::run( int duration_ms )
+{
+    QFile::remove( fileName_ );
+    QFile::remove( fileName_ + ".1" );
+
+    CorpusOptions options;
+    options.maxLines = initialLines_;
+    {
+        std::ofstream file( fileName_.toStdString(), std::ios::binary );
+        CorpusGenerator( options ).write( file );
+    }
+
+    LogData log_data;
+    QSignalSpy endSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    log_data.attachFile( fileName_ );
+    endSpy.wait( 10000 );
+
+    std::unique_ptr<LogFilteredData> filtered_data( log_data.getNewFilteredData() );
+    QSignalSpy searchSpy( filtered_data.get(),
+            SIGNAL( searchProgressed( int, int, qint64 ) ) );
+    if ( search_ ) {
+        filtered_data->runSearch( QRegularExpression( corpusNeedle ) );
+        while ( searchSpy.isEmpty() || searchSpy.last()[1].toInt() < 100 )
+            searchSpy.wait( 10000 );
+    }
+
+    endSpy.clear();
+    searchSpy.clear();
+
+    writing_ = true;
+    std::thread writer( &FollowSoak::writeLines, this, duration_ms );
+
+    SoakResults results;
+    size_t next_indexed = 0;
+    size_t next_searched = 0;
+    qint64 indexed_lines = initialLines_;
+    qint64 searched_lines = initialLines_;
+
+    // Keep going a bit after the last write, for the last lines to
+    // be indexed and searched.
+    steady_clock::time_point deadline = steady_clock::time_point::max();
+    while ( steady_clock::now() < deadline ) {
+        QCoreApplication::processEvents();
+
+        if ( endSpy.count() > 0 ) {
+            endSpy.clear();
+            indexed_lines = log_data.getNbLine();
+
+            // As CrawlerWidget does
+            if ( search_ )
+                filtered_data->updateSearch();
+        }
+
+        if ( search_ && searchSpy.count() > 0 ) {
+            if ( searchSpy.last()[1].toInt() == 100 )
+                searched_lines = filtered_data->getNbLinesProcessed();
+            searchSpy.clear();
+        }
+
+        // Checked at each iteration as a write can be indexed
+        // before the writer has recorded it.
+        const auto new_indexed = latencies( indexed_lines, &next_indexed );
+        results.indexedLatenciesMs.insert( results.indexedLatenciesMs.end(),
+                new_indexed.begin(), new_indexed.end() );
+        if ( search_ ) {
+            const auto new_searched = latencies( searched_lines, &next_searched );
+            results.searchedLatenciesMs.insert( results.searchedLatenciesMs.end(),
+                    new_searched.begin(), new_searched.end() );
+        }
+
+        {
+            std::lock_guard<std::mutex> lock( writesMutex_ );
+            const bool caught_up = next_indexed == writes_.size()
+                && ( ! search_ || next_searched == writes_.size() );
+            if ( ! writing_ ) {
+                if ( caught_up )
+                    break;
+                else if ( deadline == steady_clock::time_point::max() )
+                    deadline = steady_clock::now() + seconds( 5 );
+            }
+        }
+
+        std::this_thread::sleep_for( milliseconds( 1 ) );
+    }
+
+    writer.join();
+
+    results.linesWritten = writes_.empty() ? initialLines_ : writes_.back().lines;
+    results.linesIndexed = log_data.getNbLine();
+    results.linesSearched = search_ ? filtered_data->getNbLinesProcessed() : 0;
+    results.writes = writes_.size();
+    results.notifications = log_data.getNotificationStatistics();
+
+    QFile::remove( fileName_ + ".1" );
+
+    return results;
+}
+
+void FollowSoak::writeLines( int duration_ms )
+{
+    CorpusOptions options;
+    options.seed = 4242;
+    CorpusGenerator generator( options );
+
+    const auto start = steady_clock::now();
+    const auto burst_interval = microseconds(
+            1000000LL * pattern_.burstLines / pattern_.linesPerSecond );
+
+    qint64 nb_lines = initialLines_;
+    qint64 lines_since_rotation = initialLines_;
+    auto next_burst = start;
+    while ( next_burst < start + milliseconds( duration_ms ) ) {
+        std::this_thread::sleep_until( next_burst );
+
+        if ( pattern_.rotateEvery > 0 && lines_since_rotation >= pattern_.rotateEvery ) {
+            QFile::remove( fileName_ + ".1" );
+            QFile::rename( fileName_, fileName_ + ".1" );
+            lines_since_rotation = 0;
+        }
+
+        {
+            std::ofstream file( fileName_.toStdString(),
+                    std::ios::binary | std::ios::app );
+            for ( int i = 0; i < pattern_.burstLines; ++i )
+                file << generator.nextLine() << generator.endOfLine();
+        }
+        nb_lines += pattern_.burstLines;
+        lines_since_rotation += pattern_.burstLines;
+
+        {
+            std::lock_guard<std::mutex> lock( writesMutex_ );
+            writes_.push_back( { steady_clock::now(), nb_lines } );
+        }
+
+        next_burst += burst_interval;
+    }
+
+    std::lock_guard<std::mutex> lock( writesMutex_ );
+    writing_ = false;
+}
+
+std::vector<double> FollowSoak::latencies( qint64 nb_lines, size_t* next_write )
+{
+    const auto now = steady_clock::now();
+
+    std::vector<double> result;
+
+    std::lock_guard<std::mutex> lock( writesMutex_ );
+    while ( *next_write < writes_.size() && writes_[*next_write].lines <= nb_lines ) {
+        result.push_back( duration_cast<microseconds>(
+                    now - writes_[*next_write].time ).count() / 1000.0 );
+        ++(*next_write);
+    }
+
+    return result;
+}
+
+namespace {
+
+double percentile( std::vector<double> values, double ratio )
+{
+    if ( values.empty() )
+        return 0;
+
+    std::sort( values.begin(), values.end() );
+    const size_t rank = static_cast<size_t>( ratio * ( values.size() - 1 ) + 0.5 );
+    return values[rank];
+}
+
+void printResults( const std::string& name, const SoakResults& results )
+{
+    std::cout << name << ": " << results.writes << " writes, "
+        << results.notifications.received << " notifications ("
+        << results.notifications.coalesced << " coalesced)" << std::endl;
+    std::cout << "  write to indexed (ms): p50="
+        << percentile( results.indexedLatenciesMs, 0.5 )
+        << " p95=" << percentile( results.indexedLatenciesMs, 0.95 )
+        << " p99=" << percentile( results.indexedLatenciesMs, 0.99 )
+        << " max=" << percentile( results.indexedLatenciesMs, 1 ) << std::endl;
+    if ( ! results.searchedLatenciesMs.empty() )
+        std::cout << "  write to search updated (ms): p50="
+            << percentile( results.searchedLatenciesMs, 0.5 )
+            << " p95=" << percentile( results.searchedLatenciesMs, 0.95 )
+            << " p99=" << percentile( results.searchedLatenciesMs, 0.99 )
+            << " max=" << percentile( results.searchedLatenciesMs, 1 ) << std::endl;
+}
+
+}
+
+class FollowSoakTest : public testing::Test {
+  public:
+    FollowSoakTest() {
+        FILELog::setReportingLevel( logERROR );
+
+        // Can be raised for a proper soak test
+        const QByteArray duration = qgetenv( "GLOGG_SOAK_DURATION_MS" );
+        durationMs_ = duration.isEmpty() ? 2000 : duration.toInt();
+    }
+
+    int durationMs_;
+};
+
+TEST_F( FollowSoakTest, steadyRateIsFollowed ) {
+    FollowSoak soak( { 2000, 20, 0 }, true );
+    const auto results = soak.run( durationMs_ );
+    printResults( "steady", results );
+
+    ASSERT_THAT( results.linesIndexed, Eq( results.linesWritten ) );
+    ASSERT_THAT( results.linesSearched, Eq( results.linesWritten ) );
+    ASSERT_THAT( results.indexedLatenciesMs.size(), Eq( results.writes ) );
+    ASSERT_THAT( results.searchedLatenciesMs.size(), Eq( results.writes ) );
+    ASSERT_THAT( results.notifications.received, Gt( 0u ) );
+}
+
+TEST_F( FollowSoakTest, burstsAreFollowed ) {
+    FollowSoak soak( { 50000, 5000, 0 }, true );
+    const auto results = soak.run( durationMs_ );
+    printResults( "bursts", results );
+
+    ASSERT_THAT( results.linesIndexed, Eq( results.linesWritten ) );
+    ASSERT_THAT( results.linesSearched, Eq( results.linesWritten ) );
+    ASSERT_THAT( results.indexedLatenciesMs.size(), Eq( results.writes ) );
+}
+
+TEST_F( FollowSoakTest, rotationsAreFollowed ) {
+    FollowSoak soak( { 5000, 100, 2000 }, false );
+    const auto results = soak.run( durationMs_ );
+    printResults( "rotations", results );
+
+    ASSERT_THAT( results.linesIndexed, Eq( results.linesWritten ) );
+    ASSERT_THAT( results.indexedLatenciesMs.size(), Eq( results.writes ) );
+}
@@ -0,0 +1,91 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QFile>
+
+#include <memory>
+
+#include "log.h"
+#include "test_utils.h"
+
+#include "data/logdata.h"
+#include "data/globalsearch.h"
+
+#include "gmock/gmock.h"
+
+#define TMPDIR "/tmp"
+
+static const char* gs_format="GLOBAL search line %06d request=%d\n";
+
+class GlobalSearchBehaviour : public testing::Test {
+  public:
+    std::vector<std::shared_ptr<const AbstractLogSource>> files;
+
+    GlobalSearchBehaviour() {
+        // Three files, 'request=<file>' every 10 lines
+        for ( int f = 0; f < 3; ++f ) {
+            const QString file_name = QString( TMPDIR "/globalsearch%1.log" ).arg( f );
+            QFile file( file_name );
+            if ( file.open( QIODevice::WriteOnly ) ) {
+                char newLine[90];
+                for ( int i = 0; i < 10000; i++ ) {
+                    snprintf( newLine, 89, gs_format, i, ( i % 10 == 0 ) ? f : -1 );
+                    file.write( newLine, qstrlen( newLine ) );
+                }
+            }
+            file.close();
+
+            auto log_data = std::make_shared<LogData>();
+            SafeQSignalSpy endSpy( log_data.get(), SIGNAL( loadingFinished( LoadingStatus ) ) );
+            log_data->attachFile( file_name );
+            endSpy.safeWait( 10000 );
+
+            files.push_back( log_data );
+        }
+    }
+};
+
+TEST_F( GlobalSearchBehaviour, allFilesAreSearched ) {
+    GlobalSearch search( 2 );
+    SafeQSignalSpy finishedSpy( &search, SIGNAL( searchFinished() ) );
+
+    search.start( files, QRegularExpression( "request=[0-9]" ) );
+    ASSERT_TRUE( finishedSpy.safeWait( 10000 ) );
+
+    const auto matches = search.takeNewMatches();
+    ASSERT_THAT( matches.size(), 3000u );
+    ASSERT_THAT( search.getNbFilesSearched(), 3 );
+    ASSERT_FALSE( search.isTruncated() );
+
+    // Each file's matches are in line order
+    std::vector<qint64> last_line( 3, -1 );
+    for ( const auto& match: matches ) {
+        ASSERT_THAT( match.line, testing::Gt( last_line[match.file] ) );
+        ASSERT_THAT( match.text.toStdString(),
+                testing::EndsWith( "request=" + std::to_string( match.file ) ) );
+        last_line[match.file] = match.line;
+    }
+}
+
+TEST_F( GlobalSearchBehaviour, matchesAreFoundInTheRightFile ) {
+    GlobalSearch search( 2 );
+    SafeQSignalSpy finishedSpy( &search, SIGNAL( searchFinished() ) );
+
+    search.start( files, QRegularExpression( "line 000020 request=2" ) );
+    ASSERT_TRUE( finishedSpy.safeWait( 10000 ) );
+
+    const auto matches = search.takeNewMatches();
+    ASSERT_THAT( matches.size(), 1u );
+    ASSERT_THAT( matches[0].file, 2 );
+    ASSERT_THAT( matches[0].line, 20LL );
+}
+
+TEST_F( GlobalSearchBehaviour, searchStopsAfterTheMaximumMatches ) {
+    GlobalSearch search( 1, 500 );
+    SafeQSignalSpy finishedSpy( &search, SIGNAL( searchFinished() ) );
+
+    search.start( files, QRegularExpression( "request=[0-9]" ) );
+    ASSERT_TRUE( finishedSpy.safeWait( 10000 ) );
+
+    ASSERT_THAT( search.takeNewMatches().size(), 500u );
+    ASSERT_TRUE( search.isTruncated() );
+}
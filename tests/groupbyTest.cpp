@@ -0,0 +1,152 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QFile>
+
+#include <memory>
+
+#include "log.h"
+#include "test_utils.h"
+
+#include "data/logdata.h"
+#include "data/groupby.h"
+
+#include "gmock/gmock.h"
+
+#define TMPDIR "/tmp"
+
+using namespace testing;
+
+// 'user=u<n>' with u0 on half the lines, u1 on a quarter...
+static const char* gb_format="GROUP BY line %06d user=u%d status=%d\n";
+
+class HeavyHittersBehaviour : public testing::Test {
+  public:
+    // Adds value count times
+    void add( HeavyHitters* hitters, const QString& value, int count ) {
+        for ( int i = 0; i < count; ++i )
+            hitters->add( value );
+    }
+};
+
+TEST_F( HeavyHittersBehaviour, countsAreExactWithinCapacity ) {
+    HeavyHitters hitters( 3 );
+    add( &hitters, "a", 5 );
+    add( &hitters, "b", 2 );
+    add( &hitters, "c", 7 );
+
+    const auto entries = hitters.entries();
+    ASSERT_THAT( entries.size(), 3u );
+    ASSERT_THAT( entries[0].value.toStdString(), "c" );
+    ASSERT_THAT( entries[0].count, 7 );
+    ASSERT_THAT( entries[2].value.toStdString(), "b" );
+    ASSERT_TRUE( hitters.isExact() );
+    ASSERT_THAT( hitters.getTotal(), 14 );
+}
+
+TEST_F( HeavyHittersBehaviour, frequentValuesAreKept ) {
+    HeavyHitters hitters( 4 );
+    for ( int i = 0; i < 100; ++i ) {
+        add( &hitters, "frequent", 3 );
+        hitters.add( QString( "rare%1" ).arg( i ) );
+    }
+
+    const auto entries = hitters.entries();
+    ASSERT_FALSE( hitters.isExact() );
+    ASSERT_THAT( entries[0].value.toStdString(), "frequent" );
+    // Never overestimated by more than the error
+    ASSERT_THAT( entries[0].count, Ge( 300 ) );
+    ASSERT_THAT( entries[0].count - entries[0].error, Le( 300 ) );
+}
+
+TEST_F( HeavyHittersBehaviour, summariesAreMerged ) {
+    HeavyHitters first( 3 );
+    HeavyHitters second( 3 );
+    add( &first, "a", 5 );
+    add( &first, "b", 1 );
+    add( &second, "a", 2 );
+    add( &second, "c", 4 );
+
+    first.merge( second );
+
+    const auto entries = first.entries();
+    ASSERT_TRUE( first.isExact() );
+    ASSERT_THAT( entries.size(), 3u );
+    ASSERT_THAT( entries[0].value.toStdString(), "a" );
+    ASSERT_THAT( entries[0].count, 7 );
+    ASSERT_THAT( entries[1].value.toStdString(), "c" );
+    ASSERT_THAT( first.getTotal(), 12 );
+}
+
+TEST( GroupByFilter, groupsAreReplacedByTheirValue ) {
+    ASSERT_THAT( GroupBy::filterPattern( "user=(\\w+)", "alice" ).toStdString(),
+            "user=(alice)" );
+    ASSERT_THAT( GroupBy::filterPattern( "(GET|POST) ([^ ?]+)\\(x\\)",
+                "GET" + QString( QChar( 0x1F ) ) + "/a.b" ).toStdString(),
+            "(GET) (\\/a\\.b)\\(x\\)" );
+    // Nested and non capturing groups
+    ASSERT_THAT( GroupBy::filterPattern( "((?:a|b)(c)) (d+)",
+                "ac" + QString( QChar( 0x1F ) ) + "c" + QString( QChar( 0x1F ) ) + "dd" )
+            .toStdString(), "(ac) (dd)" );
+}
+
+class GroupByBehaviour : public testing::Test {
+  public:
+    std::shared_ptr<LogData> log_data;
+    static const int NB_LINES = 120000;
+
+    GroupByBehaviour() : log_data( std::make_shared<LogData>() ) {
+        const QString file_name( TMPDIR "/groupby.log" );
+        QFile file( file_name );
+        if ( file.open( QIODevice::WriteOnly ) ) {
+            char newLine[90];
+            for ( int i = 0; i < NB_LINES; i++ ) {
+                // Number of trailing 1 bits
+                int user = 0;
+                while ( ( i >> user ) & 1 )
+                    ++user;
+                snprintf( newLine, 89, gb_format, i, user, ( i % 4 == 0 ) ? 500 : 200 );
+                file.write( newLine, qstrlen( newLine ) );
+            }
+        }
+        file.close();
+
+        SafeQSignalSpy endSpy( log_data.get(), SIGNAL( loadingFinished( LoadingStatus ) ) );
+        log_data->attachFile( file_name );
+        endSpy.safeWait( 10000 );
+    }
+};
+
+TEST_F( GroupByBehaviour, valuesAreCountedInAllLines ) {
+    GroupBy group_by;
+    SafeQSignalSpy finishedSpy( &group_by, SIGNAL( finished() ) );
+
+    group_by.start( log_data, QRegularExpression( "user=(\\w+)" ) );
+    ASSERT_TRUE( finishedSpy.safeWait( 10000 ) );
+
+    const auto results = group_by.getResults();
+    ASSERT_TRUE( group_by.isExact() );
+    ASSERT_THAT( group_by.getNbMatchingLines(), NB_LINES );
+    ASSERT_THAT( results[0].value.toStdString(), "u0" );
+    ASSERT_THAT( results[0].count, NB_LINES / 2 );
+    ASSERT_THAT( results[1].value.toStdString(), "u1" );
+    ASSERT_THAT( results[1].count, NB_LINES / 4 );
+}
+
+TEST_F( GroupByBehaviour, valuesAreCountedInTheLinesPassed ) {
+    GroupBy group_by;
+    SafeQSignalSpy finishedSpy( &group_by, SIGNAL( finished() ) );
+
+    // The lines with status=500
+    std::vector<qint64> lines;
+    for ( qint64 i = 0; i < NB_LINES; i += 4 )
+        lines.push_back( i );
+
+    group_by.start( log_data, QRegularExpression( "user=(\\w+) status=(\\d+)" ), lines );
+    ASSERT_TRUE( finishedSpy.safeWait( 10000 ) );
+
+    // Those lines have no trailing 1 bits
+    const auto results = group_by.getResults();
+    ASSERT_THAT( results.size(), 1u );
+    ASSERT_THAT( GroupBy::displayText( results[0].value ).toStdString(), "u0 | 500" );
+    ASSERT_THAT( results[0].count, NB_LINES / 4 );
+}
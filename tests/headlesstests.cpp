@@ -0,0 +1,11 @@
+#include "gmock/gmock.h"
+
+#include <QCoreApplication>
+
+// For the tests that don't need a display
+int main(int argc, char *argv[]) {
+    QCoreApplication a( argc, argv );
+    ::testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
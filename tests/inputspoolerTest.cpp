@@ -0,0 +1,194 @@
+#include <QCoreApplication>
+#include <QFile>
+#include <QSignalSpy>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+#include <sys/stat.h>
+
+#include "log.h"
+#include "corpusgenerator.h"
+
+#include "data/inputspooler.h"
+#include "data/logdata.h"
+
+#include "gmock/gmock.h"
+
+#define TMPDIR "/tmp"
+
+using namespace std::chrono;
+using namespace testing;
+
+class InputSpoolerTest : public testing::Test {
+  public:
+    InputSpoolerTest() {
+        FILELog::setReportingLevel( logERROR );
+
+        QFile::remove( pipeName_ );
+        mkfifo( pipeName_.toStdString().c_str(), 0600 );
+    }
+
+    ~InputSpoolerTest() {
+        QFile::remove( pipeName_ );
+    }
+
+    // Writes lines to the pipe as fast as possible, returns the
+    // number of bytes written
+    uint64_t produce( uint64_t nb_bytes, milliseconds pause = milliseconds( 0 ) ) {
+        CorpusOptions options;
+        CorpusGenerator generator( options );
+
+        std::ofstream pipe( pipeName_.toStdString(), std::ios::binary );
+        uint64_t written = 0;
+        uint64_t nb_lines = 0;
+        while ( written < nb_bytes ) {
+            const std::string line = generator.nextLine() + generator.endOfLine();
+            pipe << line;
+            written += line.size();
+
+            if ( pause.count() > 0 && ++nb_lines % 1000 == 0 ) {
+                pipe.flush();
+                std::this_thread::sleep_for( pause );
+            }
+        }
+
+        return written;
+    }
+
+    const QString pipeName_ = TMPDIR "/glogg_spooler_pipe";
+};
+
+TEST_F( InputSpoolerTest, namedPipeIsAStream ) {
+    ASSERT_TRUE( InputSpooler::isStream( "-" ) );
+    ASSERT_TRUE( InputSpooler::isStream( pipeName_ ) );
+    ASSERT_FALSE( InputSpooler::isStream( TMPDIR ) );
+}
+
+TEST_F( InputSpoolerTest, fastProducerIsSpooled ) {
+    InputSpooler spooler( pipeName_, 0 );
+    spooler.start();
+
+    const auto start = steady_clock::now();
+    uint64_t written = 0;
+    std::thread producer( [&] { written = produce( 64 * 1024 * 1024 ); } );
+    producer.join();
+    spooler.waitForEnd();
+    const auto duration = duration_cast<microseconds>(
+            steady_clock::now() - start ).count();
+
+    std::cout << "Spooled " << written / ( 1024 * 1024 ) << " MiB at "
+        << written / static_cast<double>( duration ) << " MB/s" << std::endl;
+
+    ASSERT_TRUE( spooler.hasEnded() );
+    ASSERT_THAT( spooler.bytesSpooled(), Eq( written ) );
+    ASSERT_THAT( spooler.bytesDropped(), Eq( 0 ) );
+    ASSERT_THAT( QFile( spooler.spoolFileName() ).size(), Eq( written ) );
+}
+
+TEST_F( InputSpoolerTest, spoolStopsAtItsMaximumSize ) {
+    const qint64 max_size = 1024 * 1024;
+
+    InputSpooler spooler( pipeName_, max_size );
+    spooler.start();
+
+    uint64_t written = 0;
+    std::thread producer( [&] { written = produce( 8 * max_size ); } );
+    producer.join();
+    spooler.waitForEnd();
+
+    ASSERT_THAT( spooler.bytesSpooled(), Le( max_size ) );
+    ASSERT_THAT( spooler.bytesSpooled() + spooler.bytesDropped(), Eq( written ) );
+    ASSERT_THAT( QFile( spooler.spoolFileName() ).size(), Eq( spooler.bytesSpooled() ) );
+}
+
+TEST_F( InputSpoolerTest, nothingIsSpooledAfterTheFirstDrop ) {
+    const qint64 max_size = 1000;
+
+    InputSpooler spooler( pipeName_, max_size );
+    spooler.start();
+
+    const std::string first( 600, 'a' );
+    {
+        std::ofstream pipe( pipeName_.toStdString(), std::ios::binary );
+        // Fits
+        pipe << first << std::flush;
+        std::this_thread::sleep_for( milliseconds( 300 ) );
+        // Too big, dropped
+        pipe << std::string( 1000, 'b' ) << std::flush;
+        std::this_thread::sleep_for( milliseconds( 300 ) );
+        // Would fit in what is left, but comes after the gap
+        pipe << std::string( 100, 'c' ) << std::flush;
+    }
+    spooler.waitForEnd();
+
+    ASSERT_THAT( spooler.bytesSpooled(), Eq( 600 ) );
+    ASSERT_THAT( spooler.bytesDropped(), Eq( 1100 ) );
+
+    QFile spool( spooler.spoolFileName() );
+    ASSERT_TRUE( spool.open( QIODevice::ReadOnly ) );
+    ASSERT_THAT( spool.readAll().toStdString(), Eq( first ) );
+}
+
+TEST_F( InputSpoolerTest, spoolIsRemoved ) {
+    QString spool_name;
+    {
+        InputSpooler spooler( pipeName_, 0 );
+        spool_name = spooler.spoolFileName();
+        ASSERT_TRUE( QFile::exists( spool_name ) );
+    }
+    ASSERT_FALSE( QFile::exists( spool_name ) );
+}
+
+TEST_F( InputSpoolerTest, spoolerWithoutWriterCanBeDestroyed ) {
+    const auto start = steady_clock::now();
+    {
+        InputSpooler spooler( pipeName_, 0 );
+        spooler.start();
+
+        // Nobody opens the pipe for writing
+        std::this_thread::sleep_for( milliseconds( 200 ) );
+        ASSERT_FALSE( spooler.hasEnded() );
+    }
+    const auto duration = duration_cast<milliseconds>(
+            steady_clock::now() - start ).count();
+
+    ASSERT_THAT( duration, Lt( 2000 ) );
+}
+
+TEST_F( InputSpoolerTest, spoolIsIndexedAsDataArrives ) {
+    InputSpooler spooler( pipeName_, 0 );
+    spooler.start();
+
+    LogData log_data;
+    QSignalSpy endSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    log_data.attachFile( spooler.spoolFileName() );
+    endSpy.wait( 10000 );
+
+    uint64_t written = 0;
+    std::thread producer( [&] {
+            written = produce( 4 * 1024 * 1024, milliseconds( 5 ) ); } );
+
+    // The lines must be indexed whilst the producer is still writing
+    bool indexed_before_end = false;
+    const auto deadline = steady_clock::now() + seconds( 30 );
+    while ( steady_clock::now() < deadline ) {
+        QCoreApplication::processEvents();
+
+        if ( ! spooler.hasEnded() && log_data.getNbLine() > 1 )
+            indexed_before_end = true;
+
+        if ( spooler.hasEnded()
+                && log_data.getFileSize() == spooler.bytesSpooled() )
+            break;
+
+        std::this_thread::sleep_for( milliseconds( 1 ) );
+    }
+    producer.join();
+
+    ASSERT_TRUE( indexed_before_end );
+    ASSERT_THAT( spooler.bytesSpooled(), Eq( written ) );
+    ASSERT_THAT( log_data.getFileSize(), Eq( written ) );
+}
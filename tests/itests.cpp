@@ -1,10 +1,21 @@
 #include "gmock/gmock.h"
 
+#include <memory>
+
 #include <QApplication>
 
+#include "persistentinfo.h"
+#include "configuration.h"
+
 int main(int argc, char *argv[]) {
     QApplication a( argc, argv );
     ::testing::InitGoogleTest(&argc, argv);
+
+    // The QuickFind pattern reads the settings
+    GetPersistentInfo().migrateAndInit();
+    GetPersistentInfo().registerPersistable(
+            std::make_shared<Configuration>(), QString( "settings" ) );
+
     int iReturn = RUN_ALL_TESTS();
 
     // qDebug()<<"rcode:"<<iReturn;
@@ -111,6 +111,16 @@ TEST_F( LinePositionArrayLong, FakeLFisNotKeptWhenAddingAfterIt ) {
     }
 }
 
+TEST_F( LinePositionArrayLong, FullBlocksAreShrunk ) {
+    const size_t full_block_size = line_array.allocatedSize();
+    // Much less than the 8 bytes per line uncompressed
+    ASSERT_THAT( full_block_size, Lt( 256 * sizeof( uint64_t ) / 4 ) );
+
+    // A new block is allocated for the longest lines possible
+    line_array.append( 255 * 4 + 10 );
+    ASSERT_THAT( line_array.allocatedSize(), Gt( full_block_size + 256 * 6 ) );
+}
+
 
 class LinePositionArrayBig: public testing::Test {
   public:
@@ -1,3 +1,4 @@
+#include <cstdio>
 #include <iostream>
 
 #include <QTest>
@@ -32,7 +33,7 @@ TEST_F( LogDataChanging, changingFile ) {
     SafeQSignalSpy finishedSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
     SafeQSignalSpy progressSpy( &log_data, SIGNAL( loadingProgressed( int ) ) );
     SafeQSignalSpy changedSpy( &log_data,
-            SIGNAL( fileChanged( LogData::MonitoredFileStatus ) ) );
+            SIGNAL( fileChanged( AbstractLogSource::MonitoredFileStatus ) ) );
 
     // Generate a small file
     QFile file( TMPDIR "/changingfile.txt" );
@@ -122,6 +123,270 @@ TEST_F( LogDataChanging, changingFile ) {
     }
 }
 
+TEST_F( LogDataChanging, appendedDataLatencyIsReported ) {
+    char newLine[90];
+    LogData log_data;
+
+    SafeQSignalSpy finishedSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+
+    QFile file( TMPDIR "/latencyfile.txt" );
+    if ( file.open( QIODevice::WriteOnly ) ) {
+        snprintf(newLine, 89, sl_format, 0);
+        file.write( newLine, qstrlen(newLine) );
+    }
+    file.close();
+
+    log_data.attachFile( TMPDIR "/latencyfile.txt" );
+    ASSERT_TRUE( finishedSpy.safeWait() );
+
+    // Nothing appended yet
+    ASSERT_THAT( log_data.getLastIndexingLatency(), -1LL );
+
+    if ( file.open( QIODevice::Append ) ) {
+        for (int i = 1; i < 100; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    file.close();
+
+    ASSERT_TRUE( finishedSpy.wait( 1000 ) );
+
+    ASSERT_THAT( log_data.getNbLine(), 100LL );
+    ASSERT_THAT( log_data.getLastIndexingLatency(), testing::Ge( 0LL ) );
+}
+
+TEST_F( LogDataChanging, rewrittenLinesAreForgotten ) {
+    char newLine[90];
+    LogData log_data;
+
+    SafeQSignalSpy finishedSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    SafeQSignalSpy changedSpy( &log_data,
+            SIGNAL( fileChanged( AbstractLogSource::MonitoredFileStatus ) ) );
+
+    // Enough lines for the beginning of the file to be sampled,
+    // then a long line
+    const QByteArray long_line = QByteArray( 300, 'x' ) + '\n';
+    QFile file( TMPDIR "/rewrittenfile.txt" );
+    if ( file.open( QIODevice::WriteOnly ) ) {
+        for (int i = 0; i < 1000; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            file.write( newLine, qstrlen(newLine) );
+        }
+        file.write( long_line );
+    }
+    file.close();
+
+    log_data.attachFile( TMPDIR "/rewrittenfile.txt" );
+    ASSERT_TRUE( finishedSpy.safeWait() );
+    ASSERT_THAT( log_data.getMaxLength(), 300 );
+
+    // The long line is replaced by 7 shorter ones (in one write,
+    // keeping the size)
+    QByteArray short_lines;
+    for (int i = 0; i < 7; i++)
+        short_lines += QByteArray( 42, 'a' + i ) + '\n';
+    QVERIFY( file.open( QIODevice::ReadWrite ) );
+    file.seek( 1000 * (SL_LINE_LENGTH+1LL) );
+    file.write( short_lines );
+    file.close();
+
+    ASSERT_TRUE( finishedSpy.wait( 1000 ) );
+
+    ASSERT_THAT( changedSpy.last()[0].value<LogData::MonitoredFileStatus>(),
+            LogData::Rewritten );
+    ASSERT_THAT( log_data.getNbLine(), 1007LL );
+    ASSERT_THAT( log_data.getMaxLength(), SL_LINE_LENGTH );
+}
+
+TEST_F( LogDataChanging, rotatedFileIsFollowed ) {
+    char newLine[90];
+    LogData log_data;
+
+    SafeQSignalSpy finishedSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    SafeQSignalSpy changedSpy( &log_data,
+            SIGNAL( fileChanged( AbstractLogSource::MonitoredFileStatus ) ) );
+
+    QFile::remove( TMPDIR "/rotatingfile.txt.1" );
+    QFile::remove( TMPDIR "/rotatingfile.txt.2" );
+
+    // Only the latest rotated file is kept
+    log_data.setMaxRotatedFiles( 1 );
+
+    QFile file( TMPDIR "/rotatingfile.txt" );
+    if ( file.open( QIODevice::WriteOnly ) ) {
+        for (int i = 0; i < 200; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    file.close();
+
+    log_data.attachFile( TMPDIR "/rotatingfile.txt" );
+    ASSERT_TRUE( finishedSpy.safeWait() );
+    ASSERT_THAT( log_data.getNbLine(), 200LL );
+
+    // Rotate the file, the new one (smaller) is moved in place
+    // so it appears with its content in one go.
+    QFile new_file( TMPDIR "/rotatingfile.txt.new" );
+    if ( new_file.open( QIODevice::WriteOnly ) ) {
+        for (int i = 1000; i < 1050; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            new_file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    new_file.close();
+
+    QVERIFY( QFile::rename( TMPDIR "/rotatingfile.txt", TMPDIR "/rotatingfile.txt.1" ) );
+    QVERIFY( QFile::rename( TMPDIR "/rotatingfile.txt.new", TMPDIR "/rotatingfile.txt" ) );
+
+    ASSERT_TRUE( finishedSpy.wait( 1000 ) );
+
+    // Both files are displayed, as if the new one was appended
+    ASSERT_THAT( changedSpy.last()[0].value<LogData::MonitoredFileStatus>(),
+            LogData::DataAdded );
+    ASSERT_THAT( log_data.getNbLine(), 250LL );
+    ASSERT_THAT( log_data.getFileSize(), 250 * (SL_LINE_LENGTH+1LL) );
+
+    snprintf(newLine, 89, sl_format, 199);
+    ASSERT_THAT( log_data.getLineString( 199 ).toStdString() + "\n",
+            std::string( newLine ) );
+    snprintf(newLine, 89, sl_format, 1000);
+    ASSERT_THAT( log_data.getLineString( 200 ).toStdString() + "\n",
+            std::string( newLine ) );
+
+    // Lines spanning both files
+    QStringList lines = log_data.getLines( 198, 4 );
+    ASSERT_THAT( lines.size(), 4 );
+    snprintf(newLine, 89, sl_format, 1001);
+    ASSERT_THAT( lines[3].toStdString() + "\n", std::string( newLine ) );
+
+    // Rotate again, the oldest file is dropped
+    if ( new_file.open( QIODevice::WriteOnly ) ) {
+        for (int i = 2000; i < 2030; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            new_file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    new_file.close();
+
+    QVERIFY( QFile::rename( TMPDIR "/rotatingfile.txt.1", TMPDIR "/rotatingfile.txt.2" ) );
+    QVERIFY( QFile::rename( TMPDIR "/rotatingfile.txt", TMPDIR "/rotatingfile.txt.1" ) );
+    QVERIFY( QFile::rename( TMPDIR "/rotatingfile.txt.new", TMPDIR "/rotatingfile.txt" ) );
+
+    ASSERT_TRUE( finishedSpy.wait( 1000 ) );
+
+    // The line numbers have changed
+    ASSERT_THAT( changedSpy.last()[0].value<LogData::MonitoredFileStatus>(),
+            LogData::Truncated );
+    ASSERT_THAT( log_data.getNbLine(), 80LL );
+    ASSERT_THAT( log_data.getFileSize(), 80 * (SL_LINE_LENGTH+1LL) );
+
+    snprintf(newLine, 89, sl_format, 1000);
+    ASSERT_THAT( log_data.getLineString( 0 ).toStdString() + "\n",
+            std::string( newLine ) );
+    snprintf(newLine, 89, sl_format, 2000);
+    ASSERT_THAT( log_data.getLineString( 50 ).toStdString() + "\n",
+            std::string( newLine ) );
+
+    QFile::remove( TMPDIR "/rotatingfile.txt.1" );
+    QFile::remove( TMPDIR "/rotatingfile.txt.2" );
+}
+
+TEST_F( LogDataChanging, rotatedUtf16FileGetsAFullFakeLineFeed ) {
+    LogData log_data;
+
+    SafeQSignalSpy finishedSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+
+    auto utf16le = []( const char* text ) {
+        QByteArray bytes;
+        for ( const char* c = text; *c; ++c ) {
+            bytes.append( *c );
+            bytes.append( '\0' );
+        }
+        return bytes;
+    };
+
+    QFile::remove( TMPDIR "/rotatingutf16.txt.1" );
+
+    // Not LF terminated
+    const QByteArray old_content = QByteArray( "\xff\xfe", 2 )
+        + utf16le( "line one\nline two" );
+    QFile file( TMPDIR "/rotatingutf16.txt" );
+    if ( file.open( QIODevice::WriteOnly ) )
+        file.write( old_content );
+    file.close();
+
+    log_data.attachFile( TMPDIR "/rotatingutf16.txt" );
+    ASSERT_TRUE( finishedSpy.safeWait() );
+    ASSERT_THAT( log_data.getNbLine(), 2LL );
+
+    const QByteArray new_content = utf16le( "line three\n" );
+    QFile new_file( TMPDIR "/rotatingutf16.txt.new" );
+    if ( new_file.open( QIODevice::WriteOnly ) )
+        new_file.write( new_content );
+    new_file.close();
+
+    QVERIFY( QFile::rename( TMPDIR "/rotatingutf16.txt", TMPDIR "/rotatingutf16.txt.1" ) );
+    QVERIFY( QFile::rename( TMPDIR "/rotatingutf16.txt.new", TMPDIR "/rotatingutf16.txt" ) );
+
+    ASSERT_TRUE( finishedSpy.wait( 1000 ) );
+
+    // The new file starts after a two bytes line feed
+    ASSERT_THAT( log_data.getNbLine(), 3LL );
+    ASSERT_THAT( log_data.getFileSize(),
+            (qint64) ( old_content.size() + 2 + new_content.size() ) );
+    ASSERT_THAT( log_data.getLineString( 2 ).toStdString(), std::string( "line three" ) );
+
+    QFile::remove( TMPDIR "/rotatingutf16.txt.1" );
+}
+
+TEST_F( LogDataChanging, atomicallyReplacedFileIsReindexed ) {
+    char newLine[90];
+    LogData log_data;
+
+    SafeQSignalSpy finishedSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    SafeQSignalSpy changedSpy( &log_data,
+            SIGNAL( fileChanged( AbstractLogSource::MonitoredFileStatus ) ) );
+
+    QFile file( TMPDIR "/replacedfile.txt" );
+    if ( file.open( QIODevice::WriteOnly ) ) {
+        for (int i = 0; i < 200; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    file.close();
+
+    log_data.attachFile( TMPDIR "/replacedfile.txt" );
+    ASSERT_TRUE( finishedSpy.safeWait() );
+    ASSERT_THAT( log_data.getNbLine(), 200LL );
+
+    // The new version is renamed over the old one, which is unlinked
+    QFile new_file( TMPDIR "/replacedfile.txt.new" );
+    if ( new_file.open( QIODevice::WriteOnly ) ) {
+        for (int i = 1000; i < 1050; i++) {
+            snprintf(newLine, 89, sl_format, i);
+            new_file.write( newLine, qstrlen(newLine) );
+        }
+    }
+    new_file.close();
+
+    QVERIFY( ::rename( TMPDIR "/replacedfile.txt.new", TMPDIR "/replacedfile.txt" ) == 0 );
+
+    ASSERT_TRUE( finishedSpy.wait( 1000 ) );
+
+    // Only the new file is displayed
+    ASSERT_THAT( changedSpy.last()[0].value<LogData::MonitoredFileStatus>(),
+            LogData::Truncated );
+    ASSERT_THAT( log_data.getNbLine(), 50LL );
+    ASSERT_THAT( log_data.getFileSize(), 50 * (SL_LINE_LENGTH+1LL) );
+
+    snprintf(newLine, 89, sl_format, 1000);
+    ASSERT_THAT( log_data.getLineString( 0 ).toStdString() + "\n",
+            std::string( newLine ) );
+}
+
 class LogDataBehaviour : public testing::Test {
   public:
     LogDataBehaviour() {
@@ -278,3 +543,30 @@ TEST_F( LogDataMultiByte, readUtf16BE ) {
     ASSERT_THAT( QString::compare( log_data.getLines( 11, 3 ).at( 2 ), QStringLiteral( "DOM CARLOS, frère d'Elvire." ) ), 0 );
     ASSERT_THAT( QString::compare( log_data.getExpandedLines( 0, 3 ).at( 2 ), QStringLiteral( "COMÉDIE" ) ), 0 );
 }
+
+TEST_F( LogDataMultiByte, utf16IsIndexedByCodeUnits ) {
+    // U+010A and U+0A0A contain a 0x0A byte, U+1F600 is a surrogate pair
+    const QString text = QString::fromUtf8( u8"Ċਊ first\n\tsecond \U0001F600\nthird Ċ\n" );
+
+    for ( const char* encoding: { "UTF16LE", "UTF16BE" } ) {
+        QFile file( TMPDIR "/utf16codeunits.txt" );
+        ASSERT_TRUE( file.open( QIODevice::WriteOnly ) );
+        file.write( QTextCodec::codecForName( encoding )->fromUnicode( text ) );
+        file.close();
+
+        LogData log_data;
+        SafeQSignalSpy endSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+
+        log_data.attachFile( TMPDIR "/utf16codeunits.txt" );
+        endSpy.safeWait( 10000 );
+
+        log_data.setDisplayEncoding( QString( encoding ) == "UTF16LE" ?
+                Encoding::ENCODING_UTF16LE : Encoding::ENCODING_UTF16BE );
+
+        ASSERT_THAT( log_data.getNbLine(), 3 );
+        ASSERT_THAT( QString::compare( log_data.getLineString( 0 ), QString::fromUtf8( u8"Ċਊ first" ) ), 0 );
+        ASSERT_THAT( QString::compare( log_data.getLines( 1, 2 ).at( 1 ), QString::fromUtf8( u8"third Ċ" ) ), 0 );
+        // The tab expanded and the surrogate pair counting as one character
+        ASSERT_THAT( log_data.getMaxLength(), 16 );
+    }
+}
@@ -11,6 +11,8 @@
 
 #define TMPDIR "/tmp"
 
+using namespace testing;
+
 static const qint64 SL_NB_LINES = 5000LL;
 static const int SL_LINE_PER_PAGE = 70;
 static const char* sl_format="LOGDATA is a part of glogg, we are going to test it thoroughly, this is line %06d\n";
@@ -68,3 +70,103 @@ TEST_F( MarksBehaviour, marksAreStored ) {
     ASSERT_TRUE( filtered_data->isLineMarked( 10 ) );
     ASSERT_TRUE( filtered_data->isLineMarked( 25 ) );
 }
+
+class MatchSpansBehaviour : public MarksBehaviour {
+  public:
+    void search( const QString& pattern ) {
+        SafeQSignalSpy progressSpy( filtered_data,
+                SIGNAL( searchProgressed( int, int, qint64 ) ) );
+
+        filtered_data->runSearch( QRegularExpression( pattern ) );
+
+        int percent = 0;
+        while ( percent < 100 ) {
+            if ( progressSpy.isEmpty() && ! progressSpy.wait( 10000 ) )
+                break;
+            percent = qvariant_cast<int>( progressSpy.takeFirst().at( 1 ) );
+        }
+    }
+};
+
+TEST_F( MatchSpansBehaviour, allMatchesInLineAreRecorded ) {
+    filtered_data->setMatchSpansRecorded( true );
+    search( "is" );
+
+    ASSERT_THAT( filtered_data->getNbMatches(), SL_NB_LINES );
+
+    MatchSpanList spans = filtered_data->getMatchSpans( 12 );
+    ASSERT_THAT( spans.size(), 3 );
+    ASSERT_THAT( spans[0].startColumn(), 8 );
+    ASSERT_THAT( spans[1].startColumn(), 66 );
+    ASSERT_THAT( spans[2].startColumn(), 69 );
+    ASSERT_THAT( spans[2].length(), 2 );
+}
+
+TEST_F( MatchSpansBehaviour, spansAreNotRecordedByDefault ) {
+    search( "is" );
+
+    ASSERT_THAT( filtered_data->getNbMatches(), SL_NB_LINES );
+    ASSERT_TRUE( filtered_data->getMatchSpans( 12 ).isEmpty() );
+}
+
+class FieldSearchBehaviour : public testing::Test {
+  public:
+    LogData log_data;
+    SafeQSignalSpy endSpy;
+    LogFilteredData* filtered_data = nullptr;
+
+    // Enough lines for several blocks of the field index
+    static const int NB_LINES = 10000;
+
+    FieldSearchBehaviour() : endSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) ) {
+        QFile file( TMPDIR "/structuredlog.txt" );
+        if ( file.open( QIODevice::WriteOnly ) ) {
+            char newLine[90];
+            for ( int i = 0; i < NB_LINES; i++ ) {
+                snprintf( newLine, 89, "level=info status=%d latency_ms=%d msg=\"request %d\"\n",
+                        ( i % 10 == 0 ) ? 500 : 200, i % 1000, i );
+                file.write( newLine, qstrlen( newLine ) );
+            }
+        }
+        file.close();
+
+        log_data.attachFile( TMPDIR "/structuredlog.txt" );
+        endSpy.safeWait( 10000 );
+
+        filtered_data = log_data.getNewFilteredData();
+    }
+
+    void search( const QString& text ) {
+        SafeQSignalSpy progressSpy( filtered_data,
+                SIGNAL( searchProgressed( int, int, qint64 ) ) );
+
+        QString error;
+        filtered_data->runFieldSearch( FieldQuery::parse( text, &error ) );
+
+        int percent = 0;
+        while ( percent < 100 ) {
+            if ( progressSpy.isEmpty() && ! progressSpy.wait( 10000 ) )
+                break;
+            percent = qvariant_cast<int>( progressSpy.takeFirst().at( 1 ) );
+        }
+    }
+};
+
+TEST_F( FieldSearchBehaviour, formatIsDetected ) {
+    ASSERT_THAT( log_data.getStructuredFormat(), Eq( StructuredFormat::Logfmt ) );
+}
+
+TEST_F( FieldSearchBehaviour, rangesAreMatched ) {
+    search( "status=500..599 latency_ms>=900" );
+
+    ASSERT_THAT( filtered_data->getNbMatches(), Eq( 100 ) );
+    ASSERT_THAT( filtered_data->getMatchingLineNumber( 0 ), Eq( 900 ) );
+    ASSERT_THAT( filtered_data->getNbLinesProcessed(), Eq( NB_LINES ) );
+}
+
+TEST_F( FieldSearchBehaviour, prefixesAreMatched ) {
+    search( "msg^=\"request 99\"" );
+
+    // 99, 990-999 and 9900-9999
+    ASSERT_THAT( filtered_data->getNbMatches(), Eq( 111 ) );
+}
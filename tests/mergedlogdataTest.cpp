@@ -0,0 +1,144 @@
+#include <QTest>
+#include <QSignalSpy>
+
+#include <memory>
+
+#include "log.h"
+#include "test_utils.h"
+
+#include "fileset.h"
+#include "data/mergedlogdata.h"
+#include "data/logfiltereddata.h"
+
+#include "gmock/gmock.h"
+
+#define TMPDIR "/tmp"
+
+// The first file has the even seconds, the second one the odd ones
+// (in another format).
+static const char* iso_format="2016-03-12 10:%02d:%02d.000 MERGED line %06d of a\n";
+static const char* apache_format="[12/Mar/2016:10:%02d:%02d +0000] MERGED line %06d of b\n";
+
+class MergedLogDataBehaviour : public testing::Test {
+  public:
+    MergedLogData log_data;
+    SafeQSignalSpy endSpy;
+
+    const QStringList files = { TMPDIR "/merged_a.log", TMPDIR "/merged_b.log" };
+
+    MergedLogDataBehaviour()
+        : endSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) ) {
+        QFile file_a( files[0] );
+        if ( file_a.open( QIODevice::WriteOnly ) ) {
+            for ( int i = 0; i < 50; i++ ) {
+                writeLine( &file_a, iso_format, i * 2, i );
+                // A line without timestamp after the 6th one
+                if ( i == 5 )
+                    file_a.write( "    continuation\n" );
+            }
+        }
+        file_a.close();
+
+        QFile file_b( files[1] );
+        if ( file_b.open( QIODevice::WriteOnly ) ) {
+            for ( int i = 0; i < 50; i++ )
+                writeLine( &file_b, apache_format, i * 2 + 1, i );
+        }
+        file_b.close();
+
+        log_data.attachFiles( files );
+        endSpy.safeWait( 10000 );
+    }
+
+    void writeLine( QFile* file, const char* format, int seconds, int line ) {
+        char newLine[90];
+
+        snprintf( newLine, 89, format, seconds / 60, seconds % 60, line );
+        file->write( newLine, qstrlen( newLine ) );
+    }
+};
+
+TEST_F( MergedLogDataBehaviour, loadingIsReportedOnce ) {
+    ASSERT_THAT( endSpy.count(), 1 );
+    ASSERT_THAT( log_data.getNbLine(), 101LL );
+}
+
+TEST_F( MergedLogDataBehaviour, linesAreInTimestampOrder ) {
+    ASSERT_THAT( log_data.getLineString( 0 ).toStdString(),
+            testing::EndsWith( "line 000000 of a" ) );
+    ASSERT_THAT( log_data.getLineString( 1 ).toStdString(),
+            testing::EndsWith( "line 000000 of b" ) );
+    ASSERT_THAT( log_data.getLineString( 2 ).toStdString(),
+            testing::EndsWith( "line 000001 of a" ) );
+    ASSERT_THAT( log_data.getLineString( 100 ).toStdString(),
+            testing::EndsWith( "line 000049 of b" ) );
+}
+
+TEST_F( MergedLogDataBehaviour, lineWithoutTimestampFollowsItsFile ) {
+    const QStringList lines = log_data.getExpandedLines( 10, 3 );
+
+    ASSERT_THAT( lines.size(), 3 );
+    ASSERT_THAT( lines[0].toStdString(), testing::EndsWith( "line 000005 of a" ) );
+    ASSERT_THAT( lines[1].toStdString(), testing::EndsWith( "continuation" ) );
+    ASSERT_THAT( lines[2].toStdString(), testing::EndsWith( "line 000005 of b" ) );
+}
+
+TEST_F( MergedLogDataBehaviour, lineSourceIsTheFile ) {
+    ASSERT_THAT( log_data.getLineSource( 0 ), 0 );
+    ASSERT_THAT( log_data.getLineSource( 1 ), 1 );
+    ASSERT_THAT( log_data.getLineSource( 11 ), 0 );
+    ASSERT_THAT( log_data.getLineSource( 101 ), -1 );
+}
+
+TEST_F( MergedLogDataBehaviour, searchReturnsMergedLineNumbers ) {
+    std::unique_ptr<LogFilteredData> filtered_data( log_data.getNewFilteredData() );
+    SafeQSignalSpy progressSpy( filtered_data.get(),
+            SIGNAL( searchProgressed( int, int, qint64 ) ) );
+
+    filtered_data->runSearch( QRegularExpression( "line 00000[0-1] of b" ) );
+
+    int percent = 0;
+    while ( percent < 100 ) {
+        if ( progressSpy.isEmpty() && ! progressSpy.wait( 10000 ) )
+            break;
+        percent = qvariant_cast<int>( progressSpy.takeFirst().at( 1 ) );
+    }
+
+    ASSERT_THAT( filtered_data->getNbMatches(), 2u );
+    ASSERT_THAT( filtered_data->getMatchingLineNumber( 0 ), 1LL );
+    ASSERT_THAT( filtered_data->getMatchingLineNumber( 1 ), 3LL );
+    ASSERT_THAT( filtered_data->getLineSource( 0 ), 1 );
+}
+
+TEST_F( MergedLogDataBehaviour, appendedLinesAreMergedAfterTheExistingOnes ) {
+    SafeQSignalSpy changedSpy( &log_data,
+            SIGNAL( fileChanged( AbstractLogSource::MonitoredFileStatus ) ) );
+    SafeQSignalSpy finishedSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+
+    QFile file_b( files[1] );
+    if ( file_b.open( QIODevice::Append ) ) {
+        writeLine( &file_b, apache_format, 0, 50 );
+        writeLine( &file_b, apache_format, 200, 51 );
+    }
+    file_b.close();
+
+    ASSERT_TRUE( finishedSpy.safeWait() );
+    ASSERT_THAT( changedSpy.last()[0].value<AbstractLogSource::MonitoredFileStatus>(),
+            AbstractLogSource::DataAdded );
+    ASSERT_THAT( log_data.getNbLine(), 103LL );
+    ASSERT_THAT( log_data.getLineString( 101 ).toStdString(),
+            testing::EndsWith( "line 000050 of b" ) );
+    ASSERT_THAT( log_data.getLineString( 102 ).toStdString(),
+            testing::EndsWith( "line 000051 of b" ) );
+}
+
+TEST( FileSetBehaviour, mergedSetNameGivesBackTheFiles ) {
+    const QStringList files = { "/var/log/a.log", "/var/log/b.log" };
+    const QString name = FileSet::nameForFiles( files, FileSet::Kind::Merged );
+
+    ASSERT_TRUE( FileSet::isFileSet( name ) );
+    ASSERT_TRUE( FileSet::isMergedSet( name ) );
+    ASSERT_FALSE( FileSet::isMergedSet( FileSet::nameForFiles( files ) ) );
+    ASSERT_THAT( FileSet::files( name ), files );
+    ASSERT_THAT( FileSet::displayName( name ).toStdString(), "/var/log/a.log (+1 merged)" );
+}
@@ -0,0 +1,435 @@
+// End to end performance scenarios, run against a generated corpus and
+// optionally compared to a baseline:
+//   glogg_perfscenarios [--corpus FILE] [--regenerate] [--generate-only]
+//                       [--size MiB] [--lengths short|mixed|long]
+//                       [--utf8] [--crlf] [--long-lines N] [--seed N]
+//                       [--repetitions N] [--follow-appends N]
+//                       [--baseline FILE] [--tolerance RATIO]
+//                       [--output FILE]
+//
+// The corpus is only generated if it doesn't exist (or with --regenerate),
+// so the same multi-GB file can be reused between runs.
+// The results written with --output can be used as a baseline later,
+// the tolerance of each metric can be edited in the file.
+// Returns 1 if a metric regressed more than its tolerance.
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSignalSpy>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include "log.h"
+#include "corpusgenerator.h"
+
+#include "data/logdata.h"
+#include "data/logfiltereddata.h"
+
+#define TMPDIR "/tmp"
+
+namespace {
+
+// Number of lines making a screen
+const int screenLines = 50;
+// Timeout of the operations (the corpus can be big)
+const int timeoutMs = 3600 * 1000;
+
+struct Metric {
+    std::string name;
+    std::string unit;
+    double value;
+    bool higherIsBetter;
+};
+
+double medianOf( std::vector<double> values )
+{
+    std::sort( values.begin(), values.end() );
+
+    const size_t middle = values.size() / 2;
+    return ( values.size() % 2 ) ? values[middle] :
+        ( values[middle - 1] + values[middle] ) / 2;
+}
+
+double percentileOf( std::vector<double> values, double percentile )
+{
+    std::sort( values.begin(), values.end() );
+
+    const size_t rank = static_cast<size_t>( percentile * ( values.size() - 1 ) + 0.5 );
+    return values[ std::min( rank, values.size() - 1 ) ];
+}
+
+// Returns the peak resident set size of the process in MiB (0 if unknown)
+double peakRssMiB()
+{
+#ifdef Q_OS_UNIX
+    struct rusage usage;
+    if ( getrusage( RUSAGE_SELF, &usage ) == 0 ) {
+#ifdef Q_OS_MAC
+        // In bytes on macOS
+        return usage.ru_maxrss / ( 1024.0 * 1024.0 );
+#else
+        // In KiB elsewhere
+        return usage.ru_maxrss / 1024.0;
+#endif
+    }
+#endif
+    return 0;
+}
+
+bool generateCorpus( const QString& file_name, const CorpusOptions& options )
+{
+    std::cout << "Generating " << file_name.toStdString() << "..." << std::endl;
+
+    std::ofstream file( file_name.toStdString(), std::ios::binary );
+    CorpusGenerator generator( options );
+    const uint64_t nb_lines = generator.write( file );
+
+    std::cout << nb_lines << " lines written." << std::endl;
+    return file.good();
+}
+
+// Attach and load the file, returns the time in ms until the first
+// screen can be read and until the whole file is indexed.
+bool openFile( const QString& file_name, double* first_screen_ms, double* index_ms )
+{
+    LogData log_data;
+    QSignalSpy progressSpy( &log_data, SIGNAL( loadingProgressed( int ) ) );
+    QSignalSpy endSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+
+    QElapsedTimer timer;
+    timer.start();
+    log_data.attachFile( file_name );
+
+    while ( log_data.getNbLine() < screenLines && endSpy.count() == 0 )
+        progressSpy.wait( 1 );
+    log_data.getLines( 0, screenLines );
+    *first_screen_ms = timer.nsecsElapsed() / 1e6;
+
+    if ( endSpy.count() == 0 && ! endSpy.wait( timeoutMs ) )
+        return false;
+    *index_ms = timer.nsecsElapsed() / 1e6;
+
+    return true;
+}
+
+// Search the whole file, returns the time in ms
+bool searchFile( LogFilteredData* filtered_data, const QString& regexp, double* search_ms )
+{
+    QSignalSpy progressSpy( filtered_data,
+            SIGNAL( searchProgressed( int, int, qint64 ) ) );
+
+    QElapsedTimer timer;
+    timer.start();
+    filtered_data->runSearch( QRegularExpression( regexp ) );
+
+    while ( progressSpy.isEmpty() || progressSpy.last()[1].toInt() < 100 ) {
+        if ( ! progressSpy.wait( timeoutMs ) )
+            return false;
+    }
+    *search_ms = timer.nsecsElapsed() / 1e6;
+
+    return true;
+}
+
+// Append batches of lines to a followed file, returns the time in ms
+// between the end of each write and the end of its indexing.
+bool followFile( int nb_appends, std::vector<double>* latencies_ms )
+{
+    const QString file_name = TMPDIR "/glogg_perf_follow.log";
+
+    CorpusOptions options;
+    options.maxLines = 10000;
+    CorpusGenerator generator( options );
+    {
+        std::ofstream file( file_name.toStdString(), std::ios::binary );
+        generator.write( file );
+    }
+
+    LogData log_data;
+    QSignalSpy endSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    log_data.attachFile( file_name );
+    if ( ! endSpy.wait( timeoutMs ) )
+        return false;
+
+    for ( int i = 0; i < nb_appends; ++i ) {
+        endSpy.clear();
+        {
+            std::ofstream file( file_name.toStdString(),
+                    std::ios::binary | std::ios::app );
+            for ( int j = 0; j < 100; ++j )
+                file << generator.nextLine() << generator.endOfLine();
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        if ( ! endSpy.wait( 10000 ) )
+            return false;
+        latencies_ms->push_back( timer.nsecsElapsed() / 1e6 );
+    }
+
+    QFile::remove( file_name );
+
+    return true;
+}
+
+// Compare the metrics to the baseline, returns false if one regressed
+bool compareToBaseline( const std::vector<Metric>& metrics,
+        const QJsonObject& baseline, double default_tolerance )
+{
+    const QJsonObject baseline_metrics = baseline["metrics"].toObject();
+
+    bool ok = true;
+    std::cout << std::endl << std::left << std::setw( 28 ) << "metric"
+        << std::right << std::setw( 14 ) << "baseline"
+        << std::setw( 14 ) << "current"
+        << std::setw( 10 ) << "change" << "  status" << std::endl;
+
+    for ( const auto& metric: metrics ) {
+        const QString name = QString::fromStdString( metric.name );
+        if ( ! baseline_metrics.contains( name ) )
+            continue;
+
+        const QJsonObject reference = baseline_metrics[name].toObject();
+        const double base = reference["value"].toDouble();
+        const double tolerance = reference.contains( "tolerance" ) ?
+            reference["tolerance"].toDouble() : default_tolerance;
+        if ( base <= 0 || metric.value <= 0 )
+            continue;
+
+        // Positive when worse
+        const double change = ( metric.value - base ) / base;
+        const double worsening = metric.higherIsBetter ? -change : change;
+
+        std::string status = "ok";
+        if ( worsening > tolerance ) {
+            status = "REGRESSION";
+            ok = false;
+        }
+        else if ( worsening < -tolerance ) {
+            status = "improved";
+        }
+
+        std::cout << std::left << std::setw( 28 ) << metric.name << std::right
+            << std::fixed << std::setprecision( 2 )
+            << std::setw( 14 ) << base
+            << std::setw( 14 ) << metric.value
+            << std::setprecision( 1 )
+            << std::setw( 9 ) << change * 100 << "%"
+            << "  " << status << std::endl;
+    }
+
+    return ok;
+}
+
+QJsonObject toJson( const std::vector<Metric>& metrics,
+        const QJsonObject& corpus, double default_tolerance )
+{
+    QJsonObject json_metrics;
+    for ( const auto& metric: metrics ) {
+        QJsonObject json_metric;
+        json_metric["value"] = metric.value;
+        json_metric["unit"] = QString::fromStdString( metric.unit );
+        json_metric["higher_is_better"] = metric.higherIsBetter;
+        json_metric["tolerance"] = default_tolerance;
+        json_metrics[ QString::fromStdString( metric.name ) ] = json_metric;
+    }
+
+    QJsonObject json;
+    json["corpus"] = corpus;
+    json["metrics"] = json_metrics;
+
+    return json;
+}
+
+}
+
+int main( int argc, char* argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    FILELog::setReportingLevel( logERROR );
+
+    QString corpus_file = TMPDIR "/glogg_perf_corpus.log";
+    bool regenerate = false;
+    bool generate_only = false;
+    int repetitions = 3;
+    int follow_appends = 20;
+    double tolerance = 0.1;
+    QString baseline_file;
+    QString output_file;
+
+    CorpusOptions corpus;
+    corpus.maxBytes = 1024ULL * 1024 * 1024;
+    corpus.longLineEvery = 100000;
+
+    const QStringList args = app.arguments();
+    for ( int i = 1; i < args.size(); ++i ) {
+        if ( args[i] == "--regenerate" )
+            regenerate = true;
+        else if ( args[i] == "--generate-only" )
+            generate_only = true;
+        else if ( args[i] == "--utf8" )
+            corpus.utf8 = true;
+        else if ( args[i] == "--crlf" )
+            corpus.crlf = true;
+        else if ( i + 1 < args.size() ) {
+            const QString& value = args[++i];
+            if ( args[i - 1] == "--corpus" )
+                corpus_file = value;
+            else if ( args[i - 1] == "--size" )
+                corpus.maxBytes = value.toULongLong() * 1024 * 1024;
+            else if ( args[i - 1] == "--lengths" )
+                corpus.lengths = value.toStdString();
+            else if ( args[i - 1] == "--long-lines" )
+                corpus.longLineEvery = value.toULongLong();
+            else if ( args[i - 1] == "--seed" )
+                corpus.seed = value.toUInt();
+            else if ( args[i - 1] == "--repetitions" )
+                repetitions = std::max( 1, value.toInt() );
+            else if ( args[i - 1] == "--follow-appends" )
+                follow_appends = std::max( 1, value.toInt() );
+            else if ( args[i - 1] == "--baseline" )
+                baseline_file = value;
+            else if ( args[i - 1] == "--tolerance" )
+                tolerance = value.toDouble();
+            else if ( args[i - 1] == "--output" )
+                output_file = value;
+            else {
+                std::cerr << "Unknown option " << args[i - 1].toStdString() << std::endl;
+                return 2;
+            }
+        }
+        else {
+            std::cerr << "Unknown option " << args[i].toStdString() << std::endl;
+            return 2;
+        }
+    }
+
+    if ( regenerate || generate_only || ! QFileInfo::exists( corpus_file ) ) {
+        if ( ! generateCorpus( corpus_file, corpus ) ) {
+            std::cerr << "Cannot write " << corpus_file.toStdString() << std::endl;
+            return 2;
+        }
+    }
+    if ( generate_only )
+        return 0;
+
+    const double file_mib = QFileInfo( corpus_file ).size() / ( 1024.0 * 1024.0 );
+    std::vector<Metric> metrics;
+
+    // Opening and indexing
+    std::vector<double> first_screen_ms, index_ms;
+    for ( int i = 0; i < repetitions; ++i ) {
+        double first_screen, index;
+        if ( ! openFile( corpus_file, &first_screen, &index ) ) {
+            std::cerr << "Timeout indexing the corpus" << std::endl;
+            return 2;
+        }
+        first_screen_ms.push_back( first_screen );
+        index_ms.push_back( index );
+    }
+    metrics.push_back( { "open_to_first_screen_ms", "ms", medianOf( first_screen_ms ), false } );
+    metrics.push_back( { "full_index_ms", "ms", medianOf( index_ms ), false } );
+    metrics.push_back( { "index_throughput_mib_s", "MiB/s",
+            file_mib * 1000 / medianOf( index_ms ), true } );
+
+    // Searching, a simple word then a regular expression
+    {
+        LogData log_data;
+        QSignalSpy endSpy( &log_data, SIGNAL( loadingFinished( LoadingStatus ) ) );
+        log_data.attachFile( corpus_file );
+        if ( ! endSpy.wait( timeoutMs ) ) {
+            std::cerr << "Timeout indexing the corpus" << std::endl;
+            return 2;
+        }
+
+        std::unique_ptr<LogFilteredData> filtered_data( log_data.getNewFilteredData() );
+
+        const std::vector<std::pair<std::string, QString>> searches = {
+            { "word", corpusNeedle },
+            { "regexp", "ERROR.*(failed|retrying)" } };
+        for ( const auto& search: searches ) {
+            std::vector<double> search_ms;
+            for ( int i = 0; i < repetitions; ++i ) {
+                double ms;
+                if ( ! searchFile( filtered_data.get(), search.second, &ms ) ) {
+                    std::cerr << "Timeout searching the corpus" << std::endl;
+                    return 2;
+                }
+                search_ms.push_back( ms );
+            }
+            metrics.push_back( { "search_" + search.first + "_ms", "ms",
+                    medianOf( search_ms ), false } );
+            metrics.push_back( { "search_" + search.first + "_throughput_mib_s", "MiB/s",
+                    file_mib * 1000 / medianOf( search_ms ), true } );
+        }
+    }
+
+    // Following
+    std::vector<double> follow_ms;
+    if ( ! followFile( follow_appends, &follow_ms ) ) {
+        std::cerr << "Timeout following a file" << std::endl;
+        return 2;
+    }
+    metrics.push_back( { "follow_latency_p50_ms", "ms", percentileOf( follow_ms, 0.5 ), false } );
+    metrics.push_back( { "follow_latency_p95_ms", "ms", percentileOf( follow_ms, 0.95 ), false } );
+
+    metrics.push_back( { "peak_rss_mib", "MiB", peakRssMiB(), false } );
+
+    std::cout << std::left << std::setw( 28 ) << "metric"
+        << std::right << std::setw( 14 ) << "value" << std::endl;
+    for ( const auto& metric: metrics ) {
+        std::cout << std::left << std::setw( 28 ) << metric.name << std::right
+            << std::fixed << std::setprecision( 2 )
+            << std::setw( 14 ) << metric.value << " " << metric.unit << std::endl;
+    }
+
+    QJsonObject corpus_description;
+    corpus_description["file"] = corpus_file;
+    corpus_description["size_mib"] = file_mib;
+
+    if ( ! output_file.isEmpty() ) {
+        QFile output( output_file );
+        if ( ! output.open( QIODevice::WriteOnly ) ) {
+            std::cerr << "Cannot write " << output_file.toStdString() << std::endl;
+            return 2;
+        }
+        output.write( QJsonDocument(
+                    toJson( metrics, corpus_description, tolerance ) ).toJson() );
+    }
+
+    if ( ! baseline_file.isEmpty() ) {
+        QFile baseline( baseline_file );
+        if ( ! baseline.open( QIODevice::ReadOnly ) ) {
+            std::cerr << "Cannot read " << baseline_file.toStdString() << std::endl;
+            return 2;
+        }
+        const QJsonObject reference = QJsonDocument::fromJson( baseline.readAll() ).object();
+
+        const double baseline_mib = reference["corpus"].toObject()["size_mib"].toDouble();
+        if ( std::abs( baseline_mib - file_mib ) > file_mib / 100 )
+            std::cout << "Warning: the baseline was measured on a "
+                << baseline_mib << " MiB corpus" << std::endl;
+
+        if ( ! compareToBaseline( metrics, reference, tolerance ) )
+            return 1;
+    }
+
+    return 0;
+}
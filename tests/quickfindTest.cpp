@@ -0,0 +1,145 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QElapsedTimer>
+
+#include "log.h"
+
+#include "test_utils.h"
+
+#include "quickfindpattern.h"
+#include "selection.h"
+#include "quickfind.h"
+
+#include "gmock/gmock.h"
+
+using namespace std;
+using namespace testing;
+
+static const int QF_NB_LINES = 5000;
+
+class QuickFindBehaviour : public testing::Test {
+  public:
+    MemoryLogData data;
+    QuickFindPattern pattern;
+    Selection selection;
+    QuickFind quickFind;
+    SafeQSignalSpy doneSpy;
+
+    QuickFindBehaviour() : data(), pattern(), selection(),
+        quickFind( &data, &selection, &pattern ),
+        doneSpy( &quickFind, SIGNAL( searchDone( qint64 ) ) ) {}
+
+    // Lines matching 'foo' around the chunk boundaries
+    void generateData() {
+        for ( int i = 0; i < QF_NB_LINES; ++i ) {
+            if ( i == 1000 || i == 1001 || i == 3999 )
+                data.lines << QString( "foo at line %1" ).arg( i );
+            else
+                data.lines << QString( "nothing at line %1" ).arg( i );
+        }
+        pattern.changeSearchPattern( "foo", false );
+    }
+
+    // Returns the line passed by searchDone
+    qint64 waitSearchDone() {
+        if ( ! doneSpy.safeWait() )
+            return -2;
+        return qvariant_cast<qint64>( doneSpy.takeFirst().at( 0 ) );
+    }
+};
+
+TEST_F( QuickFindBehaviour, ForwardSearchFindsMatchesAcrossChunks ) {
+    generateData();
+
+    quickFind.searchForward();
+    ASSERT_THAT( waitSearchDone(), Eq( 1000 ) );
+    ASSERT_TRUE( selection.isPortion() );
+    ASSERT_THAT( selection.getNextPosition().line(), Eq( 1000 ) );
+
+    quickFind.searchForward();
+    ASSERT_THAT( waitSearchDone(), Eq( 1001 ) );
+
+    quickFind.searchForward();
+    ASSERT_THAT( waitSearchDone(), Eq( 3999 ) );
+
+    quickFind.searchForward();
+    ASSERT_THAT( waitSearchDone(), Eq( -1 ) );
+    ASSERT_FALSE( quickFind.isSearching() );
+}
+
+TEST_F( QuickFindBehaviour, BackwardSearchFindsMatchesAcrossChunks ) {
+    generateData();
+    selection.selectLine( QF_NB_LINES - 1 );
+
+    quickFind.searchBackward();
+    ASSERT_THAT( waitSearchDone(), Eq( 3999 ) );
+
+    quickFind.searchBackward();
+    ASSERT_THAT( waitSearchDone(), Eq( 1001 ) );
+
+    quickFind.searchBackward();
+    ASSERT_THAT( waitSearchDone(), Eq( 1000 ) );
+
+    quickFind.searchBackward();
+    ASSERT_THAT( waitSearchDone(), Eq( -1 ) );
+    ASSERT_FALSE( quickFind.isSearching() );
+}
+
+class SlowQuickFindBehaviour : public QuickFindBehaviour {
+  public:
+    // Long lines nearly matching everywhere, so each one is slow
+    // to search (they share the same data).
+    void generateData() {
+        const QString line = QString( 1000000, QChar( 'f' ) );
+        data.lines << "foo";
+        for ( int i = 1; i < 2000; ++i )
+            data.lines << line;
+        data.lines << "foo";
+        pattern.changeSearchPattern( "foo", false );
+    }
+};
+
+TEST_F( SlowQuickFindBehaviour, SearchGoesBackToTheEventLoopOnLongLines ) {
+    generateData();
+    selection.selectLine( 0 );
+
+    QElapsedTimer timer;
+    timer.start();
+    quickFind.searchForward();
+
+    // A chunk of these lines is far longer than the time slice
+    ASSERT_THAT( timer.elapsed(), Lt( 500 ) );
+    ASSERT_TRUE( quickFind.isSearching() );
+    ASSERT_THAT( doneSpy.count(), Eq( 0 ) );
+
+    quickFind.cancelSearch();
+}
+
+TEST_F( SlowQuickFindBehaviour, CancelledSearchIsNotReported ) {
+    generateData();
+    selection.selectLine( 0 );
+
+    quickFind.searchForward();
+    ASSERT_TRUE( quickFind.isSearching() );
+
+    quickFind.cancelSearch();
+    ASSERT_FALSE( quickFind.isSearching() );
+
+    QTest::qWait( 200 );
+    ASSERT_THAT( doneSpy.count(), Eq( 0 ) );
+    ASSERT_FALSE( selection.isPortion() );
+}
+
+TEST_F( SlowQuickFindBehaviour, NewSearchReplacesTheOngoingOne ) {
+    generateData();
+    selection.selectLine( 1000 );
+
+    quickFind.searchForward();
+    ASSERT_TRUE( quickFind.isSearching() );
+
+    quickFind.searchBackward();
+
+    ASSERT_THAT( waitSearchDone(), Eq( 0 ) );
+    QTest::qWait( 200 );
+    ASSERT_THAT( doneSpy.count(), Eq( 0 ) );
+}
@@ -0,0 +1,175 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QElapsedTimer>
+
+#include "log.h"
+
+#include "test_utils.h"
+
+#include "quickfindpattern.h"
+#include "quickfindindex.h"
+
+#include "gmock/gmock.h"
+
+using namespace std;
+using namespace testing;
+
+class QuickFindIndexBehaviour : public testing::Test {
+  public:
+    MemoryLogData data;
+    QuickFindPattern pattern;
+    QuickFindIndex index;
+
+    QuickFindIndexBehaviour() : data(), pattern(), index( &data, &pattern ) {}
+
+    // Returns whether the index has finished (complete or given up)
+    bool waitIndexed( int timeout = 10000 ) {
+        QElapsedTimer timer;
+        timer.start();
+        while ( index.isUsable() && ( ! index.isComplete() ) ) {
+            if ( timer.elapsed() > timeout )
+                return false;
+            QTest::qWait( 5 );
+        }
+        return true;
+    }
+
+    void search( const QString& text ) {
+        pattern.changeSearchPattern( text, false );
+        index.rebuild();
+        ASSERT_TRUE( waitIndexed() );
+    }
+};
+
+TEST_F( QuickFindIndexBehaviour, OccurrencesAreIndexedInOrder ) {
+    data.lines << "xxfooxxfoo" << "nothing here" << "foo";
+    search( "foo" );
+
+    ASSERT_TRUE( index.isComplete() );
+    ASSERT_THAT( index.nbOccurrences(), Eq( 3 ) );
+    ASSERT_THAT( index.occurrence( 0 ).line(), Eq( 0u ) );
+    ASSERT_THAT( index.occurrence( 0 ).startColumn(), Eq( 2 ) );
+    ASSERT_THAT( index.occurrence( 0 ).endColumn(), Eq( 4 ) );
+    ASSERT_THAT( index.occurrence( 1 ).startColumn(), Eq( 7 ) );
+    ASSERT_THAT( index.occurrence( 2 ).line(), Eq( 2u ) );
+}
+
+TEST_F( QuickFindIndexBehaviour, NextOccurrenceStartsAtOrAfterPosition ) {
+    data.lines << "xxfooxxfoo" << "nothing here" << "foo";
+    search( "foo" );
+
+    ASSERT_THAT( index.findNext( FilePosition( 0, 0 ) ), Eq( 0 ) );
+    ASSERT_THAT( index.findNext( FilePosition( 0, 2 ) ), Eq( 0 ) );
+    ASSERT_THAT( index.findNext( FilePosition( 0, 3 ) ), Eq( 1 ) );
+    ASSERT_THAT( index.findNext( FilePosition( 0, 8 ) ), Eq( 2 ) );
+    ASSERT_THAT( index.findNext( FilePosition( 1, 0 ) ), Eq( 2 ) );
+    ASSERT_THAT( index.findNext( FilePosition( 2, 1 ) ), Eq( -1 ) );
+}
+
+TEST_F( QuickFindIndexBehaviour, PreviousOccurrenceEndsBeforePosition ) {
+    data.lines << "xxfooxxfoo" << "nothing here" << "foo";
+    search( "foo" );
+
+    // The first occurrence covers columns 2 to 4
+    ASSERT_THAT( index.findPrevious( FilePosition( 0, 5 ) ), Eq( -1 ) );
+    ASSERT_THAT( index.findPrevious( FilePosition( 0, 6 ) ), Eq( 0 ) );
+    // The second one columns 7 to 9
+    ASSERT_THAT( index.findPrevious( FilePosition( 0, 10 ) ), Eq( 0 ) );
+    ASSERT_THAT( index.findPrevious( FilePosition( 0, 11 ) ), Eq( 1 ) );
+}
+
+TEST_F( QuickFindIndexBehaviour, PreviousOccurrenceWithoutColumnIsOnPreviousLines ) {
+    data.lines << "xxfooxxfoo" << "nothing here" << "foo";
+    search( "foo" );
+
+    ASSERT_THAT( index.findPrevious( FilePosition( 0, 0 ) ), Eq( -1 ) );
+    ASSERT_THAT( index.findPrevious( FilePosition( 1, 0 ) ), Eq( 1 ) );
+    ASSERT_THAT( index.findPrevious( FilePosition( 2, -1 ) ), Eq( 1 ) );
+    ASSERT_THAT( index.findPrevious( FilePosition( 3, 0 ) ), Eq( 2 ) );
+}
+
+TEST_F( QuickFindIndexBehaviour, OccurrencesOfALineAreGivenBack ) {
+    data.lines << "xxfooxxfoo" << "nothing here" << "foo";
+    search( "foo" );
+
+    QList<QuickFindMatch> matches;
+    ASSERT_TRUE( index.getLineOccurrences( 0, &matches ) );
+    ASSERT_THAT( matches.size(), Eq( 2 ) );
+    ASSERT_THAT( matches[1].startColumn(), Eq( 7 ) );
+    ASSERT_THAT( matches[1].length(), Eq( 3 ) );
+
+    matches.clear();
+    ASSERT_TRUE( index.getLineOccurrences( 1, &matches ) );
+    ASSERT_TRUE( matches.isEmpty() );
+
+    // Not indexed
+    ASSERT_FALSE( index.getLineOccurrences( 3, &matches ) );
+}
+
+TEST_F( QuickFindIndexBehaviour, TooManyOccurrencesDisableTheIndex ) {
+    // 101 occurrences per line
+    const QString line = QString( "a " ).repeated( 101 );
+    const int nb_lines = QuickFindIndex::MAX_OCCURRENCES / 101 + 1;
+    for ( int i = 0; i < nb_lines; ++i )
+        data.lines << line;
+
+    search( "a" );
+
+    ASSERT_FALSE( index.isUsable() );
+    ASSERT_FALSE( index.isComplete() );
+    ASSERT_THAT( index.nbOccurrences(), Eq( 0 ) );
+    ASSERT_THAT( index.findNext( FilePosition( 0, 0 ) ), Eq( -1 ) );
+
+    // Adding lines doesn't restart it
+    data.lines << "a";
+    index.extend();
+    QTest::qWait( 50 );
+    ASSERT_FALSE( index.isUsable() );
+    ASSERT_THAT( index.nbOccurrences(), Eq( 0 ) );
+
+    // But a new pattern does
+    search( "b" );
+    ASSERT_TRUE( index.isComplete() );
+    ASSERT_THAT( index.nbOccurrences(), Eq( 0 ) );
+}
+
+TEST_F( QuickFindIndexBehaviour, AppendedLinesExtendTheIndex ) {
+    for ( int i = 0; i < 100; ++i )
+        data.lines << QString( "line %1 foo" ).arg( i );
+    search( "foo" );
+    ASSERT_THAT( index.nbOccurrences(), Eq( 100 ) );
+
+    for ( int i = 100; i < 150; ++i )
+        data.lines << QString( "line %1 foo" ).arg( i );
+    index.extend();
+
+    // The lines already indexed are kept
+    ASSERT_THAT( index.nbIndexedLines(), Eq( 100 ) );
+    ASSERT_THAT( index.nbOccurrences(), Eq( 100 ) );
+
+    ASSERT_TRUE( waitIndexed() );
+    ASSERT_THAT( index.nbIndexedLines(), Eq( 150 ) );
+    ASSERT_THAT( index.nbOccurrences(), Eq( 150 ) );
+    ASSERT_THAT( index.occurrence( 149 ).line(), Eq( 149u ) );
+}
+
+TEST_F( QuickFindIndexBehaviour, RemovedLinesRebuildTheIndex ) {
+    for ( int i = 0; i < 100; ++i )
+        data.lines << QString( "line %1 foo" ).arg( i );
+    search( "foo" );
+    ASSERT_THAT( index.nbOccurrences(), Eq( 100 ) );
+
+    data.lines.clear();
+    for ( int i = 0; i < 20; ++i )
+        data.lines << ( ( i % 2 ) ? QString( "foo" ) : QString( "bar" ) );
+    index.extend();
+
+    // Everything is thrown away
+    ASSERT_THAT( index.nbIndexedLines(), Eq( 0 ) );
+    ASSERT_THAT( index.nbOccurrences(), Eq( 0 ) );
+
+    ASSERT_TRUE( waitIndexed() );
+    ASSERT_THAT( index.nbIndexedLines(), Eq( 20 ) );
+    ASSERT_THAT( index.nbOccurrences(), Eq( 10 ) );
+    ASSERT_THAT( index.occurrence( 0 ).line(), Eq( 1u ) );
+}
@@ -0,0 +1,250 @@
+#include "gmock/gmock.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "log.h"
+
+#include "data/taskscheduler.h"
+
+using namespace std;
+using namespace testing;
+
+class TaskSchedulerBehaviour: public testing::Test {
+  public:
+    // One thread, so the order of the tasks can be checked
+    TaskScheduler scheduler { 1 };
+
+    mutex lock_;
+    condition_variable cond_;
+    bool blocked_ = false;
+    bool released_ = false;
+    vector<string> executed_;
+
+    ~TaskSchedulerBehaviour() {
+        // Don't leave the thread blocked if a test failed
+        release();
+    }
+
+    // Submit a task blocking the thread until release() is called
+    // and wait for it to be running
+    void blockThread() {
+        scheduler.submit( TaskPriority::Search, nullptr, [this] {
+                unique_lock<mutex> lock( lock_ );
+                blocked_ = true;
+                cond_.notify_all();
+                cond_.wait( lock, [this] { return released_; } ); } );
+
+        unique_lock<mutex> lock( lock_ );
+        cond_.wait( lock, [this] { return blocked_; } );
+    }
+
+    void release() {
+        {
+            lock_guard<mutex> lock( lock_ );
+            released_ = true;
+        }
+        cond_.notify_all();
+    }
+
+    TaskScheduler::TaskId submitNamed( const string& name, TaskPriority priority,
+            const atomic<bool>* foreground = nullptr ) {
+        return scheduler.submit( priority, foreground, [this, name] {
+                lock_guard<mutex> lock( lock_ );
+                executed_.push_back( name );
+                cond_.notify_all(); } );
+    }
+
+    // Wait for nb tasks to have been executed
+    bool waitForTasks( size_t nb ) {
+        unique_lock<mutex> lock( lock_ );
+        return cond_.wait_for( lock, chrono::seconds( 5 ),
+                [this, nb] { return executed_.size() >= nb; } );
+    }
+};
+
+TEST_F( TaskSchedulerBehaviour, SubmittedTasksAreRun ) {
+    submitNamed( "a", TaskPriority::Indexing );
+    submitNamed( "b", TaskPriority::Indexing );
+
+    ASSERT_TRUE( waitForTasks( 2 ) );
+    ASSERT_THAT( executed_, ElementsAre( "a", "b" ) );
+}
+
+TEST_F( TaskSchedulerBehaviour, SearchesAreRunBeforeIndexing ) {
+    blockThread();
+    submitNamed( "index1", TaskPriority::Indexing );
+    submitNamed( "search", TaskPriority::Search );
+    submitNamed( "index2", TaskPriority::Indexing );
+    release();
+
+    ASSERT_TRUE( waitForTasks( 3 ) );
+    ASSERT_THAT( executed_, ElementsAre( "search", "index1", "index2" ) );
+}
+
+TEST_F( TaskSchedulerBehaviour, ForegroundTasksAreRunFirst ) {
+    atomic<bool> foreground { false };
+    atomic<bool> background { false };
+
+    blockThread();
+    submitNamed( "background", TaskPriority::Search, &background );
+    submitNamed( "foreground", TaskPriority::Indexing, &foreground );
+    // The file is displayed after its task is queued
+    foreground = true;
+    release();
+
+    ASSERT_TRUE( waitForTasks( 2 ) );
+    ASSERT_THAT( executed_, ElementsAre( "foreground", "background" ) );
+}
+
+TEST_F( TaskSchedulerBehaviour, QueuedTaskCanBeCancelled ) {
+    blockThread();
+    const auto id = submitNamed( "cancelled", TaskPriority::Indexing );
+    submitNamed( "run", TaskPriority::Indexing );
+
+    ASSERT_TRUE( scheduler.cancel( id ) );
+    ASSERT_THAT( scheduler.nbQueuedTasks(), Eq( 1 ) );
+    release();
+
+    ASSERT_TRUE( waitForTasks( 1 ) );
+    ASSERT_THAT( executed_, ElementsAre( "run" ) );
+}
+
+TEST_F( TaskSchedulerBehaviour, StartedTaskCannotBeCancelled ) {
+    const auto id = submitNamed( "started", TaskPriority::Indexing );
+
+    ASSERT_TRUE( waitForTasks( 1 ) );
+    ASSERT_FALSE( scheduler.cancel( id ) );
+}
+
+TEST_F( TaskSchedulerBehaviour, QueuedTasksOfAGroupAreCancelled ) {
+    TaskGroup group( scheduler, TaskPriority::Search );
+
+    blockThread();
+    group.submit( 2, [this] {
+            lock_guard<mutex> lock( lock_ );
+            executed_.push_back( "grouped" ); } );
+
+    // Does not wait for the blocked thread
+    group.cancelAndWait();
+    ASSERT_THAT( scheduler.nbQueuedTasks(), Eq( 0 ) );
+    release();
+
+    submitNamed( "after", TaskPriority::Indexing );
+    ASSERT_TRUE( waitForTasks( 1 ) );
+    ASSERT_THAT( executed_, ElementsAre( "after" ) );
+}
+
+TEST( TaskSchedulerPool, TasksRunInParallel ) {
+    TaskScheduler scheduler( 4 );
+
+    mutex lock;
+    condition_variable cond;
+    int nb_running = 0;
+
+    // Each task waits for all of them to be running
+    for ( int i = 0; i < 4; ++i )
+        scheduler.submit( TaskPriority::Search, nullptr, [&] {
+                unique_lock<mutex> l( lock );
+                ++nb_running;
+                cond.notify_all();
+                cond.wait_for( l, chrono::seconds( 5 ),
+                        [&] { return nb_running == 4; } ); } );
+
+    unique_lock<mutex> l( lock );
+    ASSERT_TRUE( cond.wait_for( l, chrono::seconds( 5 ),
+                [&] { return nb_running == 4; } ) );
+}
+
+TEST( TaskSchedulerPool, LastTaskOfAGroupIsNotified ) {
+    TaskScheduler scheduler( 4 );
+    TaskGroup group( scheduler, TaskPriority::Search );
+
+    atomic<int> nb_run { 0 };
+    mutex lock;
+    condition_variable cond;
+    int nb_last = 0;
+    int nb_run_at_last = 0;
+
+    group.submit( 8, [&] { ++nb_run; }, [&] {
+            lock_guard<mutex> l( lock );
+            ++nb_last;
+            nb_run_at_last = nb_run;
+            cond.notify_all(); } );
+
+    {
+        unique_lock<mutex> l( lock );
+        ASSERT_TRUE( cond.wait_for( l, chrono::seconds( 5 ),
+                    [&] { return nb_last > 0; } ) );
+    }
+    group.cancelAndWait();
+
+    ASSERT_THAT( nb_last, Eq( 1 ) );
+    ASSERT_THAT( nb_run_at_last, Eq( 8 ) );
+}
+
+TEST( TaskSchedulerPool, BackgroundIndexingLeavesAThreadFree ) {
+    TaskScheduler scheduler( 2 );
+
+    mutex lock;
+    condition_variable cond;
+    bool released = false;
+    int nb_indexing = 0;
+    bool searched = false;
+    bool foreground_indexed = false;
+
+    auto indexing = [&] {
+        unique_lock<mutex> l( lock );
+        ++nb_indexing;
+        cond.notify_all();
+        cond.wait( l, [&] { return released; } ); };
+
+    scheduler.submit( TaskPriority::Indexing, nullptr, indexing );
+    scheduler.submit( TaskPriority::Indexing, nullptr, indexing );
+
+    // The second one waits for the first
+    {
+        unique_lock<mutex> l( lock );
+        ASSERT_TRUE( cond.wait_for( l, chrono::seconds( 5 ),
+                    [&] { return nb_indexing == 1; } ) );
+        ASSERT_FALSE( cond.wait_for( l, chrono::milliseconds( 100 ),
+                    [&] { return nb_indexing > 1; } ) );
+    }
+
+    // Whilst a search is run straight away
+    scheduler.submit( TaskPriority::Search, nullptr, [&] {
+            lock_guard<mutex> l( lock );
+            searched = true;
+            cond.notify_all(); } );
+    {
+        unique_lock<mutex> l( lock );
+        ASSERT_TRUE( cond.wait_for( l, chrono::seconds( 5 ),
+                    [&] { return searched; } ) );
+    }
+
+    // And so is the indexing of a file brought to the foreground
+    atomic<bool> foreground { false };
+    scheduler.submit( TaskPriority::Indexing, &foreground, [&] {
+            lock_guard<mutex> l( lock );
+            foreground_indexed = true;
+            cond.notify_all(); } );
+    foreground = true;
+    scheduler.foregroundChanged();
+    {
+        unique_lock<mutex> l( lock );
+        ASSERT_TRUE( cond.wait_for( l, chrono::seconds( 5 ),
+                    [&] { return foreground_indexed; } ) );
+        released = true;
+    }
+    cond.notify_all();
+
+    // The queued one is run in the end
+    {
+        unique_lock<mutex> l( lock );
+        ASSERT_TRUE( cond.wait_for( l, chrono::seconds( 5 ),
+                    [&] { return nb_indexing == 2; } ) );
+    }
+}
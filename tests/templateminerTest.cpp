@@ -0,0 +1,153 @@
+#include <QTest>
+#include <QSignalSpy>
+#include <QFile>
+
+#include <memory>
+
+#include "log.h"
+#include "test_utils.h"
+
+#include "data/logdata.h"
+#include "data/logfiltereddata.h"
+#include "data/templateminer.h"
+
+#include "gmock/gmock.h"
+
+#define TMPDIR "/tmp"
+
+using namespace testing;
+
+TEST( DrainTreeBehaviour, variablesAreReplacedByWildcards ) {
+    const QStringList tokens = DrainTree::tokenize( "  User 42 logged\tin from host-a7 " );
+
+    ASSERT_THAT( tokens.join( ' ' ).toStdString(), "User <*> logged in from <*>" );
+}
+
+TEST( DrainTreeBehaviour, similarLinesShareATemplate ) {
+    DrainTree tree;
+
+    const int first = tree.add( DrainTree::tokenize( "Sending file alpha to server" ) );
+    const int second = tree.add( DrainTree::tokenize( "Sending file beta to server" ) );
+    const int other = tree.add( DrainTree::tokenize( "Sending file beta" ) );
+
+    ASSERT_THAT( second, Eq( first ) );
+    ASSERT_THAT( other, Ne( first ) );
+    ASSERT_THAT( tree.nbTemplates(), Eq( 2 ) );
+    ASSERT_THAT( tree.tokens( first ).join( ' ' ).toStdString(),
+            "Sending file <*> to server" );
+    ASSERT_THAT( tree.count( first ), Eq( 2 ) );
+}
+
+TEST( DrainTreeBehaviour, differentLinesDoNotShareATemplate ) {
+    DrainTree tree;
+
+    // Same length and first tokens, but few tokens in common
+    const int first = tree.add( DrainTree::tokenize(
+                "Request handled by worker pool quickly and cleanly" ) );
+    const int second = tree.add( DrainTree::tokenize(
+                "Request handled by another node after retry twice" ) );
+
+    ASSERT_THAT( second, Ne( first ) );
+}
+
+TEST( DrainTreeBehaviour, templatesAreAddedWithTheirCount ) {
+    DrainTree part;
+    part.add( DrainTree::tokenize( "Job done for alpha" ) );
+    part.add( DrainTree::tokenize( "Job done for beta" ) );
+
+    DrainTree whole;
+    whole.add( DrainTree::tokenize( "Job done for gamma" ) );
+    const int id = whole.add( part.tokens( 0 ), part.count( 0 ) );
+
+    ASSERT_THAT( whole.nbTemplates(), Eq( 1 ) );
+    ASSERT_THAT( whole.count( id ), Eq( 3 ) );
+    ASSERT_THAT( whole.tokens( id ).join( ' ' ).toStdString(), "Job done for <*>" );
+}
+
+// Three kinds of lines, in turn
+static const char* tm_formats[] = {
+    "Connection from 10.0.0.%d accepted on port %d\n",
+    "User %d logged in after %d ms\n",
+    "Disk usage above threshold\n",
+};
+
+class TemplateMinerBehaviour : public testing::Test {
+  public:
+    std::shared_ptr<LogData> log_data;
+    // Enough lines for several parts
+    static const int NB_LINES = 150000;
+
+    TemplateMinerBehaviour() : log_data( std::make_shared<LogData>() ) {
+        const QString file_name( TMPDIR "/templateminer.log" );
+        QFile file( file_name );
+        if ( file.open( QIODevice::WriteOnly ) ) {
+            char newLine[90];
+            for ( int i = 0; i < NB_LINES; i++ ) {
+                snprintf( newLine, 89, tm_formats[ i % 3 ], i % 256, i );
+                file.write( newLine, qstrlen( newLine ) );
+            }
+        }
+        file.close();
+
+        SafeQSignalSpy endSpy( log_data.get(), SIGNAL( loadingFinished( LoadingStatus ) ) );
+        log_data->attachFile( file_name );
+        endSpy.safeWait( 10000 );
+    }
+
+    std::shared_ptr<const TemplateIndex> mine() {
+        TemplateMiner miner;
+        SafeQSignalSpy finishedSpy( &miner, SIGNAL( finished() ) );
+
+        miner.start( log_data );
+        if ( ! finishedSpy.safeWait( 10000 ) )
+            return nullptr;
+
+        return miner.getIndex();
+    }
+};
+
+TEST_F( TemplateMinerBehaviour, linesAreClusteredInTemplates ) {
+    const auto index = mine();
+    ASSERT_TRUE( index != nullptr );
+
+    const auto& templates = index->getTemplates();
+    ASSERT_THAT( templates.size(), 3u );
+    ASSERT_THAT( index->getNbLines(), Eq( static_cast<LineNumber>( NB_LINES ) ) );
+
+    for ( LineNumber line = 0; line < 3; ++line ) {
+        const auto& templ = templates[ index->templateOf( line ) ];
+        ASSERT_THAT( templ.count, Eq( NB_LINES / 3 ) );
+        ASSERT_THAT( templ.exampleLine, Eq( line ) );
+    }
+    ASSERT_THAT( templates[ index->templateOf( 1 ) ].text.toStdString(),
+            "User <*> logged in after <*> ms" );
+    // In a later part
+    ASSERT_THAT( index->templateOf( NB_LINES - 1 ), Eq( index->templateOf( 2 ) ) );
+}
+
+TEST_F( TemplateMinerBehaviour, linesOfTheTemplatesSelectedAreSearched ) {
+    const auto index = mine();
+    ASSERT_TRUE( index != nullptr );
+
+    // All the lines but the disk usage ones
+    std::vector<bool> selected( index->getTemplates().size(), true );
+    selected[ index->templateOf( 2 ) ] = false;
+
+    LogFilteredData* filtered_data = log_data->getNewFilteredData();
+    SafeQSignalSpy progressSpy( filtered_data,
+            SIGNAL( searchProgressed( int, int, qint64 ) ) );
+    filtered_data->runTemplateSearch( index, selected );
+
+    int percent = 0;
+    while ( percent < 100 ) {
+        if ( progressSpy.isEmpty() && ! progressSpy.wait( 10000 ) )
+            break;
+        percent = qvariant_cast<int>( progressSpy.takeFirst().at( 1 ) );
+    }
+
+    ASSERT_THAT( filtered_data->getNbMatches(), Eq( NB_LINES / 3 * 2 ) );
+    ASSERT_THAT( filtered_data->getMatchingLineNumber( 2 ), Eq( 3 ) );
+    ASSERT_THAT( filtered_data->getNbLinesProcessed(), Eq( NB_LINES ) );
+
+    delete filtered_data;
+}
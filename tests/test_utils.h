@@ -5,6 +5,9 @@
 
 #include <string>
 #include <chrono>
+
+#include "data/abstractlogdata.h"
+
 struct TestTimer {
     TestTimer()
         : TestTimer(
@@ -46,4 +49,26 @@ class SafeQSignalSpy : public QSignalSpy {
     }
 };
 
+// Log data held in memory, so the lines can be added and removed
+class MemoryLogData : public AbstractLogData {
+  public:
+    QStringList lines;
+
+  protected:
+    QString doGetLineString( qint64 line ) const override
+    { return lines[line]; }
+    QString doGetExpandedLineString( qint64 line ) const override
+    { return lines[line]; }
+    QStringList doGetLines( qint64 first_line, int number ) const override
+    { return lines.mid( first_line, number ); }
+    QStringList doGetExpandedLines( qint64 first_line, int number ) const override
+    { return lines.mid( first_line, number ); }
+    qint64 doGetNbLine() const override { return lines.size(); }
+    int doGetMaxLength() const override { return 0; }
+    int doGetLineLength( qint64 line ) const override
+    { return lines[line].length(); }
+    void doSetDisplayEncoding( Encoding ) override {}
+    void doSetMultibyteEncodingOffsets( int, int ) override {}
+};
+
 #endif
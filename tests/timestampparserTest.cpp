@@ -0,0 +1,56 @@
+#include "gmock/gmock.h"
+
+#include "data/timestampparser.h"
+
+using namespace std;
+using namespace testing;
+
+class TimestampParserBehaviour : public testing::Test {
+  public:
+    TimestampParser parser;
+
+    // 2016-03-12 17:04:21 UTC
+    const qint64 reference = 1457802261000LL;
+};
+
+TEST_F( TimestampParserBehaviour, IsoTimestampIsRecognised ) {
+    ASSERT_THAT( parser.parse( "2016-03-12 17:04:21 INFO Started" ),
+            Eq( reference ) );
+    ASSERT_THAT( parser.parse( "2016-03-12T17:04:21.250Z INFO Started" ),
+            Eq( reference + 250 ) );
+    ASSERT_THAT( parser.parse( "[main] 2016-03-12 17:04:21,5 INFO Started" ),
+            Eq( reference + 500 ) );
+}
+
+TEST_F( TimestampParserBehaviour, ApacheTimestampIsRecognised ) {
+    ASSERT_THAT( parser.parse( "127.0.0.1 - - [12/Mar/2016:17:04:21 +0100] \"GET / HTTP/1.1\" 200" ),
+            Eq( reference ) );
+}
+
+TEST_F( TimestampParserBehaviour, SyslogTimestampIsRecognised ) {
+    const qint64 timestamp = parser.parse( "Mar 12 17:04:21 host kernel: started" );
+    const qint64 day = 24 * 3600 * 1000LL;
+
+    // The year is not in the line
+    ASSERT_THAT( timestamp, Ne( TimestampParser::NO_TIMESTAMP ) );
+    ASSERT_THAT( timestamp % day, Eq( reference % day ) );
+    ASSERT_THAT( parser.parse( "Mar 12 17:04:22 host kernel: done" ),
+            Eq( timestamp + 1000 ) );
+}
+
+TEST_F( TimestampParserBehaviour, LineWithoutTimestampIsRecognised ) {
+    ASSERT_THAT( parser.parse( "    at com.example.Main.run(Main.java:12)" ),
+            Eq( TimestampParser::NO_TIMESTAMP ) );
+    ASSERT_THAT( parser.parse( "" ), Eq( TimestampParser::NO_TIMESTAMP ) );
+}
+
+TEST_F( TimestampParserBehaviour, TimestampFarInTheLineIsIgnored ) {
+    ASSERT_THAT( parser.parse( QString( 100, 'x' ) + " 2016-03-12 17:04:21" ),
+            Eq( TimestampParser::NO_TIMESTAMP ) );
+}
+
+TEST_F( TimestampParserBehaviour, FormatsCanBeMixed ) {
+    ASSERT_THAT( parser.parse( "2016-03-12 17:04:21 INFO Started" ), Eq( reference ) );
+    ASSERT_THAT( parser.parse( "[12/Mar/2016:17:04:22 +0100] GET" ), Eq( reference + 1000 ) );
+    ASSERT_THAT( parser.parse( "2016-03-12 17:04:23 INFO Done" ), Eq( reference + 2000 ) );
+}
@@ -0,0 +1,126 @@
+#include "gmock/gmock.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "tracing.h"
+
+using namespace std;
+using namespace testing;
+
+class TracingBehaviour: public testing::Test {
+  public:
+    TracingBehaviour() {
+        Tracing::clear();
+    }
+
+    ~TracingBehaviour() {
+        Tracing::setEnabled( false );
+    }
+
+    string exported() {
+        ostringstream out;
+        Tracing::exportChromeTrace( out );
+        return out.str();
+    }
+
+    int count( const string& text, const string& pattern ) {
+        int n = 0;
+        for ( size_t pos = text.find( pattern ); pos != string::npos;
+                pos = text.find( pattern, pos + 1 ) )
+            ++n;
+        return n;
+    }
+};
+
+TEST_F( TracingBehaviour, NothingIsRecordedWhenDisabled ) {
+    {
+        TRACE_SPAN( "test", "disabled span" );
+    }
+
+    ASSERT_THAT( exported(), Not( HasSubstr( "disabled span" ) ) );
+}
+
+TEST_F( TracingBehaviour, SpansAreExportedInChromeFormat ) {
+    Tracing::setEnabled( true );
+    {
+        TRACE_SPAN( "test", "outer span", 42 );
+        TRACE_SPAN( "test", "inner span" );
+    }
+
+    const string trace = exported();
+    ASSERT_THAT( trace, StartsWith( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" ) );
+    ASSERT_THAT( trace, HasSubstr( "\"name\":\"outer span\",\"cat\":\"test\",\"ph\":\"X\"" ) );
+    ASSERT_THAT( trace, HasSubstr( "\"args\":{\"value\":42}" ) );
+    // Sorted by start time
+    ASSERT_THAT( trace.find( "outer span" ), Lt( trace.find( "inner span" ) ) );
+}
+
+TEST_F( TracingBehaviour, SpanCanBeEndedEarly ) {
+    Tracing::setEnabled( true );
+    {
+        TraceSpan span( "test", "early span" );
+        span.setArg( 7 );
+        span.end();
+    }
+
+    const string trace = exported();
+    ASSERT_THAT( count( trace, "early span" ), Eq( 1 ) );
+    ASSERT_THAT( trace, HasSubstr( "\"args\":{\"value\":7}" ) );
+}
+
+TEST_F( TracingBehaviour, SpanStartedDisabledIsNotRecorded ) {
+    {
+        TRACE_SPAN( "test", "late span" );
+        Tracing::setEnabled( true );
+    }
+
+    ASSERT_THAT( exported(), Not( HasSubstr( "late span" ) ) );
+}
+
+TEST_F( TracingBehaviour, ClearedSpansAreNotExported ) {
+    Tracing::setEnabled( true );
+    {
+        TRACE_SPAN( "test", "cleared span" );
+    }
+    Tracing::clear();
+    {
+        TRACE_SPAN( "test", "kept span" );
+    }
+
+    const string trace = exported();
+    ASSERT_THAT( trace, Not( HasSubstr( "cleared span" ) ) );
+    ASSERT_THAT( trace, HasSubstr( "kept span" ) );
+}
+
+TEST_F( TracingBehaviour, OnlyTheLatestSpansOfAThreadAreKept ) {
+    Tracing::setEnabled( true );
+
+    thread writer( [] {
+        for ( int i = 0; i < Tracing::bufferSize + 100; ++i ) {
+            TRACE_SPAN( "test", "ring span", i );
+        }
+    } );
+    writer.join();
+
+    // The oldest slot might be being rewritten, it is never exported
+    const string trace = exported();
+    ASSERT_THAT( count( trace, "ring span" ), Eq( Tracing::bufferSize - 1 ) );
+    ASSERT_THAT( trace, Not( HasSubstr( "\"args\":{\"value\":100}" ) ) );
+    ASSERT_THAT( trace, HasSubstr( "\"args\":{\"value\":101}" ) );
+}
+
+TEST_F( TracingBehaviour, ThreadsAreIdentified ) {
+    Tracing::setEnabled( true );
+
+    thread first( [] { TRACE_SPAN( "test", "first thread" ); } );
+    first.join();
+    thread second( [] { TRACE_SPAN( "test", "second thread" ); } );
+    second.join();
+
+    const string trace = exported();
+    const size_t first_tid = trace.find( "\"tid\":", trace.find( "first thread" ) );
+    const size_t second_tid = trace.find( "\"tid\":", trace.find( "second thread" ) );
+    ASSERT_THAT( trace.substr( first_tid, 8 ), Ne( trace.substr( second_tid, 8 ) ) );
+}
@@ -0,0 +1,73 @@
+#include <QTest>
+
+#include "log.h"
+
+#include "updatescheduler.h"
+
+#include "gmock/gmock.h"
+
+using namespace std;
+using namespace testing;
+
+class FakeClient : public ScheduledUpdateClientInterface {
+  public:
+    bool shown = true;
+    int updates = 0;
+
+  protected:
+    bool doIsShownForUpdate() const override { return shown; }
+    void doApplyScheduledUpdate() override { ++updates; }
+};
+
+class UpdateSchedulerBehaviour : public testing::Test {
+  public:
+    UpdateScheduler& scheduler = GetUpdateScheduler();
+
+    void waitFrames( int nb_frames = 3 ) {
+        QTest::qWait( nb_frames * UpdateScheduler::FRAME_INTERVAL_MS );
+    }
+};
+
+TEST_F( UpdateSchedulerBehaviour, RequestsAreCoalescedInOneFrame ) {
+    FakeClient client;
+    auto before = scheduler.statistics();
+
+    for ( int i = 0; i < 100; ++i )
+        scheduler.requestUpdate( &client );
+    ASSERT_THAT( client.updates, Eq( 0 ) );
+
+    waitFrames();
+
+    auto after = scheduler.statistics();
+    ASSERT_THAT( client.updates, Eq( 1 ) );
+    ASSERT_THAT( after.requested - before.requested, Eq( 100u ) );
+    ASSERT_THAT( after.coalesced - before.coalesced, Eq( 99u ) );
+    ASSERT_THAT( after.processed - before.processed, Eq( 1u ) );
+}
+
+TEST_F( UpdateSchedulerBehaviour, HiddenClientIsUpdatedWhenFlushed ) {
+    FakeClient client;
+    client.shown = false;
+
+    scheduler.requestUpdate( &client );
+    waitFrames();
+
+    ASSERT_THAT( client.updates, Eq( 0 ) );
+    ASSERT_TRUE( scheduler.isPending( &client ) );
+
+    client.shown = true;
+    scheduler.flush( &client );
+
+    ASSERT_THAT( client.updates, Eq( 1 ) );
+    ASSERT_FALSE( scheduler.isPending( &client ) );
+}
+
+TEST_F( UpdateSchedulerBehaviour, CancelledClientIsNotUpdated ) {
+    FakeClient client;
+
+    scheduler.requestUpdate( &client );
+    scheduler.cancel( &client );
+    waitFrames();
+
+    ASSERT_THAT( client.updates, Eq( 0 ) );
+}
@@ -0,0 +1,81 @@
+#include <string>
+
+#include "data/utf16scanner.h"
+
+#include "gmock/gmock.h"
+
+using namespace testing;
+
+class Utf16ScannerTest : public testing::Test {
+  public:
+    // Encode the code units
+    std::string encode( const std::u16string& text, bool big_endian ) {
+        std::string bytes;
+        for ( const char16_t code_unit: text ) {
+            const char low = static_cast<char>( code_unit & 0xFF );
+            const char high = static_cast<char>( code_unit >> 8 );
+            bytes += big_endian ? high : low;
+            bytes += big_endian ? low : high;
+        }
+        return bytes;
+    }
+
+    const int tabStop = 8;
+};
+
+TEST_F( Utf16ScannerTest, FindsLineFeeds ) {
+    for ( const bool big_endian: { false, true } ) {
+        const Utf16Scanner scanner( big_endian, tabStop );
+        // Long enough for the vectorised and scalar paths
+        const std::string text = encode(
+                u"first line\nsecond line is a bit longer\nthird", big_endian );
+
+        const int first = scanner.findLineFeed( text.data(), 0, text.size() );
+        ASSERT_THAT( first, Eq( 20 ) );
+        const int second = scanner.findLineFeed( text.data(), first + 2, text.size() );
+        ASSERT_THAT( second, Eq( 76 ) );
+        ASSERT_THAT( scanner.findLineFeed( text.data(), second + 2, text.size() ), Eq( -1 ) );
+    }
+}
+
+TEST_F( Utf16ScannerTest, IgnoresLineFeedBytesInOtherCharacters ) {
+    for ( const bool big_endian: { false, true } ) {
+        const Utf16Scanner scanner( big_endian, tabStop );
+        // U+010A and U+0A0A contain a 0x0A byte
+        const std::string text = encode(
+                u"Ċਊ਀ abc Ċਊ਀ def\n", big_endian );
+
+        ASSERT_THAT( scanner.findLineFeed( text.data(), 0, text.size() ),
+                Eq( static_cast<int>( text.size() ) - 2 ) );
+    }
+}
+
+TEST_F( Utf16ScannerTest, DoesNotReadPastTheEnd ) {
+    const Utf16Scanner scanner( false, tabStop );
+    const std::string text = encode( u"0123456789abcdef\n", false );
+
+    ASSERT_THAT( scanner.findLineFeed( text.data(), 0, text.size() - 2 ), Eq( -1 ) );
+    ASSERT_THAT( scanner.findLineFeed( text.data(), 0, text.size() - 1 ), Eq( -1 ) );
+}
+
+TEST_F( Utf16ScannerTest, LengthIsInCodePoints ) {
+    for ( const bool big_endian: { false, true } ) {
+        const Utf16Scanner scanner( big_endian, tabStop );
+        // U+1F600 is a surrogate pair
+        const std::string text = encode(
+                u"smile \U0001F600 and again \U0001F600!", big_endian );
+
+        ASSERT_THAT( scanner.expandedLength( text.data(), 0, text.size(), 0 ), Eq( 20 ) );
+    }
+}
+
+TEST_F( Utf16ScannerTest, TabsAreExpanded ) {
+    for ( const bool big_endian: { false, true } ) {
+        const Utf16Scanner scanner( big_endian, tabStop );
+        const std::string text = encode( u"a\tbc\tdefghijklmnopq\tr", big_endian );
+
+        ASSERT_THAT( scanner.expandedLength( text.data(), 0, text.size(), 0 ), Eq( 33 ) );
+        // Continuing a line
+        ASSERT_THAT( scanner.expandedLength( text.data(), 0, 4, 3 ), Eq( 8 ) );
+    }
+}
@@ -0,0 +1,372 @@
+// Rendering benchmarks of the log views, drawing offscreen:
+//   glogg_viewbenchmarks [--lines N] [--frames N] [--filters N]
+//                        [--filter TEXT]
+//
+// Each scenario scripts the views (scrolling, following, selecting,
+// highlighting) and repaints them synchronously after each step,
+// the time of each repaint is one frame.
+// QT_QPA_PLATFORM defaults to offscreen so no display is needed.
+
+#include <QApplication>
+#include <QFile>
+#include <QRegularExpression>
+#include <QScrollBar>
+#include <QSettings>
+#include <QSignalSpy>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "log.h"
+#include "corpusgenerator.h"
+
+#include "configuration.h"
+#include "filterset.h"
+#include "filteredview.h"
+#include "logmainview.h"
+#include "persistentinfo.h"
+#include "quickfindpattern.h"
+#include "data/logdata.h"
+#include "data/logfiltereddata.h"
+
+#define TMPDIR "/tmp"
+
+#ifndef GLOGG_PERF_MEASURE_FPS
+#  error "The views must be built with GLOGG_PERF_MEASURE_FPS to count the lines fetched"
+#endif
+
+namespace {
+
+int nbLines = 500000;
+int nbFrames = 300;
+int nbFilters = 20;
+
+const QString corpusFile = TMPDIR "/glogg_viewbenchmark.log";
+
+struct FrameStats {
+    std::vector<double> durationsMs;
+    std::vector<double> linesFetched;
+};
+
+double percentile( std::vector<double> values, double ratio )
+{
+    if ( values.empty() )
+        return 0;
+
+    std::sort( values.begin(), values.end() );
+    const size_t rank = static_cast<size_t>( ratio * ( values.size() - 1 ) + 0.5 );
+    return values[rank];
+}
+
+// Repaint the view now and record the time it took
+void drawFrame( AbstractLogView* view, FrameStats* stats )
+{
+    using namespace std::chrono;
+
+    const qint64 fetched_before = view->getNbLinesFetched();
+
+    const auto start = steady_clock::now();
+    view->viewport()->repaint();
+    const auto end = steady_clock::now();
+
+    stats->durationsMs.push_back(
+            duration_cast<microseconds>( end - start ).count() / 1000.0 );
+    stats->linesFetched.push_back( view->getNbLinesFetched() - fetched_before );
+}
+
+void printHeader()
+{
+    std::cout << std::left << std::setw( 28 ) << "scenario" << std::right
+        << std::setw( 8 ) << "frames"
+        << std::setw( 10 ) << "p50 ms"
+        << std::setw( 10 ) << "p95 ms"
+        << std::setw( 10 ) << "p99 ms"
+        << std::setw( 10 ) << "max ms"
+        << std::setw( 14 ) << "lines/frame" << std::endl;
+}
+
+void printStats( const std::string& name, const FrameStats& stats )
+{
+    const double lines_per_frame = stats.linesFetched.empty() ? 0 :
+        std::accumulate( stats.linesFetched.begin(), stats.linesFetched.end(), 0.0 )
+        / stats.linesFetched.size();
+
+    std::cout << std::left << std::setw( 28 ) << name << std::right
+        << std::setw( 8 ) << stats.durationsMs.size()
+        << std::fixed << std::setprecision( 3 )
+        << std::setw( 10 ) << percentile( stats.durationsMs, 0.5 )
+        << std::setw( 10 ) << percentile( stats.durationsMs, 0.95 )
+        << std::setw( 10 ) << percentile( stats.durationsMs, 0.99 )
+        << std::setw( 10 ) << percentile( stats.durationsMs, 1 )
+        << std::setprecision( 1 )
+        << std::setw( 14 ) << lines_per_frame << std::endl;
+}
+
+// Replace the FilterSet used by the views by one of nb_filters filters,
+// none of them matching except the last one.
+void setFilters( int nb_filters )
+{
+    const QString file_name = TMPDIR "/glogg_viewbenchmark.ini";
+    QFile::remove( file_name );
+
+    {
+        QSettings settings( file_name, QSettings::IniFormat );
+        // As written by FilterSet::saveToStorage (version 1)
+        settings.beginGroup( "FilterSet" );
+        settings.setValue( "version", 1 );
+        settings.beginWriteArray( "filters" );
+        for ( int i = 0; i < nb_filters; ++i ) {
+            settings.setArrayIndex( i );
+            settings.setValue( "regexp", i == nb_filters - 1 ?
+                    QString( "ERROR.*failed" ) : QString( "nomatch%1\\d+" ).arg( i ) );
+            settings.setValue( "ignore_case", i % 2 == 0 );
+            settings.setValue( "fore_colour", "black" );
+            settings.setValue( "back_colour", "red" );
+        }
+        settings.endArray();
+        settings.endGroup();
+    }
+
+    QSettings settings( file_name, QSettings::IniFormat );
+    Persistent<FilterSet>( "filterSet" )->retrieveFromStorage( settings );
+}
+
+class ViewBenchmarks {
+  public:
+    ViewBenchmarks();
+
+    void run( const std::string& filter );
+
+  private:
+    void scrollByLine( AbstractLogView* view, FrameStats* stats );
+    void scrollByPage( AbstractLogView* view, FrameStats* stats );
+    void jump( AbstractLogView* view, FrameStats* stats );
+    void moveSelection( AbstractLogView* view, FrameStats* stats );
+    void follow( FrameStats* stats );
+
+    void reset();
+
+    std::mt19937 rng_;
+    CorpusGenerator appender_;
+
+    LogData logData_;
+    std::unique_ptr<LogFilteredData> filteredData_;
+    QuickFindPattern quickFindPattern_;
+
+    std::unique_ptr<LogMainView> mainView_;
+    std::unique_ptr<FilteredView> filteredView_;
+};
+
+ViewBenchmarks::ViewBenchmarks()
+    : rng_( 42 ), appender_( CorpusOptions() )
+{
+    CorpusOptions options;
+    options.maxLines = nbLines;
+    options.density = 0.1;
+    options.utf8 = true;
+    {
+        std::ofstream file( corpusFile.toStdString(), std::ios::binary );
+        CorpusGenerator( options ).write( file );
+    }
+
+    QSignalSpy endSpy( &logData_, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    logData_.attachFile( corpusFile );
+    endSpy.wait( 600000 );
+
+    filteredData_.reset( logData_.getNewFilteredData() );
+    QSignalSpy searchSpy( filteredData_.get(),
+            SIGNAL( searchProgressed( int, int, qint64 ) ) );
+    filteredData_->runSearch( QRegularExpression( corpusNeedle ) );
+    while ( searchSpy.isEmpty() || searchSpy.last()[1].toInt() < 100 )
+        searchSpy.wait( 600000 );
+
+    mainView_.reset( new LogMainView( &logData_, &quickFindPattern_,
+                nullptr, nullptr ) );
+    mainView_->useNewFiltering( filteredData_.get() );
+    filteredView_.reset( new FilteredView( filteredData_.get(), &quickFindPattern_ ) );
+}
+
+void ViewBenchmarks::run( const std::string& filter )
+{
+    struct Scenario {
+        std::string name;
+        std::function<void( FrameStats* )> run;
+    };
+
+    LogMainView* main_view = mainView_.get();
+    FilteredView* filtered_view = filteredView_.get();
+
+    const std::vector<Scenario> scenarios = {
+        { "main/scroll_line", [=]( FrameStats* s ) { scrollByLine( main_view, s ); } },
+        { "main/scroll_page", [=]( FrameStats* s ) { scrollByPage( main_view, s ); } },
+        { "main/jump", [=]( FrameStats* s ) { jump( main_view, s ); } },
+        { "main/select", [=]( FrameStats* s ) { moveSelection( main_view, s ); } },
+        { "main/follow", [=]( FrameStats* s ) { follow( s ); } },
+        { "main/filters/scroll_page", [=]( FrameStats* s ) {
+            setFilters( nbFilters );
+            scrollByPage( main_view, s ); } },
+        { "main/quickfind/scroll_page", [=]( FrameStats* s ) {
+            quickFindPattern_.changeSearchPattern( "connection|fail(ed)?|\\d+ms" );
+            scrollByPage( main_view, s ); } },
+        { "filtered/scroll_page", [=]( FrameStats* s ) { scrollByPage( filtered_view, s ); } },
+        { "filtered/jump", [=]( FrameStats* s ) { jump( filtered_view, s ); } },
+        { "filtered/filters/jump", [=]( FrameStats* s ) {
+            setFilters( nbFilters );
+            jump( filtered_view, s ); } },
+    };
+
+    printHeader();
+    for ( const auto& scenario: scenarios ) {
+        if ( scenario.name.find( filter ) == std::string::npos )
+            continue;
+
+        reset();
+
+        FrameStats stats;
+        scenario.run( &stats );
+        printStats( scenario.name, stats );
+    }
+}
+
+void ViewBenchmarks::scrollByLine( AbstractLogView* view, FrameStats* stats )
+{
+    view->show();
+    drawFrame( view, stats );
+    stats->durationsMs.clear();
+    stats->linesFetched.clear();
+
+    QScrollBar* scroll_bar = view->verticalScrollBar();
+    for ( int i = 0; i < nbFrames; ++i ) {
+        scroll_bar->setValue( scroll_bar->value() + 1 );
+        drawFrame( view, stats );
+    }
+}
+
+void ViewBenchmarks::scrollByPage( AbstractLogView* view, FrameStats* stats )
+{
+    view->show();
+
+    QScrollBar* scroll_bar = view->verticalScrollBar();
+    for ( int i = 0; i < nbFrames; ++i ) {
+        scroll_bar->setValue( scroll_bar->value() + scroll_bar->pageStep() );
+        drawFrame( view, stats );
+    }
+}
+
+void ViewBenchmarks::jump( AbstractLogView* view, FrameStats* stats )
+{
+    view->show();
+
+    QScrollBar* scroll_bar = view->verticalScrollBar();
+    std::uniform_int_distribution<int> position( 0, scroll_bar->maximum() );
+    for ( int i = 0; i < nbFrames; ++i ) {
+        scroll_bar->setValue( position( rng_ ) );
+        drawFrame( view, stats );
+    }
+}
+
+void ViewBenchmarks::moveSelection( AbstractLogView* view, FrameStats* stats )
+{
+    view->show();
+
+    // Move the selection down, the view scrolls when it reaches the bottom
+    for ( int i = 0; i < nbFrames; ++i ) {
+        view->selectAndDisplayLine( i * 3 );
+        drawFrame( view, stats );
+    }
+}
+
+void ViewBenchmarks::follow( FrameStats* stats )
+{
+    mainView_->show();
+    mainView_->followSet( true );
+
+    QSignalSpy endSpy( &logData_, SIGNAL( loadingFinished( LoadingStatus ) ) );
+    for ( int i = 0; i < nbFrames; ++i ) {
+        endSpy.clear();
+        {
+            std::ofstream file( corpusFile.toStdString(),
+                    std::ios::binary | std::ios::app );
+            for ( int j = 0; j < 20; ++j )
+                file << appender_.nextLine() << appender_.endOfLine();
+        }
+        if ( ! endSpy.wait( 10000 ) )
+            break;
+
+        // As CrawlerWidget does when the data are updated
+        mainView_->updateData();
+        drawFrame( mainView_.get(), stats );
+    }
+
+    mainView_->followSet( false );
+}
+
+void ViewBenchmarks::reset()
+{
+    setFilters( 0 );
+    quickFindPattern_.changeSearchPattern( "" );
+
+    for ( AbstractLogView* view:
+            std::initializer_list<AbstractLogView*>{ mainView_.get(), filteredView_.get() } ) {
+        view->hide();
+        view->resize( 1200, 800 );
+        view->verticalScrollBar()->setValue( 0 );
+        view->forceRefresh();
+    }
+}
+
+}
+
+int main( int argc, char* argv[] )
+{
+    if ( qgetenv( "QT_QPA_PLATFORM" ).isEmpty() )
+        qputenv( "QT_QPA_PLATFORM", "offscreen" );
+
+    QApplication app( argc, argv );
+
+    FILELog::setReportingLevel( logERROR );
+
+    std::string filter;
+
+    const QStringList args = app.arguments();
+    for ( int i = 1; i + 1 < args.size(); i += 2 ) {
+        const QString& value = args[i + 1];
+        if ( args[i] == "--lines" )
+            nbLines = value.toInt();
+        else if ( args[i] == "--frames" )
+            nbFrames = value.toInt();
+        else if ( args[i] == "--filters" )
+            nbFilters = value.toInt();
+        else if ( args[i] == "--filter" )
+            filter = value.toStdString();
+        else {
+            std::cerr << "Unknown option " << args[i].toStdString() << std::endl;
+            return 1;
+        }
+    }
+
+    qRegisterMetaType<LoadingStatus>( "LoadingStatus" );
+
+    GetPersistentInfo().migrateAndInit();
+    GetPersistentInfo().registerPersistable(
+            std::make_shared<Configuration>(), QString( "settings" ) );
+    GetPersistentInfo().registerPersistable(
+            std::make_shared<FilterSet>(), QString( "filterSet" ) );
+
+    {
+        ViewBenchmarks benchmarks;
+        benchmarks.run( filter );
+    }
+
+    QFile::remove( corpusFile );
+
+    return 0;
+}
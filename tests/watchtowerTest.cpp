@@ -443,6 +443,211 @@ TEST_F( WatchTowerInexistantDirectory, LaterCreatedDirIsFollowed ) {
 
 /*****/
 
+class WatchTowerManyFiles: public WatchTowerDirectories {
+  public:
+    static const int NB_FILES;
+
+    vector<string> file_names;
+    vector<Registration> registrations;
+
+    WatchTowerManyFiles() {
+        // The files don't exist so they don't use any inotify watch,
+        // only the directory is watched.
+        for ( int i = 0; i < NB_FILES; i++ ) {
+            file_names.push_back( second_dir_name + "/stress" + to_string( i ) );
+            registrations.push_back( registerFile( file_names.back() ) );
+        }
+    }
+
+    ~WatchTowerManyFiles() {
+        registrations.clear();
+        for ( auto& name: file_names )
+            remove( name.c_str() );
+    }
+};
+
+const int WatchTowerManyFiles::NB_FILES = 10000;
+
+TEST_F( WatchTowerManyFiles, AllFilesAreFollowedInTheirDir ) {
+    ASSERT_THAT( watch_tower->numberWatchedDirectories(), Eq( 2 ) );
+}
+
+TEST_F( WatchTowerManyFiles, CreatingOneOfTheFilesYieldsANotification ) {
+    createTempEmptyFile( file_names[ NB_FILES / 2 ] );
+    ASSERT_TRUE( waitNotificationReceived() );
+}
+
+TEST_F( WatchTowerManyFiles, AppendingToACreatedFileYieldsANotification ) {
+    createTempEmptyFile( file_names[ NB_FILES - 1 ] );
+    waitNotificationReceived();
+
+    appendDataToFile( file_names[ NB_FILES - 1 ] );
+    ASSERT_TRUE( waitNotificationReceived() );
+}
+
+TEST_F( WatchTowerManyFiles, RemovingAllRegistrationsStopsWatchingTheDir ) {
+    registrations.clear();
+    ASSERT_THAT( watch_tower->numberWatchedDirectories(), Eq( 1 ) );
+}
+
+/*****/
+
+// Fake driver used to exercise the list bookkeeping
+// without any OS resources.
+class FakeWatchTowerDriver {
+  public:
+    class Id {
+      public:
+        Id( int id = -1 ) { id_ = id; }
+        bool operator==( const Id& other ) const
+        { return id_ == other.id_; }
+        bool valid() const
+        { return (id_ != -1); }
+        std::size_t hash() const
+        { return std::hash<int>()( id_ ); }
+      private:
+        int id_;
+    };
+
+    typedef Id FileId;
+    typedef Id SymlinkId;
+    typedef Id DirId;
+
+    class FileChangeToken {
+      public:
+        FileChangeToken() {}
+        FileChangeToken( const std::string& ) {}
+
+        void readFromFile( const std::string& ) {}
+
+        bool operator!=( const FileChangeToken& )
+        { return true; }
+    };
+};
+
+class ObservedFileListStress: public testing::Test {
+  public:
+    static const int NB_FILES;
+    static const int NB_DIRS;
+
+    ObservedFileList<FakeWatchTowerDriver> list;
+    vector<shared_ptr<ObservedDir<FakeWatchTowerDriver>>> dirs;
+    vector<shared_ptr<void>> callbacks;
+
+    string dirName( int dir ) {
+        return string { "/stress/dir" } + to_string( dir );
+    }
+
+    string baseName( int file ) {
+        return string { "file" } + to_string( file );
+    }
+
+    string fileName( int file ) {
+        return dirName( file % NB_DIRS ) + "/" + baseName( file );
+    }
+
+    ObservedFileListStress() {
+        for ( int i = 0; i < NB_DIRS; i++ ) {
+            dirs.push_back( list.addWatchedDirectory( dirName( i ),
+                        [] (ObservedDir<FakeWatchTowerDriver>*) {} ) );
+            list.setDirectoryId( dirs.back(), { i } );
+        }
+
+        for ( int i = 0; i < NB_FILES; i++ ) {
+            callbacks.push_back( make_shared<int>( i ) );
+            list.addNewObservedFile( ObservedFile<FakeWatchTowerDriver>(
+                        fileName( i ), callbacks.back(), { i }, { NB_FILES + i } ) );
+        }
+    }
+};
+
+const int ObservedFileListStress::NB_FILES = 10000;
+const int ObservedFileListStress::NB_DIRS  = 100;
+
+TEST_F( ObservedFileListStress, AllFilesAreFoundByName ) {
+    for ( int i = 0; i < NB_FILES; i++ ) {
+        auto file = list.searchByName( fileName( i ) );
+        ASSERT_THAT( file, NotNull() );
+        ASSERT_THAT( file->file_name_, Eq( fileName( i ) ) );
+    }
+}
+
+TEST_F( ObservedFileListStress, AllFilesAreFoundByFileOrSymlinkId ) {
+    for ( int i = 0; i < NB_FILES; i++ ) {
+        auto by_file = list.searchByFileOrSymlinkWd( { i }, {} );
+        ASSERT_THAT( by_file, NotNull() );
+        ASSERT_THAT( by_file->file_name_, Eq( fileName( i ) ) );
+
+        auto by_symlink = list.searchByFileOrSymlinkWd( {}, { NB_FILES + i } );
+        ASSERT_THAT( by_symlink, Eq( by_file ) );
+    }
+}
+
+TEST_F( ObservedFileListStress, AllFilesAreFoundByDirAndName ) {
+    for ( int i = 0; i < NB_FILES; i++ ) {
+        auto file = list.searchByDirWdAndName(
+                { i % NB_DIRS }, baseName( i ).c_str() );
+        ASSERT_THAT( file, NotNull() );
+        ASSERT_THAT( file->file_name_, Eq( fileName( i ) ) );
+    }
+}
+
+TEST_F( ObservedFileListStress, AllFilesInADirAreFound ) {
+    auto files = list.searchByDirWd( { 42 } );
+
+    ASSERT_THAT( files.size(), Eq( NB_FILES / NB_DIRS ) );
+    for ( auto file: files )
+        ASSERT_THAT( file->dir_, IsNull() );
+}
+
+TEST_F( ObservedFileListStress, UnknownIdsAreNotFound ) {
+    ASSERT_THAT( list.searchByFileOrSymlinkWd( { 3 * NB_FILES }, {} ), IsNull() );
+    ASSERT_THAT( list.searchByDirWdAndName( { NB_DIRS }, "file0" ), IsNull() );
+    ASSERT_THAT( list.searchByDirWd( { NB_DIRS } ).size(), Eq( 0 ) );
+}
+
+TEST_F( ObservedFileListStress, UpdatedIdsAreFound ) {
+    auto file = list.searchByName( fileName( 1234 ) );
+    list.updateFileIds( file, { 3 * NB_FILES }, {} );
+
+    ASSERT_THAT( list.searchByFileOrSymlinkWd( { 3 * NB_FILES }, {} ), Eq( file ) );
+    ASSERT_THAT( list.searchByFileOrSymlinkWd( { 1234 }, {} ), IsNull() );
+    ASSERT_THAT( list.searchByFileOrSymlinkWd( {}, { NB_FILES + 1234 } ), IsNull() );
+}
+
+TEST_F( ObservedFileListStress, ExtraCallbackKeepsTheFile ) {
+    auto extra_callback = make_shared<int>( -1 );
+    list.addCallback( list.searchByName( fileName( 10 ) ), extra_callback );
+
+    ASSERT_THAT( list.removeCallback( callbacks[10] ), IsNull() );
+    ASSERT_THAT( list.searchByName( fileName( 10 ) ), NotNull() );
+
+    ASSERT_THAT( list.removeCallback( extra_callback ), NotNull() );
+    ASSERT_THAT( list.searchByName( fileName( 10 ) ), IsNull() );
+}
+
+TEST_F( ObservedFileListStress, RemovingAllCallbacksRemovesAllFiles ) {
+    for ( int i = 0; i < NB_FILES; i++ ) {
+        auto file = list.removeCallback( callbacks[i] );
+        ASSERT_THAT( file, NotNull() );
+        ASSERT_THAT( file->file_name_, Eq( fileName( i ) ) );
+    }
+
+    ASSERT_THAT( list.numberObservedFiles(), Eq( 0 ) );
+    ASSERT_THAT( list.searchByDirWd( { 0 } ).size(), Eq( 0 ) );
+    ASSERT_THAT( list.searchByFileOrSymlinkWd( { 0 }, {} ), IsNull() );
+}
+
+TEST_F( ObservedFileListStress, ExpiredDirsAreNotFound ) {
+    dirs[5].reset();
+
+    ASSERT_THAT( list.numberWatchedDirectories(), Eq( NB_DIRS - 1 ) );
+    ASSERT_THAT( list.searchByDirWd( { 5 } ).size(), Eq( 0 ) );
+    ASSERT_THAT( list.searchByDirWdAndName( { 5 }, "file5" ), IsNull() );
+}
+
+/*****/
+
 #ifdef _WIN32
 class WinNotificationInfoListTest : public testing::Test {
   public: